@@ -0,0 +1,104 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include "snake.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Автозбереження гри. Ігровий потік лише копіює стан у буфер у пам'яті
+// (autosave_capture), а окремий потік пише його у тимчасовий файл, робить
+// fsync і перейменовує поверх контрольної точки, тож на диску завжди лежить
+// цілий файл. Попередня точка зберігається як path.prev; при відновленні
+// береться новіша з тих, що пройшли перевірку CRC-32.
+
+#define AUTOSAVE_INTERVAL 50       // Кроків між збереженнями
+#define AUTOSAVE_PATH_LEN 1024
+
+/**
+ * @brief Усе, що потрібно, щоб продовжити гру з того ж місця.
+ */
+typedef struct {
+    GameState game;              ///< Покажчики events і foods скинуто в NULL
+    FoodPool foods;              ///< Набір їжі, якщо has_foods
+    uint64_t rng;                ///< Стан генератора гри
+    uint64_t tick;               ///< Кроків від початку гри
+    struct timeval saved_at;     ///< Час збереження за годинником гри
+    int32_t has_foods;
+    int32_t level_id;            ///< LEVEL_ID_* для таблиці рекордів
+    int32_t rewound;             ///< Гру перемотували (результат не записується)
+    int32_t reserved;
+} AutosaveState;
+
+/**
+ * @brief Фоновий записувач контрольних точок.
+ * pending заповнює ігровий потік, writing пише фоновий; м'ютекс тримається
+ * лише на час копіювання між ними, ніколи під час запису на диск.
+ */
+typedef struct {
+    char path[AUTOSAVE_PATH_LEN];
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    AutosaveState pending;
+    AutosaveState writing;
+    int has_pending;
+    int stop;
+    uint64_t sequence;           ///< Номер останньої записаної точки
+    unsigned long captured;
+    unsigned long saved;
+    unsigned long replaced;      ///< Точки, замінені новішими до запису
+    unsigned long failed;
+} Autosave;
+
+/**
+ * @brief Запускає фоновий потік запису в path.
+ * @param sequence Номер, з якого продовжувати (з autosave_load або 0).
+ * @return 0 при успіху, -1 якщо потік не створено.
+ */
+int autosave_start(Autosave *saver, const char *path, uint64_t sequence);
+
+/**
+ * @brief Знімає стан гри для запису (лише ігровий потік). Не чекає на диск:
+ * ще не записана точка замінюється новою.
+ */
+void autosave_capture(Autosave *saver, const GameState *game, uint64_t tick,
+                      int level_id, int rewound);
+
+/**
+ * @brief Дописує останню зняту точку і зупиняє потік.
+ */
+void autosave_stop(Autosave *saver);
+
+/**
+ * @brief Синхронно записує точку (тимчасовий файл, fsync, rename).
+ * @return 0 при успіху, -1 при помилці запису.
+ */
+int autosave_write(const char *path, const AutosaveState *state, uint64_t sequence);
+
+/**
+ * @brief Читає найновішу цілу точку з path або path.prev.
+ * @param sequence Номер прочитаної точки (може бути NULL).
+ * @return 0 при успіху, -1 якщо жодна не пройшла перевірку.
+ */
+int autosave_load(const char *path, AutosaveState *state, uint64_t *sequence);
+
+/**
+ * @brief Переносить точку в гру: стан генератора, набір їжі (у foods) і
+ * таймер прискорення. Гра відновлюється на паузі; час між збереженням і
+ * відновленням не рахується проти прискорення.
+ */
+void autosave_restore(const AutosaveState *state, GameState *game, FoodPool *foods);
+
+/**
+ * @brief Видаляє контрольні точки (після завершеної гри).
+ */
+void autosave_remove(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUTOSAVE_H
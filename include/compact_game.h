@@ -0,0 +1,83 @@
+#ifndef COMPACT_GAME_H
+#define COMPACT_GAME_H
+
+#include "fast_game.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Компактний стан гри для пакетних рушіїв: одна кеш-лінія (64 байти)
+// замість ~700 байт GameState, тож десятки мільйонів ігор вміщаються в
+// пам'ять. Для кроку гра розгортається у FastGame і згортається назад.
+//
+// Тіло зберігається як позиція голови плюс 2-бітний напрямок до кожного
+// наступного сегмента; сегменти, що ще не розгорнулися після росту
+// (стоять на хвості), лише лічаться. Перешкоди - 10-бітні номери клітинок.
+// Стіни рівня не копіюються: гра тримає вказівник на спільну сітку.
+// Прискорення зберігається в кроках по COMPACT_TICK_US від активації,
+// тож перетворення точне, коли годинник гри кратний кроку (як у SnakeEnv).
+// Час початку паузи (paused_at) не зберігається.
+
+#define COMPACT_TICK_US 100000         // Тривалість кроку, як ENV_TICK_US
+#define COMPACT_MOVE_BYTES ((MAX_SNAKE_LENGTH - 1 + 3) / 4)
+#define COMPACT_OBSTACLE_BITS 10
+#define COMPACT_OBSTACLE_BYTES ((MAX_OBSTACLES * COMPACT_OBSTACLE_BITS + 7) / 8)
+
+// Поля CompactGame.flags
+#define COMPACT_DIR_MASK 0x03          // Напрямок руху (DIR_*)
+#define COMPACT_FOOD_ACTIVE 0x04
+#define COMPACT_FOOD_SHIFT 3           // Тип їжі (FOOD_*), 2 біти
+#define COMPACT_STATE_SHIFT 5          // Стан гри (GAME_*), 3 біти
+
+/**
+ * @brief Стан гри в одній кеш-лінії.
+ */
+typedef struct {
+    const Grid *walls;           ///< Стіни рівня поза списком перешкод (NULL - немає)
+    uint16_t score;
+    int8_t head_x;               ///< Голова може бути на рамці після зіткнення
+    int8_t head_y;
+    uint8_t length;
+    uint8_t flags;               ///< COMPACT_*: напрямок, їжа, стан
+    int8_t food_x;
+    int8_t food_y;
+    uint8_t boost_age;           ///< 0 - немає прискорення, інакше 1 + кроків від старту
+    uint8_t stacked;             ///< Кількість сегментів, що стоять на хвості
+    uint8_t apples_eaten;
+    uint8_t special_apples_eaten[4];
+    uint8_t obstacle_count;
+    uint8_t moves[COMPACT_MOVE_BYTES];          ///< По 2 біти на сегмент після голови
+    uint8_t obstacles[COMPACT_OBSTACLE_BYTES];  ///< По 10 біт на перешкоду
+} __attribute__((aligned(64))) CompactGame;
+
+/**
+ * @brief Стискає стан гри.
+ * @param walls Стіни рівня, яких немає в списку перешкод (NULL для класичного поля).
+ *        Сітка має жити, доки використовується компактна гра.
+ * @return 0 при успіху, -1 якщо стан не можна представити (тіло з розривами,
+ *         сітка перешкод не збігається з walls і списком, значення поза межами).
+ */
+int compact_game_from_state(CompactGame *game, const GameState *state, const Grid *walls);
+
+/**
+ * @brief Відновлює повний стан гри (events = NULL).
+ */
+void compact_game_to_state(const CompactGame *game, GameState *state);
+
+/**
+ * @brief Стискає стан оптимізованого рушія.
+ * @return 0 при успіху, -1 як у compact_game_from_state().
+ */
+int compact_game_from_fast(CompactGame *game, const FastGame *fast, const Grid *walls);
+
+/**
+ * @brief Розгортає компактну гру для кроку в оптимізованому рушії.
+ */
+void compact_game_to_fast(const CompactGame *game, FastGame *fast);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMPACT_GAME_H
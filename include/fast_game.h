@@ -0,0 +1,61 @@
+#ifndef FAST_GAME_H
+#define FAST_GAME_H
+
+#include "snake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Оптимізований рушій для пакетних прогонів: тіло змійки в кільцевому
+// буфері (рух за O(1) замість зсуву масиву) та лічильники сегментів на
+// клітинку (перевірка зіткнень і вільних клітинок за O(1)).
+// Семантика та споживання випадкових чисел збігаються з game.c.
+
+#define FAST_RING_SIZE 64   // Степінь двійки, не менша за MAX_SNAKE_LENGTH
+#define FAST_RING_MASK (FAST_RING_SIZE - 1)
+
+/**
+ * @brief Стан гри для оптимізованого рушія.
+ */
+typedef struct {
+    Point ring[FAST_RING_SIZE];  ///< Сегменти; голова в ring[head]
+    int head;
+    int length;
+    int direction;
+    uint8_t cells[GRID_H][GRID_W];  ///< Кількість сегментів у клітинці
+    Food food;
+    Obstacles obstacles;
+    SpeedBoost speed_boost;
+    int score;
+    int state;
+    int apples_eaten;
+    int special_apples_eaten[4];
+} FastGame;
+
+/**
+ * @brief Заповнює FastGame зі звичайного стану гри.
+ */
+void fast_game_from_state(FastGame *game, const GameState *state);
+
+/**
+ * @brief Перетворює FastGame назад у GameState.
+ */
+void fast_game_to_state(const FastGame *game, GameState *state);
+
+/**
+ * @brief Змінює напрямок, якщо це не розворот на 180 градусів.
+ */
+void fast_game_turn(FastGame *game, int direction);
+
+/**
+ * @brief Один крок гри, еквівалентний update_game().
+ * @return Новий стан гри.
+ */
+int fast_game_step(FastGame *game);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAST_GAME_H
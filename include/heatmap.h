@@ -0,0 +1,85 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "snake.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Теплові карти поля для пакетних запусків: скільки разів голова була в
+// клітинці, де з'їдено їжу і де змійка загинула (окремо для стіни, себе
+// та перешкоди). Кожен потік рахує у власну карту без атомарних операцій;
+// наприкінці карти складаються одна в одну поелементно (цикл
+// векторизується), тож рахування не залежить від кількості потоків.
+// Клітинки індексуються як сітка GRID_W x GRID_H, разом із рамкою, куди
+// потрапляє голова при зіткненні зі стіною.
+
+#define HEATMAP_VISITS 0
+#define HEATMAP_FOOD 1
+#define HEATMAP_DEATH_WALL 2     // HEATMAP_DEATH_WALL + cause - DEATH_WALL
+#define HEATMAP_DEATH_SELF 3
+#define HEATMAP_DEATH_OBSTACLE 4
+#define HEATMAP_LAYERS 5
+
+// Рядок шару, доповнений до кратного 8 (цілі вектори при злитті)
+#define HEATMAP_STRIDE ((GRID_W * GRID_H + 7) & ~7)
+
+/**
+ * @brief Лічильники клітинок для всіх шарів.
+ */
+typedef struct {
+    uint64_t cells[HEATMAP_LAYERS][HEATMAP_STRIDE]; ///< [шар][y * GRID_W + x]
+    uint64_t games;
+} Heatmap;
+
+extern const char *const heatmap_layer_names[HEATMAP_LAYERS];
+
+void heatmap_clear(Heatmap *heatmap);
+
+/**
+ * @brief Збільшує клітинку (x, y) шару; координати поза сіткою ігноруються.
+ */
+void heatmap_add(Heatmap *heatmap, int layer, int x, int y);
+
+/**
+ * @brief Обробник шини подій: EVENT_MOVED, EVENT_FOOD_EATEN і EVENT_DIED.
+ * @param context Heatmap *.
+ */
+void heatmap_on_events(const GameEvent *events, int count, const GameState *game, void *context);
+
+/**
+ * @brief Додає src до dst.
+ */
+void heatmap_merge(Heatmap *dst, const Heatmap *src);
+
+/**
+ * @brief Значення клітинки.
+ */
+uint64_t heatmap_get(const Heatmap *heatmap, int layer, int x, int y);
+
+/**
+ * @brief Записує CSV: x,y і стовпець на кожен шар, рядок на клітинку.
+ */
+int heatmap_write_csv(const Heatmap *heatmap, FILE *out);
+
+/**
+ * @brief Записує шар як PGM (P5), клітинка - піксель.
+ *
+ * Яскравість логарифмічна: 255 * log(1 + n) / log(1 + max), щоб рідкісні
+ * клітинки лишалися видимими поруч з найчастішими.
+ */
+int heatmap_write_pgm(const Heatmap *heatmap, int layer, FILE *out);
+
+/**
+ * @brief Записує prefix.csv і prefix-<шар>.pgm для кожного шару.
+ * @return 0 при успіху, -1 якщо файл не вдалося записати.
+ */
+int heatmap_export(const Heatmap *heatmap, const char *prefix);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HEATMAP_H
@@ -0,0 +1,123 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "render.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Введення з окремого потоку. Потік блокується на читанні терміналу,
+// розбирає клавіші (стрілки, WASD, Q) і кладе команди з часом надходження
+// в кільцевий буфер без блокувань (один записувач, один читач).
+// Ігровий цикл забирає команди на початку кроку.
+
+#define INPUT_RING_SIZE 64         // Степінь двійки
+#define INPUT_LATENCY_BUCKETS 32   // Кошики log2 мікросекунд
+
+/**
+ * @brief Команда з клавіатури та момент її надходження.
+ */
+typedef struct {
+    int key;                     ///< INPUT_*
+    uint64_t time_ns;            ///< CLOCK_MONOTONIC, коли байти прочитано
+} InputCommand;
+
+/**
+ * @brief Кільце SPSC: head пише лише потік введення, tail - лише гра.
+ * Індекси в окремих кеш-лініях, щоб потоки не заважали один одному.
+ */
+typedef struct {
+    unsigned int head __attribute__((aligned(64)));
+    unsigned int tail __attribute__((aligned(64)));
+    InputCommand slots[INPUT_RING_SIZE] __attribute__((aligned(64)));
+} InputRing;
+
+/**
+ * @brief Потік, що читає клавіші з файлового дескриптора.
+ */
+typedef struct {
+    InputRing ring;
+    pthread_t thread;
+    int fd;
+    int stop_pipe[2];
+    int wake_pipe[2];            ///< Потік пише сюди після нових команд
+    unsigned long dropped;       ///< Команди, що не влізли в повне кільце
+} InputThread;
+
+/**
+ * @brief Затримка від надходження клавіші до кроку, що її застосував.
+ */
+typedef struct {
+    unsigned long count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    unsigned long buckets[INPUT_LATENCY_BUCKETS];
+} InputLatency;
+
+/**
+ * @brief Розбирає першу клавішу в буфері.
+ * @param used Скільки байтів вона займає; 0, якщо escape-послідовність ще не дочитана.
+ * @return INPUT_*, або INPUT_NONE для недочитаної послідовності.
+ */
+int input_decode(const unsigned char *buf, int len, int *used);
+
+/**
+ * @brief Поточний час CLOCK_MONOTONIC у наносекундах.
+ */
+uint64_t input_now_ns(void);
+
+void input_ring_init(InputRing *ring);
+
+/**
+ * @brief Додає команду (лише потік-записувач). Не чекає.
+ * @return 0 при успіху, -1 якщо кільце повне.
+ */
+int input_ring_push(InputRing *ring, const InputCommand *command);
+
+/**
+ * @brief Читає найстаршу команду, не забираючи її (лише потік-читач).
+ * @return 1, якщо команда є, 0 якщо кільце порожнє.
+ */
+int input_ring_peek(InputRing *ring, InputCommand *command);
+
+/**
+ * @brief Забирає найстаршу команду (лише потік-читач). Не чекає.
+ * @return 1, якщо команду отримано, 0 якщо кільце порожнє.
+ */
+int input_ring_pop(InputRing *ring, InputCommand *command);
+
+/**
+ * @brief Запускає потік читання клавіш з fd.
+ * @return 0 при успіху, -1 при помилці.
+ */
+int input_thread_start(InputThread *input, int fd);
+
+/**
+ * @brief Будить і зупиняє потік; непрочитані команди лишаються в кільці.
+ */
+void input_thread_stop(InputThread *input);
+
+/**
+ * @brief Спить, доки не надійдуть нові команди або не мине timeout_ns.
+ * @param timeout_ns Максимальне очікування; від'ємне - без обмеження.
+ * @return 1, якщо надійшли команди, 0 після тайм-ауту.
+ */
+int input_wait(InputThread *input, int64_t timeout_ns);
+
+/**
+ * @brief Враховує затримку однієї застосованої команди.
+ */
+void input_latency_add(InputLatency *latency, uint64_t delay_ns);
+
+/**
+ * @brief Оцінка перцентиля затримки (верхня межа кошика) у мікросекундах.
+ */
+double input_latency_percentile(const InputLatency *latency, double p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INPUT_H
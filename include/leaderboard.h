@@ -0,0 +1,110 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include "snake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Таблиця рекордів: журнал лише з дописуванням (кожен запис з CRC-32)
+// та стиснений знімок індексу. При запуску читається знімок і лише хвіст
+// журналу після нього, тому старт не залежить від кількості зіграних ігор.
+// Дописування, читання хвоста і обрізання пошкодженого запису виконуються
+// під flock() журналу, тож кілька сесій можуть ділити один каталог.
+
+#define LEADERBOARD_TOP_K 10
+#define LEADERBOARD_SNAPSHOT_EVERY 1024  // Записів між перебудовами знімка
+#define LEADERBOARD_PATH_LEN 512
+
+#define LEVEL_ID_CLASSIC 0          // Порожнє поле без рівня
+#define LEVEL_ID_GENERATED 0xF000   // + LEVEL_* для згенерованих рівнів
+
+/**
+ * @brief Результат однієї гри (32 байти, як у журналі).
+ */
+typedef struct {
+    int64_t timestamp;           ///< Час завершення (секунди Unix)
+    int32_t score;
+    int16_t length;
+    int16_t apples_eaten;
+    int16_t special_apples_eaten[4];
+    uint16_t level;              ///< Ідентифікатор рівня (LEVEL_ID_*, 1 + індекс у наборі)
+    uint8_t state;               ///< GAME_OVER або GAME_WON
+    uint8_t reserved;
+} ScoreEntry;
+
+/**
+ * @brief K найкращих результатів (мін-купа за рахунком).
+ */
+typedef struct {
+    ScoreEntry entries[LEADERBOARD_TOP_K];
+    int count;
+} TopScores;
+
+/**
+ * @brief Найкращі результати одного рівня.
+ */
+typedef struct {
+    uint16_t level;
+    TopScores top;
+} LevelScores;
+
+/**
+ * @brief Відкрита таблиця рекордів.
+ */
+typedef struct {
+    char log_path[LEADERBOARD_PATH_LEN];
+    char snapshot_path[LEADERBOARD_PATH_LEN];
+    int log_fd;
+    uint64_t log_size;           ///< Довжина перевіреної частини журналу
+    uint64_t total_games;
+    uint64_t since_snapshot;     ///< Записів після останнього знімка
+    TopScores overall;
+    LevelScores *levels;
+    int level_count;
+    int level_capacity;
+} Leaderboard;
+
+/**
+ * @brief Відкриває (або створює) таблицю рекордів у каталозі.
+ * Пошкоджений або недописаний хвіст журналу обрізається.
+ * @return 0 при успіху, -1 якщо каталог або журнал недоступні.
+ */
+int leaderboard_open(Leaderboard *board, const char *dir);
+
+/**
+ * @brief Закриває журнал і звільняє індекс.
+ */
+void leaderboard_close(Leaderboard *board);
+
+/**
+ * @brief Дописує результат у журнал (з fdatasync) та оновлює індекс.
+ * Раз на LEADERBOARD_SNAPSHOT_EVERY записів перебудовує знімок.
+ * @return 0 при успіху, -1 при помилці запису.
+ */
+int leaderboard_record(Leaderboard *board, const ScoreEntry *entry);
+
+/**
+ * @brief Записує знімок індексу (тимчасовий файл + rename).
+ * @return 0 при успіху, -1 при помилці.
+ */
+int leaderboard_compact(Leaderboard *board);
+
+/**
+ * @brief Копіює найкращі результати за спаданням рахунку.
+ * @param level Ідентифікатор рівня або -1 для загальної таблиці.
+ * @return Кількість скопійованих записів.
+ */
+int leaderboard_top(const Leaderboard *board, int level, ScoreEntry *out, int max);
+
+/**
+ * @brief Заповнює запис результату зі стану завершеної гри.
+ */
+void score_entry_from_game(ScoreEntry *entry, const GameState *game, int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LEADERBOARD_H
@@ -0,0 +1,87 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include "snake.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Типи згенерованих рівнів
+#define LEVEL_EMPTY 0       // Порожня коробка (як у класичній грі)
+#define LEVEL_MAZE 1        // Лабіринт з випадкових відрізків стін
+#define LEVEL_ROOMS 2       // Кімнати, з'єднані дверима
+#define LEVEL_PILLARS 3     // Розкидані колони
+#define LEVEL_KIND_COUNT 4
+
+#define LEVEL_MAX_CANDIDATES 10000  // Ліміт спроб генерації одного рівня
+#define LEVEL_NAME_LEN 32
+
+/**
+ * @brief Стартове розташування перешкод та точка появи змійки.
+ */
+typedef struct {
+    Grid walls;                  ///< Стіни рівня (лише внутрішні клітинки)
+    Point spawn;                 ///< Початкова позиція голови
+    int direction;               ///< Початковий напрямок руху
+    int kind;                    ///< Тип генератора (LEVEL_*)
+    unsigned int seed;           ///< Зерно, з якого отримано рівень
+    char name[LEVEL_NAME_LEN];
+} Level;
+
+/**
+ * @brief Генерує рівень заданого типу із зерна.
+ * Кандидати, що розрізають поле на частини, відкидаються.
+ * Результат детермінований для пари (kind, seed).
+ * @return Кількість перевірених кандидатів або -1, якщо ліміт вичерпано.
+ */
+int level_generate(Level *level, int kind, unsigned int seed);
+
+/**
+ * @brief Перевіряє напрямок, що місце появи вільне, а вільний простір зв'язний.
+ * @return 1, якщо рівень придатний до гри.
+ */
+int level_is_valid(const Level *level);
+
+/**
+ * @brief Скидає стан гри та розставляє стіни і змійку згідно з рівнем.
+ */
+void level_apply(const Level *level, GameState *game);
+
+/**
+ * @brief Ставить змійку початкової довжини головою в (x, y) з напрямком руху.
+ * Тіло тягнеться у протилежний бік.
+ */
+void level_spawn_snake(GameState *game, int x, int y, int direction);
+
+/**
+ * @brief Записує рівень у текстовому форматі ('#' стіна, '.' вільно,
+ * '^', '>', 'v', '<' - голова змійки та її напрямок).
+ */
+void level_write_ascii(const Level *level, FILE *out);
+
+/**
+ * @brief Читає наступну карту в текстовому форматі.
+ * Карта - необов'язковий рядок "name: ...", далі HEIGHT рядків по WIDTH
+ * символів; порожні рядки між картами пропускаються.
+ * @return 1, якщо карту прочитано; 0 наприкінці файлу; -1 при помилці формату.
+ */
+int level_read_ascii(Level *level, FILE *in);
+
+/**
+ * @brief Назва типу рівня ("empty", "maze", "rooms", "pillars").
+ */
+const char *level_kind_name(int kind);
+
+/**
+ * @brief Тип рівня за назвою.
+ * @return LEVEL_* або -1, якщо назва невідома.
+ */
+int level_kind_from_name(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LEVEL_H
@@ -0,0 +1,95 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include "level.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Бінарний набір рівнів: заголовок та масив записів фіксованого розміру.
+// Файл відображається в пам'ять (mmap) і читається без розбору: бітова
+// сітка кожного запису копіюється прямо в GameState.obstacles.grid.
+// Порядок байтів - рідний для платформи (little-endian на x86/ARM).
+
+#define LEVELPACK_MAGIC "SNKPACK1"
+#define LEVELPACK_VERSION 1
+
+/**
+ * @brief Заголовок файлу (64 байти, щоб записи були вирівняні).
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint16_t width;              ///< Має збігатися з WIDTH
+    uint16_t height;             ///< Має збігатися з HEIGHT
+    uint32_t level_count;
+    uint32_t record_size;        ///< sizeof(LevelRecord)
+    uint32_t row_words;          ///< GRID_ROW_WORDS
+    uint32_t reserved[9];
+} LevelPackHeader;
+
+/**
+ * @brief Один рівень у наборі.
+ */
+typedef struct {
+    Grid walls;                  ///< Готова сітка перешкод
+    int16_t spawn_x;
+    int16_t spawn_y;
+    uint8_t direction;
+    int8_t kind;                 ///< LEVEL_* або -1 для карт з тексту
+    uint16_t wall_count;
+    uint32_t seed;
+    char name[LEVEL_NAME_LEN];
+} LevelRecord;
+
+/**
+ * @brief Відкритий (відображений у пам'ять) набір рівнів.
+ */
+typedef struct {
+    void *base;
+    size_t size;
+    const LevelRecord *levels;
+    int count;
+} LevelPack;
+
+/**
+ * @brief Відкриває набір через mmap та перевіряє заголовок.
+ * @return 0 при успіху, -1 якщо файл недоступний або має інший формат.
+ */
+int levelpack_open(LevelPack *pack, const char *path);
+
+/**
+ * @brief Звільняє відображення файлу.
+ */
+void levelpack_close(LevelPack *pack);
+
+/**
+ * @brief Повертає запис рівня за індексом.
+ * @return NULL, якщо індекс поза набором або запис не проходить
+ * level_is_valid() (напрямок, місце появи на полі й поза стінами, зв'язність).
+ */
+const LevelRecord *levelpack_get(const LevelPack *pack, int index);
+
+/**
+ * @brief Копіює запис у Level (без перевірки).
+ */
+void levelpack_to_level(const LevelRecord *record, Level *level);
+
+/**
+ * @brief Скидає стан гри і заповнює перешкоди та змійку із запису.
+ */
+void levelpack_apply(const LevelRecord *record, GameState *game);
+
+/**
+ * @brief Записує масив рівнів у файл набору (через тимчасовий файл).
+ * @return 0 при успіху, -1 при помилці запису.
+ */
+int levelpack_write(const char *path, const Level *levels, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LEVELPACK_H
@@ -0,0 +1,91 @@
+#ifndef LIVE_H
+#define LIVE_H
+
+#include "snake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Живий стан гри для зовнішніх спостерігачів. Гра копіює GameState і
+// лічильники кроків у сегмент спільної пам'яті POSIX під seqlock: перед
+// записом лічильник seq стає непарним, після - парним. Запис - лише
+// копіювання в уже відображені сторінки, без системних викликів; будь-яка
+// кількість читачів без блокувань повторює читання, доки не отримає
+// знімок, під час якого seq не змінився.
+
+#define LIVE_NAME "/snake-live"
+#define LIVE_MAGIC 0x564c4e53u     // "SNLV"
+#define LIVE_VERSION 1
+#define LIVE_READ_RETRIES 1000
+
+/**
+ * @brief Дані, що публікуються за один запис.
+ */
+typedef struct {
+    GameState game;              ///< Покажчики events і foods скинуто в NULL
+    uint64_t tick;               ///< Кроків від початку гри (з перемотуванням)
+    uint64_t tick_ns;            ///< CLOCK_MONOTONIC останнього кроку
+    uint64_t interval_ns;        ///< Проміжок між двома останніми кроками
+    uint64_t publishes;          ///< Записів від початку
+    int32_t boost;               ///< Прискорення активне
+    int32_t pid;                 ///< Процес гри
+} LiveSnapshot;
+
+/**
+ * @brief Вміст сегмента.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;               ///< sizeof(LiveShared) записувача
+    uint32_t seq __attribute__((aligned(64))); ///< Непарний - йде запис
+    LiveSnapshot data __attribute__((aligned(64)));
+} LiveShared;
+
+/**
+ * @brief Відображений сегмент.
+ */
+typedef struct {
+    LiveShared *shared;
+    char name[64];
+    int writer;                  ///< Сегмент створено цим процесом
+} LiveExport;
+
+/**
+ * @brief Створює (або перевикористовує) сегмент name і відображає його для запису.
+ * Сторінки заповнюються одразу, щоб перший запис не чекав на них.
+ * @return 0 при успіху, -1 при помилці.
+ */
+int live_create(LiveExport *live, const char *name);
+
+/**
+ * @brief Відображає наявний сегмент лише для читання.
+ * @return 0 при успіху, -1 якщо його немає або він іншої версії.
+ */
+int live_attach(LiveExport *live, const char *name);
+
+/**
+ * @brief Відключається від сегмента; записувач також видаляє його ім'я.
+ */
+void live_close(LiveExport *live);
+
+/**
+ * @brief Публікує стан гри (лише один записувач).
+ * @param tick Номер кроку, що його виконано.
+ * @param now_ns Час кроку (CLOCK_MONOTONIC); інтервал рахується лише для tick + 1.
+ */
+void live_publish(LiveExport *live, const GameState *game, uint64_t tick, uint64_t now_ns);
+
+/**
+ * @brief Читає узгоджений знімок.
+ * @param retries Скільки разів довелося повторити читання (може бути NULL).
+ * @return 0 при успіху, -1 якщо запис не завершився за LIVE_READ_RETRIES спроб.
+ */
+int live_read(const LiveExport *live, LiveSnapshot *out, int *retries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIVE_H
@@ -0,0 +1,96 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "snake.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Метрики для Prometheus. Ігровий потік лише збільшує лічильники
+// атомарними операціями з relaxed-порядком (без блокувань і системних
+// викликів); окремий потік приймає з'єднання на UNIX- або локальному
+// TCP-сокеті й віддає їх у текстовому форматі Prometheus, тож збір
+// метрик ніколи не затримує крок гри.
+
+#define METRICS_BUCKETS 31           // Кошики гістограм: степені двійки 1..2^29 і +Inf
+#define METRICS_PATH_LEN 108         // sizeof(sockaddr_un.sun_path)
+#define METRICS_TEXT_MAX 16384       // Найбільша відповідь
+
+/**
+ * @brief Гістограма з кошиками ≤ 1, 2, 4, ... (значення в цілих одиницях).
+ */
+typedef struct {
+    uint64_t buckets[METRICS_BUCKETS]; ///< Не накопичувальні; сума - при виводі
+    uint64_t count;
+    uint64_t sum;
+} MetricsHistogram;
+
+/**
+ * @brief Усі метрики одного процесу гри.
+ */
+typedef struct {
+    uint64_t ticks;
+    uint64_t frames;
+    MetricsHistogram tick_ns;        ///< Тривалість кроку (update_game з історією)
+    MetricsHistogram render_ns;      ///< Малювання і виведення кадру
+    MetricsHistogram input_ns;       ///< Від клавіші до кроку, що її застосував
+    uint64_t food_spawned[4];        ///< За FOOD_*
+    uint64_t obstacles;              ///< Поставлено стін
+    uint64_t obstacle_retries;       ///< Невдалих спроб add_obstacle() перед ними
+    MetricsHistogram obstacle_attempts;
+    uint64_t games[5];               ///< Завершені ігри за GAME_*
+} Metrics;
+
+/**
+ * @brief Потік, що віддає метрики.
+ */
+typedef struct {
+    const Metrics *metrics;
+    int fd;
+    int stop_pipe[2];
+    pthread_t thread;
+    char path[METRICS_PATH_LEN];     ///< Файл UNIX-сокета (видаляється при зупинці)
+    unsigned long scrapes;
+} MetricsServer;
+
+/**
+ * @brief Додає n до лічильника (relaxed, з будь-якого потоку).
+ */
+void metrics_add(uint64_t *counter, uint64_t n);
+
+/**
+ * @brief Записує значення в гістограму (relaxed).
+ */
+void metrics_observe(MetricsHistogram *histogram, uint64_t value);
+
+/**
+ * @brief Обробник шини подій: їжа за типами, стіни та спроби їх поставити.
+ * @param context Metrics *.
+ */
+void metrics_on_events(const GameEvent *events, int count, const GameState *game, void *context);
+
+/**
+ * @brief Форматує метрики в текстовому форматі Prometheus.
+ * @return Довжина тексту; обрізається до size - 1.
+ */
+size_t metrics_format(const Metrics *metrics, char *out, size_t size);
+
+/**
+ * @brief Відкриває сокет і запускає потік, що відповідає на кожне з'єднання.
+ * @param address "unix:/шлях", "порт" або "127.0.0.1:порт" (лише локальні адреси).
+ * @return 0 при успіху, -1 при помилці адреси, сокета чи потоку.
+ */
+int metrics_listen(MetricsServer *server, const Metrics *metrics, const char *address);
+
+/**
+ * @brief Зупиняє потік і закриває сокет.
+ */
+void metrics_stop(MetricsServer *server);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,285 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "snake.h"
+#include "input.h"
+#include <signal.h>
+#include <netinet/in.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Гра через мережу: сервер веде справжню гру, клієнт передбачає її.
+// Обидва боки крокують тим самим детермінованим рушієм (генератор і
+// годинник гри залежать лише від номера кроку), тож клієнт застосовує
+// свої повороти одразу, не чекаючи сервера. Клієнт іде на кілька кроків
+// попереду сервера (на час проходу пакета туди й назад), щоб його
+// повороти встигали до кроку, для якого призначені. Коли приходить стан
+// сервера, що не збігається з передбаченим (поворот запізнився),
+// клієнт відкочується до нього і заново проходить решту кроків зі своєї
+// історії. Транспорт - UDP; для вимірювань вхідні пакети можна
+// затримувати штучно.
+
+#define NET_MAGIC 0x4e4b4e53u      // "SNKN"
+#define NET_HISTORY 128            // Степінь двійки: кроків, до яких можна відкотитися
+#define NET_INPUTS_MAX 16          // Непідтверджених поворотів в одному пакеті
+#define NET_TURNS 8                // Поворотів, що чекають на один крок
+#define NET_QUEUE 256              // Затриманих пакетів
+#define NET_LEAD_MARGIN 2          // Запас кроків понад час проходу пакета
+
+// Типи повідомлень
+#define NET_HELLO 1                // Клієнт -> сервер: хочу грати
+#define NET_START 2                // Сервер -> клієнт: початковий стан гри
+#define NET_INPUTS 3               // Клієнт -> сервер: ще не підтверджені повороти
+#define NET_STATE 4                // Сервер -> клієнт: стан після кроку
+#define NET_BYE 5                  // Клієнт виходить
+
+/**
+ * @brief Поворот, призначений на крок tick.
+ */
+typedef struct {
+    uint32_t tick;
+    int32_t direction;
+} NetInput;
+
+/**
+ * @brief Пакет протоколу (однаковий для всіх типів).
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t type;               ///< NET_*
+    uint16_t count;              ///< Поворотів у inputs
+    uint32_t tick;               ///< STATE - крок сервера, INPUTS - крок клієнта
+    uint32_t ack;                ///< STATE - найновіший отриманий поворот клієнта
+    uint32_t game;               ///< Номер гри сервера (після кінця гри починається нова)
+    uint32_t interval_us;        ///< START - тривалість кроку
+    uint64_t echo_ns;            ///< Час відправлення клієнта, повернений сервером
+    uint64_t hold_ns;            ///< Скільки сервер тримав echo_ns перед відповіддю
+    uint64_t rng;                ///< Стан генератора після tick
+    NetInput inputs[NET_INPUTS_MAX];
+    GameState state;             ///< START і STATE; покажчики не передаються
+} NetMessage;
+
+/**
+ * @brief Пакет, що чекає на свою штучну затримку.
+ */
+typedef struct {
+    NetMessage message;
+    uint64_t due_ns;
+    uint64_t order;              ///< Пакети з однаковою затримкою не міняються місцями
+} NetDelayed;
+
+/**
+ * @brief UDP-з'єднання з одним співрозмовником.
+ */
+typedef struct {
+    int fd;
+    struct sockaddr_in peer;
+    int has_peer;                ///< Сервер дізнається адресу з NET_HELLO
+    int connected;               ///< Клієнт: приймаються лише пакети від peer
+    uint64_t delay_ns;           ///< Штучна затримка вхідних пакетів
+    uint64_t jitter_ns;          ///< Додаткова випадкова затримка 0..jitter_ns
+    uint64_t jitter_rng;
+    NetDelayed *queue;
+    int queued;
+    uint64_t arrivals;
+    unsigned long sent;
+    unsigned long received;
+    unsigned long dropped;       ///< Зіпсовані або від чужої адреси
+} NetLink;
+
+/**
+ * @brief Сервер: справжня гра і повороти клієнта, що чекають свого кроку.
+ */
+typedef struct {
+    GameState start;             ///< З чого починається кожна гра
+    GameState game;
+    uint64_t rng;
+    uint32_t tick;
+    uint32_t interval_us;
+    uint32_t number;             ///< Номер поточної гри
+    uint32_t received;           ///< Найновіший отриманий поворот
+    NetInput pending[NET_HISTORY];
+    int pending_count;
+    uint64_t echo_ns;
+    uint64_t echo_arrival_ns;
+    unsigned long ticks;
+    unsigned long games;
+    unsigned long late;          ///< Повороти, що прийшли після свого кроку
+    unsigned long rejected;      ///< Повороти з неможливим напрямком
+} NetServer;
+
+/**
+ * @brief Поворот клієнта та його шлях до підтвердження.
+ */
+typedef struct {
+    uint32_t tick;               ///< Крок, на який його надіслано (0 - порожньо)
+    int32_t direction;
+    uint32_t slot;               ///< Крок, на якому його зараз застосовує передбачення
+    uint64_t key_ns;             ///< Коли натиснуто клавішу
+    int confirmed;               ///< Уже є стан сервера з ним
+} NetSent;
+
+/**
+ * @brief Клієнт: передбачена гра та історія для відкатів.
+ */
+typedef struct {
+    GameState game;              ///< Поточний передбачений стан (його показують)
+    uint64_t rng;
+    GameState states[NET_HISTORY];
+    uint64_t rngs[NET_HISTORY];
+    uint32_t turns[NET_HISTORY][NET_TURNS]; ///< Повороти кроку (номери в sent)
+    uint8_t turn_count[NET_HISTORY];
+    NetSent sent[NET_HISTORY];
+    uint32_t tick;               ///< Останній передбачений крок
+    uint32_t confirmed;          ///< Останній крок, підтверджений сервером
+    uint32_t acked;              ///< Найновіший поворот, що дійшов до сервера
+    uint32_t interval_us;
+    uint32_t number;             ///< Номер гри сервера
+    int started;
+    uint32_t server_tick;        ///< Крок останнього стану сервера
+    uint64_t server_tick_ns;     ///< І коли він прийшов
+    uint64_t rtt_ns;             ///< Згладжений час проходу туди й назад
+    unsigned long confirms;      ///< Отримано станів сервера
+    unsigned long corrections;   ///< З них довелося відкочуватися
+    unsigned long resimulated;   ///< Кроків, пройдених заново
+    unsigned long snaps;         ///< Сервер випередив передбачення
+    unsigned long rejected;      ///< Відкинуто пакетів з неможливим станом гри
+    uint64_t resim_ns;
+    uint64_t resim_max_ns;
+    InputLatency predicted;      ///< Від клавіші до кроку, що її показав
+    InputLatency authoritative;  ///< Від клавіші до стану сервера з нею
+} NetPredictor;
+
+/**
+ * @brief Відкриває UDP-порт сервера (0 - будь-який вільний).
+ * @return 0 при успіху, -1 при помилці.
+ */
+int net_listen(NetLink *link, int port);
+
+/**
+ * @brief Відкриває UDP-з'єднання клієнта з host:port.
+ * @return 0 при успіху, -1 якщо адресу не знайдено або сокет не створено.
+ */
+int net_connect(NetLink *link, const char *host, int port);
+
+/**
+ * @brief Локальний порт з'єднання.
+ */
+int net_local_port(const NetLink *link);
+
+/**
+ * @brief Затримує кожен вхідний пакет на delay_ns + випадкові 0..jitter_ns.
+ */
+void net_set_delay(NetLink *link, uint64_t delay_ns, uint64_t jitter_ns);
+
+/**
+ * @brief Надсилає пакет співрозмовнику.
+ * @return 0 при успіху, -1 якщо співрозмовник ще невідомий або сокет зайнятий.
+ */
+int net_send(NetLink *link, NetMessage *message);
+
+/**
+ * @brief Забирає наступний пакет, чия затримка минула.
+ * Клієнт відкидає пакети не від свого сервера; сервер приймає пакети лише
+ * від останнього, хто надіслав NET_HELLO.
+ * @return 1, якщо пакет є, 0 якщо немає.
+ */
+int net_receive(NetLink *link, NetMessage *message, uint64_t now_ns);
+
+/**
+ * @brief Спить до until_ns або до наступного пакета (з урахуванням затримки).
+ */
+void net_wait(NetLink *link, uint64_t now_ns, uint64_t until_ns);
+
+void net_close(NetLink *link);
+
+/**
+ * @brief Готує сервер; кожна гра починається зі start.
+ */
+void net_server_init(NetServer *server, const GameState *start, uint64_t rng, uint32_t interval_us);
+
+/**
+ * @brief Починає нову гру з наступним номером (генератор іде далі).
+ */
+void net_server_restart(NetServer *server);
+
+/**
+ * @brief Заповнює пакет NET_START для поточної гри.
+ */
+void net_server_start_message(const NetServer *server, NetMessage *out, uint64_t now_ns);
+
+/**
+ * @brief Ставить у чергу повороти з пакета NET_INPUTS. Повороти з
+ * напрямком поза DIR_UP..DIR_LEFT відкидаються.
+ */
+void net_server_input(NetServer *server, const NetMessage *inputs, uint64_t now_ns);
+
+/**
+ * @brief Робить крок: повороти, чий крок настав (і ті, що запізнилися), потім update_game().
+ * @param out Пакет NET_STATE для клієнта.
+ * @return Стан гри після кроку.
+ */
+int net_server_tick(NetServer *server, NetMessage *out, uint64_t now_ns);
+
+/**
+ * @brief Веде гри для одного клієнта: чекає NET_HELLO, крокує з інтервалом
+ * сервера і починає нову гру після кінця попередньої.
+ * @return 0 після NET_BYE або *stop, -1 при помилці сокета.
+ */
+int net_serve(NetLink *link, NetServer *server, const volatile sig_atomic_t *stop);
+
+/**
+ * @brief Обнуляє передбачення і статистику.
+ */
+void net_predict_init(NetPredictor *predictor);
+
+/**
+ * @brief Починає передбачати гру з пакета NET_START (статистика лишається).
+ * @return 0 при успіху, -1 якщо стан гри в пакеті неможливий (довжина,
+ * напрямок, кількість стін, тип їжі, координати поза полем тощо).
+ */
+int net_predict_start(NetPredictor *predictor, const NetMessage *start, uint64_t now_ns);
+
+/**
+ * @brief Передбачає наступний крок.
+ * @param direction Натиснутий напрямок (DIR_*) або -1.
+ * @param key_ns Коли його натиснуто.
+ * @return Стан передбаченої гри.
+ */
+int net_predict_tick(NetPredictor *predictor, int direction, uint64_t key_ns, uint64_t now_ns);
+
+/**
+ * @brief Заповнює пакет NET_INPUTS поворотами, яких сервер ще не отримав.
+ * @return Кількість поворотів у пакеті.
+ */
+int net_predict_inputs(const NetPredictor *predictor, NetMessage *out, uint64_t now_ns);
+
+/**
+ * @brief Звіряє передбачення зі станом сервера. Якщо вони розійшлися або
+ * якийсь поворот до сервера не встиг, відкочується до цього стану і
+ * проходить наступні кроки заново; поворот, що запізнився, передбачається
+ * на найближчому кроці, де сервер ще може його застосувати.
+ * @return Кількість пройдених заново кроків; -1 для застарілого, чужого або
+ * неможливого стану (перевіряється так само, як у net_predict_start()).
+ */
+int net_predict_confirm(NetPredictor *predictor, const NetMessage *state, uint64_t now_ns);
+
+/**
+ * @brief Чи час передбачати наступний крок: клієнт тримається на час
+ * проходу пакета плюс NET_LEAD_MARGIN кроків попереду сервера, але не
+ * далі, ніж сягає історія.
+ */
+int net_predict_due(const NetPredictor *predictor, uint64_t now_ns);
+
+/**
+ * @brief Коли настане наступний крок за тим самим правилом.
+ */
+uint64_t net_predict_next_ns(const NetPredictor *predictor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NETPLAY_H
@@ -0,0 +1,143 @@
+#ifndef PERSIST_GAME_H
+#define PERSIST_GAME_H
+
+#include "snake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Рушій для розгалуження: тіло змійки - незмінна послідовність зі
+// спільними частинами, тож копія гри (розгалуження) коштує O(1), а кожна
+// гілка платить лише за сегменти, які сама змінює.
+//
+// Тіло - це вікно в історію позицій голови: розрізнені сегменти -
+// останні `distinct` голів, далі `stacked` копій хвоста після росту (як
+// у масиві після grow_snake()). Історія лежить у блоках по
+// PERSIST_CHUNK точок; блоки, що перетинають вікно, тримає хребет
+// (spine) з PERSIST_SLOTS слотів. Блоки й хребти беруться з пулу і мають
+// лічильник посилань: спільний хребет або блок голови копіюється перед
+// першим записом (копіювання під час запису), блок, з якого вийшов
+// хвіст, повертається в пул, коли на нього не лишилося посилань.
+//
+// Пул не потокобезпечний: одна гра та всі її гілки - в одному потоці.
+// Семантика і споживання випадкових чисел збігаються з game.c (одна
+// їжа, без шини подій).
+
+#define PERSIST_CHUNK 16             // Точок у блоці
+#define PERSIST_SLOTS 8              // Степінь двійки; вікно займає не більше 5 блоків
+#define PERSIST_SLAB 256             // Блоків, що виділяються за раз
+
+typedef struct PersistChunk PersistChunk;
+typedef struct PersistSpine PersistSpine;
+
+/**
+ * @brief Блок історії голови (незмінний, поки refs > 1).
+ */
+struct PersistChunk {
+    uint32_t refs;
+    Point points[PERSIST_CHUNK];
+};
+
+/**
+ * @brief Блоки, що перетинають вікно тіла; блок n - у слоті n % PERSIST_SLOTS.
+ */
+struct PersistSpine {
+    uint32_t refs;
+    PersistChunk *chunks[PERSIST_SLOTS];
+};
+
+/**
+ * @brief Пул блоків і хребтів зі списками вільних.
+ */
+typedef struct {
+    void *free_blocks;           ///< Блок або хребет: однаковий розмір комірки
+    unsigned long free_count;
+    void *slabs;                 ///< Виділені шматки пам'яті (для persist_pool_destroy)
+    unsigned long chunks_live;
+    unsigned long spines_live;
+    unsigned long chunk_copies;  ///< Копіювань блоку голови перед записом
+    unsigned long spine_copies;
+    unsigned long bytes;         ///< Виділено в шматках
+} PersistPool;
+
+/**
+ * @brief Тіло змійки: кілька слів, що посилаються на спільні блоки.
+ */
+typedef struct {
+    PersistSpine *spine;
+    uint32_t pushed;             ///< Скільки голів додано (номер наступної точки історії)
+    uint16_t distinct;           ///< Різних сегментів від голови
+    uint16_t stacked;            ///< Копій хвоста після росту
+} PersistBody;
+
+/**
+ * @brief Стан гри з тілом у пулі.
+ */
+typedef struct {
+    PersistPool *pool;
+    PersistBody body;
+    int direction;
+    Food food;
+    Obstacles obstacles;
+    SpeedBoost speed_boost;
+    int score;
+    int state;
+    int apples_eaten;
+    int special_apples_eaten[4];
+} PersistGame;
+
+void persist_pool_init(PersistPool *pool);
+
+/**
+ * @brief Звільняє всю пам'ять пулу (ігри з нього стають недійсними).
+ */
+void persist_pool_destroy(PersistPool *pool);
+
+/**
+ * @brief Будує гру зі звичайного стану.
+ * @return 0 при успіху, -1 якщо не вистачило пам'яті.
+ */
+int persist_game_from_state(PersistGame *game, PersistPool *pool, const GameState *state);
+
+/**
+ * @brief Переносить гру в GameState (тіло в масив, хеші перераховуються).
+ */
+void persist_game_to_state(const PersistGame *game, GameState *state);
+
+/**
+ * @brief Розгалуження за O(1): гілка ділить тіло з src до першої зміни.
+ */
+void persist_game_fork(PersistGame *branch, const PersistGame *src);
+
+/**
+ * @brief Віддає посилання гри на тіло; непотрібні блоки повертаються в пул.
+ */
+void persist_game_release(PersistGame *game);
+
+/**
+ * @brief Сегмент тіла i (0 - голова).
+ */
+Point persist_body_at(const PersistBody *body, int i);
+
+/**
+ * @brief Довжина тіла, як Snake.length.
+ */
+int persist_body_length(const PersistBody *body);
+
+/**
+ * @brief Змінює напрямок, якщо це не розворот на 180 градусів.
+ */
+void persist_game_turn(PersistGame *game, int direction);
+
+/**
+ * @brief Один крок гри, еквівалентний update_game().
+ * @return Новий стан гри; -1 якщо не вистачило пам'яті (гра не змінюється).
+ */
+int persist_game_step(PersistGame *game);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERSIST_GAME_H
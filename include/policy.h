@@ -0,0 +1,77 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "fast_game.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Невелика нейромережа з фіксованою топологією для керування змійкою:
+// ознаки -> прихований шар ReLU -> оцінка кожного напрямку. Усі ваги -
+// один суцільний вирівняний масив float (геном для еволюції). Матриці
+// зберігаються за входами, тож шар рахується як сума векторів ваг,
+// і компілятор векторизує ці цикли.
+// Виведення не виділяє пам'яті.
+
+#define POLICY_INPUTS 24           // 21 ознака + доповнення нулями до кратного 8
+#define POLICY_HIDDEN 16
+#define POLICY_OUTPUTS 4           // Оцінки для DIR_UP..DIR_LEFT
+
+/**
+ * @brief Ваги політики. Лише float; POLICY_GENES включає доповнення в кінці.
+ */
+typedef struct {
+    float w1[POLICY_INPUTS][POLICY_HIDDEN];   ///< Вхід -> прихований шар
+    float b1[POLICY_HIDDEN];
+    float w2[POLICY_HIDDEN][POLICY_OUTPUTS];  ///< Прихований шар -> напрямки
+    float b2[POLICY_OUTPUTS];
+} __attribute__((aligned(32))) Policy;
+
+#define POLICY_GENES (sizeof(Policy) / sizeof(float))
+
+/**
+ * @brief Обчислює ознаки стану: для кожного напрямку - чи зайнята сусідня
+ * клітинка та скільки вільних клітинок попереду; зміщення до їжі, тип їжі,
+ * прискорення, поточний напрямок, довжина, зміщення (bias).
+ */
+void policy_features(const FastGame *game, float inputs[POLICY_INPUTS]);
+
+/**
+ * @brief Оцінки напрямків для готових ознак.
+ */
+void policy_eval(const Policy *policy, const float inputs[POLICY_INPUTS],
+                 float outputs[POLICY_OUTPUTS]);
+
+/**
+ * @brief Обирає напрямок з найвищою оцінкою (без розвороту на 180 градусів).
+ */
+int policy_act(const Policy *policy, const FastGame *game);
+
+/**
+ * @brief Записує популяцію у файл контрольної точки (тимчасовий файл + rename).
+ * @return 0 при успіху, -1 при помилці.
+ */
+int policy_save_population(const char *path, const Policy *population, const float *fitness,
+                           int count, int generation, uint64_t rng_state);
+
+/**
+ * @brief Читає контрольну точку в наперед виділений масив.
+ * @param count На вході - місткість масиву, на виході - кількість політик.
+ * @return 0 при успіху, -1 якщо файл недоступний, пошкоджений або більший за масив.
+ */
+int policy_load_population(const char *path, Policy *population, float *fitness,
+                           int *count, int *generation, uint64_t *rng_state);
+
+/**
+ * @brief Читає з контрольної точки політику з найкращою пристосованістю.
+ * @return 0 при успіху, -1 як у policy_load_population().
+ */
+int policy_load_best(const char *path, Policy *best);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POLICY_H
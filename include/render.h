@@ -0,0 +1,203 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "snake.h"
+#include "leaderboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Виведення на термінал через змінний бекенд. Екрани гри малюються
+// однаковими викликами put/text, а бекенд вирішує, як їх доставити:
+// ncurses (запасний варіант) або власний ANSI-бекенд, що збирає кадр
+// у готовий буфер і виводить його одним write().
+
+// Кольорові пари
+#define COLOR_SNAKE 1
+#define COLOR_FOOD_REGULAR 2
+#define COLOR_BORDER 3
+#define COLOR_INFO 4
+#define COLOR_FOOD_GREEN 5
+#define COLOR_FOOD_GOLD 6
+#define COLOR_FOOD_BLUE 7
+#define COLOR_OBSTACLE 8
+#define COLOR_TITLE 9
+#define RENDER_COLORS 10
+
+// Атрибути тексту
+#define ATTR_BOLD 1
+#define ATTR_BLINK 2
+
+// Розмір екрана, який малюють екрани гри (все поза ним відсікається)
+#define SCREEN_ROWS (HEIGHT + 3)
+#define SCREEN_COLS (WIDTH + 40)
+
+// Команди з клавіатури (напрямки збігаються з DIR_*)
+#define INPUT_NONE -1
+#define INPUT_UP DIR_UP
+#define INPUT_RIGHT DIR_RIGHT
+#define INPUT_DOWN DIR_DOWN
+#define INPUT_LEFT DIR_LEFT
+#define INPUT_QUIT 4
+#define INPUT_OTHER 5              // Будь-яка інша клавіша
+#define INPUT_PAUSE 6              // P або пробіл
+#define INPUT_REWIND 7             // [ - крок назад
+#define INPUT_FORWARD 8            // ] - крок уперед
+#define INPUT_REWIND_FAR 9         // { - багато кроків назад
+#define INPUT_FORWARD_FAR 10       // } - багато кроків уперед
+
+/**
+ * @brief Камера для поля, що не вміщається в термінал.
+ * Показує вікно rows x cols клітинок поля (разом з рамкою) навколо голови
+ * і тримає власну сітку сегментів змійки, яку оновлює за O(1) на крок.
+ */
+typedef struct {
+    int rows;                    ///< Видимих рядків поля
+    int cols;                    ///< Видимих стовпців поля
+    int x;                       ///< Клітинка поля в лівому верхньому куті вікна
+    int y;
+    int margin;                  ///< Найменший відступ голови від краю вікна
+    uint8_t segments[GRID_H][GRID_W]; ///< Сегментів змійки в клітинці
+    Point head;                  ///< Тіло, з яким збігається segments
+    Point tail;
+    Point before_tail;
+    int length;                  ///< 0 - сітку треба перебудувати
+} Camera;
+
+/**
+ * @brief Набір функцій одного способу виведення.
+ */
+typedef struct {
+    const char *name;
+    int (*init)(void);           ///< 0 при успіху, -1 якщо термінал не підходить
+    void (*shutdown)(void);
+    void (*clear)(void);         ///< Починає новий кадр з порожнього екрана
+    void (*put)(int y, int x, int color, int attrs, char ch);
+    void (*text)(int y, int x, int color, int attrs, const char *s);
+    void (*present)(void);       ///< Показує зібраний кадр
+    int (*read_key)(int wait);   ///< INPUT_*; wait != 0 - чекати натискання
+} RenderBackend;
+
+extern const RenderBackend render_ncurses;
+extern const RenderBackend render_ansi;
+
+/**
+ * @brief Знаходить бекенд за назвою ("ansi" або "ncurses").
+ * @return NULL, якщо такого немає або він не зібраний у цю програму.
+ */
+const RenderBackend *render_backend_by_name(const char *name);
+
+/**
+ * @brief Задає файловий дескриптор виводу ANSI-бекенду (типово stdout).
+ */
+void render_ansi_output(int fd);
+
+/**
+ * @brief Лічильники виводу процесу (з /proc/self/io).
+ */
+typedef struct {
+    unsigned long long syscalls;   ///< Системні виклики запису (syscw)
+    unsigned long long bytes;      ///< Записані байти (wchar)
+} RenderIo;
+
+/**
+ * @brief Статистика виводу кадрів.
+ */
+typedef struct {
+    unsigned long frames;
+    unsigned long long syscalls;
+    unsigned long long bytes;
+    int available;               ///< 0, якщо /proc/self/io недоступний
+} RenderStats;
+
+/**
+ * @brief Зчитує лічильники виводу процесу.
+ * @return 0 при успіху, -1 якщо вони недоступні.
+ */
+int render_io_sample(RenderIo *io);
+
+/**
+ * @brief Показує кадр і додає його системні виклики та байти до статистики.
+ * @param stats Може бути NULL - тоді кадр просто показується.
+ */
+void render_present(const RenderBackend *out, RenderStats *stats);
+
+/**
+ * @brief Малює форматований текст (як printf).
+ */
+void render_printf(const RenderBackend *out, int y, int x, int color, int attrs,
+                   const char *format, ...)
+    __attribute__((format(printf, 6, 7)));
+
+/**
+ * @brief Збирає кадр гри (без показу).
+ */
+void draw_game(const RenderBackend *out, const GameState *game);
+
+/**
+ * @brief Налаштовує камеру на термінал term_rows x term_cols.
+ * Останній рядок лишається для рахунку.
+ */
+void camera_init(Camera *camera, int term_rows, int term_cols);
+
+/**
+ * @brief Оновлює сітку сегментів і зсуває вікно за головою.
+ * Після звичайного кроку гри оновлення коштує O(1); після стрибка стану
+ * (нова гра, перемотування) сітка перебудовується з тіла.
+ */
+void camera_follow(Camera *camera, const GameState *game);
+
+/**
+ * @brief Збирає кадр гри лише для вікна камери (без показу).
+ * Кожна видима клітинка шукається в сітках перешкод, сегментів та їжі,
+ * тож вартість залежить від розміру вікна, а не від довжини змійки.
+ */
+void draw_game_viewport(const RenderBackend *out, Camera *camera, const GameState *game);
+
+/**
+ * @brief Додає до кадру камери напис про паузу.
+ */
+void draw_viewport_pause(const RenderBackend *out, const Camera *camera);
+
+/**
+ * @brief Малює статичну рамку ігрового поля.
+ */
+void draw_border(const RenderBackend *out);
+
+/**
+ * @brief Додає до кадру гри напис про паузу.
+ */
+void draw_pause(const RenderBackend *out);
+
+/**
+ * @brief Додає до кадру паузи поточний крок і доступну історію перемотування.
+ */
+void draw_rewind(const RenderBackend *out, unsigned long tick,
+                 unsigned long oldest, unsigned long newest);
+
+/**
+ * @brief Збирає початковий вітальний екран з інструкціями.
+ */
+void welcome_screen(const RenderBackend *out);
+
+/**
+ * @brief Збирає екран поразки "Game Over".
+ */
+void game_over_screen(const RenderBackend *out, const GameState *game);
+
+/**
+ * @brief Збирає екран перемоги.
+ */
+void game_won_screen(const RenderBackend *out, const GameState *game);
+
+/**
+ * @brief Додає до кінцевого екрана найкращі результати рівня.
+ */
+void draw_high_scores(const RenderBackend *out, const Leaderboard *board, int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RENDER_H
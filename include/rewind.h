@@ -0,0 +1,105 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "snake.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Перемотування гри назад і вперед. Кожен крок записується як невелика
+// оборотна різниця (нова голова, звільнений хвіст, зміна їжі, нова стіна,
+// зміна рахунку), а кожні REWIND_KEYFRAME_INTERVAL кроків - повний стан.
+// Перехід на будь-який з останніх REWIND_TICKS кроків коштує не більше
+// відстані до нього або до найближчого ключового кадру; пам'ять фіксована.
+// Стан генератора випадкових чисел теж відновлюється, тож гра після
+// перемотування продовжується так само, як ішла. Прискорення зберігається
+// як час, що воно вже тривало на своєму кроці, і після перемотування
+// відлічується від game_now(): залишок у нього той самий, що й тоді.
+
+#define REWIND_TICKS 8192                  // Степінь двійки
+#define REWIND_KEYFRAME_INTERVAL 256       // Степінь двійки, не більша за REWIND_TICKS
+#define REWIND_KEYFRAMES (REWIND_TICKS / REWIND_KEYFRAME_INTERVAL)
+
+/**
+ * @brief Їжа в різниці кроку (4 байти).
+ */
+typedef struct {
+    int8_t x;
+    int8_t y;
+    uint8_t type;
+    uint8_t active;
+} RewindFood;
+
+/**
+ * @brief Зміни одного кроку, яких досить, щоб пройти його в обидва боки.
+ */
+typedef struct {
+    uint64_t rng_before;         ///< Стан генератора до кроку
+    uint64_t rng_after;
+    int64_t boost_before_us;     ///< Скільки вже триває прискорення, мкс; -1 - неактивне
+    int64_t boost_after_us;
+    int16_t score_delta;
+    int8_t head_x;               ///< Нова голова
+    int8_t head_y;
+    int8_t tail_x;               ///< Хвіст до кроку
+    int8_t tail_y;
+    int8_t obstacle_x;           ///< Нова стіна (0, 0 - стіни не додано)
+    int8_t obstacle_y;
+    RewindFood food_before;
+    RewindFood food_after;
+    uint8_t moves;               ///< Напрямок до кроку | напрямок кроку << 2 | ріст << 4
+    uint8_t eaten;               ///< Тип з'їденої їжі + 1, 0 - нічого
+    uint8_t states;              ///< Стан гри до | після << 4
+} RewindDelta;
+
+/**
+ * @brief Повний стан після кроку tick.
+ */
+typedef struct {
+    GameState state;
+    uint64_t rng;
+    int64_t boost_us;            ///< Як у RewindDelta; state.speed_boost не використовується
+    unsigned long tick;
+} RewindKeyframe;
+
+/**
+ * @brief Кільце різниць і ключових кадрів.
+ * Різниця кроку t переводить стан t - 1 у стан t.
+ */
+typedef struct {
+    RewindDelta deltas[REWIND_TICKS];
+    RewindKeyframe keyframes[REWIND_KEYFRAMES];
+    unsigned long tick;          ///< Крок, у якому зараз гра
+    unsigned long newest;        ///< Останній записаний крок
+    unsigned long oldest;        ///< Найраніший крок, до якого можна повернутися
+    int last_direction;          ///< Напрямок у стані tick
+    int64_t boost_us;            ///< Прискорення у стані tick, як у RewindDelta
+} RewindBuffer;
+
+/**
+ * @brief Починає історію з поточного стану (крок 0).
+ */
+void rewind_init(RewindBuffer *rewind, const GameState *game);
+
+/**
+ * @brief Виконує update_game() і записує різницю кроку.
+ * Якщо гру перемотано назад, записи після поточного кроку відкидаються.
+ * Ігри з набором їжі (GameState.foods) не записуються: історія
+ * починається заново з кожного кроку.
+ * @return Результат update_game().
+ */
+int rewind_update(RewindBuffer *rewind, GameState *game);
+
+/**
+ * @brief Переводить гру на крок tick з [oldest, newest].
+ * Підключені events і foods лишаються як були; події не надсилаються.
+ * @return 0 при успіху, -1 якщо кроку вже (або ще) немає в історії.
+ */
+int rewind_seek(RewindBuffer *rewind, GameState *game, unsigned long tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REWIND_H
@@ -1,6 +1,7 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
+#include <stdint.h>
 #include <sys/time.h>
 
 #ifdef __cplusplus
@@ -27,6 +28,7 @@ extern "C" {
 #define GAME_OVER 1
 #define GAME_QUIT 2
 #define GAME_WON 3
+#define GAME_PAUSED 4
 
 // Типи їжі (Яблука)
 #define FOOD_REGULAR 0    // Червоне - звичайне (+1 довжина, +10 балів)
@@ -34,6 +36,32 @@ extern "C" {
 #define FOOD_GOLD 2       // Золоте - прискорення (+1 довжина, +50 балів, x2 швидкість)
 #define FOOD_BLUE 3       // Синє - перешкода (+1 довжина, +15 балів, додає стіну)
 
+// Причини поразки (у порядку перевірки в check_collision)
+#define DEATH_NONE 0
+#define DEATH_WALL 1
+#define DEATH_SELF 2
+#define DEATH_OBSTACLE 3
+
+// Події кроку гри (GameEvent.type)
+#define EVENT_MOVED 0          // Голова в (x, y)
+#define EVENT_TAIL_FREED 1     // Хвіст звільнив клітинку (x, y)
+#define EVENT_FOOD_EATEN 2     // З'їдено їжу типу arg у (x, y)
+#define EVENT_GREW 3           // Додано arg сегментів
+#define EVENT_OBSTACLE_ADDED 4 // Нова стіна в (x, y), arg - кількість спроб
+#define EVENT_FOOD_SPAWNED 5   // Нова їжа типу arg у (x, y)
+#define EVENT_BOOST_STARTED 6
+#define EVENT_BOOST_ENDED 7
+#define EVENT_DIED 8           // Голова в (x, y), arg - причина DEATH_*
+#define EVENT_WON 9
+
+#define GAME_EVENTS_MAX 16           // Подій за один крок
+#define GAME_EVENT_SUBSCRIBERS_MAX 8
+
+// Сітка зайнятості: поле разом з рамкою, кожен рядок - бітова маска
+#define GRID_W (WIDTH + 2)
+#define GRID_H (HEIGHT + 2)
+#define GRID_ROW_WORDS ((GRID_W + 63) / 64)
+
 // --- СТРУКТУРИ ДАНИХ ---
 
 /**
@@ -52,6 +80,7 @@ typedef struct {
     Point body[MAX_SNAKE_LENGTH];
     int length;
     int direction;
+    uint64_t hash;               ///< Zobrist-хеш клітинок тіла, голови та хвоста
 } Snake;
 
 /**
@@ -64,12 +93,49 @@ typedef struct {
     int type;
 } Food;
 
+#define FOOD_POOL_MAX (WIDTH * HEIGHT)  // Більше їжі на полі не вміститься
+
+/**
+ * @brief Таблиця аліасів Уолкера для вибору типу їжі за O(1).
+ * Будується один раз із ваг типів; кожен вибір - одне випадкове число.
+ */
+typedef struct {
+    uint32_t threshold[4];       ///< Поріг у [0, 2^24]: нижче - сам стовпчик
+    uint8_t alias[4];            ///< Тип, що займає решту стовпчика
+} FoodAlias;
+
+/**
+ * @brief Набір одночасної їжі з індексом клітинок.
+ * Активна їжа лежить щільно на початку масиву; cells дає номер їжі в
+ * клітинці, тож перевірка голови не залежить від кількості їжі.
+ */
+typedef struct {
+    Food foods[FOOD_POOL_MAX];
+    int count;                   ///< Їжі на полі зараз
+    int target;                  ///< Скільки їжі тримати на полі
+    int16_t cells[GRID_H][GRID_W]; ///< Номер їжі + 1, 0 - клітинка порожня
+    FoodAlias types;
+    uint64_t hash;               ///< Zobrist-хеш усієї їжі набору
+} FoodPool;
+
+/**
+ * @brief Бітова сітка клітинок поля (1 біт на клітинку).
+ * Індексується так само, як екран: x від 0 до WIDTH + 1, y від 0 до HEIGHT + 1.
+ */
+typedef struct {
+    uint64_t rows[GRID_H][GRID_ROW_WORDS];
+} Grid;
+
 /**
  * @brief Масив перешкод на полі.
+ * Список містить лише стіни від синіх яблук, а сітка - всі перешкоди,
+ * включно зі стінами рівня.
  */
 typedef struct {
     Point obstacles[MAX_OBSTACLES];
     int count;
+    Grid grid;                   ///< Усі зайняті перешкодами клітинки
+    uint64_t hash;               ///< Zobrist-хеш списку перешкод (без стін рівня)
 } Obstacles;
 
 /**
@@ -80,6 +146,19 @@ typedef struct {
     struct timeval start_time;
 } SpeedBoost;
 
+/**
+ * @brief Одна подія кроку гри (8 байт).
+ */
+typedef struct {
+    uint8_t type;                ///< EVENT_*
+    uint8_t arg;                 ///< Тип їжі, кількість сегментів, причина тощо
+    int16_t x;
+    int16_t y;
+    uint16_t reserved;
+} GameEvent;
+
+typedef struct GameEventBus GameEventBus;
+
 /**
  * @brief Головна структура, що зберігає повний стан гри.
  */
@@ -92,8 +171,33 @@ typedef struct {
     int state;                   ///< Поточний стан (гра йде/перемога/поразка)
     int apples_eaten;            ///< Загальна кількість з'їдених яблук
     int special_apples_eaten[4]; ///< Статистика по типах яблук
+    GameEventBus *events;        ///< Буфер подій (NULL - події не збираються)
+    FoodPool *foods;             ///< Кілька їжі замість food (NULL - одна їжа)
+    struct timeval paused_at;    ///< Початок паузи (для GAME_PAUSED)
 } GameState;
 
+/**
+ * @brief Обробник подій: отримує події кроку одним масивом. Крок, що
+ * породжує більше за GAME_EVENTS_MAX подій (заповнення великого набору
+ * їжі), передається кількома порціями.
+ */
+typedef void (*GameEventHandler)(const GameEvent *events, int count,
+                                 const GameState *game, void *context);
+
+/**
+ * @brief Буфер подій поточного кроку та список підписників.
+ * Підключається через GameState.events; без нього рушій подій не записує.
+ */
+struct GameEventBus {
+    GameEvent events[GAME_EVENTS_MAX];
+    int count;
+    unsigned long tick;          ///< Кількість виконаних кроків
+    unsigned long dropped;       ///< Подій, що не влізли в буфер
+    GameEventHandler handlers[GAME_EVENT_SUBSCRIBERS_MAX];
+    void *contexts[GAME_EVENT_SUBSCRIBERS_MAX];
+    int handler_count;
+};
+
 // --- ЛОГІКА ГРИ (Функції) ---
 
 /**
@@ -132,6 +236,12 @@ int check_obstacle_collision(const Snake *snake, const Obstacles *obstacles);
  */
 int check_collision(const Snake *snake, const Obstacles *obstacles);
 
+/**
+ * @brief Те саме, що check_collision, але повідомляє, з чим саме зіткнення.
+ * @return DEATH_NONE, DEATH_WALL, DEATH_SELF або DEATH_OBSTACLE.
+ */
+int collision_cause(const Snake *snake, const Obstacles *obstacles);
+
 /**
  * @brief Перевіряє, чи знаходиться голова змійки на координатах їжі.
  * @return 1, якщо змійка "з'їла" їжу.
@@ -152,7 +262,7 @@ int is_valid_direction_change(int current_dir, int new_dir);
 
 /**
  * @brief Збільшує довжину змійки.
- * Додає нові сегменти до хвоста змійки.
+ * Додає нові сегменти до хвоста змійки (у клітинку поточного хвоста).
  * @param amount Кількість сегментів для додавання.
  */
 void grow_snake(Snake *snake, int amount);
@@ -188,52 +298,233 @@ void activate_speed_boost(SpeedBoost *boost);
  */
 long get_time_diff_us(struct timeval start, struct timeval end);
 
-// КЕРУВАННЯ ПОТОКОМ ГРИ
+/**
+ * @brief Перевіряє, чи не розріже нова перешкода вільний простір поля.
+ * @return 1, якщо після встановлення стіни в (x, y) поле лишається зв'язним.
+ */
+int can_place_obstacle(const Obstacles *obstacles, int x, int y);
+
+// СІТКА ЗАЙНЯТОСТІ
 
 /**
- * @brief Повна ініціалізація гри перед стартом.
- * Скидає змійку, рахунок та генерує першу їжу.
+ * @brief Очищує всі клітинки сітки.
  */
-void init_game(GameState *game);
+void grid_clear(Grid *grid);
 
 /**
- * @brief Основний крок ігрового циклу.
- * Виконує рух, перевірки колізій та оновлення стану.
- * @return Новий стан гри (наприклад, GAME_OVER або GAME_RUNNING).
+ * @brief Позначає клітинку (x, y) як зайняту.
  */
-int update_game(GameState *game);
+void grid_set(Grid *grid, int x, int y);
 
 /**
- * @brief Обробляє наслідки поїдання їжі.
- * Нараховує бали, збільшує змійку та активує ефекти залежно від типу їжі.
+ * @brief Звільняє клітинку (x, y).
  */
-void handle_food_eaten(GameState *game);
+void grid_reset(Grid *grid, int x, int y);
+
+/**
+ * @brief Перевіряє, чи зайнята клітинка (x, y).
+ * @return 1, якщо зайнята; 0 для вільних клітинок і координат поза сіткою.
+ */
+int grid_test(const Grid *grid, int x, int y);
+
+/**
+ * @brief Кількість зайнятих клітинок.
+ */
+int grid_count(const Grid *grid);
+
+/**
+ * @brief Перевіряє зв'язність вільних клітинок усередині рамки.
+ * Заливка бітовими масками рядків: усі клітинки, не зайняті в `walls`,
+ * мають бути досяжні одна з одної кроками вгору/вниз/вліво/вправо.
+ * @return 1, якщо вільний простір зв'язний (або порожній).
+ */
+int grid_is_connected(const Grid *walls);
+
+// ДЕТЕРМІНІЗМ: ВИПАДКОВІ ЧИСЛА ТА ЧАС
+
+/**
+ * @brief Джерело поточного часу для ефекту прискорення.
+ */
+typedef void (*GameClock)(struct timeval *now);
+
+/**
+ * @brief Задає зерно генератора випадкових чисел гри (для поточного потоку).
+ */
+void game_srand(unsigned int seed);
+
+/**
+ * @brief Наступне випадкове число гри в діапазоні [0, 2^31).
+ * Використовується замість rand(), щоб кожен потік мав власну послідовність.
+ */
+int game_rand(void);
+
+/**
+ * @brief Повний стан генератора (для збереження та відтворення гри).
+ */
+uint64_t game_rng_state(void);
+
+/**
+ * @brief Відновлює стан генератора, отриманий з game_rng_state().
+ */
+void game_set_rng_state(uint64_t state);
+
+/**
+ * @brief Підміняє годинник гри для поточного потоку (NULL - gettimeofday).
+ * Дозволяє відтворювати ігри з віртуальним часом.
+ */
+void game_set_clock(GameClock clock);
+
+/**
+ * @brief Годинник гри поточного потоку (NULL - gettimeofday).
+ */
+GameClock game_get_clock(void);
+
+/**
+ * @brief Поточний час за годинником гри.
+ */
+void game_now(struct timeval *now);
+
+/**
+ * @brief 64-бітний хеш стану гри (FNV-1a) для порівняння рушіїв.
+ * Враховує лише значущі поля: сегменти тіла за межами довжини ігноруються.
+ */
+uint64_t game_state_hash(const GameState *game);
+
+// ZOBRIST-ХЕШУВАННЯ
+// Хеші тіла та перешкод оновлюються за O(1) у update_snake_position(),
+// grow_snake() (через handle_food_eaten()) та add_obstacle(). Напрямок,
+// довжина, їжа та прискорення додаються в game_zobrist() теж за O(1).
+// Код, що змінює тіло чи список перешкод напряму, має викликати *_rehash().
 
-// Інтерфейс
+/**
+ * @brief Перераховує хеш тіла з нуля.
+ */
+void snake_rehash(Snake *snake);
 
 /**
- * @brief Відмальовує поточний кадр гри в консолі.
+ * @brief Перераховує хеш списку перешкод з нуля.
+ * Стіни рівня в хеш не входять: вони не змінюються протягом гри.
  */
-void draw_game(const GameState *game);
+void obstacles_rehash(Obstacles *obstacles);
+
+/**
+ * @brief Zobrist-хеш позиції: тіло, голова, хвіст, довжина, напрямок,
+ * їжа з типом (або весь набір їжі), перешкоди та активність прискорення.
+ * Однакові позиції, отримані різними послідовностями ходів, мають
+ * однаковий хеш.
+ */
+uint64_t game_zobrist(const GameState *game);
+
+// КІЛЬКА ЇЖІ
+// Набір підключається через GameState.foods після ініціалізації, як і
+// буфер подій. Тоді update_game() не чіпає GameState.food: голова шукає
+// їжу в індексі клітинок, а з'їдена їжа з'являється знову в іншому місці.
+// Класична одна їжа лишає свою послідовність випадкових чисел, тож
+// записані ігри та FastGame відтворюються як раніше.
 
 /**
- * @brief Малює статичну рамку ігрового поля.
+ * @brief Будує таблицю аліасів з ваг типів FOOD_REGULAR..FOOD_BLUE.
+ * @return 0 при успіху, -1 якщо ваги від'ємні або всі нульові.
  */
-void draw_border(void);
+int food_alias_build(FoodAlias *alias, const int weights[4]);
 
 /**
- * @brief Показує екран поразки "Game Over".
+ * @brief Випадковий тип їжі (одне game_rand()).
  */
-void game_over_screen(const GameState *game);
+int food_alias_sample(const FoodAlias *alias);
 
 /**
- * @brief Показує екран перемоги.
+ * @brief Порожній набір, що тримає на полі target їжі.
+ * @param weights Ваги типів; NULL - як у generate_food() (60/15/10/15).
+ * @return 0 при успіху, -1 для неприпустимих target або ваг.
  */
-void game_won_screen(const GameState *game);
+int food_pool_init(FoodPool *pool, int target, const int weights[4]);
+
+/**
+ * @brief Номер їжі в клітинці (x, y) за O(1).
+ * @return Індекс у pool->foods або -1.
+ */
+int food_pool_find(const FoodPool *pool, int x, int y);
+
+/**
+ * @brief Додає одну їжу на вільну клітинку (не змійка, не перешкода, не їжа).
+ * @return Індекс нової їжі або -1, якщо набір повний чи місця немає.
+ */
+int food_pool_spawn(FoodPool *pool, const Snake *snake, const Obstacles *obstacles);
+
+/**
+ * @brief Переносить їжу index на нову вільну клітинку з новим типом.
+ * Якщо місця немає, їжа зникає, а її місце в масиві займає остання.
+ * @return index, якщо їжа з'явилася знову, інакше -1.
+ */
+int food_pool_respawn(FoodPool *pool, int index, const Snake *snake,
+                      const Obstacles *obstacles);
+
+// ПОДІЇ
+
+/**
+ * @brief Очищує буфер подій і список підписників.
+ */
+void game_events_init(GameEventBus *bus);
+
+/**
+ * @brief Додає обробник, що викликається в кінці кожного кроку з подіями.
+ * @return 0 при успіху, -1 якщо підписників забагато.
+ */
+int game_events_subscribe(GameEventBus *bus, GameEventHandler handler, void *context);
+
 /**
- * @brief Показує початковий вітальний екран з інструкціями.
+ * @brief Записує подію в буфер. Зайві події понад GAME_EVENTS_MAX
+ * відкидаються і рахуються в dropped.
  */
-void welcome_screen(void);
+void game_events_emit(GameEventBus *bus, int type, int arg, int x, int y);
+
+/**
+ * @brief Передає події кроку всім підписникам.
+ */
+void game_events_dispatch(GameEventBus *bus, const GameState *game);
+
+/**
+ * @brief Передає накопичені події підписникам і звільняє буфер, щоб крок
+ * міг записати більше за GAME_EVENTS_MAX подій.
+ */
+void game_events_flush(GameEventBus *bus, const GameState *game);
+
+// КЕРУВАННЯ ПОТОКОМ ГРИ
+
+/**
+ * @brief Повна ініціалізація гри перед стартом.
+ * Скидає змійку, рахунок та генерує першу їжу.
+ */
+void init_game(GameState *game);
+
+/**
+ * @brief Ставить гру на паузу (лише з GAME_RUNNING).
+ */
+void pause_game(GameState *game);
+
+/**
+ * @brief Знімає паузу; прискорення продовжується з того ж місця.
+ */
+void resume_game(GameState *game);
+
+/**
+ * @brief Основний крок ігрового циклу.
+ * Виконує рух, перевірки колізій та оновлення стану.
+ * Якщо підключено GameState.events, записує події кроку та сповіщає підписників.
+ * На паузі нічого не змінює.
+ * @return Новий стан гри (наприклад, GAME_OVER або GAME_RUNNING).
+ */
+int update_game(GameState *game);
+
+/**
+ * @brief Обробляє наслідки поїдання їжі.
+ * Нараховує бали, збільшує змійку та активує ефекти залежно від типу їжі.
+ * З набором їжі обробляє їжу під головою і одразу переносить лише її.
+ */
+void handle_food_eaten(GameState *game);
+
+// Інтерфейс: функції малювання оголошені в render.h
 
 #ifdef __cplusplus
 }
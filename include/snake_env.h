@@ -0,0 +1,94 @@
+#ifndef SNAKE_ENV_H
+#define SNAKE_ENV_H
+
+#include "fast_game.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Пакет із N середовищ для навчання агентів (у стилі Gym): reset, step,
+// observe. Спостереження пишуться прямо в суцільний буфер викликача:
+// площини [N][ENV_PLANES][HEIGHT][WIDTH] по байту на клітинку, або
+// бітові площини [N][ENV_PLANES][HEIGHT] по uint64 на рядок (біт x-1).
+// Крок оновлює лише клітинки, що змінилися; пам'ять виділяється тільки
+// в snake_env_init. Кожне середовище має власний генератор випадкових
+// чисел і віртуальний годинник (ENV_TICK_US на крок), тож результати
+// відтворюються за seed.
+
+// Площини спостереження
+#define ENV_PLANE_SNAKE 0          // Усі сегменти, разом з головою
+#define ENV_PLANE_HEAD 1
+#define ENV_PLANE_FOOD 2           // + FOOD_*: окрема площина на кожен тип їжі
+#define ENV_PLANE_OBSTACLE 6       // Стіни рівня та стіни від синіх яблук
+#define ENV_PLANE_BOOST 7          // Уся площина заповнена, поки діє прискорення
+#define ENV_PLANES 8
+
+// Формати спостережень
+#define ENV_OBS_U8 0
+#define ENV_OBS_BITS 1
+
+#define ENV_ACTION_NONE 4          // Дія: DIR_* або продовжити рух
+#define ENV_TICK_US 100000         // Віртуальний час одного кроку
+
+// Значення dones
+#define ENV_RUNNING 0
+#define ENV_LOST 1
+#define ENV_WON 2
+
+/**
+ * @brief Пакет середовищ.
+ */
+typedef struct {
+    int count;
+    int format;                  ///< ENV_OBS_*
+    void *obs;                   ///< Буфер викликача, count * snake_env_obs_size(format)
+    FastGame *games;
+    uint64_t *rng;               ///< Стан генератора кожного середовища
+    uint64_t *ticks;             ///< Кроки з початку поточного епізоду
+    uint64_t *episodes;          ///< Завершені епізоди
+} SnakeEnv;
+
+/**
+ * @brief Розмір спостереження одного середовища в байтах.
+ */
+size_t snake_env_obs_size(int format);
+
+/**
+ * @brief Виділяє стани для count середовищ; obs - буфер викликача.
+ * @return 0 при успіху, -1 при неправильних параметрах або нестачі пам'яті.
+ */
+int snake_env_init(SnakeEnv *env, int count, int format, void *obs);
+
+/**
+ * @brief Звільняє стани середовищ (буфер спостережень лишається викликачу).
+ */
+void snake_env_free(SnakeEnv *env);
+
+/**
+ * @brief Починає нові епізоди: середовище i отримує seed + i.
+ * Записує спостереження всіх середовищ.
+ */
+void snake_env_reset(SnakeEnv *env, unsigned int seed);
+
+/**
+ * @brief Один крок усіх середовищ.
+ * Завершене середовище (GAME_OVER або GAME_WON) одразу починає новий
+ * епізод, і його спостереження вже показує новий старт.
+ * @param actions DIR_* або ENV_ACTION_NONE для кожного середовища.
+ * @param rewards Зміна рахунку за крок (може бути NULL).
+ * @param dones ENV_RUNNING, ENV_LOST або ENV_WON (може бути NULL).
+ */
+void snake_env_step(SnakeEnv *env, const uint8_t *actions, int32_t *rewards, uint8_t *dones);
+
+/**
+ * @brief Повністю переписує спостереження всіх середовищ з їхніх станів.
+ */
+void snake_env_observe(SnakeEnv *env);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_ENV_H
@@ -0,0 +1,98 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Потокова статистика з пам'яттю, що не залежить від кількості значень:
+// середнє та дисперсія за Велфордом і квантилі через t-digest.
+// Обидва агрегатори можна зливати, тож кожен потік рахує свої.
+
+#define TDIGEST_COMPRESSION 100                     // Більше - точніші квантилі
+#define TDIGEST_CENTROIDS (2 * TDIGEST_COMPRESSION) // Стиснений дайджест не перевищує
+#define TDIGEST_BUFFER 512                          // Значень до наступного стиснення
+
+/**
+ * @brief Середнє, дисперсія та межі потоку значень.
+ */
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2;                   ///< Сума квадратів відхилень від середнього
+    double min;
+    double max;
+} RunningStats;
+
+/**
+ * @brief Центроїд t-digest: середнє групи значень та їх кількість.
+ */
+typedef struct {
+    double mean;
+    double weight;
+} TDigestCentroid;
+
+/**
+ * @brief Наближені квантилі потоку значень (t-digest зі злиттям).
+ */
+typedef struct {
+    TDigestCentroid centroids[TDIGEST_CENTROIDS + TDIGEST_BUFFER];
+    int count;                   ///< Стиснених центроїдів на початку масиву
+    int buffered;                ///< Нових значень після них
+    double total;                ///< Сумарна вага
+    double min;
+    double max;
+} TDigest;
+
+/**
+ * @brief Очищає статистику.
+ */
+void running_stats_init(RunningStats *stats);
+
+/**
+ * @brief Додає значення.
+ */
+void running_stats_add(RunningStats *stats, double value);
+
+/**
+ * @brief Додає до dst усі значення src.
+ */
+void running_stats_merge(RunningStats *dst, const RunningStats *src);
+
+/**
+ * @brief Вибіркова дисперсія (0 для менше ніж двох значень).
+ */
+double running_stats_variance(const RunningStats *stats);
+
+/**
+ * @brief Половина ширини 95% довірчого інтервалу середнього.
+ */
+double running_stats_ci95(const RunningStats *stats);
+
+/**
+ * @brief Очищає дайджест.
+ */
+void tdigest_init(TDigest *digest);
+
+/**
+ * @brief Додає значення з вагою.
+ */
+void tdigest_add(TDigest *digest, double value, double weight);
+
+/**
+ * @brief Додає до dst усі значення src.
+ */
+void tdigest_merge(TDigest *dst, const TDigest *src);
+
+/**
+ * @brief Наближений квантиль q з [0, 1] (0 для порожнього дайджесту).
+ */
+double tdigest_quantile(TDigest *digest, double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATS_H
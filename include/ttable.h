@@ -0,0 +1,81 @@
+#ifndef TTABLE_H
+#define TTABLE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Таблиця транспозицій для пошукових агентів: фіксований розмір, спільна
+// для потоків без блокувань. Кожен запис - два 64-бітні слова (ключ XOR
+// дані, дані), тож розірваний паралельним записом запис просто не
+// проходить перевірку ключа і вважається промахом. Кошик з чотирьох
+// записів займає одну кеш-лінію.
+
+#define TTABLE_BUCKET 4
+
+// Тип оцінки в записі
+#define TT_EXACT 0
+#define TT_LOWER 1               // Оцінка не менша за value
+#define TT_UPPER 2               // Оцінка не більша за value
+
+/**
+ * @brief Результат пошуку для однієї позиції.
+ */
+typedef struct {
+    int32_t value;
+    int16_t depth;               ///< Глибина пошуку, що дала value
+    uint8_t bound;               ///< TT_*
+    uint8_t move;                ///< Найкращий напрямок (DIR_*)
+} TTEntry;
+
+/**
+ * @brief Один запис таблиці.
+ */
+typedef struct {
+    uint64_t check;              ///< Ключ XOR data
+    uint64_t data;               ///< Упакований TTEntry
+} TTSlot;
+
+/**
+ * @brief Таблиця транспозицій.
+ */
+typedef struct {
+    TTSlot *slots;
+    uint64_t mask;               ///< Кількість кошиків - 1
+} TTable;
+
+/**
+ * @brief Виділяє таблицю з 2^log2_buckets кошиків.
+ * @return 0 при успіху, -1 якщо не вистачило пам'яті.
+ */
+int ttable_init(TTable *table, int log2_buckets);
+
+/**
+ * @brief Звільняє таблицю.
+ */
+void ttable_free(TTable *table);
+
+/**
+ * @brief Очищає всі записи (не одночасно з пошуком).
+ */
+void ttable_clear(TTable *table);
+
+/**
+ * @brief Шукає позицію за Zobrist-ключем.
+ * @return 1 і запис у entry, якщо знайдено, інакше 0.
+ */
+int ttable_probe(const TTable *table, uint64_t key, TTEntry *entry);
+
+/**
+ * @brief Зберігає результат. Замінює запис тієї ж позиції, інакше
+ * порожній або найменш глибокий запис у кошику.
+ */
+void ttable_store(TTable *table, uint64_t key, const TTEntry *entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TTABLE_H
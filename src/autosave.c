@@ -0,0 +1,223 @@
+#include "autosave.h"
+#include "checksum.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define AUTOSAVE_MAGIC "SNKSAVE1"
+
+typedef struct {
+    char magic[8];
+    uint32_t size;               // sizeof(AutosaveState) of the writer
+    uint32_t crc;                // Of the state
+    uint64_t sequence;
+} AutosaveHeader;
+
+static void prev_path(char *out, size_t size, const char *path) {
+    snprintf(out, size, "%s.prev", path);
+}
+
+int autosave_write(const char *path, const AutosaveState *state, uint64_t sequence) {
+    char tmp_path[AUTOSAVE_PATH_LEN + 8];
+    char old_path[AUTOSAVE_PATH_LEN + 8];
+    AutosaveHeader header;
+    int fd;
+    int ok = 1;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, AUTOSAVE_MAGIC, sizeof(header.magic));
+    header.size = (uint32_t)sizeof(*state);
+    header.crc = crc32_update(0, state, sizeof(*state));
+    header.sequence = sequence;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    ok &= write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header);
+    ok &= write(fd, state, sizeof(*state)) == (ssize_t)sizeof(*state);
+    ok &= fsync(fd) == 0;
+    ok &= close(fd) == 0;
+    if (!ok) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    // The last good checkpoint stays around in case this one is lost
+    prev_path(old_path, sizeof(old_path), path);
+    if (rename(path, old_path) != 0 && errno != ENOENT) {
+        unlink(tmp_path);
+        return -1;
+    }
+    if (rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+static int load_one(const char *path, AutosaveState *state, uint64_t *sequence) {
+    AutosaveHeader header;
+    int fd = open(path, O_RDONLY);
+    int ok;
+
+    if (fd < 0) {
+        return -1;
+    }
+    ok = read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header) &&
+         memcmp(header.magic, AUTOSAVE_MAGIC, sizeof(header.magic)) == 0 &&
+         header.size == sizeof(*state) &&
+         read(fd, state, sizeof(*state)) == (ssize_t)sizeof(*state) &&
+         crc32_update(0, state, sizeof(*state)) == header.crc;
+    close(fd);
+    if (!ok) {
+        return -1;
+    }
+    *sequence = header.sequence;
+    return 0;
+}
+
+int autosave_load(const char *path, AutosaveState *state, uint64_t *sequence) {
+    char old_path[AUTOSAVE_PATH_LEN + 8];
+    AutosaveState older;
+    uint64_t newest = 0, old = 0;
+    int found = load_one(path, state, &newest) == 0;
+
+    prev_path(old_path, sizeof(old_path), path);
+    if (load_one(old_path, &older, &old) == 0 && (!found || old > newest)) {
+        *state = older;
+        newest = old;
+        found = 1;
+    }
+    if (!found) {
+        return -1;
+    }
+    if (sequence) {
+        *sequence = newest;
+    }
+    return 0;
+}
+
+void autosave_remove(const char *path) {
+    char old_path[AUTOSAVE_PATH_LEN + 8];
+
+    prev_path(old_path, sizeof(old_path), path);
+    unlink(path);
+    unlink(old_path);
+}
+
+void autosave_restore(const AutosaveState *state, GameState *game, FoodPool *foods) {
+    *game = state->game;
+    game->events = NULL;
+    game->foods = NULL;
+    if (state->has_foods && foods) {
+        *foods = state->foods;
+        game->foods = foods;
+    }
+    game_set_rng_state(state->rng);
+
+    // Paused since the save, so resume_game() moves the boost timer past
+    // the time the game was not running
+    if (game->state == GAME_RUNNING) {
+        game->state = GAME_PAUSED;
+        game->paused_at = state->saved_at;
+    }
+}
+
+// ========== Background writer ==========
+
+static void *autosave_main(void *arg) {
+    Autosave *saver = arg;
+
+    pthread_mutex_lock(&saver->lock);
+    for (;;) {
+        while (!saver->has_pending && !saver->stop) {
+            pthread_cond_wait(&saver->wake, &saver->lock);
+        }
+        if (!saver->has_pending) {
+            break;
+        }
+        saver->writing = saver->pending;
+        saver->has_pending = 0;
+        uint64_t sequence = ++saver->sequence;
+        pthread_mutex_unlock(&saver->lock);
+
+        int result = autosave_write(saver->path, &saver->writing, sequence);
+
+        pthread_mutex_lock(&saver->lock);
+        if (result == 0) {
+            saver->saved++;
+        } else {
+            saver->failed++;
+        }
+    }
+    pthread_mutex_unlock(&saver->lock);
+    return NULL;
+}
+
+int autosave_start(Autosave *saver, const char *path, uint64_t sequence) {
+    sigset_t all, old;
+
+    snprintf(saver->path, sizeof(saver->path), "%s", path);
+    saver->has_pending = 0;
+    saver->stop = 0;
+    saver->sequence = sequence;
+    saver->captured = saver->saved = saver->replaced = saver->failed = 0;
+    pthread_mutex_init(&saver->lock, NULL);
+    pthread_cond_init(&saver->wake, NULL);
+
+    // Signals such as SIGHUP are for the game thread, which saves and exits
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    int result = pthread_create(&saver->thread, NULL, autosave_main, saver);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (result != 0) {
+        pthread_mutex_destroy(&saver->lock);
+        pthread_cond_destroy(&saver->wake);
+        return -1;
+    }
+    return 0;
+}
+
+void autosave_capture(Autosave *saver, const GameState *game, uint64_t tick,
+                      int level_id, int rewound) {
+    AutosaveState *state = &saver->pending;
+
+    pthread_mutex_lock(&saver->lock);
+    if (saver->has_pending) {
+        saver->replaced++;
+    }
+    state->game = *game;
+    state->game.events = NULL;
+    state->game.foods = NULL;
+    state->has_foods = game->foods != NULL;
+    if (game->foods) {
+        state->foods = *game->foods;
+    } else {
+        memset(&state->foods, 0, sizeof(state->foods));
+    }
+    state->rng = game_rng_state();
+    state->tick = tick;
+    game_now(&state->saved_at);
+    state->level_id = level_id;
+    state->rewound = rewound;
+    state->reserved = 0;
+    saver->has_pending = 1;
+    saver->captured++;
+    pthread_cond_signal(&saver->wake);
+    pthread_mutex_unlock(&saver->lock);
+}
+
+void autosave_stop(Autosave *saver) {
+    pthread_mutex_lock(&saver->lock);
+    saver->stop = 1;
+    pthread_cond_signal(&saver->wake);
+    pthread_mutex_unlock(&saver->lock);
+    pthread_join(saver->thread, NULL);
+    pthread_mutex_destroy(&saver->lock);
+    pthread_cond_destroy(&saver->wake);
+}
@@ -0,0 +1,275 @@
+#include "compact_game.h"
+#include <string.h>
+
+_Static_assert(sizeof(CompactGame) == 64, "compact games must fit one cache line");
+_Static_assert(WIDTH * HEIGHT <= (1 << COMPACT_OBSTACLE_BITS), "obstacle cells must fit 10 bits");
+_Static_assert(WIDTH + 1 <= 127 && HEIGHT + 1 <= 127, "coordinates must fit int8_t");
+
+static const int step_x[4] = { 0, 1, 0, -1 };
+static const int step_y[4] = { -1, 0, 1, 0 };
+
+// Direction that leads from a to the adjacent b, or -1
+static int move_between(Point a, Point b) {
+    for (int dir = 0; dir < 4; dir++) {
+        if (a.x + step_x[dir] == b.x && a.y + step_y[dir] == b.y) {
+            return dir;
+        }
+    }
+    return -1;
+}
+
+static int fits_int8(int v) {
+    return v >= -128 && v <= 127;
+}
+
+static int encode_body(CompactGame *game, const Point *body, int length) {
+    int unfolded = length;
+
+    if (length < 1 || length > MAX_SNAKE_LENGTH ||
+        !fits_int8(body[0].x) || !fits_int8(body[0].y)) {
+        return -1;
+    }
+    // Segments added by grow_snake() sit on the tail until the snake moves on
+    while (unfolded > 1 && body[unfolded - 1].x == body[unfolded - 2].x &&
+           body[unfolded - 1].y == body[unfolded - 2].y) {
+        unfolded--;
+    }
+
+    game->head_x = (int8_t)body[0].x;
+    game->head_y = (int8_t)body[0].y;
+    game->length = (uint8_t)length;
+    game->stacked = (uint8_t)(length - unfolded);
+    memset(game->moves, 0, sizeof(game->moves));
+    for (int i = 1; i < unfolded; i++) {
+        int dir = move_between(body[i - 1], body[i]);
+        if (dir < 0) {
+            return -1;
+        }
+        game->moves[(i - 1) >> 2] |= (uint8_t)(dir << (((i - 1) & 3) * 2));
+    }
+    return 0;
+}
+
+static void decode_body(const CompactGame *game, Point *body) {
+    int unfolded = game->length - game->stacked;
+
+    body[0].x = game->head_x;
+    body[0].y = game->head_y;
+    for (int i = 1; i < game->length; i++) {
+        body[i] = body[i - 1];
+        if (i < unfolded) {
+            int dir = (game->moves[(i - 1) >> 2] >> (((i - 1) & 3) * 2)) & 3;
+            body[i].x += step_x[dir];
+            body[i].y += step_y[dir];
+        }
+    }
+}
+
+static void set_obstacle(CompactGame *game, int index, int cell) {
+    int bit = index * COMPACT_OBSTACLE_BITS;
+    for (int b = 0; b < COMPACT_OBSTACLE_BITS; b++, bit++) {
+        if (cell & (1 << b)) {
+            game->obstacles[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+        }
+    }
+}
+
+static int get_obstacle(const CompactGame *game, int index) {
+    int bit = index * COMPACT_OBSTACLE_BITS;
+    int cell = 0;
+    for (int b = 0; b < COMPACT_OBSTACLE_BITS; b++, bit++) {
+        cell |= ((game->obstacles[bit >> 3] >> (bit & 7)) & 1) << b;
+    }
+    return cell;
+}
+
+static int encode_obstacles(CompactGame *game, const Obstacles *obstacles, const Grid *walls) {
+    Grid expected;
+
+    if (obstacles->count < 0 || obstacles->count > MAX_OBSTACLES) {
+        return -1;
+    }
+    if (walls) {
+        expected = *walls;
+    } else {
+        grid_clear(&expected);
+    }
+
+    game->walls = walls;
+    game->obstacle_count = (uint8_t)obstacles->count;
+    memset(game->obstacles, 0, sizeof(game->obstacles));
+    for (int i = 0; i < obstacles->count; i++) {
+        Point p = obstacles->obstacles[i];
+        if (p.x < 1 || p.x > WIDTH || p.y < 1 || p.y > HEIGHT) {
+            return -1;
+        }
+        set_obstacle(game, i, (p.y - 1) * WIDTH + (p.x - 1));
+        grid_set(&expected, p.x, p.y);
+    }
+    // Everything on the grid must come back from walls plus the list
+    return memcmp(&expected, &obstacles->grid, sizeof(Grid)) == 0 ? 0 : -1;
+}
+
+static void decode_obstacles(const CompactGame *game, Obstacles *obstacles) {
+    if (game->walls) {
+        obstacles->grid = *game->walls;
+    } else {
+        grid_clear(&obstacles->grid);
+    }
+    obstacles->count = game->obstacle_count;
+    for (int i = 0; i < game->obstacle_count; i++) {
+        int cell = get_obstacle(game, i);
+        obstacles->obstacles[i].x = cell % WIDTH + 1;
+        obstacles->obstacles[i].y = cell / WIDTH + 1;
+        grid_set(&obstacles->grid, obstacles->obstacles[i].x, obstacles->obstacles[i].y);
+    }
+    obstacles_rehash(obstacles);
+}
+
+static void encode_boost(CompactGame *game, const SpeedBoost *boost) {
+    struct timeval now;
+    long ticks;
+
+    if (!boost->active) {
+        game->boost_age = 0;
+        return;
+    }
+    game_now(&now);
+    ticks = get_time_diff_us(boost->start_time, now) / COMPACT_TICK_US;
+    if (ticks < 0) {
+        ticks = 0;
+    }
+    // Long-expired boosts all behave the same until the next tick clears them
+    game->boost_age = (uint8_t)(ticks < 254 ? ticks + 1 : 255);
+}
+
+static void decode_boost(const CompactGame *game, SpeedBoost *boost) {
+    boost->active = game->boost_age != 0;
+    if (boost->active) {
+        long back = (long)(game->boost_age - 1) * COMPACT_TICK_US;
+        struct timeval now;
+
+        game_now(&now);
+        long usec = now.tv_usec - back % 1000000;
+        boost->start_time.tv_sec = now.tv_sec - back / 1000000;
+        if (usec < 0) {
+            usec += 1000000;
+            boost->start_time.tv_sec--;
+        }
+        boost->start_time.tv_usec = usec;
+    }
+}
+
+// Fields shared by GameState and FastGame after the body
+static int encode_rest(CompactGame *game, int direction, const Food *food,
+                       const Obstacles *obstacles, const SpeedBoost *boost,
+                       int score, int state, int apples_eaten, const int *special,
+                       const Grid *walls) {
+    if (direction < 0 || direction > 3 || state < 0 || state > GAME_PAUSED ||
+        score < 0 || score > UINT16_MAX || apples_eaten < 0 || apples_eaten > UINT8_MAX) {
+        return -1;
+    }
+
+    game->flags = (uint8_t)(direction | state << COMPACT_STATE_SHIFT);
+    game->food_x = 0;
+    game->food_y = 0;
+    if (food->active) {
+        if (!fits_int8(food->position.x) || !fits_int8(food->position.y) ||
+            food->type < FOOD_REGULAR || food->type > FOOD_BLUE) {
+            return -1;
+        }
+        game->flags |= COMPACT_FOOD_ACTIVE | food->type << COMPACT_FOOD_SHIFT;
+        game->food_x = (int8_t)food->position.x;
+        game->food_y = (int8_t)food->position.y;
+    }
+
+    game->score = (uint16_t)score;
+    game->apples_eaten = (uint8_t)apples_eaten;
+    for (int i = 0; i < 4; i++) {
+        if (special[i] < 0 || special[i] > UINT8_MAX) {
+            return -1;
+        }
+        game->special_apples_eaten[i] = (uint8_t)special[i];
+    }
+    encode_boost(game, boost);
+    return encode_obstacles(game, obstacles, walls);
+}
+
+static void decode_food(const CompactGame *game, Food *food) {
+    food->active = (game->flags & COMPACT_FOOD_ACTIVE) != 0;
+    food->type = food->active ? (game->flags >> COMPACT_FOOD_SHIFT) & 3 : FOOD_REGULAR;
+    food->position.x = game->food_x;
+    food->position.y = game->food_y;
+}
+
+int compact_game_from_state(CompactGame *game, const GameState *state, const Grid *walls) {
+    memset(game, 0, sizeof(*game));
+    if (encode_body(game, state->snake.body, state->snake.length) < 0) {
+        return -1;
+    }
+    return encode_rest(game, state->snake.direction, &state->food, &state->obstacles,
+                       &state->speed_boost, state->score, state->state,
+                       state->apples_eaten, state->special_apples_eaten, walls);
+}
+
+void compact_game_to_state(const CompactGame *game, GameState *state) {
+    init_game_state(state);
+    state->snake.length = game->length;
+    state->snake.direction = game->flags & COMPACT_DIR_MASK;
+    decode_body(game, state->snake.body);
+    snake_rehash(&state->snake);
+    decode_food(game, &state->food);
+    decode_obstacles(game, &state->obstacles);
+    decode_boost(game, &state->speed_boost);
+    state->score = game->score;
+    state->state = game->flags >> COMPACT_STATE_SHIFT;
+    state->apples_eaten = game->apples_eaten;
+    for (int i = 0; i < 4; i++) {
+        state->special_apples_eaten[i] = game->special_apples_eaten[i];
+    }
+    if (state->state == GAME_PAUSED) {
+        game_now(&state->paused_at);
+    }
+}
+
+int compact_game_from_fast(CompactGame *game, const FastGame *fast, const Grid *walls) {
+    Point body[MAX_SNAKE_LENGTH];
+
+    memset(game, 0, sizeof(*game));
+    if (fast->length < 1 || fast->length > MAX_SNAKE_LENGTH) {
+        return -1;
+    }
+    for (int i = 0; i < fast->length; i++) {
+        body[i] = fast->ring[(fast->head + i) & FAST_RING_MASK];
+    }
+    if (encode_body(game, body, fast->length) < 0) {
+        return -1;
+    }
+    return encode_rest(game, fast->direction, &fast->food, &fast->obstacles,
+                       &fast->speed_boost, fast->score, fast->state,
+                       fast->apples_eaten, fast->special_apples_eaten, walls);
+}
+
+void compact_game_to_fast(const CompactGame *game, FastGame *fast) {
+    memset(fast->cells, 0, sizeof(fast->cells));
+    fast->head = 0;
+    fast->length = game->length;
+    fast->direction = game->flags & COMPACT_DIR_MASK;
+    decode_body(game, fast->ring);
+    for (int i = 0; i < fast->length; i++) {
+        Point p = fast->ring[i];
+        if (p.x >= 0 && p.x < GRID_W && p.y >= 0 && p.y < GRID_H) {
+            fast->cells[p.y][p.x]++;
+        }
+    }
+
+    decode_food(game, &fast->food);
+    decode_obstacles(game, &fast->obstacles);
+    decode_boost(game, &fast->speed_boost);
+    fast->score = game->score;
+    fast->state = game->flags >> COMPACT_STATE_SHIFT;
+    fast->apples_eaten = game->apples_eaten;
+    for (int i = 0; i < 4; i++) {
+        fast->special_apples_eaten[i] = game->special_apples_eaten[i];
+    }
+}
@@ -0,0 +1,42 @@
+#include "snake.h"
+#include <string.h>
+
+void game_events_init(GameEventBus *bus) {
+    memset(bus, 0, sizeof(*bus));
+}
+
+int game_events_subscribe(GameEventBus *bus, GameEventHandler handler, void *context) {
+    if (bus->handler_count >= GAME_EVENT_SUBSCRIBERS_MAX) {
+        return -1;
+    }
+    bus->handlers[bus->handler_count] = handler;
+    bus->contexts[bus->handler_count] = context;
+    bus->handler_count++;
+    return 0;
+}
+
+void game_events_emit(GameEventBus *bus, int type, int arg, int x, int y) {
+    if (bus->count >= GAME_EVENTS_MAX) {
+        bus->dropped++;
+        return;
+    }
+    GameEvent *event = &bus->events[bus->count++];
+    event->type = (uint8_t)type;
+    event->arg = (uint8_t)arg;
+    event->x = (int16_t)x;
+    event->y = (int16_t)y;
+    event->reserved = 0;
+}
+
+void game_events_dispatch(GameEventBus *bus, const GameState *game) {
+    for (int i = 0; i < bus->handler_count; i++) {
+        bus->handlers[i](bus->events, bus->count, game, bus->contexts[i]);
+    }
+}
+
+void game_events_flush(GameEventBus *bus, const GameState *game) {
+    if (bus->count > 0) {
+        game_events_dispatch(bus, game);
+        bus->count = 0;
+    }
+}
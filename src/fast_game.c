@@ -0,0 +1,202 @@
+#include "fast_game.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(FAST_RING_SIZE >= MAX_SNAKE_LENGTH, "ring must hold the longest snake");
+
+#define SEG(g, i) ((g)->ring[((g)->head + (i)) & FAST_RING_MASK])
+
+void fast_game_from_state(FastGame *game, const GameState *state) {
+    memset(game->cells, 0, sizeof(game->cells));
+    game->head = 0;
+    game->length = state->snake.length;
+    game->direction = state->snake.direction;
+    for (int i = 0; i < state->snake.length; i++) {
+        Point p = state->snake.body[i];
+        game->ring[i] = p;
+        if (p.x >= 0 && p.x < GRID_W && p.y >= 0 && p.y < GRID_H) {
+            game->cells[p.y][p.x]++;
+        }
+    }
+
+    game->food = state->food;
+    game->obstacles = state->obstacles;
+    game->speed_boost = state->speed_boost;
+    game->score = state->score;
+    game->state = state->state;
+    game->apples_eaten = state->apples_eaten;
+    memcpy(game->special_apples_eaten, state->special_apples_eaten,
+           sizeof(game->special_apples_eaten));
+}
+
+void fast_game_to_state(const FastGame *game, GameState *state) {
+    init_game_state(state);
+    state->snake.length = game->length;
+    state->snake.direction = game->direction;
+    for (int i = 0; i < game->length; i++) {
+        state->snake.body[i] = SEG(game, i);
+    }
+    snake_rehash(&state->snake);
+
+    state->food = game->food;
+    state->obstacles = game->obstacles;
+    obstacles_rehash(&state->obstacles);
+    state->speed_boost = game->speed_boost;
+    state->score = game->score;
+    state->state = game->state;
+    state->apples_eaten = game->apples_eaten;
+    memcpy(state->special_apples_eaten, game->special_apples_eaten,
+           sizeof(state->special_apples_eaten));
+}
+
+void fast_game_turn(FastGame *game, int direction) {
+    if (is_valid_direction_change(game->direction, direction)) {
+        game->direction = direction;
+    }
+}
+
+static int on_snake(const FastGame *game, int x, int y) {
+    if (x < 0 || x >= GRID_W || y < 0 || y >= GRID_H) {
+        return 0;
+    }
+    return game->cells[y][x] != 0;
+}
+
+static void grow(FastGame *game, int amount) {
+    for (int i = 0; i < amount; i++) {
+        if (game->length < MAX_SNAKE_LENGTH) {
+            Point tail = SEG(game, game->length - 1);
+            SEG(game, game->length) = tail;
+            game->cells[tail.y][tail.x]++;
+            game->length++;
+        }
+    }
+}
+
+static void spawn_food(FastGame *game) {
+    Food *food = &game->food;
+    int valid = 0;
+    int attempts = 0;
+
+    // Same draws in the same order as generate_food()
+    int r = game_rand() % 100;
+    if (r < 60) {
+        food->type = FOOD_REGULAR;
+    } else if (r < 75) {
+        food->type = FOOD_GREEN;
+    } else if (r < 85) {
+        food->type = FOOD_GOLD;
+    } else {
+        food->type = FOOD_BLUE;
+    }
+
+    while (!valid && attempts < 1000) {
+        food->position.x = game_rand() % WIDTH + 1;
+        food->position.y = game_rand() % HEIGHT + 1;
+        valid = !on_snake(game, food->position.x, food->position.y) &&
+                !grid_test(&game->obstacles.grid, food->position.x, food->position.y);
+        attempts++;
+    }
+    food->active = 1;
+}
+
+static void place_obstacle(FastGame *game) {
+    Obstacles *obstacles = &game->obstacles;
+    int valid = 0;
+    int attempts = 0;
+    Point p;
+
+    if (obstacles->count >= MAX_OBSTACLES) {
+        return;
+    }
+
+    // Same draws in the same order as add_obstacle()
+    while (!valid && attempts < 100) {
+        p.x = game_rand() % WIDTH + 1;
+        p.y = game_rand() % HEIGHT + 1;
+        valid = !on_snake(game, p.x, p.y) &&
+                !grid_test(&obstacles->grid, p.x, p.y) &&
+                !(game->food.active &&
+                  abs(p.x - game->food.position.x) < 3 &&
+                  abs(p.y - game->food.position.y) < 3) &&
+                can_place_obstacle(obstacles, p.x, p.y);
+        attempts++;
+    }
+
+    if (valid) {
+        obstacles->obstacles[obstacles->count++] = p;
+        grid_set(&obstacles->grid, p.x, p.y);
+    }
+}
+
+static void eat(FastGame *game) {
+    game->apples_eaten++;
+    game->special_apples_eaten[game->food.type]++;
+
+    switch (game->food.type) {
+        case FOOD_REGULAR:
+            game->score += 10;
+            grow(game, 1);
+            break;
+        case FOOD_GREEN:
+            game->score += 20;
+            grow(game, 2);
+            break;
+        case FOOD_GOLD:
+            game->score += 50;
+            grow(game, 1);
+            activate_speed_boost(&game->speed_boost);
+            break;
+        case FOOD_BLUE:
+            game->score += 15;
+            grow(game, 1);
+            place_obstacle(game);
+            break;
+    }
+    game->food.active = 0;
+}
+
+int fast_game_step(FastGame *game) {
+    Point tail = SEG(game, game->length - 1);
+    Point head = SEG(game, 0);
+
+    switch (game->direction) {
+        case DIR_UP:    head.y--; break;
+        case DIR_RIGHT: head.x++; break;
+        case DIR_DOWN:  head.y++; break;
+        case DIR_LEFT:  head.x--; break;
+    }
+
+    // Drop the tail, then push the new head in front of the old one
+    game->cells[tail.y][tail.x]--;
+    game->head = (game->head - 1) & FAST_RING_MASK;
+    SEG(game, 0) = head;
+
+    if (head.x <= 0 || head.x >= WIDTH + 1 || head.y <= 0 || head.y >= HEIGHT + 1) {
+        game->state = GAME_OVER;
+        return GAME_OVER;
+    }
+    game->cells[head.y][head.x]++;
+    if (game->cells[head.y][head.x] > 1 || grid_test(&game->obstacles.grid, head.x, head.y)) {
+        game->state = GAME_OVER;
+        return GAME_OVER;
+    }
+
+    if (game->length >= WIN_LENGTH) {
+        game->state = GAME_WON;
+        return GAME_WON;
+    }
+
+    if (game->food.active &&
+        head.x == game->food.position.x && head.y == game->food.position.y) {
+        eat(game);
+    }
+    if (!game->food.active) {
+        spawn_food(game);
+    }
+
+    if (game->speed_boost.active && !is_speed_boost_active(&game->speed_boost)) {
+        game->speed_boost.active = 0;
+    }
+    return GAME_RUNNING;
+}
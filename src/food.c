@@ -0,0 +1,175 @@
+#include "snake.h"
+#include <string.h>
+
+#define ALIAS_ONE (1u << 24)
+#define SPAWN_ATTEMPTS 64
+
+// Same odds as the probability chain in generate_food()
+static const int default_weights[4] = { 60, 15, 10, 15 };
+
+int food_alias_build(FoodAlias *alias, const int weights[4]) {
+    uint64_t scaled[4];
+    int small[4], large[4];
+    int small_count = 0, large_count = 0;
+    uint64_t total = 0;
+
+    for (int i = 0; i < 4; i++) {
+        if (weights[i] < 0) {
+            return -1;
+        }
+        total += (uint64_t)weights[i];
+    }
+    if (total == 0) {
+        return -1;
+    }
+
+    // Vose's method in fixed point: each column holds 1/4 of the mass,
+    // split between its own type and one alias
+    for (int i = 0; i < 4; i++) {
+        scaled[i] = (uint64_t)weights[i] * 4 * ALIAS_ONE / total;
+        alias->alias[i] = (uint8_t)i;
+        alias->threshold[i] = ALIAS_ONE;
+        if (scaled[i] < ALIAS_ONE) {
+            small[small_count++] = i;
+        } else {
+            large[large_count++] = i;
+        }
+    }
+    while (small_count > 0 && large_count > 0) {
+        int s = small[--small_count];
+        int l = large[large_count - 1];
+        alias->threshold[s] = (uint32_t)scaled[s];
+        alias->alias[s] = (uint8_t)l;
+        scaled[l] -= ALIAS_ONE - scaled[s];
+        if (scaled[l] < ALIAS_ONE) {
+            large_count--;
+            small[small_count++] = l;
+        }
+    }
+    // Whatever is left over only differs from a full column by rounding
+    return 0;
+}
+
+int food_alias_sample(const FoodAlias *alias) {
+    uint32_t r = (uint32_t)game_rand();
+    int column = r & 3;
+    return ((r >> 2) & (ALIAS_ONE - 1)) < alias->threshold[column] ? column : alias->alias[column];
+}
+
+// Zobrist key of one pooled food (splitmix64 of type and cell)
+static uint64_t food_key(const Food *food) {
+    uint64_t z = ((uint64_t)(4 + food->type) << 32 |
+                  (uint32_t)(food->position.y << 16 | food->position.x)) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int food_pool_init(FoodPool *pool, int target, const int weights[4]) {
+    if (target < 1 || target > FOOD_POOL_MAX) {
+        return -1;
+    }
+    memset(pool, 0, sizeof(*pool));
+    pool->target = target;
+    return food_alias_build(&pool->types, weights ? weights : default_weights);
+}
+
+int food_pool_find(const FoodPool *pool, int x, int y) {
+    if (x < 0 || x >= GRID_W || y < 0 || y >= GRID_H) {
+        return -1;
+    }
+    return pool->cells[y][x] - 1;
+}
+
+static int cell_is_free(const FoodPool *pool, const Snake *snake,
+                        const Obstacles *obstacles, int x, int y) {
+    return !pool->cells[y][x] && !is_position_on_obstacle(obstacles, x, y) &&
+           !is_position_on_snake(snake, x, y);
+}
+
+// Rejection sampling while the board is sparse, then a uniform pick among
+// the cells that are actually free
+static int pick_cell(const FoodPool *pool, const Snake *snake,
+                     const Obstacles *obstacles, Point *out) {
+    int free_count = 0;
+
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+        out->x = game_rand() % WIDTH + 1;
+        out->y = game_rand() % HEIGHT + 1;
+        if (cell_is_free(pool, snake, obstacles, out->x, out->y)) {
+            return 0;
+        }
+    }
+
+    for (int y = 1; y <= HEIGHT; y++) {
+        for (int x = 1; x <= WIDTH; x++) {
+            free_count += cell_is_free(pool, snake, obstacles, x, y);
+        }
+    }
+    if (free_count == 0) {
+        return -1;
+    }
+    int pick = game_rand() % free_count;
+    for (int y = 1; y <= HEIGHT; y++) {
+        for (int x = 1; x <= WIDTH; x++) {
+            if (cell_is_free(pool, snake, obstacles, x, y) && pick-- == 0) {
+                out->x = x;
+                out->y = y;
+                return 0;
+            }
+        }
+    }
+    return -1;
+}
+
+static void place(FoodPool *pool, int index, Point position, int type) {
+    Food *food = &pool->foods[index];
+
+    food->position = position;
+    food->active = 1;
+    food->type = type;
+    pool->cells[position.y][position.x] = (int16_t)(index + 1);
+    pool->hash ^= food_key(food);
+}
+
+int food_pool_spawn(FoodPool *pool, const Snake *snake, const Obstacles *obstacles) {
+    Point position;
+
+    if (pool->count >= FOOD_POOL_MAX) {
+        return -1;
+    }
+    int type = food_alias_sample(&pool->types);
+    if (pick_cell(pool, snake, obstacles, &position) < 0) {
+        return -1;
+    }
+    place(pool, pool->count, position, type);
+    return pool->count++;
+}
+
+int food_pool_respawn(FoodPool *pool, int index, const Snake *snake,
+                      const Obstacles *obstacles) {
+    Food *food;
+    Point position;
+
+    if (index < 0 || index >= pool->count) {
+        return -1;
+    }
+    food = &pool->foods[index];
+    pool->cells[food->position.y][food->position.x] = 0;
+    pool->hash ^= food_key(food);
+
+    int type = food_alias_sample(&pool->types);
+    if (pick_cell(pool, snake, obstacles, &position) == 0) {
+        place(pool, index, position, type);
+        return index;
+    }
+
+    // No room: keep the array dense by moving the last food into the gap
+    pool->count--;
+    if (index != pool->count) {
+        *food = pool->foods[pool->count];
+        pool->cells[food->position.y][food->position.x] = (int16_t)(index + 1);
+    }
+    pool->foods[pool->count].active = 0;
+    return -1;
+}
@@ -1,285 +1,628 @@
-#include "snake.h"
-#include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
-
-void init_game_state(GameState *game) {
-    // Initialize snake in the middle
-    game->snake.length = 3;
-    game->snake.direction = DIR_RIGHT;
-    
-    for (int i = 0; i < game->snake.length; i++) {
-        game->snake.body[i].x = WIDTH / 2 - i;
-        game->snake.body[i].y = HEIGHT / 2;
-    }
-    
-    // Initialize food
-    game->food.active = 0;
-    game->food.type = FOOD_REGULAR;
-    
-    // Initialize obstacles
-    game->obstacles.count = 0;
-    
-    // Initialize speed boost
-    game->speed_boost.active = 0;
-    
-    // Initialize score and stats
-    game->score = 0;
-    game->state = GAME_RUNNING;
-    game->apples_eaten = 0;
-    for (int i = 0; i < 4; i++) {
-        game->special_apples_eaten[i] = 0;
-    }
-}
-
-void init_game(GameState *game) {
-    srand(time(NULL));
-    init_game_state(game);
-}
-
-void update_snake_position(Snake *snake) {
-    // Move body segments
-    for (int i = snake->length - 1; i > 0; i--) {
-        snake->body[i] = snake->body[i - 1];
-    }
-    
-    // Move head based on direction
-    switch(snake->direction) {
-        case DIR_UP:
-            snake->body[0].y--;
-            break;
-        case DIR_RIGHT:
-            snake->body[0].x++;
-            break;
-        case DIR_DOWN:
-            snake->body[0].y++;
-            break;
-        case DIR_LEFT:
-            snake->body[0].x--;
-            break;
-    }
-}
-
-int check_wall_collision(const Snake *snake) {
-    return (snake->body[0].x <= 0 || snake->body[0].x >= WIDTH + 1 ||
-            snake->body[0].y <= 0 || snake->body[0].y >= HEIGHT + 1);
-}
-
-int check_self_collision(const Snake *snake) {
-    for (int i = 1; i < snake->length; i++) {
-        if (snake->body[0].x == snake->body[i].x &&
-            snake->body[0].y == snake->body[i].y) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-int check_obstacle_collision(const Snake *snake, const Obstacles *obstacles) {
-    for (int i = 0; i < obstacles->count; i++) {
-        if (snake->body[0].x == obstacles->obstacles[i].x &&
-            snake->body[0].y == obstacles->obstacles[i].y) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-int check_collision(const Snake *snake, const Obstacles *obstacles) {
-    return check_wall_collision(snake) || check_self_collision(snake) || 
-           check_obstacle_collision(snake, obstacles);
-}
-
-int check_food_collision(const Snake *snake, const Food *food) {
-    if (food->active &&
-        snake->body[0].x == food->position.x &&
-        snake->body[0].y == food->position.y) {
-        return 1;
-    }
-    return 0;
-}
-
-int is_position_on_snake(const Snake *snake, int x, int y) {
-    for (int i = 0; i < snake->length; i++) {
-        if (snake->body[i].x == x && snake->body[i].y == y) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-int is_position_on_obstacle(const Obstacles *obstacles, int x, int y) {
-    for (int i = 0; i < obstacles->count; i++) {
-        if (obstacles->obstacles[i].x == x && obstacles->obstacles[i].y == y) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-void generate_food(const Snake *snake, const Obstacles *obstacles, Food *food) {
-    int valid = 0;
-    int attempts = 0;
-    const int max_attempts = 1000;
-    
-    // Determine food type based on probability
-    int r = rand() % 100;
-    if (r < 60) {
-        food->type = FOOD_REGULAR;  // 60% chance
-    } else if (r < 75) {
-        food->type = FOOD_GREEN;    // 15% chance
-    } else if (r < 85) {
-        food->type = FOOD_GOLD;     // 10% chance
-    } else {
-        food->type = FOOD_BLUE;     // 15% chance
-    }
-    
-    while (!valid && attempts < max_attempts) {
-        food->position.x = rand() % WIDTH + 1;
-        food->position.y = rand() % HEIGHT + 1;
-        
-        // Make sure food doesn't spawn on snake or obstacles
-        if (!is_position_on_snake(snake, food->position.x, food->position.y) &&
-            !is_position_on_obstacle(obstacles, food->position.x, food->position.y)) {
-            valid = 1;
-        }
-        attempts++;
-    }
-    
-    food->active = 1;
-}
-
-int is_valid_direction_change(int current_dir, int new_dir) {
-    // Can't reverse direction
-    if ((current_dir == DIR_UP && new_dir == DIR_DOWN) ||
-        (current_dir == DIR_DOWN && new_dir == DIR_UP) ||
-        (current_dir == DIR_LEFT && new_dir == DIR_RIGHT) ||
-        (current_dir == DIR_RIGHT && new_dir == DIR_LEFT)) {
-        return 0;
-    }
-    return 1;
-}
-
-void grow_snake(Snake *snake, int amount) {
-    for (int i = 0; i < amount; i++) {
-        if (snake->length < MAX_SNAKE_LENGTH) {
-            snake->length++;
-        }
-    }
-}
-
-void add_obstacle(GameState *game) {
-    if (game->obstacles.count >= MAX_OBSTACLES) {
-        return;
-    }
-    
-    int valid = 0;
-    int attempts = 0;
-    const int max_attempts = 100;
-    Point new_obstacle;
-    
-    while (!valid && attempts < max_attempts) {
-        new_obstacle.x = rand() % WIDTH + 1;
-        new_obstacle.y = rand() % HEIGHT + 1;
-        
-        // Don't place on snake, existing obstacles, or near food
-        if (!is_position_on_snake(&game->snake, new_obstacle.x, new_obstacle.y) &&
-            !is_position_on_obstacle(&game->obstacles, new_obstacle.x, new_obstacle.y) &&
-            !(game->food.active && 
-              abs(new_obstacle.x - game->food.position.x) < 3 &&
-              abs(new_obstacle.y - game->food.position.y) < 3)) {
-            valid = 1;
-        }
-        attempts++;
-    }
-    
-    if (valid) {
-        game->obstacles.obstacles[game->obstacles.count++] = new_obstacle;
-    }
-}
-
-long get_time_diff_us(struct timeval start, struct timeval end) {
-    return (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
-}
-
-int is_speed_boost_active(const SpeedBoost *boost) {
-    if (!boost->active) {
-        return 0;
-    }
-    
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    long diff = get_time_diff_us(boost->start_time, now);
-    
-    return diff < SPEED_BOOST_DURATION;
-}
-
-void activate_speed_boost(SpeedBoost *boost) {
-    boost->active = 1;
-    gettimeofday(&boost->start_time, NULL);
-}
-
-void handle_food_eaten(GameState *game) {
-    game->apples_eaten++;
-    game->special_apples_eaten[game->food.type]++;
-    
-    switch (game->food.type) {
-        case FOOD_REGULAR:
-            game->score += 10;
-            grow_snake(&game->snake, 1);
-            break;
-            
-        case FOOD_GREEN:
-            game->score += 20;
-            grow_snake(&game->snake, 2);
-            break;
-            
-        case FOOD_GOLD:
-            game->score += 50;
-            grow_snake(&game->snake, 1);
-            activate_speed_boost(&game->speed_boost);
-            break;
-            
-        case FOOD_BLUE:
-            game->score += 15;
-            grow_snake(&game->snake, 1);
-            add_obstacle(game);
-            break;
-    }
-    
-    game->food.active = 0;
-}
-
-int update_game(GameState *game) {
-    // Update snake position
-    update_snake_position(&game->snake);
-    
-    // Check for collisions
-    if (check_collision(&game->snake, &game->obstacles)) {
-        game->state = GAME_OVER;
-        return GAME_OVER;
-    }
-    
-    // Check win condition
-    if (game->snake.length >= WIN_LENGTH) {
-        game->state = GAME_WON;
-        return GAME_WON;
-    }
-    
-    // Check if snake ate food
-    if (check_food_collision(&game->snake, &game->food)) {
-        handle_food_eaten(game);
-    }
-    
-    // Generate new food if needed
-    if (!game->food.active) {
-        generate_food(&game->snake, &game->obstacles, &game->food);
-    }
-    
-    // Update speed boost status
-    if (game->speed_boost.active && !is_speed_boost_active(&game->speed_boost)) {
-        game->speed_boost.active = 0;
-    }
-    
-    return GAME_RUNNING;
-}
+#include "snake.h"
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+// Per-thread engine state so batch runners can play many games in parallel
+static _Thread_local uint64_t rng_state = 0x853C49E6748FEA9BULL;
+static _Thread_local GameClock game_clock = NULL;
+
+void game_srand(unsigned int seed) {
+    // splitmix64 of the seed, never zero
+    uint64_t z = (uint64_t)seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    rng_state = z ? z : 1;
+}
+
+int game_rand(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (int)((rng_state * 0x2545F4914F6CDD1DULL) >> 33);
+}
+
+uint64_t game_rng_state(void) {
+    return rng_state;
+}
+
+void game_set_rng_state(uint64_t state) {
+    rng_state = state ? state : 1;
+}
+
+void game_set_clock(GameClock clock) {
+    game_clock = clock;
+}
+
+GameClock game_get_clock(void) {
+    return game_clock;
+}
+
+void game_now(struct timeval *now) {
+    if (game_clock) {
+        game_clock(now);
+    } else {
+        gettimeofday(now, NULL);
+    }
+}
+
+// ========== Zobrist keys ==========
+
+#define ZOBRIST_BODY 0
+#define ZOBRIST_HEAD 1
+#define ZOBRIST_TAIL 2
+#define ZOBRIST_OBSTACLE 3
+#define ZOBRIST_FOOD 4           // + food type
+#define ZOBRIST_DIRECTION 8
+#define ZOBRIST_LENGTH 9
+#define ZOBRIST_BOOST 10
+
+// Keys are derived on the fly (splitmix64 of kind and cell) instead of read
+// from a table: no initialization, shared by all threads, and no table
+// cache misses on the hot path
+static uint64_t zobrist_key(int kind, int x, int y) {
+    uint64_t z = ((uint64_t)kind << 32 | (uint32_t)(y << 16 | (x & 0xFFFF))) *
+                 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void snake_rehash(Snake *snake) {
+    snake->hash = 0;
+    for (int i = 0; i < snake->length; i++) {
+        snake->hash ^= zobrist_key(ZOBRIST_BODY, snake->body[i].x, snake->body[i].y);
+    }
+    if (snake->length > 0) {
+        Point tail = snake->body[snake->length - 1];
+        snake->hash ^= zobrist_key(ZOBRIST_HEAD, snake->body[0].x, snake->body[0].y) ^
+                       zobrist_key(ZOBRIST_TAIL, tail.x, tail.y);
+    }
+}
+
+void obstacles_rehash(Obstacles *obstacles) {
+    obstacles->hash = 0;
+    for (int i = 0; i < obstacles->count; i++) {
+        obstacles->hash ^= zobrist_key(ZOBRIST_OBSTACLE, obstacles->obstacles[i].x,
+                                       obstacles->obstacles[i].y);
+    }
+}
+
+uint64_t game_zobrist(const GameState *game) {
+    uint64_t hash = game->snake.hash ^ game->obstacles.hash ^
+                    zobrist_key(ZOBRIST_DIRECTION, game->snake.direction, 0) ^
+                    zobrist_key(ZOBRIST_LENGTH, game->snake.length, 0);
+
+    if (game->foods) {
+        hash ^= game->foods->hash;
+    } else if (game->food.active) {
+        hash ^= zobrist_key(ZOBRIST_FOOD + game->food.type,
+                            game->food.position.x, game->food.position.y);
+    }
+    if (game->speed_boost.active) {
+        hash ^= zobrist_key(ZOBRIST_BOOST, 0, 0);
+    }
+    return hash;
+}
+
+// ========== Game logic ==========
+
+void init_game_state(GameState *game) {
+    // Initialize snake in the middle
+    game->snake.length = 3;
+    game->snake.direction = DIR_RIGHT;
+    
+    for (int i = 0; i < game->snake.length; i++) {
+        game->snake.body[i].x = WIDTH / 2 - i;
+        game->snake.body[i].y = HEIGHT / 2;
+    }
+    snake_rehash(&game->snake);
+    
+    // Initialize food
+    game->food.active = 0;
+    game->food.type = FOOD_REGULAR;
+    
+    // Initialize obstacles
+    game->obstacles.count = 0;
+    grid_clear(&game->obstacles.grid);
+    game->obstacles.hash = 0;
+    
+    // Initialize speed boost
+    game->speed_boost.active = 0;
+    
+    // Initialize score and stats
+    game->score = 0;
+    game->state = GAME_RUNNING;
+    game->apples_eaten = 0;
+    for (int i = 0; i < 4; i++) {
+        game->special_apples_eaten[i] = 0;
+    }
+    
+    // Events and the food pool are opt-in; callers attach them after initialization
+    game->events = NULL;
+    game->foods = NULL;
+    game->paused_at.tv_sec = 0;
+    game->paused_at.tv_usec = 0;
+}
+
+void init_game(GameState *game) {
+    game_srand((unsigned int)time(NULL));
+    init_game_state(game);
+}
+
+void update_snake_position(Snake *snake) {
+    Point old_head = snake->body[0];
+    Point old_tail = snake->body[snake->length - 1];
+
+    // Move body segments
+    for (int i = snake->length - 1; i > 0; i--) {
+        snake->body[i] = snake->body[i - 1];
+    }
+    
+    // Move head based on direction
+    switch(snake->direction) {
+        case DIR_UP:
+            snake->body[0].y--;
+            break;
+        case DIR_RIGHT:
+            snake->body[0].x++;
+            break;
+        case DIR_DOWN:
+            snake->body[0].y++;
+            break;
+        case DIR_LEFT:
+            snake->body[0].x--;
+            break;
+    }
+
+    // The old tail cell is freed and the new head cell taken
+    Point head = snake->body[0];
+    Point tail = snake->body[snake->length - 1];
+    snake->hash ^= zobrist_key(ZOBRIST_BODY, old_tail.x, old_tail.y) ^
+                   zobrist_key(ZOBRIST_BODY, head.x, head.y) ^
+                   zobrist_key(ZOBRIST_HEAD, old_head.x, old_head.y) ^
+                   zobrist_key(ZOBRIST_HEAD, head.x, head.y) ^
+                   zobrist_key(ZOBRIST_TAIL, old_tail.x, old_tail.y) ^
+                   zobrist_key(ZOBRIST_TAIL, tail.x, tail.y);
+}
+
+int check_wall_collision(const Snake *snake) {
+    return (snake->body[0].x <= 0 || snake->body[0].x >= WIDTH + 1 ||
+            snake->body[0].y <= 0 || snake->body[0].y >= HEIGHT + 1);
+}
+
+int check_self_collision(const Snake *snake) {
+    for (int i = 1; i < snake->length; i++) {
+        if (snake->body[0].x == snake->body[i].x &&
+            snake->body[0].y == snake->body[i].y) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int check_obstacle_collision(const Snake *snake, const Obstacles *obstacles) {
+    return grid_test(&obstacles->grid, snake->body[0].x, snake->body[0].y);
+}
+
+int check_collision(const Snake *snake, const Obstacles *obstacles) {
+    return check_wall_collision(snake) || check_self_collision(snake) || 
+           check_obstacle_collision(snake, obstacles);
+}
+
+int collision_cause(const Snake *snake, const Obstacles *obstacles) {
+    if (check_wall_collision(snake)) {
+        return DEATH_WALL;
+    }
+    if (check_self_collision(snake)) {
+        return DEATH_SELF;
+    }
+    if (check_obstacle_collision(snake, obstacles)) {
+        return DEATH_OBSTACLE;
+    }
+    return DEATH_NONE;
+}
+
+int check_food_collision(const Snake *snake, const Food *food) {
+    if (food->active &&
+        snake->body[0].x == food->position.x &&
+        snake->body[0].y == food->position.y) {
+        return 1;
+    }
+    return 0;
+}
+
+int is_position_on_snake(const Snake *snake, int x, int y) {
+    for (int i = 0; i < snake->length; i++) {
+        if (snake->body[i].x == x && snake->body[i].y == y) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int is_position_on_obstacle(const Obstacles *obstacles, int x, int y) {
+    return grid_test(&obstacles->grid, x, y);
+}
+
+int can_place_obstacle(const Obstacles *obstacles, int x, int y) {
+    Grid walls = obstacles->grid;
+    grid_set(&walls, x, y);
+    return grid_is_connected(&walls);
+}
+
+void generate_food(const Snake *snake, const Obstacles *obstacles, Food *food) {
+    int valid = 0;
+    int attempts = 0;
+    const int max_attempts = 1000;
+    
+    // Determine food type based on probability
+    int r = game_rand() % 100;
+    if (r < 60) {
+        food->type = FOOD_REGULAR;  // 60% chance
+    } else if (r < 75) {
+        food->type = FOOD_GREEN;    // 15% chance
+    } else if (r < 85) {
+        food->type = FOOD_GOLD;     // 10% chance
+    } else {
+        food->type = FOOD_BLUE;     // 15% chance
+    }
+    
+    while (!valid && attempts < max_attempts) {
+        food->position.x = game_rand() % WIDTH + 1;
+        food->position.y = game_rand() % HEIGHT + 1;
+        
+        // Make sure food doesn't spawn on snake or obstacles
+        if (!is_position_on_snake(snake, food->position.x, food->position.y) &&
+            !is_position_on_obstacle(obstacles, food->position.x, food->position.y)) {
+            valid = 1;
+        }
+        attempts++;
+    }
+    
+    food->active = 1;
+}
+
+int is_valid_direction_change(int current_dir, int new_dir) {
+    // Can't reverse direction
+    if ((current_dir == DIR_UP && new_dir == DIR_DOWN) ||
+        (current_dir == DIR_DOWN && new_dir == DIR_UP) ||
+        (current_dir == DIR_LEFT && new_dir == DIR_RIGHT) ||
+        (current_dir == DIR_RIGHT && new_dir == DIR_LEFT)) {
+        return 0;
+    }
+    return 1;
+}
+
+void grow_snake(Snake *snake, int amount) {
+    for (int i = 0; i < amount; i++) {
+        if (snake->length < MAX_SNAKE_LENGTH) {
+            // New segments start on the tail cell and unfold as the snake moves
+            Point tail = snake->body[snake->length - 1];
+            snake->body[snake->length++] = tail;
+            snake->hash ^= zobrist_key(ZOBRIST_BODY, tail.x, tail.y);
+        }
+    }
+}
+
+// Blue apples wall off a random cell, but never next to the apple itself
+// or on top of pooled food
+static void place_obstacle(GameState *game, const Food *near) {
+    if (game->obstacles.count >= MAX_OBSTACLES) {
+        return;
+    }
+    
+    int valid = 0;
+    int attempts = 0;
+    const int max_attempts = 100;
+    Point new_obstacle;
+    
+    while (!valid && attempts < max_attempts) {
+        new_obstacle.x = game_rand() % WIDTH + 1;
+        new_obstacle.y = game_rand() % HEIGHT + 1;
+        
+        // Don't place on snake, existing obstacles, or near food,
+        // and never cut the free space in two
+        if (!is_position_on_snake(&game->snake, new_obstacle.x, new_obstacle.y) &&
+            !is_position_on_obstacle(&game->obstacles, new_obstacle.x, new_obstacle.y) &&
+            !(near->active &&
+              abs(new_obstacle.x - near->position.x) < 3 &&
+              abs(new_obstacle.y - near->position.y) < 3) &&
+            !(game->foods && food_pool_find(game->foods, new_obstacle.x, new_obstacle.y) >= 0) &&
+            can_place_obstacle(&game->obstacles, new_obstacle.x, new_obstacle.y)) {
+            valid = 1;
+        }
+        attempts++;
+    }
+    
+    if (valid) {
+        game->obstacles.obstacles[game->obstacles.count++] = new_obstacle;
+        grid_set(&game->obstacles.grid, new_obstacle.x, new_obstacle.y);
+        game->obstacles.hash ^= zobrist_key(ZOBRIST_OBSTACLE, new_obstacle.x, new_obstacle.y);
+        if (game->events) {
+            game_events_emit(game->events, EVENT_OBSTACLE_ADDED, attempts,
+                             new_obstacle.x, new_obstacle.y);
+        }
+    }
+}
+
+void add_obstacle(GameState *game) {
+    place_obstacle(game, &game->food);
+}
+
+long get_time_diff_us(struct timeval start, struct timeval end) {
+    return (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
+}
+
+int is_speed_boost_active(const SpeedBoost *boost) {
+    if (!boost->active) {
+        return 0;
+    }
+    
+    struct timeval now;
+    game_now(&now);
+    long diff = get_time_diff_us(boost->start_time, now);
+    
+    return diff < SPEED_BOOST_DURATION;
+}
+
+void activate_speed_boost(SpeedBoost *boost) {
+    boost->active = 1;
+    game_now(&boost->start_time);
+}
+
+// A pool fills all at once, far past GAME_EVENTS_MAX, so a full bus is
+// handed to the subscribers early instead of dropping spawns
+static void emit_pool_spawn(GameState *game, const Food *food) {
+    if (!game->events) {
+        return;
+    }
+    if (game->events->count >= GAME_EVENTS_MAX) {
+        game_events_flush(game->events, game);
+    }
+    game_events_emit(game->events, EVENT_FOOD_SPAWNED, food->type,
+                     food->position.x, food->position.y);
+}
+
+static void eat_food(GameState *game, const Food *food) {
+    int old_length = game->snake.length;
+    
+    if (game->events) {
+        game_events_emit(game->events, EVENT_FOOD_EATEN, food->type,
+                         food->position.x, food->position.y);
+    }
+    
+    game->apples_eaten++;
+    game->special_apples_eaten[food->type]++;
+    
+    switch (food->type) {
+        case FOOD_REGULAR:
+            game->score += 10;
+            grow_snake(&game->snake, 1);
+            break;
+            
+        case FOOD_GREEN:
+            game->score += 20;
+            grow_snake(&game->snake, 2);
+            break;
+            
+        case FOOD_GOLD:
+            game->score += 50;
+            grow_snake(&game->snake, 1);
+            activate_speed_boost(&game->speed_boost);
+            if (game->events) {
+                game_events_emit(game->events, EVENT_BOOST_STARTED, 0, 0, 0);
+            }
+            break;
+            
+        case FOOD_BLUE:
+            game->score += 15;
+            grow_snake(&game->snake, 1);
+            place_obstacle(game, food);
+            break;
+    }
+    
+    if (game->events && game->snake.length > old_length) {
+        game_events_emit(game->events, EVENT_GREW, game->snake.length - old_length, 0, 0);
+    }
+}
+
+void handle_food_eaten(GameState *game) {
+    if (game->foods) {
+        Point head = game->snake.body[0];
+        int index = food_pool_find(game->foods, head.x, head.y);
+        if (index < 0) {
+            return;
+        }
+        // Only the eaten food moves; the rest of the pool stays put
+        Food eaten = game->foods->foods[index];
+        eat_food(game, &eaten);
+        index = food_pool_respawn(game->foods, index, &game->snake, &game->obstacles);
+        if (index >= 0) {
+            emit_pool_spawn(game, &game->foods->foods[index]);
+        }
+        return;
+    }
+    
+    eat_food(game, &game->food);
+    game->food.active = 0;
+}
+
+// Hands the tick's events to subscribers on every exit path
+static int finish_tick(GameState *game, int result) {
+    if (game->events) {
+        game_events_dispatch(game->events, game);
+    }
+    return result;
+}
+
+void pause_game(GameState *game) {
+    if (game->state == GAME_RUNNING) {
+        game->state = GAME_PAUSED;
+        game_now(&game->paused_at);
+    }
+}
+
+void resume_game(GameState *game) {
+    if (game->state != GAME_PAUSED) {
+        return;
+    }
+    
+    // Time spent paused does not count against the speed boost
+    if (game->speed_boost.active) {
+        struct timeval now;
+        game_now(&now);
+        long paused = get_time_diff_us(game->paused_at, now);
+        long usec = game->speed_boost.start_time.tv_usec + paused % 1000000;
+        game->speed_boost.start_time.tv_sec += paused / 1000000 + usec / 1000000;
+        game->speed_boost.start_time.tv_usec = usec % 1000000;
+    }
+    game->state = GAME_RUNNING;
+}
+
+int update_game(GameState *game) {
+    GameEventBus *events = game->events;
+    Point old_tail = { 0, 0 };
+    
+    if (game->state == GAME_PAUSED) {
+        return GAME_PAUSED;
+    }
+    
+    if (events) {
+        events->count = 0;
+        events->tick++;
+        old_tail = game->snake.body[game->snake.length - 1];
+    }
+    
+    // Update snake position
+    update_snake_position(&game->snake);
+    
+    if (events) {
+        Point new_tail = game->snake.body[game->snake.length - 1];
+        if (new_tail.x != old_tail.x || new_tail.y != old_tail.y) {
+            game_events_emit(events, EVENT_TAIL_FREED, 0, old_tail.x, old_tail.y);
+        }
+        game_events_emit(events, EVENT_MOVED, 0,
+                         game->snake.body[0].x, game->snake.body[0].y);
+    }
+    
+    // Check for collisions
+    int cause = collision_cause(&game->snake, &game->obstacles);
+    if (cause != DEATH_NONE) {
+        game->state = GAME_OVER;
+        if (events) {
+            game_events_emit(events, EVENT_DIED, cause,
+                             game->snake.body[0].x, game->snake.body[0].y);
+        }
+        return finish_tick(game, GAME_OVER);
+    }
+    
+    // Check win condition
+    if (game->snake.length >= WIN_LENGTH) {
+        game->state = GAME_WON;
+        if (events) {
+            game_events_emit(events, EVENT_WON, 0,
+                             game->snake.body[0].x, game->snake.body[0].y);
+        }
+        return finish_tick(game, GAME_WON);
+    }
+    
+    if (game->foods) {
+        FoodPool *pool = game->foods;
+        if (food_pool_find(pool, game->snake.body[0].x, game->snake.body[0].y) >= 0) {
+            handle_food_eaten(game);
+        }
+        // Fill the pool on the first tick and whenever the board had no room
+        while (pool->count < pool->target) {
+            int index = food_pool_spawn(pool, &game->snake, &game->obstacles);
+            if (index < 0) {
+                break;
+            }
+            emit_pool_spawn(game, &pool->foods[index]);
+        }
+    } else if (check_food_collision(&game->snake, &game->food)) {
+        // Check if snake ate food
+        handle_food_eaten(game);
+    }
+    
+    // Generate new food if needed
+    if (!game->foods && !game->food.active) {
+        generate_food(&game->snake, &game->obstacles, &game->food);
+        if (events) {
+            game_events_emit(events, EVENT_FOOD_SPAWNED, game->food.type,
+                             game->food.position.x, game->food.position.y);
+        }
+    }
+    
+    // Update speed boost status
+    if (game->speed_boost.active && !is_speed_boost_active(&game->speed_boost)) {
+        game->speed_boost.active = 0;
+        if (events) {
+            game_events_emit(events, EVENT_BOOST_ENDED, 0, 0, 0);
+        }
+    }
+    
+    return finish_tick(game, GAME_RUNNING);
+}
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static uint64_t hash_int(uint64_t hash, long value) {
+    return hash_bytes(hash, &value, sizeof(value));
+}
+
+uint64_t game_state_hash(const GameState *game) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    hash = hash_int(hash, game->snake.length);
+    hash = hash_int(hash, game->snake.direction);
+    for (int i = 0; i < game->snake.length; i++) {
+        hash = hash_int(hash, game->snake.body[i].x);
+        hash = hash_int(hash, game->snake.body[i].y);
+    }
+
+    hash = hash_int(hash, game->food.active);
+    if (game->food.active) {
+        hash = hash_int(hash, game->food.position.x);
+        hash = hash_int(hash, game->food.position.y);
+        hash = hash_int(hash, game->food.type);
+    }
+    if (game->foods) {
+        hash = hash_int(hash, game->foods->count);
+        for (int i = 0; i < game->foods->count; i++) {
+            hash = hash_int(hash, game->foods->foods[i].position.x);
+            hash = hash_int(hash, game->foods->foods[i].position.y);
+            hash = hash_int(hash, game->foods->foods[i].type);
+        }
+    }
+
+    hash = hash_int(hash, game->obstacles.count);
+    for (int i = 0; i < game->obstacles.count; i++) {
+        hash = hash_int(hash, game->obstacles.obstacles[i].x);
+        hash = hash_int(hash, game->obstacles.obstacles[i].y);
+    }
+    hash = hash_bytes(hash, &game->obstacles.grid, sizeof(game->obstacles.grid));
+
+    hash = hash_int(hash, game->speed_boost.active);
+    if (game->speed_boost.active) {
+        hash = hash_int(hash, game->speed_boost.start_time.tv_sec);
+        hash = hash_int(hash, game->speed_boost.start_time.tv_usec);
+    }
+
+    hash = hash_int(hash, game->score);
+    hash = hash_int(hash, game->state);
+    hash = hash_int(hash, game->apples_eaten);
+    for (int i = 0; i < 4; i++) {
+        hash = hash_int(hash, game->special_apples_eaten[i]);
+    }
+    return hash;
+}
@@ -0,0 +1,134 @@
+#include "snake.h"
+#include <string.h>
+
+typedef uint64_t Row[GRID_ROW_WORDS];
+
+void grid_clear(Grid *grid) {
+    memset(grid->rows, 0, sizeof(grid->rows));
+}
+
+void grid_set(Grid *grid, int x, int y) {
+    if (x < 0 || x >= GRID_W || y < 0 || y >= GRID_H) {
+        return;
+    }
+    grid->rows[y][x >> 6] |= (uint64_t)1 << (x & 63);
+}
+
+void grid_reset(Grid *grid, int x, int y) {
+    if (x < 0 || x >= GRID_W || y < 0 || y >= GRID_H) {
+        return;
+    }
+    grid->rows[y][x >> 6] &= ~((uint64_t)1 << (x & 63));
+}
+
+int grid_test(const Grid *grid, int x, int y) {
+    if (x < 0 || x >= GRID_W || y < 0 || y >= GRID_H) {
+        return 0;
+    }
+    return (grid->rows[y][x >> 6] >> (x & 63)) & 1;
+}
+
+int grid_count(const Grid *grid) {
+    int count = 0;
+    for (int y = 0; y < GRID_H; y++) {
+        for (int w = 0; w < GRID_ROW_WORDS; w++) {
+            count += __builtin_popcountll(grid->rows[y][w]);
+        }
+    }
+    return count;
+}
+
+// Mask of the playable cells in a row (x = 1..WIDTH)
+static void interior_row(Row out) {
+    memset(out, 0, sizeof(Row));
+    for (int x = 1; x <= WIDTH; x++) {
+        out[x >> 6] |= (uint64_t)1 << (x & 63);
+    }
+}
+
+// Grows `row` sideways inside `free` until it stops changing
+static void fill_row(Row row, const Row free) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int w = 0; w < GRID_ROW_WORDS; w++) {
+            uint64_t grown = row[w] | (row[w] << 1) | (row[w] >> 1);
+            if (w > 0) {
+                grown |= row[w - 1] >> 63;
+            }
+            if (w + 1 < GRID_ROW_WORDS) {
+                grown |= row[w + 1] << 63;
+            }
+            grown &= free[w];
+            if (grown != row[w]) {
+                row[w] = grown;
+                changed = 1;
+            }
+        }
+    }
+}
+
+// Pulls cells from the neighbouring row into row y; returns 1 if y grew
+static int spread_row(Row *reach, const Row *free, int y, int from) {
+    Row next;
+    int grew = 0;
+    for (int w = 0; w < GRID_ROW_WORDS; w++) {
+        next[w] = reach[y][w] | (reach[from][w] & free[y][w]);
+    }
+    fill_row(next, free[y]);
+    for (int w = 0; w < GRID_ROW_WORDS; w++) {
+        if (next[w] != reach[y][w]) {
+            reach[y][w] = next[w];
+            grew = 1;
+        }
+    }
+    return grew;
+}
+
+int grid_is_connected(const Grid *walls) {
+    Row interior;
+    Row free[GRID_H];
+    Row reach[GRID_H];
+    int total = 0;
+    int seeded = 0;
+
+    interior_row(interior);
+    memset(free, 0, sizeof(free));
+    memset(reach, 0, sizeof(reach));
+
+    for (int y = 1; y <= HEIGHT; y++) {
+        for (int w = 0; w < GRID_ROW_WORDS; w++) {
+            free[y][w] = interior[w] & ~walls->rows[y][w];
+            total += __builtin_popcountll(free[y][w]);
+            if (!seeded && free[y][w]) {
+                reach[y][w] = free[y][w] & -free[y][w];
+                fill_row(reach[y], free[y]);
+                seeded = 1;
+            }
+        }
+    }
+
+    if (total == 0) {
+        return 1;
+    }
+
+    // Alternate downward and upward sweeps until nothing new is reached
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int y = 2; y <= HEIGHT; y++) {
+            changed |= spread_row(reach, free, y, y - 1);
+        }
+        for (int y = HEIGHT - 1; y >= 1; y--) {
+            changed |= spread_row(reach, free, y, y + 1);
+        }
+    }
+
+    int reached = 0;
+    for (int y = 1; y <= HEIGHT; y++) {
+        for (int w = 0; w < GRID_ROW_WORDS; w++) {
+            reached += __builtin_popcountll(reach[y][w]);
+        }
+    }
+    return reached == total;
+}
@@ -0,0 +1,134 @@
+#include "heatmap.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+const char *const heatmap_layer_names[HEATMAP_LAYERS] = {
+    "visits", "food", "wall", "self", "obstacle"
+};
+
+void heatmap_clear(Heatmap *heatmap) {
+    memset(heatmap, 0, sizeof(*heatmap));
+}
+
+void heatmap_add(Heatmap *heatmap, int layer, int x, int y) {
+    if (x < 0 || x >= GRID_W || y < 0 || y >= GRID_H) {
+        return;
+    }
+    heatmap->cells[layer][y * GRID_W + x]++;
+}
+
+void heatmap_on_events(const GameEvent *events, int count, const GameState *game, void *context) {
+    Heatmap *heatmap = context;
+    (void)game;
+
+    for (int i = 0; i < count; i++) {
+        const GameEvent *event = &events[i];
+        switch (event->type) {
+            case EVENT_MOVED:
+                heatmap_add(heatmap, HEATMAP_VISITS, event->x, event->y);
+                break;
+            case EVENT_FOOD_EATEN:
+                heatmap_add(heatmap, HEATMAP_FOOD, event->x, event->y);
+                break;
+            case EVENT_DIED:
+                if (event->arg >= DEATH_WALL && event->arg <= DEATH_OBSTACLE) {
+                    heatmap_add(heatmap, HEATMAP_DEATH_WALL + event->arg - DEATH_WALL,
+                                event->x, event->y);
+                }
+                heatmap->games++;
+                break;
+            case EVENT_WON:
+                heatmap->games++;
+                break;
+        }
+    }
+}
+
+// Layers are padded to a multiple of the vector width, so the inner loop
+// has a fixed trip count and vectorizes at -O2 with no scalar tail
+void heatmap_merge(Heatmap *restrict dst, const Heatmap *restrict src) {
+    for (int layer = 0; layer < HEATMAP_LAYERS; layer++) {
+        for (int i = 0; i < HEATMAP_STRIDE; i++) {
+            dst->cells[layer][i] += src->cells[layer][i];
+        }
+    }
+    dst->games += src->games;
+}
+
+uint64_t heatmap_get(const Heatmap *heatmap, int layer, int x, int y) {
+    if (x < 0 || x >= GRID_W || y < 0 || y >= GRID_H) {
+        return 0;
+    }
+    return heatmap->cells[layer][y * GRID_W + x];
+}
+
+int heatmap_write_csv(const Heatmap *heatmap, FILE *out) {
+    int ok = fprintf(out, "x,y") > 0;
+
+    for (int layer = 0; layer < HEATMAP_LAYERS; layer++) {
+        ok &= fprintf(out, ",%s", heatmap_layer_names[layer]) > 0;
+    }
+    ok &= fputc('\n', out) != EOF;
+    for (int y = 0; y < GRID_H && ok; y++) {
+        for (int x = 0; x < GRID_W && ok; x++) {
+            ok &= fprintf(out, "%d,%d", x, y) > 0;
+            for (int layer = 0; layer < HEATMAP_LAYERS; layer++) {
+                ok &= fprintf(out, ",%llu",
+                              (unsigned long long)heatmap->cells[layer][y * GRID_W + x]) > 0;
+            }
+            ok &= fputc('\n', out) != EOF;
+        }
+    }
+    return ok ? 0 : -1;
+}
+
+int heatmap_write_pgm(const Heatmap *heatmap, int layer, FILE *out) {
+    const uint64_t *cells = heatmap->cells[layer];
+    unsigned char pixels[GRID_W * GRID_H];
+    uint64_t max = 0;
+
+    for (int i = 0; i < GRID_W * GRID_H; i++) {
+        if (cells[i] > max) {
+            max = cells[i];
+        }
+    }
+    double scale = max > 0 ? 255.0 / log1p((double)max) : 0.0;
+    for (int i = 0; i < GRID_W * GRID_H; i++) {
+        pixels[i] = (unsigned char)lround(log1p((double)cells[i]) * scale);
+    }
+
+    if (fprintf(out, "P5\n%d %d\n255\n", GRID_W, GRID_H) <= 0 ||
+        fwrite(pixels, sizeof(pixels), 1, out) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+static int export_file(const Heatmap *heatmap, const char *path, int layer) {
+    FILE *out = fopen(path, "wb");
+    int ok;
+
+    if (!out) {
+        return -1;
+    }
+    ok = (layer < 0 ? heatmap_write_csv(heatmap, out) : heatmap_write_pgm(heatmap, layer, out)) == 0;
+    ok &= fclose(out) == 0;
+    return ok ? 0 : -1;
+}
+
+int heatmap_export(const Heatmap *heatmap, const char *prefix) {
+    char path[4096];
+
+    snprintf(path, sizeof(path), "%s.csv", prefix);
+    if (export_file(heatmap, path, -1) < 0) {
+        return -1;
+    }
+    for (int layer = 0; layer < HEATMAP_LAYERS; layer++) {
+        snprintf(path, sizeof(path), "%s-%s.pgm", prefix, heatmap_layer_names[layer]);
+        if (export_file(heatmap, path, layer) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,270 @@
+#include "input.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// How long a lone ESC may wait for the rest of an arrow sequence
+#define ESCAPE_WAIT_MS 25
+
+int input_decode(const unsigned char *buf, int len, int *used) {
+    *used = 1;
+    switch (buf[0]) {
+        case 'w': case 'W': return INPUT_UP;
+        case 'd': case 'D': return INPUT_RIGHT;
+        case 's': case 'S': return INPUT_DOWN;
+        case 'a': case 'A': return INPUT_LEFT;
+        case 'q': case 'Q': return INPUT_QUIT;
+        case 'p': case 'P': case ' ': return INPUT_PAUSE;
+        case '[': return INPUT_REWIND;
+        case ']': return INPUT_FORWARD;
+        case '{': return INPUT_REWIND_FAR;
+        case '}': return INPUT_FORWARD_FAR;
+        case 0x1b:
+            break;
+        default:
+            return INPUT_OTHER;
+    }
+    
+    // Arrows: ESC [ A..D, or ESC O A..D in application cursor mode
+    if (len == 1 || (len == 2 && (buf[1] == '[' || buf[1] == 'O'))) {
+        *used = 0;
+        return INPUT_NONE;
+    }
+    if (buf[1] != '[' && buf[1] != 'O') {
+        return INPUT_OTHER;
+    }
+    *used = 3;
+    switch (buf[2]) {
+        case 'A': return INPUT_UP;
+        case 'C': return INPUT_RIGHT;
+        case 'B': return INPUT_DOWN;
+        case 'D': return INPUT_LEFT;
+        default:
+            *used = 2;
+            return INPUT_OTHER;
+    }
+}
+
+uint64_t input_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// ========== SPSC ring ==========
+
+void input_ring_init(InputRing *ring) {
+    memset(ring, 0, sizeof(*ring));
+}
+
+int input_ring_push(InputRing *ring, const InputCommand *command) {
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    
+    if (head - tail == INPUT_RING_SIZE) {
+        return -1;
+    }
+    ring->slots[head & (INPUT_RING_SIZE - 1)] = *command;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int input_ring_peek(InputRing *ring, InputCommand *command) {
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    
+    if (head == tail) {
+        return 0;
+    }
+    *command = ring->slots[tail & (INPUT_RING_SIZE - 1)];
+    return 1;
+}
+
+int input_ring_pop(InputRing *ring, InputCommand *command) {
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    
+    if (head == tail) {
+        return 0;
+    }
+    *command = ring->slots[tail & (INPUT_RING_SIZE - 1)];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// ========== Reader thread ==========
+
+static void push_key(InputThread *input, int key, uint64_t time_ns) {
+    InputCommand command = { key, time_ns };
+    if (input_ring_push(&input->ring, &command) < 0) {
+        __atomic_add_fetch(&input->dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Wakes a consumer blocked in input_wait(); a full pipe already means "wake up"
+static void notify(InputThread *input) {
+    char wake = 0;
+    while (write(input->wake_pipe[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+}
+
+static void *input_thread_main(void *arg) {
+    InputThread *input = arg;
+    unsigned char buf[64];
+    int len = 0;
+    uint64_t arrived = 0;
+    
+    for (;;) {
+        struct pollfd fds[2] = {
+            { input->fd, POLLIN, 0 },
+            { input->stop_pipe[0], POLLIN, 0 },
+        };
+        
+        // A pending ESC only waits briefly for the rest of its sequence
+        int ready = poll(fds, 2, len > 0 ? ESCAPE_WAIT_MS : -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+        
+        if (ready == 0) {
+            push_key(input, INPUT_OTHER, arrived);
+            notify(input);
+            len = 0;
+            continue;
+        }
+        
+        ssize_t n = read(input->fd, buf + len, sizeof(buf) - (size_t)len);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        arrived = input_now_ns();
+        len += (int)n;
+        
+        int pos = 0;
+        while (pos < len) {
+            int used;
+            int key = input_decode(buf + pos, len - pos, &used);
+            if (used == 0) {
+                break;
+            }
+            push_key(input, key, arrived);
+            pos += used;
+        }
+        if (pos > 0) {
+            notify(input);
+        }
+        len -= pos;
+        memmove(buf, buf + pos, (size_t)len);
+    }
+    return NULL;
+}
+
+int input_thread_start(InputThread *input, int fd) {
+    sigset_t all, old;
+    
+    input_ring_init(&input->ring);
+    input->fd = fd;
+    input->dropped = 0;
+    
+    if (pipe(input->stop_pipe) < 0) {
+        return -1;
+    }
+    if (pipe(input->wake_pipe) < 0) {
+        close(input->stop_pipe[0]);
+        close(input->stop_pipe[1]);
+        return -1;
+    }
+    fcntl(input->wake_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(input->wake_pipe[1], F_SETFL, O_NONBLOCK);
+    // Signals such as SIGHUP are for the game thread, not the blocked reader
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    int result = pthread_create(&input->thread, NULL, input_thread_main, input);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (result != 0) {
+        close(input->stop_pipe[0]);
+        close(input->stop_pipe[1]);
+        close(input->wake_pipe[0]);
+        close(input->wake_pipe[1]);
+        return -1;
+    }
+    return 0;
+}
+
+void input_thread_stop(InputThread *input) {
+    char wake = 0;
+    
+    while (write(input->stop_pipe[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+    pthread_join(input->thread, NULL);
+    close(input->stop_pipe[0]);
+    close(input->stop_pipe[1]);
+    close(input->wake_pipe[0]);
+    close(input->wake_pipe[1]);
+}
+
+int input_wait(InputThread *input, int64_t timeout_ns) {
+    struct pollfd pfd = { input->wake_pipe[0], POLLIN, 0 };
+    char drain[64];
+    
+    // Rounded up so a tick deadline is never woken for just before it is due
+    int timeout_ms = timeout_ns < 0 ? -1 : (int)((timeout_ns + 999999) / 1000000);
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return 0;
+    }
+    while (read(input->wake_pipe[0], drain, sizeof(drain)) > 0) {
+    }
+    return 1;
+}
+
+// ========== Latency ==========
+
+void input_latency_add(InputLatency *latency, uint64_t delay_ns) {
+    uint64_t us = delay_ns / 1000;
+    int bucket = 0;
+    
+    while (us > 0 && bucket < INPUT_LATENCY_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    latency->buckets[bucket]++;
+    latency->count++;
+    latency->total_ns += delay_ns;
+    if (delay_ns > latency->max_ns) {
+        latency->max_ns = delay_ns;
+    }
+}
+
+double input_latency_percentile(const InputLatency *latency, double p) {
+    unsigned long target = (unsigned long)(p * latency->count);
+    unsigned long seen = 0;
+    
+    if (latency->count == 0) {
+        return 0.0;
+    }
+    if (target >= latency->count) {
+        target = latency->count - 1;
+    }
+    double max_us = (double)latency->max_ns / 1000.0;
+    for (int i = 0; i < INPUT_LATENCY_BUCKETS; i++) {
+        seen += latency->buckets[i];
+        if (seen > target) {
+            double bound = (double)(1ull << i);
+            return bound < max_us ? bound : max_us;
+        }
+    }
+    return max_us;
+}
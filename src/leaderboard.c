@@ -0,0 +1,439 @@
+#include "leaderboard.h"
+#include "checksum.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#define LOG_MAGIC 0x31524353u       // "SCR1"
+#define SNAPSHOT_MAGIC "SNKSNAP1"
+#define REPLAY_BATCH 4096
+
+typedef struct {
+    uint32_t magic;
+    uint32_t crc;
+    ScoreEntry entry;
+} LogRecord;
+
+typedef struct {
+    char magic[8];
+    uint64_t log_size;
+    uint64_t total_games;
+    uint32_t level_count;
+    uint32_t crc;                // CRC of the header (with crc = 0) and the body
+} SnapshotHeader;
+
+_Static_assert(sizeof(ScoreEntry) == 32, "score entries are stored on disk");
+_Static_assert(sizeof(LogRecord) == 40, "log records are stored on disk");
+
+// ========== Top-K heap ==========
+
+// Lower score ranks lower; on equal score the older result is kept
+static int entry_less(const ScoreEntry *a, const ScoreEntry *b) {
+    if (a->score != b->score) {
+        return a->score < b->score;
+    }
+    return a->timestamp > b->timestamp;
+}
+
+static void heap_sift_down(TopScores *top, int i) {
+    for (;;) {
+        int smallest = i;
+        int l = 2 * i + 1;
+        int r = 2 * i + 2;
+
+        if (l < top->count && entry_less(&top->entries[l], &top->entries[smallest])) {
+            smallest = l;
+        }
+        if (r < top->count && entry_less(&top->entries[r], &top->entries[smallest])) {
+            smallest = r;
+        }
+        if (smallest == i) {
+            return;
+        }
+        ScoreEntry tmp = top->entries[i];
+        top->entries[i] = top->entries[smallest];
+        top->entries[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static void top_insert(TopScores *top, const ScoreEntry *entry) {
+    if (top->count < LEADERBOARD_TOP_K) {
+        int i = top->count++;
+        top->entries[i] = *entry;
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!entry_less(&top->entries[i], &top->entries[parent])) {
+                break;
+            }
+            ScoreEntry tmp = top->entries[i];
+            top->entries[i] = top->entries[parent];
+            top->entries[parent] = tmp;
+            i = parent;
+        }
+    } else if (entry_less(&top->entries[0], entry)) {
+        top->entries[0] = *entry;
+        heap_sift_down(top, 0);
+    }
+}
+
+static const LevelScores *find_level(const Leaderboard *board, uint16_t level) {
+    for (int i = 0; i < board->level_count; i++) {
+        if (board->levels[i].level == level) {
+            return &board->levels[i];
+        }
+    }
+    return NULL;
+}
+
+static LevelScores *get_level(Leaderboard *board, uint16_t level) {
+    const LevelScores *found = find_level(board, level);
+    if (found) {
+        return &board->levels[found - board->levels];
+    }
+    if (board->level_count == board->level_capacity) {
+        int capacity = board->level_capacity ? board->level_capacity * 2 : 16;
+        LevelScores *levels = realloc(board->levels, sizeof(LevelScores) * capacity);
+        if (!levels) {
+            return NULL;
+        }
+        board->levels = levels;
+        board->level_capacity = capacity;
+    }
+    LevelScores *scores = &board->levels[board->level_count++];
+    memset(scores, 0, sizeof(*scores));
+    scores->level = level;
+    return scores;
+}
+
+static void index_entry(Leaderboard *board, const ScoreEntry *entry) {
+    LevelScores *scores = get_level(board, entry->level);
+
+    top_insert(&board->overall, entry);
+    if (scores) {
+        top_insert(&scores->top, entry);
+    }
+    board->total_games++;
+}
+
+static void reset_index(Leaderboard *board) {
+    memset(&board->overall, 0, sizeof(board->overall));
+    board->level_count = 0;
+    board->total_games = 0;
+    board->log_size = 0;
+    board->since_snapshot = 0;
+}
+
+// ========== Log replay ==========
+
+static uint32_t record_crc(const LogRecord *record) {
+    return crc32_update(0, &record->entry, sizeof(record->entry));
+}
+
+// Indexes every valid record from board->log_size to the end of the log.
+// A torn or corrupt record ends the log: everything after it is cut off.
+// Callers hold the log lock, so no other session can be appending behind
+// the torn record while it is cut.
+static int replay_log(Leaderboard *board) {
+    size_t batch_size = sizeof(LogRecord) * REPLAY_BATCH;
+    LogRecord *batch = malloc(batch_size);
+    int status = 0;
+
+    if (!batch) {
+        return -1;
+    }
+
+    for (;;) {
+        ssize_t got = pread(board->log_fd, batch, batch_size, (off_t)board->log_size);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            status = -1;
+            break;
+        }
+
+        int records = (int)(got / (ssize_t)sizeof(LogRecord));
+        int torn = got % (ssize_t)sizeof(LogRecord) != 0;
+        for (int i = 0; i < records; i++) {
+            if (batch[i].magic != LOG_MAGIC || batch[i].crc != record_crc(&batch[i])) {
+                torn = 1;
+                break;
+            }
+            index_entry(board, &batch[i].entry);
+            board->log_size += sizeof(LogRecord);
+            board->since_snapshot++;
+        }
+
+        if (torn) {
+            status = ftruncate(board->log_fd, (off_t)board->log_size);
+            break;
+        }
+        if (got < (ssize_t)batch_size) {
+            break;
+        }
+    }
+    free(batch);
+    return status;
+}
+
+// Serializes append, replay and truncation between sessions sharing the log
+static int lock_log(const Leaderboard *board) {
+    while (flock(board->log_fd, LOCK_EX) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void unlock_log(const Leaderboard *board) {
+    flock(board->log_fd, LOCK_UN);
+}
+
+static int locked_replay(Leaderboard *board) {
+    int status;
+
+    if (lock_log(board) < 0) {
+        return -1;
+    }
+    status = replay_log(board);
+    unlock_log(board);
+    return status;
+}
+
+// ========== Snapshot ==========
+
+static uint32_t snapshot_crc(const SnapshotHeader *header, const void *body, size_t body_size) {
+    SnapshotHeader covered = *header;
+    covered.crc = 0;
+    return crc32_update(crc32_update(0, &covered, sizeof(covered)), body, body_size);
+}
+
+static int load_snapshot(Leaderboard *board) {
+    SnapshotHeader header;
+    FILE *in = fopen(board->snapshot_path, "rb");
+    int ok = 0;
+
+    if (!in) {
+        return -1;
+    }
+
+    if (fread(&header, sizeof(header), 1, in) == 1 &&
+        memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 &&
+        header.level_count <= 65536) {
+        size_t body_size = sizeof(TopScores) + sizeof(LevelScores) * header.level_count;
+        char *body = malloc(body_size);
+
+        if (body && fread(body, body_size, 1, in) == 1 &&
+            snapshot_crc(&header, body, body_size) == header.crc) {
+            memcpy(&board->overall, body, sizeof(TopScores));
+            board->level_count = 0;
+            for (uint32_t i = 0; i < header.level_count; i++) {
+                const LevelScores *saved =
+                    (const LevelScores *)(body + sizeof(TopScores)) + i;
+                LevelScores *scores = get_level(board, saved->level);
+                if (scores) {
+                    *scores = *saved;
+                }
+            }
+            board->total_games = header.total_games;
+            board->log_size = header.log_size;
+            ok = 1;
+        }
+        free(body);
+    }
+    fclose(in);
+    return ok ? 0 : -1;
+}
+
+int leaderboard_compact(Leaderboard *board) {
+    char tmp_path[LEADERBOARD_PATH_LEN + 8];
+    SnapshotHeader header;
+    size_t body_size = sizeof(TopScores) + sizeof(LevelScores) * board->level_count;
+    char *body = malloc(body_size);
+    int fd;
+    int ok = 1;
+
+    if (!body) {
+        return -1;
+    }
+    memcpy(body, &board->overall, sizeof(TopScores));
+    if (board->level_count > 0) {
+        memcpy(body + sizeof(TopScores), board->levels,
+               sizeof(LevelScores) * board->level_count);
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.log_size = board->log_size;
+    header.total_games = board->total_games;
+    header.level_count = (uint32_t)board->level_count;
+    header.crc = snapshot_crc(&header, body, body_size);
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", board->snapshot_path);
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        free(body);
+        return -1;
+    }
+    ok &= write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header);
+    ok &= write(fd, body, body_size) == (ssize_t)body_size;
+    ok &= fsync(fd) == 0;
+    ok &= close(fd) == 0;
+    free(body);
+
+    if (!ok || rename(tmp_path, board->snapshot_path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    board->since_snapshot = 0;
+    return 0;
+}
+
+// ========== Public API ==========
+
+int leaderboard_open(Leaderboard *board, const char *dir) {
+    struct stat st;
+
+    memset(board, 0, sizeof(*board));
+    board->log_fd = -1;
+
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        return -1;
+    }
+    snprintf(board->log_path, sizeof(board->log_path), "%s/scores.log", dir);
+    snprintf(board->snapshot_path, sizeof(board->snapshot_path), "%s/scores.snap", dir);
+
+    board->log_fd = open(board->log_path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (board->log_fd < 0) {
+        return -1;
+    }
+
+    // A snapshot that claims more log than exists belongs to another log
+    if (load_snapshot(board) < 0 ||
+        fstat(board->log_fd, &st) < 0 || (uint64_t)st.st_size < board->log_size) {
+        reset_index(board);
+    }
+
+    if (locked_replay(board) < 0) {
+        leaderboard_close(board);
+        return -1;
+    }
+    if (board->since_snapshot >= LEADERBOARD_SNAPSHOT_EVERY) {
+        leaderboard_compact(board);
+    }
+    return 0;
+}
+
+void leaderboard_close(Leaderboard *board) {
+    if (board->log_fd >= 0) {
+        close(board->log_fd);
+    }
+    free(board->levels);
+    board->levels = NULL;
+    board->level_count = 0;
+    board->level_capacity = 0;
+    board->log_fd = -1;
+}
+
+int leaderboard_record(Leaderboard *board, const ScoreEntry *entry) {
+    LogRecord record;
+    const char *p = (const char *)&record;
+    size_t left = sizeof(record);
+
+    int status = 0;
+
+    record.magic = LOG_MAGIC;
+    record.entry = *entry;
+    record.crc = record_crc(&record);
+
+    // Catching up first cuts any torn tail left by a crashed session, so
+    // our record never lands behind garbage
+    if (lock_log(board) < 0) {
+        return -1;
+    }
+    if (replay_log(board) < 0) {
+        unlock_log(board);
+        return -1;
+    }
+    while (left > 0) {
+        ssize_t n = write(board->log_fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            status = -1;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    if (status == 0 && fdatasync(board->log_fd) < 0) {
+        status = -1;
+    }
+
+    // Indexes our record, or cuts it off again if the write was short
+    if (replay_log(board) < 0) {
+        status = -1;
+    }
+    unlock_log(board);
+    if (status < 0) {
+        return -1;
+    }
+    if (board->since_snapshot >= LEADERBOARD_SNAPSHOT_EVERY) {
+        leaderboard_compact(board);
+    }
+    return 0;
+}
+
+static int compare_desc(const void *a, const void *b) {
+    const ScoreEntry *x = a;
+    const ScoreEntry *y = b;
+    if (entry_less(x, y)) {
+        return 1;
+    }
+    if (entry_less(y, x)) {
+        return -1;
+    }
+    return 0;
+}
+
+int leaderboard_top(const Leaderboard *board, int level, ScoreEntry *out, int max) {
+    const TopScores *top = &board->overall;
+
+    if (level >= 0) {
+        const LevelScores *scores = find_level(board, (uint16_t)level);
+        if (!scores) {
+            return 0;
+        }
+        top = &scores->top;
+    }
+
+    ScoreEntry sorted[LEADERBOARD_TOP_K];
+    memcpy(sorted, top->entries, sizeof(ScoreEntry) * top->count);
+    qsort(sorted, top->count, sizeof(ScoreEntry), compare_desc);
+
+    int n = top->count < max ? top->count : max;
+    memcpy(out, sorted, sizeof(ScoreEntry) * n);
+    return n;
+}
+
+void score_entry_from_game(ScoreEntry *entry, const GameState *game, int level) {
+    memset(entry, 0, sizeof(*entry));
+    entry->timestamp = (int64_t)time(NULL);
+    entry->score = game->score;
+    entry->length = (int16_t)game->snake.length;
+    entry->apples_eaten = (int16_t)game->apples_eaten;
+    for (int i = 0; i < 4; i++) {
+        entry->special_apples_eaten[i] = (int16_t)game->special_apples_eaten[i];
+    }
+    entry->level = (uint16_t)level;
+    entry->state = (uint8_t)game->state;
+}
@@ -0,0 +1,282 @@
+#include "level.h"
+#include <string.h>
+
+static const char *kind_names[LEVEL_KIND_COUNT] = {
+    "empty", "maze", "rooms", "pillars"
+};
+
+// Small local generator so levels do not depend on the game RNG state
+static unsigned int level_rand(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int level_range(unsigned int *state, int lo, int hi) {
+    return lo + (int)(level_rand(state) % (unsigned int)(hi - lo + 1));
+}
+
+static void dir_step(int direction, int *dx, int *dy) {
+    *dx = 0;
+    *dy = 0;
+    switch (direction) {
+        case DIR_UP:    *dy = -1; break;
+        case DIR_RIGHT: *dx = 1;  break;
+        case DIR_DOWN:  *dy = 1;  break;
+        case DIR_LEFT:  *dx = -1; break;
+    }
+}
+
+static void set_wall(Level *level, int x, int y) {
+    if (x >= 1 && x <= WIDTH && y >= 1 && y <= HEIGHT) {
+        grid_set(&level->walls, x, y);
+    }
+}
+
+static void build_maze(Level *level, unsigned int *rng) {
+    int segments = level_range(rng, 14, 22);
+
+    for (int i = 0; i < segments; i++) {
+        // Walls start on even cells so corridors stay at least one cell wide
+        int x = level_range(rng, 1, WIDTH / 2) * 2;
+        int y = level_range(rng, 1, HEIGHT / 2) * 2;
+        int len = level_range(rng, 3, 9);
+        int horizontal = level_rand(rng) & 1;
+
+        for (int j = 0; j < len; j++) {
+            set_wall(level, horizontal ? x + j : x, horizontal ? y : y + j);
+        }
+    }
+}
+
+static void build_rooms(Level *level, unsigned int *rng) {
+    int split_x[2] = { WIDTH / 3, 2 * WIDTH / 3 };
+    int split_y = HEIGHT / 3;
+
+    for (int i = 0; i < 2; i++) {
+        for (int y = 1; y <= HEIGHT; y++) {
+            set_wall(level, split_x[i], y);
+        }
+    }
+    for (int x = 1; x <= WIDTH; x++) {
+        set_wall(level, x, split_y);
+    }
+
+    // Each vertical wall piece gets up to one door, each horizontal one
+    // up to two; rooms left without a door are rejected by the caller
+    for (int i = 0; i < 2; i++) {
+        if (level_range(rng, 0, 5) > 0) {
+            int y = level_range(rng, 1, split_y - 2);
+            grid_reset(&level->walls, split_x[i], y);
+            grid_reset(&level->walls, split_x[i], y + 1);
+        }
+        if (level_range(rng, 0, 5) > 0) {
+            int y = level_range(rng, split_y + 1, HEIGHT - 1);
+            grid_reset(&level->walls, split_x[i], y);
+            grid_reset(&level->walls, split_x[i], y + 1);
+        }
+    }
+    int doors = level_range(rng, 2, 4);
+    for (int i = 0; i < doors; i++) {
+        int x = level_range(rng, 1, WIDTH - 1);
+        grid_reset(&level->walls, x, split_y);
+        grid_reset(&level->walls, x + 1, split_y);
+    }
+}
+
+static void build_pillars(Level *level, unsigned int *rng) {
+    int pillars = level_range(rng, 10, 24);
+
+    for (int i = 0; i < pillars; i++) {
+        int x = level_range(rng, 2, WIDTH - 2);
+        int y = level_range(rng, 2, HEIGHT - 2);
+        int w = level_range(rng, 1, 2);
+        int h = level_range(rng, 1, 3);
+
+        for (int dy = 0; dy < h; dy++) {
+            for (int dx = 0; dx < w; dx++) {
+                set_wall(level, x + dx, y + dy);
+            }
+        }
+    }
+}
+
+// Keeps the starting snake and a few cells in front of it free
+static void clear_spawn(Level *level) {
+    int dx, dy;
+    dir_step(level->direction, &dx, &dy);
+
+    for (int i = -2; i <= 4; i++) {
+        grid_reset(&level->walls, level->spawn.x + dx * i, level->spawn.y + dy * i);
+    }
+}
+
+int level_generate(Level *level, int kind, unsigned int seed) {
+    unsigned int rng = seed * 2654435761u ^ 0x9E3779B9u;
+    if (rng == 0) {
+        rng = 1;
+    }
+
+    for (int attempt = 1; attempt <= LEVEL_MAX_CANDIDATES; attempt++) {
+        grid_clear(&level->walls);
+        level->spawn.x = WIDTH / 2;
+        level->spawn.y = HEIGHT / 2;
+        level->direction = DIR_RIGHT;
+        level->kind = kind;
+        level->seed = seed;
+        snprintf(level->name, sizeof(level->name), "%s-%u", level_kind_name(kind), seed);
+
+        switch (kind) {
+            case LEVEL_MAZE:
+                build_maze(level, &rng);
+                break;
+            case LEVEL_ROOMS:
+                build_rooms(level, &rng);
+                break;
+            case LEVEL_PILLARS:
+                build_pillars(level, &rng);
+                break;
+            default:
+                break;
+        }
+        clear_spawn(level);
+
+        if (grid_is_connected(&level->walls)) {
+            return attempt;
+        }
+    }
+    return -1;
+}
+
+int level_is_valid(const Level *level) {
+    int dx, dy;
+
+    if (level->direction < DIR_UP || level->direction > DIR_LEFT) {
+        return 0;
+    }
+    dir_step(level->direction, &dx, &dy);
+
+    // The initial body trails behind the head
+    for (int i = 0; i < 3; i++) {
+        int x = level->spawn.x - dx * i;
+        int y = level->spawn.y - dy * i;
+        if (x < 1 || x > WIDTH || y < 1 || y > HEIGHT ||
+            grid_test(&level->walls, x, y)) {
+            return 0;
+        }
+    }
+    return grid_is_connected(&level->walls);
+}
+
+void level_spawn_snake(GameState *game, int x, int y, int direction) {
+    int dx, dy;
+
+    game->snake.direction = direction;
+    dir_step(direction, &dx, &dy);
+    for (int i = 0; i < game->snake.length; i++) {
+        game->snake.body[i].x = x - dx * i;
+        game->snake.body[i].y = y - dy * i;
+    }
+    snake_rehash(&game->snake);
+}
+
+void level_apply(const Level *level, GameState *game) {
+    init_game_state(game);
+    game->obstacles.grid = level->walls;
+    level_spawn_snake(game, level->spawn.x, level->spawn.y, level->direction);
+}
+
+void level_write_ascii(const Level *level, FILE *out) {
+    static const char heads[4] = { '^', '>', 'v', '<' };
+
+    fprintf(out, "name: %s\n", level->name);
+    for (int y = 1; y <= HEIGHT; y++) {
+        for (int x = 1; x <= WIDTH; x++) {
+            char c = '.';
+            if (x == level->spawn.x && y == level->spawn.y) {
+                c = heads[level->direction & 3];
+            } else if (grid_test(&level->walls, x, y)) {
+                c = '#';
+            }
+            fputc(c, out);
+        }
+        fputc('\n', out);
+    }
+    fputc('\n', out);
+}
+
+int level_read_ascii(Level *level, FILE *in) {
+    static const char heads[] = "^>v<";
+    char line[256];
+    int y = 0;
+    int have_spawn = 0;
+
+    grid_clear(&level->walls);
+    level->spawn.x = WIDTH / 2;
+    level->spawn.y = HEIGHT / 2;
+    level->direction = DIR_RIGHT;
+    level->kind = -1;
+    level->seed = 0;
+    level->name[0] = '\0';
+
+    while (y < HEIGHT && fgets(line, sizeof(line), in)) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (y == 0 && line[0] == '\0') {
+            continue;
+        }
+        if (y == 0 && strncmp(line, "name:", 5) == 0) {
+            const char *name = line + 5;
+            while (*name == ' ') {
+                name++;
+            }
+            snprintf(level->name, sizeof(level->name), "%.*s", LEVEL_NAME_LEN - 1, name);
+            continue;
+        }
+        if ((int)strlen(line) != WIDTH) {
+            return -1;
+        }
+
+        for (int x = 0; x < WIDTH; x++) {
+            const char *head = strchr(heads, line[x]);
+            if (line[x] == '#') {
+                grid_set(&level->walls, x + 1, y + 1);
+            } else if (head && line[x] != '\0') {
+                if (have_spawn) {
+                    return -1;
+                }
+                level->spawn.x = x + 1;
+                level->spawn.y = y + 1;
+                level->direction = (int)(head - heads);
+                have_spawn = 1;
+            } else if (line[x] != '.') {
+                return -1;
+            }
+        }
+        y++;
+    }
+
+    if (y == 0) {
+        return 0;
+    }
+    return y == HEIGHT ? 1 : -1;
+}
+
+const char *level_kind_name(int kind) {
+    if (kind < 0 || kind >= LEVEL_KIND_COUNT) {
+        return "custom";
+    }
+    return kind_names[kind];
+}
+
+int level_kind_from_name(const char *name) {
+    for (int i = 0; i < LEVEL_KIND_COUNT; i++) {
+        if (strcmp(name, kind_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
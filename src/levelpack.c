@@ -0,0 +1,133 @@
+#include "levelpack.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+_Static_assert(sizeof(LevelPackHeader) == 64, "level pack header must stay 64 bytes");
+_Static_assert(sizeof(LevelRecord) % 8 == 0, "level records must keep the grid aligned");
+
+int levelpack_open(LevelPack *pack, const char *path) {
+    struct stat st;
+    int fd;
+
+    memset(pack, 0, sizeof(*pack));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(LevelPackHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    const LevelPackHeader *header = base;
+    if (memcmp(header->magic, LEVELPACK_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != LEVELPACK_VERSION ||
+        header->width != WIDTH || header->height != HEIGHT ||
+        header->record_size != sizeof(LevelRecord) ||
+        header->row_words != GRID_ROW_WORDS ||
+        sizeof(LevelPackHeader) + (size_t)header->level_count * sizeof(LevelRecord) >
+            (size_t)st.st_size) {
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    pack->base = base;
+    pack->size = st.st_size;
+    pack->levels = (const LevelRecord *)((const char *)base + sizeof(LevelPackHeader));
+    pack->count = (int)header->level_count;
+    return 0;
+}
+
+void levelpack_close(LevelPack *pack) {
+    if (pack->base) {
+        munmap(pack->base, pack->size);
+    }
+    memset(pack, 0, sizeof(*pack));
+}
+
+void levelpack_to_level(const LevelRecord *record, Level *level) {
+    level->walls = record->walls;
+    level->spawn.x = record->spawn_x;
+    level->spawn.y = record->spawn_y;
+    level->direction = record->direction;
+    level->kind = record->kind;
+    level->seed = record->seed;
+    snprintf(level->name, sizeof(level->name), "%.*s", (int)sizeof(record->name), record->name);
+}
+
+// Records come straight from a file, so each one is checked with the same
+// rules as a generated level before anything is built from it
+const LevelRecord *levelpack_get(const LevelPack *pack, int index) {
+    Level level;
+
+    if (index < 0 || index >= pack->count) {
+        return NULL;
+    }
+    levelpack_to_level(&pack->levels[index], &level);
+    if (!level_is_valid(&level)) {
+        return NULL;
+    }
+    return &pack->levels[index];
+}
+
+void levelpack_apply(const LevelRecord *record, GameState *game) {
+    init_game_state(game);
+    memcpy(&game->obstacles.grid, &record->walls, sizeof(Grid));
+    level_spawn_snake(game, record->spawn_x, record->spawn_y, record->direction);
+}
+
+int levelpack_write(const char *path, const Level *levels, int count) {
+    char tmp_path[4096];
+    LevelPackHeader header;
+    FILE *out;
+    int ok = 1;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    out = fopen(tmp_path, "wb");
+    if (!out) {
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LEVELPACK_MAGIC, sizeof(header.magic));
+    header.version = LEVELPACK_VERSION;
+    header.width = WIDTH;
+    header.height = HEIGHT;
+    header.level_count = (uint32_t)count;
+    header.record_size = sizeof(LevelRecord);
+    header.row_words = GRID_ROW_WORDS;
+    ok &= fwrite(&header, sizeof(header), 1, out) == 1;
+
+    for (int i = 0; i < count && ok; i++) {
+        LevelRecord record;
+
+        memset(&record, 0, sizeof(record));
+        record.walls = levels[i].walls;
+        record.spawn_x = (int16_t)levels[i].spawn.x;
+        record.spawn_y = (int16_t)levels[i].spawn.y;
+        record.direction = (uint8_t)levels[i].direction;
+        record.kind = (int8_t)levels[i].kind;
+        record.wall_count = (uint16_t)grid_count(&levels[i].walls);
+        record.seed = levels[i].seed;
+        memcpy(record.name, levels[i].name, sizeof(record.name));
+        ok &= fwrite(&record, sizeof(record), 1, out) == 1;
+    }
+
+    ok &= fclose(out) == 0;
+    if (!ok || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "live.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static int live_map(LiveExport *live, const char *name, int writer) {
+    struct stat st;
+    int fd = shm_open(name, writer ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    void *base;
+
+    if (fd < 0) {
+        return -1;
+    }
+    if (writer && ftruncate(fd, sizeof(LiveShared)) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(LiveShared)) {
+        close(fd);
+        return -1;
+    }
+    // Writers fault every page in now so that publishing never has to
+    base = mmap(NULL, sizeof(LiveShared), writer ? PROT_READ | PROT_WRITE : PROT_READ,
+                writer ? MAP_SHARED | MAP_POPULATE : MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    live->shared = base;
+    live->writer = writer;
+    snprintf(live->name, sizeof(live->name), "%s", name);
+    return 0;
+}
+
+int live_create(LiveExport *live, const char *name) {
+    LiveShared *shared;
+
+    if (live_map(live, name, 1) < 0) {
+        return -1;
+    }
+    shared = live->shared;
+
+    // A leftover segment from a crashed game is taken over; the magic goes
+    // in last so readers never accept a half-written header
+    __atomic_store_n(&shared->magic, 0, __ATOMIC_RELAXED);
+    memset(&shared->data, 0, sizeof(shared->data));
+    shared->data.pid = (int32_t)getpid();
+    shared->version = LIVE_VERSION;
+    shared->size = sizeof(LiveShared);
+    __atomic_store_n(&shared->seq, __atomic_load_n(&shared->seq, __ATOMIC_RELAXED) & ~1u,
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&shared->magic, LIVE_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int live_attach(LiveExport *live, const char *name) {
+    const LiveShared *shared;
+
+    if (live_map(live, name, 0) < 0) {
+        return -1;
+    }
+    shared = live->shared;
+    if (__atomic_load_n(&shared->magic, __ATOMIC_ACQUIRE) != LIVE_MAGIC ||
+        shared->version != LIVE_VERSION || shared->size != sizeof(LiveShared)) {
+        munmap(live->shared, sizeof(LiveShared));
+        live->shared = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void live_close(LiveExport *live) {
+    if (!live->shared) {
+        return;
+    }
+    munmap(live->shared, sizeof(LiveShared));
+    live->shared = NULL;
+    if (live->writer) {
+        shm_unlink(live->name);
+    }
+}
+
+void live_publish(LiveExport *live, const GameState *game, uint64_t tick, uint64_t now_ns) {
+    LiveShared *shared = live->shared;
+    LiveSnapshot *data = &shared->data;
+    uint32_t seq = __atomic_load_n(&shared->seq, __ATOMIC_RELAXED);
+    int boost = is_speed_boost_active(&game->speed_boost);
+
+    // Odd while the copy is in progress; the fence keeps the data stores
+    // from moving ahead of it
+    __atomic_store_n(&shared->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    data->game = *game;
+    data->game.events = NULL;
+    data->game.foods = NULL;
+    if (tick != data->tick) {
+        // Seeking through the history is not a tick interval
+        data->interval_ns = tick == data->tick + 1 && data->tick_ns ? now_ns - data->tick_ns : 0;
+        data->tick_ns = now_ns;
+        data->tick = tick;
+    }
+    data->publishes++;
+    data->boost = boost;
+
+    __atomic_store_n(&shared->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+int live_read(const LiveExport *live, LiveSnapshot *out, int *retries) {
+    const LiveShared *shared = live->shared;
+
+    for (int attempt = 0; attempt < LIVE_READ_RETRIES; attempt++) {
+        uint32_t before = __atomic_load_n(&shared->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(out, &shared->data, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shared->seq, __ATOMIC_RELAXED) == before) {
+            if (retries) {
+                *retries = attempt;
+            }
+            return 0;
+        }
+    }
+    if (retries) {
+        *retries = LIVE_READ_RETRIES;
+    }
+    return -1;
+}
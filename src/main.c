@@ -1,8 +1,24 @@
 #include "snake.h"
-#include <ncurses.h>
+#include "levelpack.h"
+#include "leaderboard.h"
+#include "render.h"
+#include "input.h"
+#include "rewind.h"
+#include "live.h"
+#include "autosave.h"
+#include "netplay.h"
+#include "metrics.h"
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <string.h>
+#include <time.h>
 
 // Fixed: Normalize movement speed to account for terminal character aspect ratio
 // Terminal characters are typically 2:1 (height:width), so horizontal movement
@@ -10,419 +26,769 @@
 #define MOVE_DELAY_HORIZONTAL 100000  // 150ms for left/right
 #define MOVE_DELAY_VERTICAL 170000    // 100ms for up/down
 
-// Color pairs
-#define COLOR_SNAKE 1
-#define COLOR_FOOD_REGULAR 2
-#define COLOR_BORDER 3
-#define COLOR_INFO 4
-#define COLOR_FOOD_GREEN 5
-#define COLOR_FOOD_GOLD 6
-#define COLOR_FOOD_BLUE 7
-#define COLOR_OBSTACLE 8
-#define COLOR_TITLE 9
+// Ticks skipped by { and }
+#define REWIND_JUMP 50
 
-void draw_border(void) {
-    attron(COLOR_PAIR(COLOR_BORDER) | A_BOLD);
-    
-    // Double line border for better look
-    for (int x = 0; x <= WIDTH + 1; x++) {
-        mvaddch(0, x, '=');
-        mvaddch(HEIGHT + 1, x, '=');
+// Set by SIGHUP/SIGTERM: save the game and leave
+static volatile sig_atomic_t hangup = 0;
+
+static void on_hangup(int sig) {
+    (void)sig;
+    hangup = 1;
+}
+
+// Counters for the metrics listener (NULL - not listening)
+static Metrics *meter = NULL;
+
+static void note_latency(InputLatency *latency, uint64_t delay_ns) {
+    input_latency_add(latency, delay_ns);
+    if (meter) {
+        metrics_observe(&meter->input_ns, delay_ns);
     }
-    
-    for (int y = 1; y <= HEIGHT; y++) {
-        mvaddch(y, 0, '|');
-        mvaddch(y, WIDTH + 1, '|');
+}
+
+/**
+ * Leaderboard directory: $SNAKE_HOME, or ~/.snake.
+ */
+static void scores_dir(char *out, size_t size) {
+    const char *dir = getenv("SNAKE_HOME");
+    const char *home = getenv("HOME");
+    
+    if (dir && *dir) {
+        snprintf(out, size, "%s", dir);
+    } else {
+        snprintf(out, size, "%s/.snake", home ? home : ".");
     }
-    
-    // Corners
-    mvaddch(0, 0, '+');
-    mvaddch(0, WIDTH + 1, '+');
-    mvaddch(HEIGHT + 1, 0, '+');
-    mvaddch(HEIGHT + 1, WIDTH + 1, '+');
-    
-    attroff(COLOR_PAIR(COLOR_BORDER) | A_BOLD);
 }
 
-void draw_game(const GameState *game) {
-    clear();
-    
-    // Draw border
-    draw_border();
-    
-    // Draw title and stats
-    attron(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    mvprintw(0, WIDTH + 5, "[ SNAKE GAME ]");
-    attroff(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    
-    // Draw score and stats
-    attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-    mvprintw(2, WIDTH + 5, "SCORE: %d", game->score);
-    mvprintw(3, WIDTH + 5, "LENGTH: %d/%d", game->snake.length, WIN_LENGTH);
-    mvprintw(4, WIDTH + 5, "APPLES: %d", game->apples_eaten);
-    attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-    
-    // Draw progress bar to win
-    int progress = (game->snake.length * 20) / WIN_LENGTH;
-    mvprintw(5, WIDTH + 5, "WIN:");
-    attron(COLOR_PAIR(COLOR_TITLE));
-    for (int i = 0; i < 20; i++) {
-        mvaddch(5, WIDTH + 10 + i, i < progress ? '=' : '-');
-    }
-    attroff(COLOR_PAIR(COLOR_TITLE));
+int get_movement_delay(int direction, int speed_boost) {
+    int base_delay;
     
-    // Draw speed boost indicator
-    if (is_speed_boost_active(&game->speed_boost)) {
-        attron(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD | A_BLINK);
-        mvprintw(7, WIDTH + 5, ">>> SPEED x2 <<<");
-        attroff(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD | A_BLINK);
+    if (direction == DIR_LEFT || direction == DIR_RIGHT) {
+        base_delay = MOVE_DELAY_HORIZONTAL;
+    } else {
+        base_delay = MOVE_DELAY_VERTICAL;
     }
     
-    // Draw legend
-    mvprintw(9, WIDTH + 5, "--- APPLES ---");
-    attron(COLOR_PAIR(COLOR_FOOD_REGULAR) | A_BOLD);
-    mvprintw(10, WIDTH + 5, "* Red: +1 +10pts");
-    attroff(COLOR_PAIR(COLOR_FOOD_REGULAR) | A_BOLD);
-    
-    attron(COLOR_PAIR(COLOR_FOOD_GREEN) | A_BOLD);
-    mvprintw(11, WIDTH + 5, "$ Green: +2 +20pts");
-    attroff(COLOR_PAIR(COLOR_FOOD_GREEN) | A_BOLD);
-    
-    attron(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD);
-    mvprintw(12, WIDTH + 5, "@ Gold: Speed x2");
-    attroff(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD);
+    // Apply speed boost (2x speed = half delay)
+    if (speed_boost) {
+        return base_delay / 2;
+    }
     
-    attron(COLOR_PAIR(COLOR_FOOD_BLUE) | A_BOLD);
-    mvprintw(13, WIDTH + 5, "# Blue: +Wall");
-    attroff(COLOR_PAIR(COLOR_FOOD_BLUE) | A_BOLD);
+    return base_delay;
+}
+
+/**
+ * Keys applied since the last tick.
+ */
+typedef struct {
+    int turned;                  // A turn is waiting for the next tick
+    uint64_t turn_arrival_ns;
+    int rewound;                 // The game moved through its history
+} TickInput;
+
+/**
+ * Steps through the recorded history and leaves the game paused there.
+ */
+static void rewind_key(GameState *game, RewindBuffer *history, int key, TickInput *tick) {
+    long step = key == INPUT_REWIND ? -1 : key == INPUT_FORWARD ? 1 :
+                key == INPUT_REWIND_FAR ? -REWIND_JUMP : REWIND_JUMP;
+    unsigned long target = history->tick;
+    
+    if (step < 0) {
+        target = target - history->oldest > (unsigned long)-step ? target + step : history->oldest;
+    } else {
+        target = history->newest - target > (unsigned long)step ? target + step : history->newest;
+    }
+    if (target == history->tick || rewind_seek(history, game, target) < 0) {
+        return;
+    }
+    pause_game(game);
+    tick->turned = 0;
+    tick->rewound = 1;
+}
+
+/**
+ * Applies one key. Only one turn takes effect per tick, so two quick turns
+ * cannot reverse the snake into itself.
+ * @return 0 if the key has to wait for the next tick.
+ */
+static int apply_key(GameState *game, RewindBuffer *history, int key, uint64_t arrival_ns,
+                     TickInput *tick, InputLatency *latency) {
+    if (key >= DIR_UP && key <= DIR_LEFT) {
+        if (game->state == GAME_PAUSED) {
+            return 1;
+        }
+        if (tick->turned) {
+            return 0;
+        }
+        if (is_valid_direction_change(game->snake.direction, key)) {
+            game->snake.direction = key;
+            tick->turned = 1;
+            tick->turn_arrival_ns = arrival_ns;
+        }
+        return 1;
+    }
     
-    // Draw snake
-    attron(COLOR_PAIR(COLOR_SNAKE) | A_BOLD);
-    for (int i = 0; i < game->snake.length; i++) {
-        if (i == 0) {
-            mvaddch(game->snake.body[i].y, game->snake.body[i].x, '@');
+    if (key == INPUT_QUIT) {
+        game->state = GAME_QUIT;
+    } else if (key == INPUT_PAUSE) {
+        if (game->state == GAME_PAUSED) {
+            resume_game(game);
         } else {
-            mvaddch(game->snake.body[i].y, game->snake.body[i].x, 'o');
+            pause_game(game);
         }
+    } else if (key >= INPUT_REWIND && key <= INPUT_FORWARD_FAR) {
+        rewind_key(game, history, key, tick);
+    } else {
+        return 1;
     }
-    attroff(COLOR_PAIR(COLOR_SNAKE) | A_BOLD);
-    
-    // Draw food with different colors
-    if (game->food.active) {
-        int color_pair;
-        char symbol;
-        
-        switch (game->food.type) {
-            case FOOD_REGULAR:
-                color_pair = COLOR_FOOD_REGULAR;
-                symbol = '*';
-                break;
-            case FOOD_GREEN:
-                color_pair = COLOR_FOOD_GREEN;
-                symbol = '$';
-                break;
-            case FOOD_GOLD:
-                color_pair = COLOR_FOOD_GOLD;
-                symbol = '@';
-                break;
-            case FOOD_BLUE:
-                color_pair = COLOR_FOOD_BLUE;
-                symbol = '#';
-                break;
-            default:
-                color_pair = COLOR_FOOD_REGULAR;
-                symbol = '*';
+    note_latency(latency, input_now_ns() - arrival_ns);
+    return 1;
+}
+
+/**
+ * Applies queued keys; a second turn stays queued for the following tick.
+ */
+static void apply_input(InputThread *input, GameState *game, RewindBuffer *history,
+                        TickInput *tick, InputLatency *latency) {
+    InputCommand command;
+    
+    while ((game->state == GAME_RUNNING || game->state == GAME_PAUSED) &&
+           input_ring_peek(&input->ring, &command)) {
+        if (!apply_key(game, history, command.key, command.time_ns, tick, latency)) {
+            break;
         }
-        
-        attron(COLOR_PAIR(color_pair) | A_BOLD);
-        mvaddch(game->food.position.y, game->food.position.x, symbol);
-        attroff(COLOR_PAIR(color_pair) | A_BOLD);
+        input_ring_pop(&input->ring, &command);
     }
-    
-    // Draw obstacles
-    attron(COLOR_PAIR(COLOR_OBSTACLE) | A_BOLD);
-    for (int i = 0; i < game->obstacles.count; i++) {
-        mvaddch(game->obstacles.obstacles[i].y, 
-                game->obstacles.obstacles[i].x, 'X');
+}
+
+/**
+ * Whole board with the side panel, or only the window around the head when
+ * the terminal is too small for it.
+ */
+static void draw_frame(const RenderBackend *out, const GameState *game, Camera *camera) {
+    if (camera) {
+        draw_game_viewport(out, camera, game);
+    } else {
+        draw_game(out, game);
     }
-    attroff(COLOR_PAIR(COLOR_OBSTACLE) | A_BOLD);
-    
-    // Instructions
-    attron(COLOR_PAIR(COLOR_INFO));
-    mvprintw(HEIGHT + 2, 0, "Arrow Keys: Move | Q: Quit | Get to %d length to WIN!", WIN_LENGTH);
-    attroff(COLOR_PAIR(COLOR_INFO));
-    
-    refresh();
 }
 
-void welcome_screen(void) {
-    clear();
-    
-    // ASCII Art Title
-    attron(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    mvprintw(3, WIDTH / 2 - 15, "   _____ _   _          _  _______ ");
-    mvprintw(4, WIDTH / 2 - 15, "  / ____| \\ | |   /\\   | |/ /  ____|");
-    mvprintw(5, WIDTH / 2 - 15, " | (___ |  \\| |  /  \\  | ' /| |__   ");
-    mvprintw(6, WIDTH / 2 - 15, "  \\___ \\| . ` | / /\\ \\ |  < |  __|  ");
-    mvprintw(7, WIDTH / 2 - 15, "  ____) | |\\  |/ ____ \\| . \\| |____ ");
-    mvprintw(8, WIDTH / 2 - 15, " |_____/|_| \\_/_/    \\_\\_|\\_\\______|");
-    attroff(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    
-    // Instructions
-    mvprintw(12, WIDTH / 2 - 18, "GOAL: Grow to %d length to WIN!", WIN_LENGTH);
-    mvprintw(14, WIDTH / 2 - 15, "CONTROLS:");
-    mvprintw(15, WIDTH / 2 - 15, "  Arrow Keys - Move");
-    mvprintw(16, WIDTH / 2 - 15, "  Q - Quit");
-    
-    mvprintw(18, WIDTH / 2 - 15, "SPECIAL APPLES:");
-    attron(COLOR_PAIR(COLOR_FOOD_REGULAR));
-    mvprintw(19, WIDTH / 2 - 15, "  * Red");
-    attroff(COLOR_PAIR(COLOR_FOOD_REGULAR));
-    mvprintw(19, WIDTH / 2 - 6, "- Normal (+1, +10pts)");
-    
-    attron(COLOR_PAIR(COLOR_FOOD_GREEN));
-    mvprintw(20, WIDTH / 2 - 15, "  $ Green");
-    attroff(COLOR_PAIR(COLOR_FOOD_GREEN));
-    mvprintw(20, WIDTH / 2 - 6, "- Big (+2, +20pts)");
-    
-    attron(COLOR_PAIR(COLOR_FOOD_GOLD));
-    mvprintw(21, WIDTH / 2 - 15, "  @ Gold");
-    attroff(COLOR_PAIR(COLOR_FOOD_GOLD));
-    mvprintw(21, WIDTH / 2 - 6, "- Speed x2 for 3s (+50pts)");
-    
-    attron(COLOR_PAIR(COLOR_FOOD_BLUE));
-    mvprintw(22, WIDTH / 2 - 15, "  # Blue");
-    attroff(COLOR_PAIR(COLOR_FOOD_BLUE));
-    mvprintw(22, WIDTH / 2 - 6, "- Adds obstacle (+15pts)");
-    
-    attron(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    mvprintw(HEIGHT - 3, WIDTH / 2 - 15, "Press ANY KEY to start...");
-    attroff(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    
-    refresh();
-    nodelay(stdscr, FALSE);
-    getch();
-    nodelay(stdscr, TRUE);
+/**
+ * Runs the games of one remote player without a terminal.
+ */
+static int serve_games(const GameState *start, int port, int show_stats) {
+    static NetServer server;
+    NetLink link;
+    
+    if (net_listen(&link, port) < 0) {
+        fprintf(stderr, "Cannot listen on UDP port %d\n", port);
+        return 1;
+    }
+    net_server_init(&server, start, game_rng_state(), MOVE_DELAY_HORIZONTAL);
+    printf("Serving on UDP port %d\n", net_local_port(&link));
+    fflush(stdout);
+    net_serve(&link, &server, &hangup);
+    if (show_stats) {
+        printf("server: %lu games, %lu ticks, %lu late turns, %lu packets in, %lu out\n",
+               server.games, server.ticks, server.late, link.received, link.sent);
+    }
+    net_close(&link);
+    return 0;
 }
 
-void game_over_screen(const GameState *game) {
-    clear();
+/**
+ * Plays on a server: turns show up on the predicted game at once, and the
+ * server's states correct it when a turn reached the server too late.
+ */
+static void play_online(const RenderBackend *out, RenderStats *stats, Camera *view,
+                        NetLink *link, NetPredictor *predictor) {
+    InputThread input;
+    InputCommand command;
+    NetMessage message;
+    uint64_t hello_at = 0;
+    int quit = 0;
+    
+    if (input_thread_start(&input, STDIN_FILENO) < 0) {
+        return;
+    }
+    while (!quit && !hangup) {
+        uint64_t now = input_now_ns();
+        
+        // Until the server answers, say hello once a second
+        if (!predictor->started && now >= hello_at) {
+            memset(&message, 0, sizeof(message));
+            message.type = NET_HELLO;
+            message.echo_ns = now;
+            net_send(link, &message);
+            hello_at = now + 1000000000ull;
+        }
+        while (net_receive(link, &message, now)) {
+            if (message.type == NET_START &&
+                (!predictor->started || message.game != predictor->number)) {
+                if (net_predict_start(predictor, &message, now) == 0) {
+                    draw_frame(out, &predictor->game, view);
+                    render_present(out, stats);
+                }
+            } else if (message.type == NET_STATE) {
+                net_predict_confirm(predictor, &message, now);
+            }
+        }
+        
+        // Keys other than turns and quit mean nothing online; one turn per tick
+        int direction = -1;
+        uint64_t key_ns = 0;
+        while (input_ring_peek(&input.ring, &command)) {
+            if (command.key == INPUT_QUIT) {
+                quit = 1;
+            } else if (command.key >= DIR_UP && command.key <= DIR_LEFT) {
+                if (direction >= 0 || !net_predict_due(predictor, now)) {
+                    break;
+                }
+                direction = command.key;
+                key_ns = command.time_ns;
+            }
+            input_ring_pop(&input.ring, &command);
+        }
+        
+        if (!net_predict_due(predictor, now)) {
+            uint64_t until = predictor->started ? net_predict_next_ns(predictor) : hello_at;
+            net_wait(link, now, until);
+            continue;
+        }
+        net_predict_tick(predictor, direction, key_ns, now);
+        net_predict_inputs(predictor, &message, now);
+        net_send(link, &message);
+        draw_frame(out, &predictor->game, view);
+        render_present(out, stats);
+    }
+    input_thread_stop(&input);
     
-    // Title - Simplified and centered properly
-    attron(COLOR_PAIR(COLOR_FOOD_REGULAR) | A_BOLD);
-    mvprintw(HEIGHT / 2 - 4, WIDTH / 2 - 12, "   ____    _    __  __ _____ ");
-    mvprintw(HEIGHT / 2 - 3, WIDTH / 2 - 12, "  / ___|  / \\  |  \\/  | ____|");
-    mvprintw(HEIGHT / 2 - 2, WIDTH / 2 - 12, " | |  _  / _ \\ | |\\/| |  _|  ");
-    mvprintw(HEIGHT / 2 - 1, WIDTH / 2 - 12, " | |_| |/ ___ \\| |  | | |___ ");
-    mvprintw(HEIGHT / 2, WIDTH / 2 - 12,     "  \\____/_/   \\_\\_|  |_|_____|");
-    mvprintw(HEIGHT / 2 + 1, WIDTH / 2 - 12, "   _____     _______ ____  _ ");
-    mvprintw(HEIGHT / 2 + 2, WIDTH / 2 - 12, "  / _ \\ \\   / / ____|  _ \\| |");
-    mvprintw(HEIGHT / 2 + 3, WIDTH / 2 - 12, " | | | \\ \\ / /|  _| | |_) | |");
-    mvprintw(HEIGHT / 2 + 4, WIDTH / 2 - 12, " | |_| |\\ V / | |___|  _ <|_|");
-    mvprintw(HEIGHT / 2 + 5, WIDTH / 2 - 12, "  \\___/  \\_/  |_____|_| \\_(_)");
-    attroff(COLOR_PAIR(COLOR_FOOD_REGULAR) | A_BOLD);
-
+    memset(&message, 0, sizeof(message));
+    message.type = NET_BYE;
+    net_send(link, &message);
+}
 
-    // Stats
-    attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-    mvprintw(HEIGHT / 2 + 7, WIDTH / 2 - 10, "FINAL SCORE: %d", game->score);
-    mvprintw(HEIGHT / 2 + 8, WIDTH / 2 - 10, "FINAL LENGTH: %d/%d", game->snake.length, WIN_LENGTH);
-    mvprintw(HEIGHT / 2 + 9, WIDTH / 2 - 10, "APPLES EATEN: %d", game->apples_eaten);
-    attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-    
-    // Apple breakdown
-    attron(COLOR_PAIR(COLOR_INFO));
-    mvprintw(HEIGHT / 2 + 11, WIDTH / 2 - 10, "Apple Breakdown:");
-    attroff(COLOR_PAIR(COLOR_INFO));
-    
-    attron(COLOR_PAIR(COLOR_FOOD_REGULAR));
-    mvprintw(HEIGHT / 2 + 12, WIDTH / 2 - 8, "Red: %d", game->special_apples_eaten[FOOD_REGULAR]);
-    attroff(COLOR_PAIR(COLOR_FOOD_REGULAR));
-    
-    attron(COLOR_PAIR(COLOR_FOOD_GREEN));
-    mvprintw(HEIGHT / 2 + 12, WIDTH / 2, "Green: %d", game->special_apples_eaten[FOOD_GREEN]);
-    attroff(COLOR_PAIR(COLOR_FOOD_GREEN));
-    
-    attron(COLOR_PAIR(COLOR_FOOD_GOLD));
-    mvprintw(HEIGHT / 2 + 13, WIDTH / 2 - 8, "Gold: %d", game->special_apples_eaten[FOOD_GOLD]);
-    attroff(COLOR_PAIR(COLOR_FOOD_GOLD));
-    
-    attron(COLOR_PAIR(COLOR_FOOD_BLUE));
-    mvprintw(HEIGHT / 2 + 13, WIDTH / 2, "Blue: %d", game->special_apples_eaten[FOOD_BLUE]);
-    attroff(COLOR_PAIR(COLOR_FOOD_BLUE));
-    
-    attron(COLOR_PAIR(COLOR_BORDER) | A_BOLD);
-    mvprintw(HEIGHT - 2, WIDTH / 2 - 15, "Press any key to exit...");
-    attroff(COLOR_PAIR(COLOR_BORDER) | A_BOLD);
-    
-    refresh();
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-l empty|maze|rooms|pillars] [-s seed]\n", prog);
+    fprintf(stderr, "       %s -p levels.pack [-n index]\n", prog);
+    fprintf(stderr, "Display: -r ansi|ncurses, -S to print output cost per frame on exit,\n");
+    fprintf(stderr, "         -V COLSxROWS to show the board through a scrolling window that size\n");
+    fprintf(stderr, "Food: -f count of foods on the board, -w regular,green,gold,blue weights\n");
+    fprintf(stderr, "Monitoring: -e name to publish live state to shared memory (e.g. %s),\n", LIVE_NAME);
+    fprintf(stderr, "            -M unix:PATH|[127.0.0.1:]PORT to serve Prometheus metrics\n");
+    fprintf(stderr, "Saving: -A ticks between autosaves (0 - off, default %d),\n", AUTOSAVE_INTERVAL);
+    fprintf(stderr, "        --resume to continue the last saved game\n");
+    fprintf(stderr, "Network: --serve PORT to host games (level options apply),\n");
+    fprintf(stderr, "         --connect HOST:PORT to play on a server,\n");
+    fprintf(stderr, "         --net-delay MS[,JITTER] to delay incoming packets\n");
 }
 
-void game_won_screen(const GameState *game) {
-    clear();
-    
-    // Victory Title
-    attron(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD);
-    mvprintw(HEIGHT / 2 - 6, WIDTH / 2 - 15, "__   __ ___   _   _  __      __ ___  _  _ _ ");
-    mvprintw(HEIGHT / 2 - 5, WIDTH / 2 - 15, "\\ \\ / // _ \\ | | | | \\ \\    / /|_ _|| \\| | |");
-    mvprintw(HEIGHT / 2 - 4, WIDTH / 2 - 15, " \\ V /| (_) || |_| |  \\ \\/\\/ /  | | | .` |_|");
-    mvprintw(HEIGHT / 2 - 3, WIDTH / 2 - 15, "  |_|  \\___/  \\___/    \\_/\\_/  |___||_|\\_(_)");
-    attroff(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD);
-    
-    // Congratulations
-    attron(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    mvprintw(HEIGHT / 2 - 1, WIDTH / 2 - 20, "CONGRATULATIONS! You reached %d length!", WIN_LENGTH);
-    attroff(COLOR_PAIR(COLOR_TITLE) | A_BOLD);
-    
-    // Stats
-    attron(COLOR_PAIR(COLOR_INFO) | A_BOLD);
-    mvprintw(HEIGHT / 2 + 1, WIDTH / 2 - 10, "FINAL SCORE: %d", game->score);
-    mvprintw(HEIGHT / 2 + 2, WIDTH / 2 - 10, "APPLES EATEN: %d", game->apples_eaten);
-    mvprintw(HEIGHT / 2 + 3, WIDTH / 2 - 10, "OBSTACLES CREATED: %d", game->obstacles.count);
-    attroff(COLOR_PAIR(COLOR_INFO) | A_BOLD);
+int main(int argc, char **argv) {
+    GameState game;
+    int level_kind = LEVEL_EMPTY;
+    unsigned int level_seed = (unsigned int)time(NULL);
+    const char *pack_path = NULL;
+    int pack_index = 0;
+    LevelPack pack;
+    int level_id = LEVEL_ID_CLASSIC;
+    Leaderboard board;
+    char board_dir[LEADERBOARD_PATH_LEN];
+    const RenderBackend *out = &render_ansi;
+    RenderStats stats = { 0, 0, 0, 0 };
+    int show_stats = 0;
+    InputThread input;
+    InputLatency latency;
+    int threaded_input;
+    TickInput tick = { 0, 0, 0 };
+    static RewindBuffer history;
+    int rewound = 0;
+    uint64_t deadline = 0;
+    int paused_drawn = 0;
+    static FoodPool foods;
+    int food_count = 0;
+    int food_weights[4] = { 60, 15, 10, 15 };
+    static Camera camera;
+    Camera *view = NULL;
+    int view_cols = 0, view_rows = 0;
+    struct winsize term;
+    const char *live_name = NULL;
+    LiveExport live = { NULL, "", 0 };
+    static Autosave saver;
+    static AutosaveState saved;
+    char save_path[AUTOSAVE_PATH_LEN];
+    int autosave_every = AUTOSAVE_INTERVAL;
+    int resume = 0;
+    uint64_t save_sequence = 0;
+    uint64_t tick_base = 0;      // Ticks played before a resumed game started
+    int live_state = GAME_RUNNING;
+    const char *metrics_address = NULL;
+    static Metrics metrics;
+    static MetricsServer metrics_server;
+    static GameEventBus bus;
+    int finished = 0;            // Counted in the metrics
+    int serve_port = -1;
+    char connect_host[256] = "";
+    int connect_port = 0;
+    double net_delay_ms = 0, net_jitter_ms = 0;
+    static NetPredictor predictor;
+    NetLink link;
+    static const struct option long_options[] = {
+        { "resume", no_argument, NULL, 'R' },
+        { "serve", required_argument, NULL, 'H' },
+        { "connect", required_argument, NULL, 'C' },
+        { "net-delay", required_argument, NULL, 'D' },
+        { NULL, 0, NULL, 0 },
+    };
+    struct sigaction action;
+    int opt;
+    
+    while ((opt = getopt_long(argc, argv, "l:s:p:n:r:Sf:w:V:e:A:M:", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'l':
+                level_kind = level_kind_from_name(optarg);
+                if (level_kind < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 's':
+                level_seed = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                pack_path = optarg;
+                break;
+            case 'n':
+                pack_index = atoi(optarg);
+                break;
+            case 'r':
+                out = render_backend_by_name(optarg);
+                if (!out) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'S':
+                show_stats = 1;
+                break;
+            case 'f':
+                food_count = atoi(optarg);
+                break;
+            case 'e':
+                live_name = optarg;
+                break;
+            case 'M':
+                metrics_address = optarg;
+                break;
+            case 'A':
+                autosave_every = atoi(optarg);
+                break;
+            case 'R':
+                resume = 1;
+                break;
+            case 'H':
+                serve_port = atoi(optarg);
+                break;
+            case 'C':
+                if (sscanf(optarg, "%255[^:]:%d", connect_host, &connect_port) != 2) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'D':
+                if (sscanf(optarg, "%lf,%lf", &net_delay_ms, &net_jitter_ms) < 1) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'V':
+                if (sscanf(optarg, "%dx%d", &view_cols, &view_rows) != 2 ||
+                    view_cols < 1 || view_rows < 2) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'w':
+                if (sscanf(optarg, "%d,%d,%d,%d", &food_weights[0], &food_weights[1],
+                           &food_weights[2], &food_weights[3]) != 4) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                // Custom odds need the pool, even with a single food
+                if (food_count == 0) {
+                    food_count = 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
     
-    // Apple breakdown
-    mvprintw(HEIGHT / 2 + 5, WIDTH / 2 - 10, "Apple Collection:");
-    attron(COLOR_PAIR(COLOR_FOOD_REGULAR));
-    mvprintw(HEIGHT / 2 + 6, WIDTH / 2 - 10, "  Red: %d", game->special_apples_eaten[FOOD_REGULAR]);
-    attroff(COLOR_PAIR(COLOR_FOOD_REGULAR));
+    // The food pool lives outside GameState and is not sent over the network
+    if ((serve_port >= 0 || connect_host[0]) && (food_count > 0 || resume)) {
+        fprintf(stderr, "Network games use the classic food and cannot be resumed\n");
+        return 1;
+    }
+    if (food_count > 0 && food_pool_init(&foods, food_count, food_weights) < 0) {
+        fprintf(stderr, "Food count must be 1..%d and weights non-negative\n", FOOD_POOL_MAX);
+        return 1;
+    }
     
-    attron(COLOR_PAIR(COLOR_FOOD_GREEN));
-    mvprintw(HEIGHT / 2 + 7, WIDTH / 2 - 10, "  Green: %d", game->special_apples_eaten[FOOD_GREEN]);
-    attroff(COLOR_PAIR(COLOR_FOOD_GREEN));
+    // A resumed game brings its own level, food and random state
+    scores_dir(board_dir, sizeof(board_dir));
+    snprintf(save_path, sizeof(save_path), "%s/autosave", board_dir);
+    if (autosave_load(save_path, &saved, &save_sequence) < 0) {
+        if (resume) {
+            fprintf(stderr, "%s: no saved game to resume\n", save_path);
+            return 1;
+        }
+        save_sequence = 0;
+    }
+    if (resume) {
+        pack_path = NULL;
+        level_kind = LEVEL_EMPTY;
+        food_count = 0;
+    }
     
-    attron(COLOR_PAIR(COLOR_FOOD_GOLD));
-    mvprintw(HEIGHT / 2 + 8, WIDTH / 2 - 10, "  Gold: %d", game->special_apples_eaten[FOOD_GOLD]);
-    attroff(COLOR_PAIR(COLOR_FOOD_GOLD));
+    if (pack_path) {
+        if (levelpack_open(&pack, pack_path) < 0) {
+            fprintf(stderr, "%s: not a valid level pack\n", pack_path);
+            return 1;
+        }
+        if (!levelpack_get(&pack, pack_index)) {
+            fprintf(stderr, "%s: no playable level %d (pack has %d)\n", pack_path, pack_index, pack.count);
+            return 1;
+        }
+    }
     
-    attron(COLOR_PAIR(COLOR_FOOD_BLUE));
-    mvprintw(HEIGHT / 2 + 9, WIDTH / 2 - 10, "  Blue: %d", game->special_apples_eaten[FOOD_BLUE]);
-    attroff(COLOR_PAIR(COLOR_FOOD_BLUE));
+    if (connect_host[0]) {
+        if (net_connect(&link, connect_host, connect_port) < 0) {
+            fprintf(stderr, "%s: host not found\n", connect_host);
+            return 1;
+        }
+        net_set_delay(&link, (uint64_t)(net_delay_ms * 1e6), (uint64_t)(net_jitter_ms * 1e6));
+        net_predict_init(&predictor);
+        autosave_every = 0;
+    }
     
-    attron(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD);
-    mvprintw(HEIGHT - 2, WIDTH / 2 - 15, "Press any key to exit...");
-    attroff(COLOR_PAIR(COLOR_FOOD_GOLD) | A_BOLD);
+    // Initialize game
+    init_game(&game);
+    if (pack_path) {
+        levelpack_apply(levelpack_get(&pack, pack_index), &game);
+        levelpack_close(&pack);
+        level_id = 1 + pack_index;
+    } else if (level_kind != LEVEL_EMPTY) {
+        Level level;
+        if (level_generate(&level, level_kind, level_seed) > 0) {
+            level_apply(&level, &game);
+            level_id = LEVEL_ID_GENERATED + level_kind;
+        }
+    }
     
-    refresh();
-}
-
-int get_movement_delay(int direction, int speed_boost) {
-    int base_delay;
+    // The server is headless: it plays this level for whoever connects
+    if (serve_port >= 0) {
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = on_hangup;
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+        return serve_games(&game, serve_port, show_stats);
+    }
     
-    if (direction == DIR_LEFT || direction == DIR_RIGHT) {
-        base_delay = MOVE_DELAY_HORIZONTAL;
-    } else {
-        base_delay = MOVE_DELAY_VERTICAL;
+    if (metrics_address) {
+        if (metrics_listen(&metrics_server, &metrics, metrics_address) < 0) {
+            fprintf(stderr, "%s: cannot listen for metrics (only UNIX sockets and 127.x)\n",
+                    metrics_address);
+            return 1;
+        }
+        meter = &metrics;
     }
     
-    // Apply speed boost (2x speed = half delay)
-    if (speed_boost) {
-        return base_delay / 2;
+    if (live_name && live_create(&live, live_name) < 0) {
+        fprintf(stderr, "%s: cannot create shared memory segment\n", live_name);
+        if (meter) {
+            metrics_stop(&metrics_server);
+        }
+        return 1;
     }
     
-    return base_delay;
-}
-
-int main(void) {
-    GameState game;
-    int ch;
+    // Initialize the terminal; ncurses is the fallback for terminals the ANSI backend rejects
+    if (out->init() < 0) {
+        out = &render_ncurses;
+        if (out->init() < 0) {
+            fprintf(stderr, "Cannot initialize the terminal\n");
+            if (meter) {
+                metrics_stop(&metrics_server);
+            }
+            return 1;
+        }
+    }
     
-    // Initialize ncurses
-    initscr();
-    cbreak();
-    noecho();
-    curs_set(0);
-    keypad(stdscr, TRUE);
-    nodelay(stdscr, TRUE);
+    if (food_count > 0) {
+        game.foods = &foods;
+    }
+    if (resume) {
+        autosave_restore(&saved, &game, &foods);
+        level_id = saved.level_id;
+        rewound = saved.rewound;
+        tick_base = saved.tick;
+    }
     
-    // Enable colors
-    if (has_colors()) {
-        start_color();
-        init_pair(COLOR_SNAKE, COLOR_GREEN, COLOR_BLACK);
-        init_pair(COLOR_FOOD_REGULAR, COLOR_RED, COLOR_BLACK);
-        init_pair(COLOR_BORDER, COLOR_YELLOW, COLOR_BLACK);
-        init_pair(COLOR_INFO, COLOR_CYAN, COLOR_BLACK);
-        init_pair(COLOR_FOOD_GREEN, COLOR_GREEN, COLOR_BLACK);
-        init_pair(COLOR_FOOD_GOLD, COLOR_YELLOW, COLOR_BLACK);
-        init_pair(COLOR_FOOD_BLUE, COLOR_BLUE, COLOR_BLACK);
-        init_pair(COLOR_OBSTACLE, COLOR_MAGENTA, COLOR_BLACK);
-        init_pair(COLOR_TITLE, COLOR_WHITE, COLOR_BLACK);
+    // Food and walls are counted from the engine's events
+    if (meter) {
+        game_events_init(&bus);
+        game_events_subscribe(&bus, metrics_on_events, meter);
+        game.events = &bus;
     }
     
-    // Initialize game
-    init_game(&game);
+    // Checkpoints are written in the background; the game only copies its state
+    if (autosave_every > 0 && ((mkdir(board_dir, 0755) < 0 && errno != EEXIST) ||
+                               autosave_start(&saver, save_path, save_sequence) < 0)) {
+        autosave_every = 0;
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_hangup;
+    sigaction(SIGHUP, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    
+    // Boards larger than the terminal scroll with the head
+    if (view_cols == 0 && ioctl(STDOUT_FILENO, TIOCGWINSZ, &term) == 0 && term.ws_col > 0 &&
+        (term.ws_row < SCREEN_ROWS || term.ws_col < SCREEN_COLS)) {
+        view_cols = term.ws_col;
+        view_rows = term.ws_row;
+    }
+    if (view_cols > 0) {
+        camera_init(&camera, view_rows, view_cols);
+        view = &camera;
+    }
     
     // Welcome screen
-    welcome_screen();
+    welcome_screen(out);
+    out->present();
+    out->read_key(1);
+    
+    if (connect_host[0]) {
+        play_online(out, show_stats ? &stats : NULL, view, &link, &predictor);
+        net_close(&link);
+        game.state = GAME_QUIT;
+    }
     
-    // Game loop
-    while (game.state == GAME_RUNNING) {
-        // Handle input
-        ch = getch();
-        switch(ch) {
-            case KEY_UP:
-            case 'w':
-            case 'W':
-                if (is_valid_direction_change(game.snake.direction, DIR_UP)) {
-                    game.snake.direction = DIR_UP;
-                }
+    // Every tick goes into the rewind history
+    rewind_init(&history, &game);
+    memset(&latency, 0, sizeof(latency));
+    if (live.shared) {
+        live_publish(&live, &game, tick_base + history.tick, input_now_ns());
+    }
+    
+    for (;;) {
+        // Keys are read on their own thread while the game runs
+        threaded_input = input_thread_start(&input, STDIN_FILENO) == 0;
+        deadline = input_now_ns();
+        paused_drawn = 0;
+        
+        // Game loop: sleep until the next tick is due or a key arrives,
+        // and block without any timer while paused
+        while (game.state == GAME_RUNNING || game.state == GAME_PAUSED) {
+            live_state = game.state;
+            if (hangup) {
+                game.state = GAME_QUIT;
                 break;
-            case KEY_RIGHT:
-            case 'd':
-            case 'D':
-                if (is_valid_direction_change(game.snake.direction, DIR_RIGHT)) {
-                    game.snake.direction = DIR_RIGHT;
+            }
+            
+            // Handle input
+            if (threaded_input) {
+                apply_input(&input, &game, &history, &tick, &latency);
+            } else {
+                apply_key(&game, &history, out->read_key(game.state == GAME_PAUSED),
+                          input_now_ns(), &tick, &latency);
+            }
+            if (tick.rewound) {
+                tick.rewound = 0;
+                rewound = 1;
+                paused_drawn = 0;
+            }
+            
+            if (game.state == GAME_PAUSED) {
+                if (!paused_drawn) {
+                    draw_frame(out, &game, view);
+                    if (view) {
+                        draw_viewport_pause(out, view);
+                    } else {
+                        draw_pause(out);
+                        draw_rewind(out, history.tick, history.oldest, history.newest);
+                    }
+                    render_present(out, show_stats ? &stats : NULL);
+                    if (meter) {
+                        metrics_add(&meter->frames, 1);
+                    }
+                    paused_drawn = 1;
+                    if (live.shared) {
+                        live_publish(&live, &game, tick_base + history.tick, input_now_ns());
+                    }
+                    if (autosave_every > 0) {
+                        autosave_capture(&saver, &game, tick_base + history.tick, level_id, rewound);
+                    }
                 }
-                break;
-            case KEY_DOWN:
-            case 's':
-            case 'S':
-                if (is_valid_direction_change(game.snake.direction, DIR_DOWN)) {
-                    game.snake.direction = DIR_DOWN;
+                if (threaded_input) {
+                    input_wait(&input, -1);
                 }
+                continue;
+            }
+            if (game.state != GAME_RUNNING) {
                 break;
-            case KEY_LEFT:
-            case 'a':
-            case 'A':
-                if (is_valid_direction_change(game.snake.direction, DIR_LEFT)) {
-                    game.snake.direction = DIR_LEFT;
+            }
+            if (paused_drawn) {
+                paused_drawn = 0;
+                deadline = input_now_ns();
+            }
+            
+            uint64_t now = input_now_ns();
+            if (now < deadline) {
+                if (threaded_input) {
+                    input_wait(&input, (int64_t)(deadline - now));
+                } else {
+                    usleep((useconds_t)((deadline - now) / 1000));
                 }
-                break;
-            case 'q':
-            case 'Q':
-                game.state = GAME_QUIT;
-                break;
+                continue;
+            }
+            
+            if (tick.turned) {
+                note_latency(&latency, now - tick.turn_arrival_ns);
+                tick.turned = 0;
+            }
+            
+            // Update game state
+            rewind_update(&history, &game);
+            if (meter) {
+                uint64_t done = input_now_ns();
+                metrics_add(&meter->ticks, 1);
+                metrics_observe(&meter->tick_ns, done - now);
+                now = done;
+            }
+            if (live.shared) {
+                live_publish(&live, &game, tick_base + history.tick, now);
+            }
+            if (autosave_every > 0 && game.state == GAME_RUNNING &&
+                (tick_base + history.tick) % (uint64_t)autosave_every == 0) {
+                autosave_capture(&saver, &game, tick_base + history.tick, level_id, rewound);
+            }
+            
+            // Draw everything
+            draw_frame(out, &game, view);
+            render_present(out, show_stats ? &stats : NULL);
+            if (meter) {
+                metrics_add(&meter->frames, 1);
+                metrics_observe(&meter->render_ns, input_now_ns() - now);
+            }
+            
+            // Control game speed based on direction and speed boost; a late
+            // tick does not make the following ones run faster to catch up
+            uint64_t delay = 1000ull * get_movement_delay(game.snake.direction, 
+                                                          is_speed_boost_active(&game.speed_boost));
+            deadline = deadline + delay > now ? deadline + delay : now + delay;
         }
         
-        if (game.state != GAME_RUNNING) {
+        if (threaded_input) {
+            input_thread_stop(&input);
+        }
+        if (live.shared) {
+            live_publish(&live, &game, tick_base + history.tick, input_now_ns());
+        }
+        if (game.state == GAME_QUIT && autosave_every > 0) {
+            // Quitting, or losing the terminal, saves the game as it stood
+            GameState last = game;
+            last.state = live_state;
+            autosave_capture(&saver, &last, tick_base + history.tick, level_id, rewound);
+        }
+        if (meter && !finished) {
+            metrics_add(&meter->games[game.state], 1);
+        }
+        finished = 1;
+        if (game.state != GAME_OVER && game.state != GAME_WON) {
             break;
         }
         
-        // Update game state
-        update_game(&game);
+        // Show appropriate end screen
+        if (game.state == GAME_OVER) {
+            game_over_screen(out, &game);
+        } else {
+            game_won_screen(out, &game);
+        }
+        
+        // Save the result; the game still ends normally if the disk is unavailable.
+        // Games that went back through the history do not count
+        if (leaderboard_open(&board, board_dir) == 0) {
+            ScoreEntry entry;
+            score_entry_from_game(&entry, &game, level_id);
+            if (!rewound) {
+                leaderboard_record(&board, &entry);
+            }
+            draw_high_scores(out, &board, level_id);
+            leaderboard_close(&board);
+        }
         
-        // Draw everything
-        draw_game(&game);
+        out->present();
         
-        // Control game speed based on direction and speed boost
-        int delay = get_movement_delay(game.snake.direction, 
-                                       is_speed_boost_active(&game.speed_boost));
-        usleep(delay);
+        // [ or { on the end screen goes back into the game to look at what happened
+        int key = out->read_key(1);
+        if (key != INPUT_REWIND && key != INPUT_REWIND_FAR) {
+            break;
+        }
+        rewind_key(&game, &history, key, &tick);
+        if (game.state != GAME_PAUSED) {
+            break;
+        }
     }
     
-    // Show appropriate end screen
-    if (game.state == GAME_OVER) {
-        game_over_screen(&game);
-        nodelay(stdscr, FALSE);
-        getch();
-    } else if (game.state == GAME_WON) {
-        game_won_screen(&game);
-        nodelay(stdscr, FALSE);
-        getch();
+    // Cleanup
+    out->shutdown();
+    live_close(&live);
+    if (meter) {
+        metrics_stop(&metrics_server);
+    }
+    if (autosave_every > 0) {
+        autosave_stop(&saver);
+        // A finished game has nothing left to resume
+        if (game.state == GAME_OVER || game.state == GAME_WON) {
+            autosave_remove(save_path);
+        }
     }
     
-    // Cleanup
-    endwin();
+    if (show_stats && stats.frames > 0) {
+        if (stats.available) {
+            printf("%s: %lu frames, %.2f write syscalls/frame, %.0f bytes/frame\n",
+                   out->name, stats.frames, (double)stats.syscalls / stats.frames,
+                   (double)stats.bytes / stats.frames);
+        } else {
+            printf("%s: %lu frames (/proc/self/io unavailable)\n", out->name, stats.frames);
+        }
+    }
+    if (show_stats && latency.count > 0) {
+        printf("input: %lu keys, key-to-tick latency avg %.1f ms, p99 <= %.1f ms, max %.1f ms\n",
+               latency.count, latency.total_ns / 1e6 / latency.count,
+               input_latency_percentile(&latency, 0.99) / 1000.0, latency.max_ns / 1e6);
+    }
+    if (show_stats && predictor.confirms > 0) {
+        printf("net: %lu server states, %lu corrections (%lu snapped ahead), "
+               "%.1f ticks and %.1f us re-simulated per correction, max %.1f us\n",
+               predictor.confirms, predictor.corrections, predictor.snaps,
+               predictor.corrections ? (double)predictor.resimulated / predictor.corrections : 0.0,
+               predictor.corrections ? predictor.resim_ns / 1e3 / predictor.corrections : 0.0,
+               predictor.resim_max_ns / 1e3);
+        printf("net: rtt %.1f ms; key to screen avg %.1f ms, p99 <= %.1f ms; "
+               "key to server state avg %.1f ms, p99 <= %.1f ms\n",
+               predictor.rtt_ns / 1e6,
+               predictor.predicted.count ? predictor.predicted.total_ns / 1e6 / predictor.predicted.count : 0.0,
+               input_latency_percentile(&predictor.predicted, 0.99) / 1000.0,
+               predictor.authoritative.count ?
+                   predictor.authoritative.total_ns / 1e6 / predictor.authoritative.count : 0.0,
+               input_latency_percentile(&predictor.authoritative, 0.99) / 1000.0);
+    }
+    if (show_stats && autosave_every > 0) {
+        printf("autosave: %lu captured, %lu written, %lu replaced before writing, %lu failed\n",
+               saver.captured, saver.saved, saver.replaced, saver.failed);
+    }
     
     return 0;
 }
@@ -0,0 +1,339 @@
+#include "metrics.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define METRICS_REQUEST_MAX 4096
+#define METRICS_READ_TIMEOUT_MS 1000
+#define DURATION_FIRST 8               // Durations are listed from 256 ns up
+
+static const char *food_names[4] = { "regular", "green", "gold", "blue" };
+static const char *state_names[5] = { "running", "over", "quit", "won", "paused" };
+
+// ========== Hot path ==========
+
+void metrics_add(uint64_t *counter, uint64_t n) {
+    __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+void metrics_observe(MetricsHistogram *histogram, uint64_t value) {
+    // Bucket i holds values up to 2^i; the last one everything above
+    int bucket = value <= 1 ? 0 : 64 - __builtin_clzll(value - 1);
+    if (bucket > METRICS_BUCKETS - 1) {
+        bucket = METRICS_BUCKETS - 1;
+    }
+    __atomic_fetch_add(&histogram->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, value, __ATOMIC_RELAXED);
+}
+
+void metrics_on_events(const GameEvent *events, int count, const GameState *game, void *context) {
+    Metrics *metrics = context;
+    (void)game;
+
+    for (int i = 0; i < count; i++) {
+        if (events[i].type == EVENT_FOOD_SPAWNED && events[i].arg < 4) {
+            metrics_add(&metrics->food_spawned[events[i].arg], 1);
+        } else if (events[i].type == EVENT_OBSTACLE_ADDED) {
+            metrics_add(&metrics->obstacles, 1);
+            metrics_add(&metrics->obstacle_retries, events[i].arg - 1u);
+            metrics_observe(&metrics->obstacle_attempts, events[i].arg);
+        }
+    }
+}
+
+// ========== Text format ==========
+
+typedef struct {
+    char *out;
+    size_t size;
+    size_t len;
+} TextBuffer;
+
+static void append(TextBuffer *text, const char *format, ...) {
+    va_list args;
+
+    if (text->len + 1 >= text->size) {
+        return;
+    }
+    va_start(args, format);
+    int n = vsnprintf(text->out + text->len, text->size - text->len, format, args);
+    va_end(args);
+    if (n > 0) {
+        text->len += (size_t)n;
+        if (text->len >= text->size) {
+            text->len = text->size - 1;
+        }
+    }
+}
+
+static uint64_t load(const uint64_t *counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static void counter(TextBuffer *text, const char *name, const char *help, uint64_t value) {
+    append(text, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n",
+           name, help, name, name, (unsigned long long)value);
+}
+
+// Buckets are read one by one while the game goes on, so the total is
+// taken from the buckets themselves to keep +Inf and _count consistent.
+// Only buckets first..last are listed; the others still count towards them
+static void histogram(TextBuffer *text, const char *name, const char *help,
+                      const MetricsHistogram *histogram, double scale, int first, int last) {
+    uint64_t total = 0;
+
+    append(text, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    for (int i = 0; i < METRICS_BUCKETS - 1; i++) {
+        total += load(&histogram->buckets[i]);
+        if (i >= first && i <= last) {
+            append(text, "%s_bucket{le=\"%g\"} %llu\n", name, (double)(1ull << i) * scale,
+                   (unsigned long long)total);
+        }
+    }
+    total += load(&histogram->buckets[METRICS_BUCKETS - 1]);
+    append(text, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)total);
+    append(text, "%s_sum %g\n", name, (double)load(&histogram->sum) * scale);
+    append(text, "%s_count %llu\n", name, (unsigned long long)total);
+}
+
+size_t metrics_format(const Metrics *metrics, char *out, size_t size) {
+    TextBuffer text = { out, size, 0 };
+
+    if (size == 0) {
+        return 0;
+    }
+    out[0] = '\0';
+    counter(&text, "snake_ticks_total", "Game ticks played.", load(&metrics->ticks));
+    counter(&text, "snake_frames_total", "Frames drawn.", load(&metrics->frames));
+    histogram(&text, "snake_tick_duration_seconds", "Time spent in one game tick.",
+              &metrics->tick_ns, 1e-9, DURATION_FIRST, METRICS_BUCKETS - 2);
+    histogram(&text, "snake_render_duration_seconds", "Time spent drawing and writing one frame.",
+              &metrics->render_ns, 1e-9, DURATION_FIRST, METRICS_BUCKETS - 2);
+    histogram(&text, "snake_input_latency_seconds", "Time from a key press to the tick that applied it.",
+              &metrics->input_ns, 1e-9, DURATION_FIRST, METRICS_BUCKETS - 2);
+
+    append(&text, "# HELP snake_food_spawned_total Food placed on the board, by type.\n"
+                  "# TYPE snake_food_spawned_total counter\n");
+    for (int i = 0; i < 4; i++) {
+        append(&text, "snake_food_spawned_total{type=\"%s\"} %llu\n", food_names[i],
+               (unsigned long long)load(&metrics->food_spawned[i]));
+    }
+    counter(&text, "snake_obstacles_total", "Walls placed by blue apples.", load(&metrics->obstacles));
+    counter(&text, "snake_obstacle_retries_total", "Rejected cells tried before a wall was placed.",
+            load(&metrics->obstacle_retries));
+    // add_obstacle() gives up after 100 tries, so larger buckets stay empty
+    histogram(&text, "snake_obstacle_attempts", "Cells tried per placed wall.",
+              &metrics->obstacle_attempts, 1.0, 0, 7);
+
+    append(&text, "# HELP snake_games_finished_total Games that ended, by final state.\n"
+                  "# TYPE snake_games_finished_total counter\n");
+    for (int i = GAME_OVER; i <= GAME_WON; i++) {
+        append(&text, "snake_games_finished_total{state=\"%s\"} %llu\n", state_names[i],
+               (unsigned long long)load(&metrics->games[i]));
+    }
+    return text.len;
+}
+
+// ========== Listener ==========
+
+static int listen_unix(MetricsServer *server, const char *path) {
+    struct sockaddr_un addr;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, strlen(path));
+    server->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server->fd < 0) {
+        return -1;
+    }
+    // A socket file left by a crashed game would block the name
+    unlink(path);
+    if (bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(server->fd);
+        return -1;
+    }
+    snprintf(server->path, sizeof(server->path), "%s", path);
+    return 0;
+}
+
+static int listen_tcp(MetricsServer *server, const char *address) {
+    struct sockaddr_in addr;
+    const char *colon = strrchr(address, ':');
+    char host[64] = "127.0.0.1";
+    char *end;
+    int one = 1;
+
+    if (colon) {
+        if ((size_t)(colon - address) >= sizeof(host)) {
+            return -1;
+        }
+        memcpy(host, address, (size_t)(colon - address));
+        host[colon - address] = '\0';
+        address = colon + 1;
+    }
+    long port = strtol(address, &end, 10);
+    if (*address == '\0' || *end != '\0' || port < 0 || port > 65535) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    // Metrics are for a local collector only
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1 || (ntohl(addr.sin_addr.s_addr) >> 24) != 127) {
+        return -1;
+    }
+    server->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server->fd < 0) {
+        return -1;
+    }
+    setsockopt(server->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(server->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(server->fd);
+        return -1;
+    }
+    return 0;
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Reads the request head (its contents do not matter), then answers with
+// the current metrics and closes the connection
+static void serve_one(MetricsServer *server, int client) {
+    char request[METRICS_REQUEST_MAX];
+    char body[METRICS_TEXT_MAX];
+    char head[256];
+    size_t got = 0;
+    struct pollfd pfd = { client, POLLIN, 0 };
+
+    while (got < sizeof(request) - 1 && poll(&pfd, 1, METRICS_READ_TIMEOUT_MS) > 0) {
+        ssize_t n = read(client, request + got, sizeof(request) - 1 - got);
+        if (n <= 0) {
+            break;
+        }
+        got += (size_t)n;
+        request[got] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) {
+            break;
+        }
+    }
+
+    size_t len = metrics_format(server->metrics, body, sizeof(body));
+    int head_len = snprintf(head, sizeof(head),
+                            "HTTP/1.0 200 OK\r\n"
+                            "Content-Type: text/plain; version=0.0.4\r\n"
+                            "Content-Length: %zu\r\n"
+                            "Connection: close\r\n\r\n", len);
+    if (write_all(client, head, (size_t)head_len) == 0) {
+        write_all(client, body, len);
+    }
+    server->scrapes++;
+}
+
+static void *metrics_main(void *arg) {
+    MetricsServer *server = arg;
+    struct pollfd fds[2] = {
+        { server->fd, POLLIN, 0 },
+        { server->stop_pipe[0], POLLIN, 0 },
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            int client = accept(server->fd, NULL, NULL);
+            if (client >= 0) {
+                serve_one(server, client);
+                close(client);
+            }
+        }
+    }
+    return NULL;
+}
+
+int metrics_listen(MetricsServer *server, const Metrics *metrics, const char *address) {
+    sigset_t all, old;
+    int result;
+
+    memset(server, 0, sizeof(*server));
+    server->metrics = metrics;
+    server->fd = -1;
+    if (strncmp(address, "unix:", 5) == 0) {
+        result = listen_unix(server, address + 5);
+    } else {
+        result = listen_tcp(server, address);
+    }
+    if (result < 0) {
+        return -1;
+    }
+    if (listen(server->fd, 16) < 0 || pipe(server->stop_pipe) < 0) {
+        metrics_stop(server);
+        return -1;
+    }
+
+    // Signals such as SIGHUP are for the game thread
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    result = pthread_create(&server->thread, NULL, metrics_main, server);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (result != 0) {
+        close(server->stop_pipe[0]);
+        close(server->stop_pipe[1]);
+        server->stop_pipe[0] = server->stop_pipe[1] = 0;
+        metrics_stop(server);
+        return -1;
+    }
+    return 0;
+}
+
+void metrics_stop(MetricsServer *server) {
+    if (server->stop_pipe[1] > 0) {
+        char byte = 1;
+        if (write(server->stop_pipe[1], &byte, 1) == 1) {
+            pthread_join(server->thread, NULL);
+        }
+        close(server->stop_pipe[0]);
+        close(server->stop_pipe[1]);
+        server->stop_pipe[0] = server->stop_pipe[1] = 0;
+    }
+    if (server->fd >= 0) {
+        close(server->fd);
+        server->fd = -1;
+    }
+    if (server->path[0]) {
+        unlink(server->path);
+        server->path[0] = '\0';
+    }
+}
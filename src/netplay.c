@@ -0,0 +1,636 @@
+#include "netplay.h"
+#include <netdb.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+_Static_assert((NET_HISTORY & (NET_HISTORY - 1)) == 0, "net history must be a power of two");
+_Static_assert(sizeof(NetMessage) <= 1400, "a message must fit one datagram on any link");
+
+#define NET_HELLO_RETRY_NS 1000000000ull
+
+// ========== Shared rules ==========
+
+// Game time on both sides is the tick number times the interval, so the
+// speed boost runs out on the same tick for the server and the client
+static _Thread_local uint64_t net_clock_us;
+
+static void net_clock(struct timeval *now) {
+    now->tv_sec = (time_t)(net_clock_us / 1000000);
+    now->tv_usec = (suseconds_t)(net_clock_us % 1000000);
+}
+
+// One tick as both sides play it: turns in arrival order, then update_game()
+// on the tick's own clock and random state
+static int net_step(GameState *game, uint64_t *rng, uint32_t tick, uint32_t interval_us,
+                    const int *turns, int count) {
+    GameClock clock = game_get_clock();
+    uint64_t rng_outside = game_rng_state();
+    int result;
+
+    if (game->state != GAME_RUNNING) {
+        return game->state;
+    }
+    for (int i = 0; i < count; i++) {
+        if (is_valid_direction_change(game->snake.direction, turns[i])) {
+            game->snake.direction = turns[i];
+        }
+    }
+    net_clock_us = (uint64_t)tick * interval_us;
+    game_set_clock(net_clock);
+    game_set_rng_state(*rng);
+    result = update_game(game);
+    *rng = game_rng_state();
+    game_set_rng_state(rng_outside);
+    game_set_clock(clock);
+    return result;
+}
+
+static void clear_message(NetMessage *message, int type) {
+    memset(message, 0, sizeof(*message));
+    message->type = (uint16_t)type;
+}
+
+// ========== Transport ==========
+
+static int net_socket(NetLink *link) {
+    memset(link, 0, sizeof(*link));
+    link->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (link->fd < 0) {
+        return -1;
+    }
+    link->queue = malloc(sizeof(NetDelayed) * NET_QUEUE);
+    if (!link->queue) {
+        close(link->fd);
+        return -1;
+    }
+    link->jitter_rng = 0x9E3779B97F4A7C15ULL;
+    return 0;
+}
+
+int net_listen(NetLink *link, int port) {
+    struct sockaddr_in addr;
+
+    if (net_socket(link) < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(link->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        net_close(link);
+        return -1;
+    }
+    return 0;
+}
+
+int net_connect(NetLink *link, const char *host, int port) {
+    struct addrinfo hints, *found;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, NULL, &hints, &found) != 0) {
+        return -1;
+    }
+    if (net_socket(link) < 0) {
+        freeaddrinfo(found);
+        return -1;
+    }
+    memcpy(&link->peer, found->ai_addr, sizeof(link->peer));
+    link->peer.sin_port = htons((uint16_t)port);
+    link->has_peer = 1;
+    link->connected = 1;
+    freeaddrinfo(found);
+    return 0;
+}
+
+int net_local_port(const NetLink *link) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    if (getsockname(link->fd, (struct sockaddr *)&addr, &len) < 0) {
+        return -1;
+    }
+    return ntohs(addr.sin_port);
+}
+
+void net_set_delay(NetLink *link, uint64_t delay_ns, uint64_t jitter_ns) {
+    link->delay_ns = delay_ns;
+    link->jitter_ns = jitter_ns;
+}
+
+int net_send(NetLink *link, NetMessage *message) {
+    if (!link->has_peer) {
+        return -1;
+    }
+    message->magic = NET_MAGIC;
+    if (sendto(link->fd, message, sizeof(*message), 0, (struct sockaddr *)&link->peer,
+               sizeof(link->peer)) != (ssize_t)sizeof(*message)) {
+        return -1;
+    }
+    link->sent++;
+    return 0;
+}
+
+static uint64_t jitter(NetLink *link) {
+    uint64_t z;
+
+    if (link->jitter_ns == 0) {
+        return 0;
+    }
+    z = (link->jitter_rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (z ^ (z >> 31)) % (link->jitter_ns + 1);
+}
+
+static int same_address(const struct sockaddr_in *a, const struct sockaddr_in *b) {
+    return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+int net_receive(NetLink *link, NetMessage *message, uint64_t now_ns) {
+    int best = -1;
+
+    // Everything the socket holds goes into the delay queue first
+    while (link->queued < NET_QUEUE) {
+        NetDelayed *slot = &link->queue[link->queued];
+        struct sockaddr_in from;
+        socklen_t len = sizeof(from);
+        ssize_t n = recvfrom(link->fd, &slot->message, sizeof(slot->message), 0,
+                             (struct sockaddr *)&from, &len);
+        if (n < 0) {
+            break;
+        }
+        if (n != (ssize_t)sizeof(slot->message) || slot->message.magic != NET_MAGIC) {
+            link->dropped++;
+            continue;
+        }
+        // A client only listens to its server; the server only changes
+        // partners when someone says hello
+        if (link->connected || slot->message.type != NET_HELLO) {
+            if (!link->has_peer || !same_address(&from, &link->peer)) {
+                link->dropped++;
+                continue;
+            }
+        } else {
+            link->peer = from;
+            link->has_peer = 1;
+        }
+        slot->due_ns = now_ns + link->delay_ns + jitter(link);
+        slot->order = link->arrivals++;
+        link->queued++;
+        link->received++;
+    }
+
+    for (int i = 0; i < link->queued; i++) {
+        const NetDelayed *slot = &link->queue[i];
+        if (slot->due_ns <= now_ns &&
+            (best < 0 || slot->due_ns < link->queue[best].due_ns ||
+             (slot->due_ns == link->queue[best].due_ns && slot->order < link->queue[best].order))) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return 0;
+    }
+    *message = link->queue[best].message;
+    link->queue[best] = link->queue[--link->queued];
+    return 1;
+}
+
+void net_wait(NetLink *link, uint64_t now_ns, uint64_t until_ns) {
+    struct pollfd pfd = { link->fd, POLLIN, 0 };
+
+    for (int i = 0; i < link->queued; i++) {
+        if (link->queue[i].due_ns < until_ns) {
+            until_ns = link->queue[i].due_ns;
+        }
+    }
+    if (until_ns <= now_ns) {
+        return;
+    }
+    // Rounded up so a deadline is never woken for just before it is due
+    poll(&pfd, 1, (int)((until_ns - now_ns + 999999) / 1000000));
+}
+
+void net_close(NetLink *link) {
+    if (link->fd >= 0) {
+        close(link->fd);
+        link->fd = -1;
+    }
+    free(link->queue);
+    link->queue = NULL;
+}
+
+// ========== Server ==========
+
+void net_server_init(NetServer *server, const GameState *start, uint64_t rng, uint32_t interval_us) {
+    memset(server, 0, sizeof(*server));
+    server->start = *start;
+    server->start.events = NULL;
+    server->start.foods = NULL;
+    server->rng = rng;
+    server->interval_us = interval_us;
+    net_server_restart(server);
+}
+
+void net_server_restart(NetServer *server) {
+    server->game = server->start;
+    server->tick = 0;
+    server->number++;
+    server->received = 0;
+    server->pending_count = 0;
+    server->games++;
+}
+
+static void echo(const NetServer *server, NetMessage *out, uint64_t now_ns) {
+    if (server->echo_ns) {
+        out->echo_ns = server->echo_ns;
+        out->hold_ns = now_ns - server->echo_arrival_ns;
+    }
+}
+
+void net_server_start_message(const NetServer *server, NetMessage *out, uint64_t now_ns) {
+    clear_message(out, NET_START);
+    out->tick = server->tick;
+    out->game = server->number;
+    out->interval_us = server->interval_us;
+    out->rng = server->rng;
+    out->state = server->game;
+    echo(server, out, now_ns);
+}
+
+void net_server_input(NetServer *server, const NetMessage *inputs, uint64_t now_ns) {
+    if (inputs->game != server->number) {
+        return;
+    }
+    if (inputs->echo_ns > server->echo_ns) {
+        server->echo_ns = inputs->echo_ns;
+        server->echo_arrival_ns = now_ns;
+    }
+    // Packets repeat every turn the server has not acknowledged yet
+    for (int i = 0; i < inputs->count && i < NET_INPUTS_MAX; i++) {
+        const NetInput *input = &inputs->inputs[i];
+        if (input->direction < DIR_UP || input->direction > DIR_LEFT) {
+            server->rejected++;
+            continue;
+        }
+        if (input->tick <= server->received || server->pending_count >= NET_HISTORY) {
+            continue;
+        }
+        server->received = input->tick;
+        if (input->tick <= server->tick) {
+            server->late++;
+        }
+        server->pending[server->pending_count++] = *input;
+    }
+}
+
+int net_server_tick(NetServer *server, NetMessage *out, uint64_t now_ns) {
+    uint32_t tick = server->tick + 1;
+    int turns[NET_HISTORY];
+    int count = 0, kept = 0;
+    int result;
+
+    // Late turns are applied now: the server never goes back in time
+    for (int i = 0; i < server->pending_count; i++) {
+        if (server->pending[i].tick <= tick) {
+            turns[count++] = server->pending[i].direction;
+        } else {
+            server->pending[kept++] = server->pending[i];
+        }
+    }
+    server->pending_count = kept;
+
+    result = net_step(&server->game, &server->rng, tick, server->interval_us, turns, count);
+    server->tick = tick;
+    server->ticks++;
+
+    clear_message(out, NET_STATE);
+    out->tick = tick;
+    out->ack = server->received;
+    out->game = server->number;
+    out->rng = server->rng;
+    out->state = server->game;
+    echo(server, out, now_ns);
+    return result;
+}
+
+int net_serve(NetLink *link, NetServer *server, const volatile sig_atomic_t *stop) {
+    NetMessage message, out;
+    uint64_t interval_ns = (uint64_t)server->interval_us * 1000;
+    uint64_t deadline = 0;
+    int started = 0;
+
+    while (!*stop) {
+        uint64_t now = input_now_ns();
+
+        while (net_receive(link, &message, now)) {
+            if (message.type == NET_HELLO) {
+                // A client that did not get its start (or came back) begins a new game
+                if (started) {
+                    net_server_restart(server);
+                }
+                server->echo_ns = message.echo_ns;
+                server->echo_arrival_ns = now;
+                net_server_start_message(server, &out, now);
+                net_send(link, &out);
+                started = 1;
+                deadline = now + interval_ns;
+            } else if (message.type == NET_INPUTS && started) {
+                net_server_input(server, &message, now);
+            } else if (message.type == NET_BYE) {
+                return 0;
+            }
+        }
+        if (!started || now < deadline) {
+            net_wait(link, now, started ? deadline : now + 100000000ull);
+            continue;
+        }
+
+        int state = net_server_tick(server, &out, now);
+        net_send(link, &out);
+        deadline = deadline + interval_ns > now ? deadline + interval_ns : now + interval_ns;
+        if (state != GAME_RUNNING) {
+            net_server_restart(server);
+            net_server_start_message(server, &out, now);
+            net_send(link, &out);
+        }
+    }
+    return 0;
+}
+
+// ========== Client prediction ==========
+
+#define SLOT(tick) ((tick) & (NET_HISTORY - 1))
+
+void net_predict_init(NetPredictor *predictor) {
+    memset(predictor, 0, sizeof(*predictor));
+}
+
+static int in_grid(Point p) {
+    return p.x >= 0 && p.x < GRID_W && p.y >= 0 && p.y < GRID_H;
+}
+
+static int on_board(Point p) {
+    return p.x >= 1 && p.x <= WIDTH && p.y >= 1 && p.y <= HEIGHT;
+}
+
+// A received state is played and drawn as it is, so every count and
+// coordinate that indexes an array has to be in range first
+static int state_is_valid(const GameState *state) {
+    const Snake *snake = &state->snake;
+    const Obstacles *obstacles = &state->obstacles;
+
+    if (snake->length < 1 || snake->length > MAX_SNAKE_LENGTH ||
+        snake->direction < DIR_UP || snake->direction > DIR_LEFT ||
+        obstacles->count < 0 || obstacles->count > MAX_OBSTACLES ||
+        state->food.type < FOOD_REGULAR || state->food.type > FOOD_BLUE ||
+        state->state < GAME_RUNNING || state->state > GAME_PAUSED) {
+        return 0;
+    }
+    // The head may sit on the border once the snake has hit a wall
+    for (int i = 0; i < snake->length; i++) {
+        if (!in_grid(snake->body[i])) {
+            return 0;
+        }
+    }
+    for (int i = 0; i < obstacles->count; i++) {
+        if (!on_board(obstacles->obstacles[i])) {
+            return 0;
+        }
+    }
+    return !state->food.active || on_board(state->food.position);
+}
+
+int net_predict_start(NetPredictor *predictor, const NetMessage *start, uint64_t now_ns) {
+    if (start->interval_us == 0 || !state_is_valid(&start->state)) {
+        predictor->rejected++;
+        return -1;
+    }
+    predictor->game = start->state;
+    predictor->game.events = NULL;
+    predictor->game.foods = NULL;
+    predictor->rng = start->rng;
+    predictor->tick = predictor->confirmed = start->tick;
+    predictor->acked = 0;
+    predictor->interval_us = start->interval_us;
+    predictor->number = start->game;
+    predictor->started = 1;
+    memset(predictor->turn_count, 0, sizeof(predictor->turn_count));
+    memset(predictor->sent, 0, sizeof(predictor->sent));
+    predictor->states[SLOT(start->tick)] = predictor->game;
+    predictor->rngs[SLOT(start->tick)] = predictor->rng;
+    predictor->server_tick = start->tick;
+    predictor->server_tick_ns = now_ns;
+    if (start->echo_ns && now_ns > start->echo_ns + start->hold_ns) {
+        predictor->rtt_ns = now_ns - start->echo_ns - start->hold_ns;
+    }
+    return 0;
+}
+
+// Replays one tick with the turns currently planned for it
+static int predict_step(NetPredictor *predictor, uint32_t tick) {
+    uint32_t slot = SLOT(tick);
+    int turns[NET_TURNS];
+    int count = predictor->turn_count[slot];
+    int result;
+
+    for (int i = 0; i < count; i++) {
+        turns[i] = predictor->sent[SLOT(predictor->turns[slot][i])].direction;
+    }
+    result = net_step(&predictor->game, &predictor->rng, tick, predictor->interval_us, turns, count);
+    predictor->states[slot] = predictor->game;
+    predictor->rngs[slot] = predictor->rng;
+    return result;
+}
+
+int net_predict_tick(NetPredictor *predictor, int direction, uint64_t key_ns, uint64_t now_ns) {
+    uint32_t tick = predictor->tick + 1;
+    uint32_t slot = SLOT(tick);
+    int current = predictor->game.snake.direction;
+    int result;
+
+    if (direction >= DIR_UP && direction <= DIR_LEFT && direction != current &&
+        is_valid_direction_change(current, direction) && predictor->turn_count[slot] < NET_TURNS) {
+        NetSent *sent = &predictor->sent[slot];
+        sent->tick = tick;
+        sent->direction = direction;
+        sent->slot = tick;
+        sent->key_ns = key_ns;
+        sent->confirmed = 0;
+        predictor->turns[slot][predictor->turn_count[slot]++] = tick;
+        input_latency_add(&predictor->predicted, now_ns > key_ns ? now_ns - key_ns : 0);
+    }
+    result = predict_step(predictor, tick);
+    predictor->tick = tick;
+    predictor->turn_count[SLOT(tick + 1)] = 0;
+    return result;
+}
+
+// Oldest tick still in the history
+static uint32_t history_start(const NetPredictor *predictor) {
+    return predictor->tick >= NET_HISTORY ? predictor->tick - NET_HISTORY + 1 : 1;
+}
+
+int net_predict_inputs(const NetPredictor *predictor, NetMessage *out, uint64_t now_ns) {
+    uint32_t first = history_start(predictor);
+
+    clear_message(out, NET_INPUTS);
+    out->tick = predictor->tick;
+    out->game = predictor->number;
+    out->echo_ns = now_ns;
+    if (first <= predictor->acked) {
+        first = predictor->acked + 1;
+    }
+    for (uint32_t tick = first; tick <= predictor->tick && out->count < NET_INPUTS_MAX; tick++) {
+        const NetSent *sent = &predictor->sent[SLOT(tick)];
+        if (sent->tick == tick) {
+            out->inputs[out->count].tick = tick;
+            out->inputs[out->count].direction = sent->direction;
+            out->count++;
+        }
+    }
+    return out->count;
+}
+
+static void remove_turn(NetPredictor *predictor, uint32_t slot_tick, uint32_t tick) {
+    uint32_t slot = SLOT(slot_tick);
+    int kept = 0;
+
+    for (int i = 0; i < predictor->turn_count[slot]; i++) {
+        if (predictor->turns[slot][i] != tick) {
+            predictor->turns[slot][kept++] = predictor->turns[slot][i];
+        }
+    }
+    predictor->turn_count[slot] = (uint8_t)kept;
+}
+
+// Turns sent for ticks up to `tick` that the server had not received by then
+// will be applied on its next tick, so that is where they are predicted now
+static int reschedule_late(NetPredictor *predictor, uint32_t tick, uint32_t ack) {
+    uint32_t late[NET_TURNS];
+    uint32_t next = SLOT(tick + 1);
+    int count = 0;
+
+    for (uint32_t t = history_start(predictor); t <= tick && count < NET_TURNS; t++) {
+        NetSent *sent = &predictor->sent[SLOT(t)];
+        if (sent->tick != t || t <= ack || sent->slot > tick) {
+            continue;
+        }
+        remove_turn(predictor, sent->slot, t);
+        sent->slot = tick + 1;
+        late[count++] = t;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    // They arrived before anything planned for that tick
+    int existing = predictor->turn_count[next];
+    if (existing > NET_TURNS - count) {
+        existing = NET_TURNS - count;
+    }
+    memmove(&predictor->turns[next][count], predictor->turns[next], sizeof(uint32_t) * existing);
+    memcpy(predictor->turns[next], late, sizeof(uint32_t) * count);
+    predictor->turn_count[next] = (uint8_t)(count + existing);
+    return count;
+}
+
+int net_predict_confirm(NetPredictor *predictor, const NetMessage *state, uint64_t now_ns) {
+    uint32_t tick = state->tick;
+    GameState authority = state->state;
+    uint32_t applied;
+
+    if (!predictor->started || state->game != predictor->number || tick <= predictor->confirmed) {
+        return -1;
+    }
+    if (!state_is_valid(&state->state)) {
+        predictor->rejected++;
+        return -1;
+    }
+    authority.events = NULL;
+    authority.foods = NULL;
+
+    predictor->server_tick = tick;
+    predictor->server_tick_ns = now_ns;
+    if (state->echo_ns && now_ns > state->echo_ns + state->hold_ns) {
+        uint64_t sample = now_ns - state->echo_ns - state->hold_ns;
+        predictor->rtt_ns = predictor->rtt_ns ? (predictor->rtt_ns * 7 + sample) / 8 : sample;
+    }
+    if (state->ack > predictor->acked) {
+        predictor->acked = state->ack;
+    }
+    predictor->confirms++;
+
+    // Turns the server has applied by this tick are now visible without prediction
+    applied = state->ack < tick ? state->ack : tick;
+    for (uint32_t t = history_start(predictor); t <= applied; t++) {
+        NetSent *sent = &predictor->sent[SLOT(t)];
+        if (sent->tick == t && !sent->confirmed) {
+            sent->confirmed = 1;
+            input_latency_add(&predictor->authoritative, now_ns - sent->key_ns);
+        }
+    }
+
+    // The server got ahead of the prediction: take its state as it is
+    if (tick > predictor->tick) {
+        predictor->game = authority;
+        predictor->rng = state->rng;
+        predictor->tick = tick;
+        predictor->states[SLOT(tick)] = authority;
+        predictor->rngs[SLOT(tick)] = state->rng;
+        predictor->turn_count[SLOT(tick + 1)] = 0;
+        predictor->confirmed = tick;
+        predictor->snaps++;
+        return 0;
+    }
+
+    int rescheduled = reschedule_late(predictor, tick, state->ack);
+    uint32_t slot = SLOT(tick);
+    if (!rescheduled && predictor->rngs[slot] == state->rng &&
+        game_state_hash(&predictor->states[slot]) == game_state_hash(&authority)) {
+        predictor->confirmed = tick;
+        return 0;
+    }
+
+    // Roll back to the server's state and play the predicted ticks again
+    uint64_t start = input_now_ns();
+    predictor->game = authority;
+    predictor->rng = state->rng;
+    predictor->states[slot] = authority;
+    predictor->rngs[slot] = state->rng;
+    for (uint32_t t = tick + 1; t <= predictor->tick; t++) {
+        predict_step(predictor, t);
+    }
+    uint64_t elapsed = input_now_ns() - start;
+
+    predictor->confirmed = tick;
+    predictor->corrections++;
+    predictor->resimulated += predictor->tick - tick;
+    predictor->resim_ns += elapsed;
+    if (elapsed > predictor->resim_max_ns) {
+        predictor->resim_max_ns = elapsed;
+    }
+    return (int)(predictor->tick - tick);
+}
+
+uint64_t net_predict_next_ns(const NetPredictor *predictor) {
+    int64_t interval_ns = (int64_t)predictor->interval_us * 1000;
+    int64_t ahead = (int64_t)predictor->tick + 1 - predictor->server_tick - NET_LEAD_MARGIN;
+    int64_t due = (int64_t)predictor->server_tick_ns - (int64_t)predictor->rtt_ns + ahead * interval_ns;
+
+    return due > 0 ? (uint64_t)due : 0;
+}
+
+int net_predict_due(const NetPredictor *predictor, uint64_t now_ns) {
+    if (!predictor->started || predictor->tick - predictor->confirmed >= NET_HISTORY - 2) {
+        return 0;
+    }
+    return now_ns >= net_predict_next_ns(predictor);
+}
@@ -0,0 +1,405 @@
+#include "persist_game.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The window plus the head being pushed never spans more chunks than there are slots
+_Static_assert(MAX_SNAKE_LENGTH / PERSIST_CHUNK + 2 <= PERSIST_SLOTS, "spine too small for the longest snake");
+_Static_assert((PERSIST_SLOTS & (PERSIST_SLOTS - 1)) == 0, "spine slots must be a power of two");
+
+#define SLOT(chunk) ((chunk) & (PERSIST_SLOTS - 1))
+
+typedef union PoolBlock {
+    union PoolBlock *next;
+    PersistChunk chunk;
+    PersistSpine spine;
+} PoolBlock;
+
+typedef struct PoolSlab {
+    struct PoolSlab *next;
+    PoolBlock blocks[PERSIST_SLAB];
+} PoolSlab;
+
+// ========== Pool ==========
+
+void persist_pool_init(PersistPool *pool) {
+    memset(pool, 0, sizeof(*pool));
+}
+
+void persist_pool_destroy(PersistPool *pool) {
+    PoolSlab *slab = pool->slabs;
+
+    while (slab) {
+        PoolSlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    memset(pool, 0, sizeof(*pool));
+}
+
+// Makes sure `count` blocks can be taken without failing halfway through a step
+static int pool_reserve(PersistPool *pool, unsigned long count) {
+    while (pool->free_count < count) {
+        PoolSlab *slab = malloc(sizeof(PoolSlab));
+        if (!slab) {
+            return -1;
+        }
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        for (int i = PERSIST_SLAB - 1; i >= 0; i--) {
+            slab->blocks[i].next = pool->free_blocks;
+            pool->free_blocks = &slab->blocks[i];
+        }
+        pool->free_count += PERSIST_SLAB;
+        pool->bytes += sizeof(PoolSlab);
+    }
+    return 0;
+}
+
+static void *pool_take(PersistPool *pool) {
+    PoolBlock *block = pool->free_blocks;
+
+    pool->free_blocks = block->next;
+    pool->free_count--;
+    return block;
+}
+
+static void pool_give(PersistPool *pool, void *block) {
+    ((PoolBlock *)block)->next = pool->free_blocks;
+    pool->free_blocks = block;
+    pool->free_count++;
+}
+
+static void chunk_release(PersistPool *pool, PersistChunk *chunk) {
+    if (chunk && --chunk->refs == 0) {
+        pool->chunks_live--;
+        pool_give(pool, chunk);
+    }
+}
+
+static void spine_release(PersistPool *pool, PersistSpine *spine) {
+    if (--spine->refs > 0) {
+        return;
+    }
+    for (int i = 0; i < PERSIST_SLOTS; i++) {
+        chunk_release(pool, spine->chunks[i]);
+    }
+    pool->spines_live--;
+    pool_give(pool, spine);
+}
+
+// ========== Body ==========
+
+static Point history_at(const PersistBody *body, uint32_t index) {
+    return body->spine->chunks[SLOT(index / PERSIST_CHUNK)]->points[index % PERSIST_CHUNK];
+}
+
+Point persist_body_at(const PersistBody *body, int i) {
+    if (i >= body->distinct) {
+        i = body->distinct - 1;
+    }
+    return history_at(body, body->pushed - 1 - (uint32_t)i);
+}
+
+int persist_body_length(const PersistBody *body) {
+    return body->distinct + body->stacked;
+}
+
+// Whether segment `from` or any later one is on (x, y)
+static int body_contains(const PersistBody *body, int x, int y, int from) {
+    uint32_t oldest = body->pushed - body->distinct;
+
+    for (uint32_t index = body->pushed - 1 - (uint32_t)from; index + 1 > oldest; index--) {
+        Point p = history_at(body, index);
+        if (p.x == x && p.y == y) {
+            return 1;
+        }
+        if (index == 0) {
+            break;
+        }
+    }
+    // Stacked segments all sit on the last distinct one
+    if (body->stacked > 0 && from >= body->distinct) {
+        Point tail = persist_body_at(body, body->distinct - 1);
+        return tail.x == x && tail.y == y;
+    }
+    return 0;
+}
+
+// Appends the next head to the history. The caller has reserved two blocks
+static void body_push(PersistPool *pool, PersistBody *body, Point head) {
+    PersistSpine *spine = body->spine;
+    uint32_t index = body->pushed;
+    int offset = (int)(index % PERSIST_CHUNK);
+    int slot = (int)SLOT(index / PERSIST_CHUNK);
+
+    // A spine shared with another branch is copied before the first change
+    if (spine->refs > 1) {
+        PersistSpine *copy = pool_take(pool);
+        copy->refs = 1;
+        for (int i = 0; i < PERSIST_SLOTS; i++) {
+            copy->chunks[i] = spine->chunks[i];
+            if (copy->chunks[i]) {
+                copy->chunks[i]->refs++;
+            }
+        }
+        spine->refs--;
+        spine = body->spine = copy;
+        pool->spines_live++;
+        pool->spine_copies++;
+    }
+
+    PersistChunk *chunk = spine->chunks[slot];
+    if (offset == 0) {
+        chunk_release(pool, chunk);
+        chunk = pool_take(pool);
+        chunk->refs = 1;
+        spine->chunks[slot] = chunk;
+        pool->chunks_live++;
+    } else if (chunk->refs > 1) {
+        // Only the points up to the head are copied; later ones are never read
+        PersistChunk *copy = pool_take(pool);
+        copy->refs = 1;
+        memcpy(copy->points, chunk->points, sizeof(Point) * (size_t)offset);
+        chunk->refs--;
+        chunk = spine->chunks[slot] = copy;
+        pool->chunks_live++;
+        pool->chunk_copies++;
+    }
+    chunk->points[offset] = head;
+    body->pushed++;
+}
+
+// Moves the snake: the new head goes in front and, unless the snake has
+// grown segments waiting on its tail, the tail leaves the window
+static int body_move(PersistPool *pool, PersistBody *body, Point head) {
+    if (pool_reserve(pool, 2) < 0) {
+        return -1;
+    }
+    body_push(pool, body, head);
+    if (body->stacked > 0) {
+        body->stacked--;
+        body->distinct++;
+        return 0;
+    }
+
+    // A chunk the tail has just left is no longer in this branch's window
+    uint32_t left = body->pushed - 1 - body->distinct;
+    if ((left + 1) % PERSIST_CHUNK == 0) {
+        int slot = (int)SLOT(left / PERSIST_CHUNK);
+        PersistSpine *spine = body->spine;
+        chunk_release(pool, spine->chunks[slot]);
+        spine->chunks[slot] = NULL;
+    }
+    return 0;
+}
+
+// ========== Game ==========
+
+int persist_game_from_state(PersistGame *game, PersistPool *pool, const GameState *state) {
+    const Snake *snake = &state->snake;
+    Point tail = snake->body[snake->length - 1];
+    int distinct = snake->length;
+
+    // Copies of the tail left by grow_snake() become the stacked count
+    while (distinct > 1 && snake->body[distinct - 2].x == tail.x &&
+           snake->body[distinct - 2].y == tail.y) {
+        distinct--;
+    }
+    if (pool_reserve(pool, 1 + (unsigned long)distinct / PERSIST_CHUNK + 1) < 0) {
+        return -1;
+    }
+
+    game->pool = pool;
+    game->body.spine = pool_take(pool);
+    memset(game->body.spine, 0, sizeof(PersistSpine));
+    game->body.spine->refs = 1;
+    pool->spines_live++;
+    game->body.pushed = 0;
+    game->body.distinct = (uint16_t)distinct;
+    game->body.stacked = (uint16_t)(snake->length - distinct);
+    for (int i = distinct - 1; i >= 0; i--) {
+        body_push(pool, &game->body, snake->body[i]);
+    }
+
+    game->direction = snake->direction;
+    game->food = state->food;
+    game->obstacles = state->obstacles;
+    game->speed_boost = state->speed_boost;
+    game->score = state->score;
+    game->state = state->state;
+    game->apples_eaten = state->apples_eaten;
+    memcpy(game->special_apples_eaten, state->special_apples_eaten,
+           sizeof(game->special_apples_eaten));
+    return 0;
+}
+
+void persist_game_to_state(const PersistGame *game, GameState *state) {
+    init_game_state(state);
+    state->snake.length = persist_body_length(&game->body);
+    state->snake.direction = game->direction;
+    for (int i = 0; i < state->snake.length; i++) {
+        state->snake.body[i] = persist_body_at(&game->body, i);
+    }
+    snake_rehash(&state->snake);
+
+    state->food = game->food;
+    state->obstacles = game->obstacles;
+    obstacles_rehash(&state->obstacles);
+    state->speed_boost = game->speed_boost;
+    state->score = game->score;
+    state->state = game->state;
+    state->apples_eaten = game->apples_eaten;
+    memcpy(state->special_apples_eaten, game->special_apples_eaten,
+           sizeof(state->special_apples_eaten));
+}
+
+void persist_game_fork(PersistGame *branch, const PersistGame *src) {
+    *branch = *src;
+    branch->body.spine->refs++;
+}
+
+void persist_game_release(PersistGame *game) {
+    if (game->body.spine) {
+        spine_release(game->pool, game->body.spine);
+        game->body.spine = NULL;
+    }
+}
+
+void persist_game_turn(PersistGame *game, int direction) {
+    if (is_valid_direction_change(game->direction, direction)) {
+        game->direction = direction;
+    }
+}
+
+static void grow(PersistGame *game, int amount) {
+    for (int i = 0; i < amount; i++) {
+        if (persist_body_length(&game->body) < MAX_SNAKE_LENGTH) {
+            game->body.stacked++;
+        }
+    }
+}
+
+static void spawn_food(PersistGame *game) {
+    Food *food = &game->food;
+    int valid = 0;
+    int attempts = 0;
+
+    // Same draws in the same order as generate_food()
+    int r = game_rand() % 100;
+    if (r < 60) {
+        food->type = FOOD_REGULAR;
+    } else if (r < 75) {
+        food->type = FOOD_GREEN;
+    } else if (r < 85) {
+        food->type = FOOD_GOLD;
+    } else {
+        food->type = FOOD_BLUE;
+    }
+
+    while (!valid && attempts < 1000) {
+        food->position.x = game_rand() % WIDTH + 1;
+        food->position.y = game_rand() % HEIGHT + 1;
+        valid = !body_contains(&game->body, food->position.x, food->position.y, 0) &&
+                !grid_test(&game->obstacles.grid, food->position.x, food->position.y);
+        attempts++;
+    }
+    food->active = 1;
+}
+
+static void place_obstacle(PersistGame *game) {
+    Obstacles *obstacles = &game->obstacles;
+    int valid = 0;
+    int attempts = 0;
+    Point p;
+
+    if (obstacles->count >= MAX_OBSTACLES) {
+        return;
+    }
+
+    // Same draws in the same order as add_obstacle()
+    while (!valid && attempts < 100) {
+        p.x = game_rand() % WIDTH + 1;
+        p.y = game_rand() % HEIGHT + 1;
+        valid = !body_contains(&game->body, p.x, p.y, 0) &&
+                !grid_test(&obstacles->grid, p.x, p.y) &&
+                !(game->food.active &&
+                  abs(p.x - game->food.position.x) < 3 &&
+                  abs(p.y - game->food.position.y) < 3) &&
+                can_place_obstacle(obstacles, p.x, p.y);
+        attempts++;
+    }
+
+    if (valid) {
+        obstacles->obstacles[obstacles->count++] = p;
+        grid_set(&obstacles->grid, p.x, p.y);
+    }
+}
+
+static void eat(PersistGame *game) {
+    game->apples_eaten++;
+    game->special_apples_eaten[game->food.type]++;
+
+    switch (game->food.type) {
+        case FOOD_REGULAR:
+            game->score += 10;
+            grow(game, 1);
+            break;
+        case FOOD_GREEN:
+            game->score += 20;
+            grow(game, 2);
+            break;
+        case FOOD_GOLD:
+            game->score += 50;
+            grow(game, 1);
+            activate_speed_boost(&game->speed_boost);
+            break;
+        case FOOD_BLUE:
+            game->score += 15;
+            grow(game, 1);
+            place_obstacle(game);
+            break;
+    }
+    game->food.active = 0;
+}
+
+int persist_game_step(PersistGame *game) {
+    Point head = persist_body_at(&game->body, 0);
+
+    if (game->state == GAME_PAUSED) {
+        return GAME_PAUSED;
+    }
+    switch (game->direction) {
+        case DIR_UP:    head.y--; break;
+        case DIR_RIGHT: head.x++; break;
+        case DIR_DOWN:  head.y++; break;
+        case DIR_LEFT:  head.x--; break;
+    }
+    if (body_move(game->pool, &game->body, head) < 0) {
+        return -1;
+    }
+
+    if (head.x <= 0 || head.x >= WIDTH + 1 || head.y <= 0 || head.y >= HEIGHT + 1 ||
+        body_contains(&game->body, head.x, head.y, 1) ||
+        grid_test(&game->obstacles.grid, head.x, head.y)) {
+        game->state = GAME_OVER;
+        return GAME_OVER;
+    }
+
+    if (persist_body_length(&game->body) >= WIN_LENGTH) {
+        game->state = GAME_WON;
+        return GAME_WON;
+    }
+
+    if (game->food.active &&
+        head.x == game->food.position.x && head.y == game->food.position.y) {
+        eat(game);
+    }
+    if (!game->food.active) {
+        spawn_food(game);
+    }
+
+    if (game->speed_boost.active && !is_speed_boost_active(&game->speed_boost)) {
+        game->speed_boost.active = 0;
+    }
+    return GAME_RUNNING;
+}
@@ -0,0 +1,207 @@
+#include "policy.h"
+#include "checksum.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CHECKPOINT_MAGIC "SNKEVO01"
+
+_Static_assert(sizeof(Policy) % (8 * sizeof(float)) == 0, "policy weights come in blocks of 8");
+_Static_assert(POLICY_INPUTS % 8 == 0 && POLICY_HIDDEN % 8 == 0, "layers are padded to 8");
+
+typedef struct {
+    char magic[8];
+    uint32_t genes;              // POLICY_GENES of the writer
+    uint32_t count;
+    uint32_t generation;
+    uint32_t crc;                // Fitness values and genomes
+    uint64_t rng_state;
+} CheckpointHeader;
+
+static const int dir_dx[4] = { 0, 1, 0, -1 };
+static const int dir_dy[4] = { -1, 0, 1, 0 };
+
+static int blocked(const FastGame *game, int x, int y) {
+    if (x <= 0 || x > WIDTH || y <= 0 || y > HEIGHT) {
+        return 1;
+    }
+    return game->cells[y][x] != 0 || grid_test(&game->obstacles.grid, x, y);
+}
+
+void policy_features(const FastGame *game, float inputs[POLICY_INPUTS]) {
+    Point head = game->ring[game->head];
+    int n = 0;
+
+    memset(inputs, 0, sizeof(float) * POLICY_INPUTS);
+    for (int d = 0; d < 4; d++) {
+        int x = head.x + dir_dx[d];
+        int y = head.y + dir_dy[d];
+        int run = 0;
+
+        inputs[n++] = (float)blocked(game, x, y);
+        while (!blocked(game, x, y)) {
+            run++;
+            x += dir_dx[d];
+            y += dir_dy[d];
+        }
+        inputs[n++] = (float)run / WIDTH;
+    }
+
+    if (game->food.active) {
+        inputs[n] = (float)(game->food.position.x - head.x) / WIDTH;
+        inputs[n + 1] = (float)(game->food.position.y - head.y) / HEIGHT;
+        inputs[n + 2 + game->food.type] = 1.0f;
+    }
+    n += 6;
+
+    inputs[n++] = (float)game->speed_boost.active;
+    inputs[n + game->direction] = 1.0f;
+    n += 4;
+    inputs[n++] = (float)game->length / WIN_LENGTH;
+    inputs[n++] = 1.0f;
+}
+
+// Accumulates whole layers one input at a time: every unit is an
+// independent lane, so the inner loops vectorize without reassociation
+void policy_eval(const Policy *policy, const float inputs[POLICY_INPUTS],
+                 float outputs[POLICY_OUTPUTS]) {
+    float hidden[POLICY_HIDDEN] __attribute__((aligned(32)));
+    float out[POLICY_OUTPUTS];
+
+    memcpy(hidden, policy->b1, sizeof(hidden));
+    for (int i = 0; i < POLICY_INPUTS; i++) {
+        float in = inputs[i];
+        for (int h = 0; h < POLICY_HIDDEN; h++) {
+            hidden[h] += policy->w1[i][h] * in;
+        }
+    }
+    for (int h = 0; h < POLICY_HIDDEN; h++) {
+        hidden[h] = hidden[h] > 0.0f ? hidden[h] : 0.0f;
+    }
+
+    memcpy(out, policy->b2, sizeof(out));
+    for (int h = 0; h < POLICY_HIDDEN; h++) {
+        float in = hidden[h];
+        for (int o = 0; o < POLICY_OUTPUTS; o++) {
+            out[o] += policy->w2[h][o] * in;
+        }
+    }
+    memcpy(outputs, out, sizeof(out));
+}
+
+int policy_act(const Policy *policy, const FastGame *game) {
+    float inputs[POLICY_INPUTS] __attribute__((aligned(32)));
+    float outputs[POLICY_OUTPUTS];
+    int best = game->direction;
+
+    policy_features(game, inputs);
+    policy_eval(policy, inputs, outputs);
+    for (int d = 0; d < POLICY_OUTPUTS; d++) {
+        if (is_valid_direction_change(game->direction, d) && outputs[d] > outputs[best]) {
+            best = d;
+        }
+    }
+    return best;
+}
+
+// ========== Checkpoints ==========
+
+static uint32_t population_crc(const Policy *population, const float *fitness, int count) {
+    uint32_t crc = crc32_update(0, fitness, sizeof(float) * count);
+    return crc32_update(crc, population, sizeof(Policy) * count);
+}
+
+int policy_save_population(const char *path, const Policy *population, const float *fitness,
+                           int count, int generation, uint64_t rng_state) {
+    char tmp_path[4096];
+    CheckpointHeader header;
+    FILE *out;
+    int ok = 1;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.genes = (uint32_t)POLICY_GENES;
+    header.count = (uint32_t)count;
+    header.generation = (uint32_t)generation;
+    header.rng_state = rng_state;
+    header.crc = population_crc(population, fitness, count);
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    out = fopen(tmp_path, "wb");
+    if (!out) {
+        return -1;
+    }
+    ok &= fwrite(&header, sizeof(header), 1, out) == 1;
+    ok &= fwrite(fitness, sizeof(float), count, out) == (size_t)count;
+    ok &= fwrite(population, sizeof(Policy), count, out) == (size_t)count;
+    ok &= fflush(out) == 0 && fsync(fileno(out)) == 0;
+    ok &= fclose(out) == 0;
+
+    if (!ok || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int policy_load_population(const char *path, Policy *population, float *fitness,
+                           int *count, int *generation, uint64_t *rng_state) {
+    CheckpointHeader header;
+    FILE *in = fopen(path, "rb");
+    int ok;
+
+    if (!in) {
+        return -1;
+    }
+    ok = fread(&header, sizeof(header), 1, in) == 1 &&
+         memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0 &&
+         header.genes == POLICY_GENES && header.count > 0 && (int)header.count <= *count;
+    ok = ok && fread(fitness, sizeof(float), header.count, in) == header.count &&
+         fread(population, sizeof(Policy), header.count, in) == header.count &&
+         population_crc(population, fitness, (int)header.count) == header.crc;
+    fclose(in);
+    if (!ok) {
+        return -1;
+    }
+
+    *count = (int)header.count;
+    *generation = (int)header.generation;
+    *rng_state = header.rng_state;
+    return 0;
+}
+
+int policy_load_best(const char *path, Policy *best) {
+    CheckpointHeader header;
+    FILE *in = fopen(path, "rb");
+    int count, generation, ok;
+    uint64_t rng_state;
+
+    if (!in) {
+        return -1;
+    }
+    ok = fread(&header, sizeof(header), 1, in) == 1 && header.count > 0 &&
+         header.count <= 1u << 20;
+    fclose(in);
+    if (!ok) {
+        return -1;
+    }
+
+    count = (int)header.count;
+    Policy *population = aligned_alloc(_Alignof(Policy), sizeof(Policy) * count);
+    float *fitness = malloc(sizeof(float) * count);
+    ok = population && fitness &&
+         policy_load_population(path, population, fitness, &count, &generation, &rng_state) == 0;
+    if (ok) {
+        int top = 0;
+        for (int i = 1; i < count; i++) {
+            if (fitness[i] > fitness[top]) {
+                top = i;
+            }
+        }
+        *best = population[top];
+    }
+    free(population);
+    free(fitness);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,474 @@
+#include "render.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// ========== Frame accounting ==========
+
+int render_io_sample(RenderIo *io) {
+    FILE *in = fopen("/proc/self/io", "r");
+    char line[128];
+    int found = 0;
+
+    if (!in) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in)) {
+        if (sscanf(line, "syscw: %llu", &io->syscalls) == 1 ||
+            sscanf(line, "wchar: %llu", &io->bytes) == 1) {
+            found++;
+        }
+    }
+    fclose(in);
+    return found == 2 ? 0 : -1;
+}
+
+void render_present(const RenderBackend *out, RenderStats *stats) {
+    RenderIo before, after;
+
+    if (!stats) {
+        out->present();
+        return;
+    }
+
+    int sampled = render_io_sample(&before) == 0;
+    out->present();
+    sampled = sampled && render_io_sample(&after) == 0;
+
+    stats->frames++;
+    stats->available = sampled;
+    if (sampled) {
+        stats->syscalls += after.syscalls - before.syscalls;
+        stats->bytes += after.bytes - before.bytes;
+    }
+}
+
+void render_printf(const RenderBackend *out, int y, int x, int color, int attrs,
+                   const char *format, ...) {
+    char line[SCREEN_COLS + 1];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    out->text(y, x, color, attrs, line);
+}
+
+const RenderBackend *render_backend_by_name(const char *name) {
+    if (strcmp(name, render_ansi.name) == 0) {
+        return &render_ansi;
+    }
+    if (strcmp(name, render_ncurses.name) == 0) {
+        return &render_ncurses;
+    }
+    return NULL;
+}
+
+// ========== Screens ==========
+
+void draw_border(const RenderBackend *out) {
+    int style = ATTR_BOLD;
+    
+    // Double line border for better look
+    for (int x = 0; x <= WIDTH + 1; x++) {
+        out->put(0, x, COLOR_BORDER, style, '=');
+        out->put(HEIGHT + 1, x, COLOR_BORDER, style, '=');
+    }
+    
+    for (int y = 1; y <= HEIGHT; y++) {
+        out->put(y, 0, COLOR_BORDER, style, '|');
+        out->put(y, WIDTH + 1, COLOR_BORDER, style, '|');
+    }
+    
+    // Corners
+    out->put(0, 0, COLOR_BORDER, style, '+');
+    out->put(0, WIDTH + 1, COLOR_BORDER, style, '+');
+    out->put(HEIGHT + 1, 0, COLOR_BORDER, style, '+');
+    out->put(HEIGHT + 1, WIDTH + 1, COLOR_BORDER, style, '+');
+}
+
+static void food_style(int type, int *color, char *glyph) {
+    int color_pair;
+    char symbol;
+    
+    switch (type) {
+        case FOOD_REGULAR:
+            color_pair = COLOR_FOOD_REGULAR;
+            symbol = '*';
+            break;
+        case FOOD_GREEN:
+            color_pair = COLOR_FOOD_GREEN;
+            symbol = '$';
+            break;
+        case FOOD_GOLD:
+            color_pair = COLOR_FOOD_GOLD;
+            symbol = '@';
+            break;
+        case FOOD_BLUE:
+            color_pair = COLOR_FOOD_BLUE;
+            symbol = '#';
+            break;
+        default:
+            color_pair = COLOR_FOOD_REGULAR;
+            symbol = '*';
+    }
+    
+    *color = color_pair;
+    *glyph = symbol;
+}
+
+static void draw_food(const RenderBackend *out, const Food *food) {
+    int color_pair;
+    char symbol;
+    
+    food_style(food->type, &color_pair, &symbol);
+    out->put(food->position.y, food->position.x, color_pair, ATTR_BOLD, symbol);
+}
+
+void draw_game(const RenderBackend *out, const GameState *game) {
+    out->clear();
+    
+    // Draw border
+    draw_border(out);
+    
+    // Draw title and stats
+    out->text(0, WIDTH + 5, COLOR_TITLE, ATTR_BOLD, "[ SNAKE GAME ]");
+    
+    // Draw score and stats
+    render_printf(out, 2, WIDTH + 5, COLOR_INFO, ATTR_BOLD, "SCORE: %d", game->score);
+    render_printf(out, 3, WIDTH + 5, COLOR_INFO, ATTR_BOLD, "LENGTH: %d/%d",
+                  game->snake.length, WIN_LENGTH);
+    render_printf(out, 4, WIDTH + 5, COLOR_INFO, ATTR_BOLD, "APPLES: %d", game->apples_eaten);
+    
+    // Draw progress bar to win
+    int progress = (game->snake.length * 20) / WIN_LENGTH;
+    out->text(5, WIDTH + 5, 0, 0, "WIN:");
+    for (int i = 0; i < 20; i++) {
+        out->put(5, WIDTH + 10 + i, COLOR_TITLE, 0, i < progress ? '=' : '-');
+    }
+    
+    // Draw speed boost indicator
+    if (is_speed_boost_active(&game->speed_boost)) {
+        out->text(7, WIDTH + 5, COLOR_FOOD_GOLD, ATTR_BOLD | ATTR_BLINK, ">>> SPEED x2 <<<");
+    }
+    
+    // Draw legend
+    out->text(9, WIDTH + 5, 0, 0, "--- APPLES ---");
+    out->text(10, WIDTH + 5, COLOR_FOOD_REGULAR, ATTR_BOLD, "* Red: +1 +10pts");
+    out->text(11, WIDTH + 5, COLOR_FOOD_GREEN, ATTR_BOLD, "$ Green: +2 +20pts");
+    out->text(12, WIDTH + 5, COLOR_FOOD_GOLD, ATTR_BOLD, "@ Gold: Speed x2");
+    out->text(13, WIDTH + 5, COLOR_FOOD_BLUE, ATTR_BOLD, "# Blue: +Wall");
+    
+    // Draw snake
+    for (int i = 0; i < game->snake.length; i++) {
+        out->put(game->snake.body[i].y, game->snake.body[i].x, COLOR_SNAKE, ATTR_BOLD,
+                 i == 0 ? '@' : 'o');
+    }
+    
+    // Draw food with different colors
+    if (game->foods) {
+        for (int i = 0; i < game->foods->count; i++) {
+            draw_food(out, &game->foods->foods[i]);
+        }
+    } else if (game->food.active) {
+        draw_food(out, &game->food);
+    }
+    
+    // Draw obstacles (level walls and blue apple walls share the grid)
+    for (int y = 1; y <= HEIGHT; y++) {
+        for (int x = 1; x <= WIDTH; x++) {
+            if (grid_test(&game->obstacles.grid, x, y)) {
+                out->put(y, x, COLOR_OBSTACLE, ATTR_BOLD, 'X');
+            }
+        }
+    }
+    
+    // Instructions
+    render_printf(out, HEIGHT + 2, 0, COLOR_INFO, 0,
+                  "Arrow Keys: Move | P: Pause | Q: Quit | Get to %d length to WIN!", WIN_LENGTH);
+}
+
+void draw_pause(const RenderBackend *out) {
+    out->text(HEIGHT / 2, WIDTH / 2 - 4, COLOR_TITLE, ATTR_BOLD, " PAUSED ");
+    out->text(7, WIDTH + 5, COLOR_INFO, ATTR_BOLD, "P: resume  Q: quit");
+}
+
+void draw_rewind(const RenderBackend *out, unsigned long tick,
+                 unsigned long oldest, unsigned long newest) {
+    render_printf(out, 15, WIDTH + 5, COLOR_INFO, 0, "TICK %lu (%lu..%lu)", tick, oldest, newest);
+    out->text(16, WIDTH + 5, COLOR_INFO, 0, "[ ]: step  { }: jump");
+}
+
+// ========== Viewport ==========
+
+static int same_point(Point a, Point b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+static int in_grid(Point p) {
+    return p.x >= 0 && p.x < GRID_W && p.y >= 0 && p.y < GRID_H;
+}
+
+static void camera_count(Camera *camera, Point p, int delta) {
+    if (in_grid(p)) {
+        camera->segments[p.y][p.x] = (uint8_t)(camera->segments[p.y][p.x] + delta);
+    }
+}
+
+static void camera_remember(Camera *camera, const Snake *snake) {
+    camera->head = snake->body[0];
+    camera->tail = snake->body[snake->length - 1];
+    camera->before_tail = snake->body[snake->length > 1 ? snake->length - 2 : 0];
+    camera->length = snake->length;
+}
+
+static void camera_sync(Camera *camera, const Snake *snake) {
+    int grew = snake->length - camera->length;
+    
+    if (camera->length == snake->length && same_point(camera->head, snake->body[0]) &&
+        same_point(camera->tail, snake->body[snake->length - 1])) {
+        return;
+    }
+    
+    // One tick of update_game(): a new head, the old tail gone and any new
+    // segments stacked where the tail now is
+    if (camera->length >= 2 && grew >= 0 && grew <= 2 && snake->length >= 2 &&
+        same_point(snake->body[1], camera->head) &&
+        same_point(snake->body[camera->length - 1], camera->before_tail) &&
+        same_point(snake->body[snake->length - 1], camera->before_tail)) {
+        camera_count(camera, snake->body[0], 1);
+        camera_count(camera, camera->tail, -1);
+        camera_count(camera, camera->before_tail, grew);
+    } else {
+        memset(camera->segments, 0, sizeof(camera->segments));
+        for (int i = 0; i < snake->length; i++) {
+            camera_count(camera, snake->body[i], 1);
+        }
+    }
+    camera_remember(camera, snake);
+}
+
+// Keeps the head at least `margin` cells inside the window
+static int scroll_axis(int origin, int head, int visible, int size, int margin) {
+    if (head - origin < margin) {
+        origin = head - margin;
+    } else if (origin + visible - 1 - head < margin) {
+        origin = head - (visible - 1 - margin);
+    }
+    if (origin > size - visible) {
+        origin = size - visible;
+    }
+    return origin < 0 ? 0 : origin;
+}
+
+void camera_init(Camera *camera, int term_rows, int term_cols) {
+    memset(camera, 0, sizeof(*camera));
+    camera->rows = term_rows - 1 < GRID_H ? term_rows - 1 : GRID_H;
+    camera->cols = term_cols < GRID_W ? term_cols : GRID_W;
+    if (camera->rows < 1) {
+        camera->rows = 1;
+    }
+    if (camera->cols < 1) {
+        camera->cols = 1;
+    }
+    camera->margin = (camera->rows < camera->cols ? camera->rows : camera->cols) / 4;
+}
+
+void camera_follow(Camera *camera, const GameState *game) {
+    Point head = game->snake.body[0];
+    
+    camera_sync(camera, &game->snake);
+    camera->x = scroll_axis(camera->x, head.x, camera->cols, GRID_W, camera->margin);
+    camera->y = scroll_axis(camera->y, head.y, camera->rows, GRID_H, camera->margin);
+}
+
+static char border_glyph(int x, int y) {
+    int edge_x = x == 0 || x == GRID_W - 1;
+    int edge_y = y == 0 || y == GRID_H - 1;
+    
+    if (edge_x && edge_y) {
+        return '+';
+    }
+    return edge_y ? '=' : edge_x ? '|' : 0;
+}
+
+// Same layering as draw_game(): obstacles over food over the snake over the border
+static void draw_cell(const RenderBackend *out, const Camera *camera, const GameState *game,
+                      int row, int col) {
+    int x = camera->x + col;
+    int y = camera->y + row;
+    int color;
+    char glyph;
+    
+    if (grid_test(&game->obstacles.grid, x, y) && border_glyph(x, y) == 0) {
+        out->put(row, col, COLOR_OBSTACLE, ATTR_BOLD, 'X');
+        return;
+    }
+    if (game->foods) {
+        int index = food_pool_find(game->foods, x, y);
+        if (index >= 0) {
+            food_style(game->foods->foods[index].type, &color, &glyph);
+            out->put(row, col, color, ATTR_BOLD, glyph);
+            return;
+        }
+    } else if (game->food.active && game->food.position.x == x && game->food.position.y == y) {
+        food_style(game->food.type, &color, &glyph);
+        out->put(row, col, color, ATTR_BOLD, glyph);
+        return;
+    }
+    if (camera->segments[y][x]) {
+        out->put(row, col, COLOR_SNAKE, ATTR_BOLD,
+                 x == game->snake.body[0].x && y == game->snake.body[0].y ? '@' : 'o');
+        return;
+    }
+    glyph = border_glyph(x, y);
+    if (glyph) {
+        out->put(row, col, COLOR_BORDER, ATTR_BOLD, glyph);
+    }
+}
+
+void draw_game_viewport(const RenderBackend *out, Camera *camera, const GameState *game) {
+    camera_follow(camera, game);
+    out->clear();
+    
+    for (int row = 0; row < camera->rows; row++) {
+        for (int col = 0; col < camera->cols; col++) {
+            draw_cell(out, camera, game, row, col);
+        }
+    }
+    
+    // The side panel does not fit, so the stats share one line under the board
+    char line[SCREEN_COLS + 1];
+    snprintf(line, sizeof(line), "SCORE %d  LEN %d/%d  %s", game->score,
+             game->snake.length, WIN_LENGTH, is_speed_boost_active(&game->speed_boost) ? "x2" : "");
+    line[camera->cols] = '\0';
+    out->text(camera->rows, 0, COLOR_INFO, ATTR_BOLD, line);
+}
+
+void draw_viewport_pause(const RenderBackend *out, const Camera *camera) {
+    out->text(camera->rows / 2, camera->cols / 2 - 4 > 0 ? camera->cols / 2 - 4 : 0,
+              COLOR_TITLE, ATTR_BOLD, " PAUSED ");
+}
+
+void welcome_screen(const RenderBackend *out) {
+    out->clear();
+    
+    // ASCII Art Title
+    out->text(3, WIDTH / 2 - 15, COLOR_TITLE, ATTR_BOLD, "   _____ _   _          _  _______ ");
+    out->text(4, WIDTH / 2 - 15, COLOR_TITLE, ATTR_BOLD, "  / ____| \\ | |   /\\   | |/ /  ____|");
+    out->text(5, WIDTH / 2 - 15, COLOR_TITLE, ATTR_BOLD, " | (___ |  \\| |  /  \\  | ' /| |__   ");
+    out->text(6, WIDTH / 2 - 15, COLOR_TITLE, ATTR_BOLD, "  \\___ \\| . ` | / /\\ \\ |  < |  __|  ");
+    out->text(7, WIDTH / 2 - 15, COLOR_TITLE, ATTR_BOLD, "  ____) | |\\  |/ ____ \\| . \\| |____ ");
+    out->text(8, WIDTH / 2 - 15, COLOR_TITLE, ATTR_BOLD, " |_____/|_| \\_/_/    \\_\\_|\\_\\______|");
+    
+    // Instructions
+    render_printf(out, 12, WIDTH / 2 - 18, 0, 0, "GOAL: Grow to %d length to WIN!", WIN_LENGTH);
+    out->text(14, WIDTH / 2 - 15, 0, 0, "CONTROLS:");
+    out->text(15, WIDTH / 2 - 15, 0, 0, "  Arrow Keys - Move");
+    out->text(16, WIDTH / 2 - 15, 0, 0, "  P - Pause, Q - Quit, [ ] - Rewind");
+    
+    out->text(18, WIDTH / 2 - 15, 0, 0, "SPECIAL APPLES:");
+    out->text(19, WIDTH / 2 - 15, COLOR_FOOD_REGULAR, 0, "  * Red");
+    out->text(19, WIDTH / 2 - 6, 0, 0, "- Normal (+1, +10pts)");
+    
+    out->text(20, WIDTH / 2 - 15, COLOR_FOOD_GREEN, 0, "  $ Green");
+    out->text(20, WIDTH / 2 - 6, 0, 0, "- Big (+2, +20pts)");
+    
+    out->text(21, WIDTH / 2 - 15, COLOR_FOOD_GOLD, 0, "  @ Gold");
+    out->text(21, WIDTH / 2 - 6, 0, 0, "- Speed x2 for 3s (+50pts)");
+    
+    out->text(22, WIDTH / 2 - 15, COLOR_FOOD_BLUE, 0, "  # Blue");
+    out->text(22, WIDTH / 2 - 6, 0, 0, "- Adds obstacle (+15pts)");
+    
+    out->text(HEIGHT - 3, WIDTH / 2 - 15, COLOR_TITLE, ATTR_BOLD, "Press ANY KEY to start...");
+}
+
+void game_over_screen(const RenderBackend *out, const GameState *game) {
+    int c = COLOR_FOOD_REGULAR;
+    
+    out->clear();
+    
+    // Title - Simplified and centered properly
+    out->text(HEIGHT / 2 - 4, WIDTH / 2 - 12, c, ATTR_BOLD, "   ____    _    __  __ _____ ");
+    out->text(HEIGHT / 2 - 3, WIDTH / 2 - 12, c, ATTR_BOLD, "  / ___|  / \\  |  \\/  | ____|");
+    out->text(HEIGHT / 2 - 2, WIDTH / 2 - 12, c, ATTR_BOLD, " | |  _  / _ \\ | |\\/| |  _|  ");
+    out->text(HEIGHT / 2 - 1, WIDTH / 2 - 12, c, ATTR_BOLD, " | |_| |/ ___ \\| |  | | |___ ");
+    out->text(HEIGHT / 2, WIDTH / 2 - 12,     c, ATTR_BOLD, "  \\____/_/   \\_\\_|  |_|_____|");
+    out->text(HEIGHT / 2 + 1, WIDTH / 2 - 12, c, ATTR_BOLD, "   _____     _______ ____  _ ");
+    out->text(HEIGHT / 2 + 2, WIDTH / 2 - 12, c, ATTR_BOLD, "  / _ \\ \\   / / ____|  _ \\| |");
+    out->text(HEIGHT / 2 + 3, WIDTH / 2 - 12, c, ATTR_BOLD, " | | | \\ \\ / /|  _| | |_) | |");
+    out->text(HEIGHT / 2 + 4, WIDTH / 2 - 12, c, ATTR_BOLD, " | |_| |\\ V / | |___|  _ <|_|");
+    out->text(HEIGHT / 2 + 5, WIDTH / 2 - 12, c, ATTR_BOLD, "  \\___/  \\_/  |_____|_| \\_(_)");
+
+    // Stats
+    render_printf(out, HEIGHT / 2 + 7, WIDTH / 2 - 10, COLOR_INFO, ATTR_BOLD,
+                  "FINAL SCORE: %d", game->score);
+    render_printf(out, HEIGHT / 2 + 8, WIDTH / 2 - 10, COLOR_INFO, ATTR_BOLD,
+                  "FINAL LENGTH: %d/%d", game->snake.length, WIN_LENGTH);
+    render_printf(out, HEIGHT / 2 + 9, WIDTH / 2 - 10, COLOR_INFO, ATTR_BOLD,
+                  "APPLES EATEN: %d", game->apples_eaten);
+    
+    // Apple breakdown
+    out->text(HEIGHT / 2 + 11, WIDTH / 2 - 10, COLOR_INFO, 0, "Apple Breakdown:");
+    render_printf(out, HEIGHT / 2 + 12, WIDTH / 2 - 8, COLOR_FOOD_REGULAR, 0,
+                  "Red: %d", game->special_apples_eaten[FOOD_REGULAR]);
+    render_printf(out, HEIGHT / 2 + 12, WIDTH / 2, COLOR_FOOD_GREEN, 0,
+                  "Green: %d", game->special_apples_eaten[FOOD_GREEN]);
+    render_printf(out, HEIGHT / 2 + 13, WIDTH / 2 - 8, COLOR_FOOD_GOLD, 0,
+                  "Gold: %d", game->special_apples_eaten[FOOD_GOLD]);
+    render_printf(out, HEIGHT / 2 + 13, WIDTH / 2, COLOR_FOOD_BLUE, 0,
+                  "Blue: %d", game->special_apples_eaten[FOOD_BLUE]);
+    
+    out->text(HEIGHT - 2, WIDTH / 2 - 15, COLOR_BORDER, ATTR_BOLD, "Press any key to exit...");
+}
+
+void game_won_screen(const RenderBackend *out, const GameState *game) {
+    int c = COLOR_FOOD_GOLD;
+    
+    out->clear();
+    
+    // Victory Title
+    out->text(HEIGHT / 2 - 6, WIDTH / 2 - 15, c, ATTR_BOLD, "__   __ ___   _   _  __      __ ___  _  _ _ ");
+    out->text(HEIGHT / 2 - 5, WIDTH / 2 - 15, c, ATTR_BOLD, "\\ \\ / // _ \\ | | | | \\ \\    / /|_ _|| \\| | |");
+    out->text(HEIGHT / 2 - 4, WIDTH / 2 - 15, c, ATTR_BOLD, " \\ V /| (_) || |_| |  \\ \\/\\/ /  | | | .` |_|");
+    out->text(HEIGHT / 2 - 3, WIDTH / 2 - 15, c, ATTR_BOLD, "  |_|  \\___/  \\___/    \\_/\\_/  |___||_|\\_(_)");
+    
+    // Congratulations
+    render_printf(out, HEIGHT / 2 - 1, WIDTH / 2 - 20, COLOR_TITLE, ATTR_BOLD,
+                  "CONGRATULATIONS! You reached %d length!", WIN_LENGTH);
+    
+    // Stats
+    render_printf(out, HEIGHT / 2 + 1, WIDTH / 2 - 10, COLOR_INFO, ATTR_BOLD,
+                  "FINAL SCORE: %d", game->score);
+    render_printf(out, HEIGHT / 2 + 2, WIDTH / 2 - 10, COLOR_INFO, ATTR_BOLD,
+                  "APPLES EATEN: %d", game->apples_eaten);
+    render_printf(out, HEIGHT / 2 + 3, WIDTH / 2 - 10, COLOR_INFO, ATTR_BOLD,
+                  "OBSTACLES CREATED: %d", game->obstacles.count);
+    
+    // Apple breakdown
+    out->text(HEIGHT / 2 + 5, WIDTH / 2 - 10, 0, 0, "Apple Collection:");
+    render_printf(out, HEIGHT / 2 + 6, WIDTH / 2 - 10, COLOR_FOOD_REGULAR, 0,
+                  "  Red: %d", game->special_apples_eaten[FOOD_REGULAR]);
+    render_printf(out, HEIGHT / 2 + 7, WIDTH / 2 - 10, COLOR_FOOD_GREEN, 0,
+                  "  Green: %d", game->special_apples_eaten[FOOD_GREEN]);
+    render_printf(out, HEIGHT / 2 + 8, WIDTH / 2 - 10, COLOR_FOOD_GOLD, 0,
+                  "  Gold: %d", game->special_apples_eaten[FOOD_GOLD]);
+    render_printf(out, HEIGHT / 2 + 9, WIDTH / 2 - 10, COLOR_FOOD_BLUE, 0,
+                  "  Blue: %d", game->special_apples_eaten[FOOD_BLUE]);
+    
+    out->text(HEIGHT - 2, WIDTH / 2 - 15, COLOR_FOOD_GOLD, ATTR_BOLD, "Press any key to exit...");
+}
+
+void draw_high_scores(const RenderBackend *out, const Leaderboard *board, int level) {
+    ScoreEntry top[LEADERBOARD_TOP_K];
+    int count = leaderboard_top(board, level, top, LEADERBOARD_TOP_K);
+    
+    out->text(2, WIDTH + 5, COLOR_TITLE, ATTR_BOLD, "--- HIGH SCORES ---");
+    
+    for (int i = 0; i < count; i++) {
+        render_printf(out, 4 + i, WIDTH + 5, COLOR_INFO, 0, "%2d. %6d  len %2d%s", i + 1,
+                      top[i].score, top[i].length, top[i].state == GAME_WON ? "  WIN" : "");
+    }
+    render_printf(out, 5 + LEADERBOARD_TOP_K, WIDTH + 5, COLOR_INFO, 0, "Games played: %llu",
+                  (unsigned long long)board->total_games);
+}
@@ -0,0 +1,270 @@
+#include "render.h"
+#include "input.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Lean backend: put/text only fill a cell array. present() compares it
+// with what the terminal already shows and encodes just the changed cells
+// (cursor moves, SGR colors, characters) into one preallocated buffer,
+// which goes out with a single write().
+
+typedef struct {
+    char ch;
+    uint8_t color;
+    uint8_t attrs;
+    uint8_t reserved;
+} Cell;
+
+// Worst case per cell: cursor move, full SGR and the character
+#define CELL_BYTES_MAX 32
+#define FRAME_BYTES (SCREEN_ROWS * SCREEN_COLS * CELL_BYTES_MAX + 64)
+
+// A run of unchanged cells this short is cheaper to repeat than to jump over
+#define SKIP_MAX 4
+
+// Alternate screen with a hidden cursor, and back
+#define ENTER_SCREEN "\x1b[?1049h\x1b[?25l"
+#define LEAVE_SCREEN "\x1b[0m\x1b[?25h\x1b[?1049l"
+
+static const char ansi_fg[RENDER_COLORS] = {
+    0, '2', '1', '3', '6', '2', '3', '4', '5', '7'
+};
+
+static Cell back[SCREEN_ROWS][SCREEN_COLS];
+static Cell front[SCREEN_ROWS][SCREEN_COLS];
+static int front_valid;
+static char frame[FRAME_BYTES];
+static int out_fd = STDOUT_FILENO;
+
+static struct termios saved_termios;
+static int raw_mode;
+static unsigned char pending[64];
+static int pending_len;
+
+static const Cell blank = { ' ', 0, 0, 0 };
+
+static int same_cell(const Cell *a, const Cell *b) {
+    return a->ch == b->ch && a->color == b->color && a->attrs == b->attrs;
+}
+
+static int style_of(const Cell *cell) {
+    return cell->color | cell->attrs << 4;
+}
+
+static size_t append(size_t len, const char *s, size_t n) {
+    memcpy(frame + len, s, n);
+    return len + n;
+}
+
+static size_t append_uint(size_t len, unsigned int value) {
+    char digits[10];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n > 0) {
+        frame[len++] = digits[--n];
+    }
+    return len;
+}
+
+static size_t append_move(size_t len, int y, int x) {
+    len = append(len, "\x1b[", 2);
+    len = append_uint(len, (unsigned int)y + 1);
+    frame[len++] = ';';
+    len = append_uint(len, (unsigned int)x + 1);
+    frame[len++] = 'H';
+    return len;
+}
+
+static size_t append_style(size_t len, const Cell *cell) {
+    len = append(len, "\x1b[0", 3);
+    if (cell->attrs & ATTR_BOLD) {
+        len = append(len, ";1", 2);
+    }
+    if (cell->attrs & ATTR_BLINK) {
+        len = append(len, ";5", 2);
+    }
+    if (cell->color) {
+        len = append(len, ";3", 2);
+        frame[len++] = ansi_fg[cell->color];
+        len = append(len, ";40", 3);
+    }
+    frame[len++] = 'm';
+    return len;
+}
+
+static void write_all(const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(out_fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+}
+
+void render_ansi_output(int fd) {
+    out_fd = fd;
+    front_valid = 0;
+}
+
+static int ansi_init(void) {
+    const char *term = getenv("TERM");
+    
+    if (!term || !*term || strcmp(term, "dumb") == 0) {
+        return -1;
+    }
+    
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved_termios) == 0) {
+        struct termios raw = saved_termios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        raw_mode = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    
+    write_all(ENTER_SCREEN, sizeof(ENTER_SCREEN) - 1);
+    front_valid = 0;
+    pending_len = 0;
+    return 0;
+}
+
+static void ansi_shutdown(void) {
+    write_all(LEAVE_SCREEN, sizeof(LEAVE_SCREEN) - 1);
+    if (raw_mode) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        raw_mode = 0;
+    }
+}
+
+static void ansi_clear(void) {
+    for (int y = 0; y < SCREEN_ROWS; y++) {
+        for (int x = 0; x < SCREEN_COLS; x++) {
+            back[y][x] = blank;
+        }
+    }
+}
+
+static void ansi_put(int y, int x, int color, int attrs, char ch) {
+    if (y < 0 || y >= SCREEN_ROWS || x < 0 || x >= SCREEN_COLS) {
+        return;
+    }
+    Cell *cell = &back[y][x];
+    cell->ch = ch;
+    cell->color = (uint8_t)(color >= 0 && color < RENDER_COLORS ? color : 0);
+    cell->attrs = (uint8_t)attrs;
+}
+
+static void ansi_text(int y, int x, int color, int attrs, const char *s) {
+    for (; *s; s++, x++) {
+        ansi_put(y, x, color, attrs, *s);
+    }
+}
+
+static void ansi_present(void) {
+    size_t len = 0;
+    int cur_y = -1;
+    int cur_x = -1;
+    int style = -1;
+    
+    if (!front_valid) {
+        len = append(len, "\x1b[0m\x1b[2J", 8);
+        style = 0;
+        for (int y = 0; y < SCREEN_ROWS; y++) {
+            for (int x = 0; x < SCREEN_COLS; x++) {
+                front[y][x] = blank;
+            }
+        }
+        front_valid = 1;
+    }
+    
+    for (int y = 0; y < SCREEN_ROWS; y++) {
+        for (int x = 0; x < SCREEN_COLS; x++) {
+            const Cell *cell = &back[y][x];
+            if (same_cell(cell, &front[y][x])) {
+                continue;
+            }
+            
+            if (cur_y != y || cur_x != x) {
+                int gap = cur_y == y ? x - cur_x : SKIP_MAX + 1;
+                int reuse = gap > 0 && gap <= SKIP_MAX;
+                for (int i = cur_x; reuse && i < x; i++) {
+                    reuse = style_of(&front[y][i]) == style;
+                }
+                if (reuse) {
+                    for (int i = cur_x; i < x; i++) {
+                        frame[len++] = front[y][i].ch;
+                    }
+                } else {
+                    len = append_move(len, y, x);
+                }
+            }
+            if (style_of(cell) != style) {
+                len = append_style(len, cell);
+                style = style_of(cell);
+            }
+            frame[len++] = cell->ch;
+            front[y][x] = *cell;
+            cur_y = y;
+            cur_x = x + 1;
+        }
+    }
+    
+    if (len > 0) {
+        write_all(frame, len);
+    }
+}
+
+// Turns the next buffered key into an INPUT_* command
+static int decode_key(void) {
+    int used;
+    int key = input_decode(pending, pending_len, &used);
+    
+    // An escape sequence cut short is just a lone ESC
+    if (used == 0) {
+        key = INPUT_OTHER;
+        used = pending_len;
+    }
+    pending_len -= used;
+    memmove(pending, pending + used, (size_t)pending_len);
+    return key;
+}
+
+static int ansi_read_key(int wait) {
+    if (pending_len == 0) {
+        if (wait) {
+            struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+            while (poll(&pfd, 1, -1) < 0 && errno == EINTR) {
+            }
+        }
+        ssize_t n = read(STDIN_FILENO, pending, sizeof(pending));
+        if (n <= 0) {
+            // Closed input while waiting for a key ends the game instead of spinning
+            return wait && n == 0 && !isatty(STDIN_FILENO) ? INPUT_QUIT : INPUT_NONE;
+        }
+        pending_len = (int)n;
+    }
+    return decode_key();
+}
+
+const RenderBackend render_ansi = {
+    "ansi",
+    ansi_init,
+    ansi_shutdown,
+    ansi_clear,
+    ansi_put,
+    ansi_text,
+    ansi_present,
+    ansi_read_key,
+};
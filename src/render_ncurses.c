@@ -0,0 +1,130 @@
+#include "render.h"
+#include <ncurses.h>
+
+// Fallback backend: every call goes through ncurses, which diffs the
+// virtual screen against the terminal on refresh().
+
+static int ncurses_attrs(int color, int attrs) {
+    int result = color ? COLOR_PAIR(color) : 0;
+    if (attrs & ATTR_BOLD) {
+        result |= A_BOLD;
+    }
+    if (attrs & ATTR_BLINK) {
+        result |= A_BLINK;
+    }
+    return result;
+}
+
+static int ncurses_init(void) {
+    if (!initscr()) {
+        return -1;
+    }
+    cbreak();
+    noecho();
+    curs_set(0);
+    keypad(stdscr, TRUE);
+    nodelay(stdscr, TRUE);
+    
+    // Enable colors
+    if (has_colors()) {
+        start_color();
+        init_pair(COLOR_SNAKE, COLOR_GREEN, COLOR_BLACK);
+        init_pair(COLOR_FOOD_REGULAR, COLOR_RED, COLOR_BLACK);
+        init_pair(COLOR_BORDER, COLOR_YELLOW, COLOR_BLACK);
+        init_pair(COLOR_INFO, COLOR_CYAN, COLOR_BLACK);
+        init_pair(COLOR_FOOD_GREEN, COLOR_GREEN, COLOR_BLACK);
+        init_pair(COLOR_FOOD_GOLD, COLOR_YELLOW, COLOR_BLACK);
+        init_pair(COLOR_FOOD_BLUE, COLOR_BLUE, COLOR_BLACK);
+        init_pair(COLOR_OBSTACLE, COLOR_MAGENTA, COLOR_BLACK);
+        init_pair(COLOR_TITLE, COLOR_WHITE, COLOR_BLACK);
+    }
+    return 0;
+}
+
+static void ncurses_shutdown(void) {
+    endwin();
+}
+
+// erase() rather than clear(): clear() would force a full repaint every frame
+static void ncurses_clear(void) {
+    erase();
+}
+
+static void ncurses_put(int y, int x, int color, int attrs, char ch) {
+    int a = ncurses_attrs(color, attrs);
+    attron(a);
+    mvaddch(y, x, (unsigned char)ch);
+    attroff(a);
+}
+
+static void ncurses_text(int y, int x, int color, int attrs, const char *s) {
+    int a = ncurses_attrs(color, attrs);
+    attron(a);
+    mvaddstr(y, x, s);
+    attroff(a);
+}
+
+static void ncurses_present(void) {
+    refresh();
+}
+
+static int ncurses_read_key(int wait) {
+    int ch;
+    
+    if (wait) {
+        nodelay(stdscr, FALSE);
+    }
+    ch = getch();
+    if (wait) {
+        nodelay(stdscr, TRUE);
+    }
+    
+    switch (ch) {
+        case ERR:
+            return INPUT_NONE;
+        case KEY_UP:
+        case 'w':
+        case 'W':
+            return INPUT_UP;
+        case KEY_RIGHT:
+        case 'd':
+        case 'D':
+            return INPUT_RIGHT;
+        case KEY_DOWN:
+        case 's':
+        case 'S':
+            return INPUT_DOWN;
+        case KEY_LEFT:
+        case 'a':
+        case 'A':
+            return INPUT_LEFT;
+        case 'q':
+        case 'Q':
+            return INPUT_QUIT;
+        case 'p':
+        case 'P':
+        case ' ':
+            return INPUT_PAUSE;
+        case '[':
+            return INPUT_REWIND;
+        case ']':
+            return INPUT_FORWARD;
+        case '{':
+            return INPUT_REWIND_FAR;
+        case '}':
+            return INPUT_FORWARD_FAR;
+        default:
+            return INPUT_OTHER;
+    }
+}
+
+const RenderBackend render_ncurses = {
+    "ncurses",
+    ncurses_init,
+    ncurses_shutdown,
+    ncurses_clear,
+    ncurses_put,
+    ncurses_text,
+    ncurses_present,
+    ncurses_read_key,
+};
@@ -0,0 +1,238 @@
+#include "rewind.h"
+#include <string.h>
+
+_Static_assert((REWIND_TICKS & (REWIND_TICKS - 1)) == 0, "rewind ring size must be a power of two");
+_Static_assert(REWIND_TICKS % REWIND_KEYFRAME_INTERVAL == 0, "keyframes must tile the ring");
+_Static_assert(sizeof(RewindDelta) <= 64, "a tick delta must stay within a cache line");
+_Static_assert(WIDTH + 1 <= 127 && HEIGHT + 1 <= 127, "coordinates must fit int8_t");
+
+static RewindDelta *delta_at(RewindBuffer *rewind, unsigned long tick) {
+    return &rewind->deltas[tick & (REWIND_TICKS - 1)];
+}
+
+static RewindKeyframe *keyframe_at(RewindBuffer *rewind, unsigned long tick) {
+    return &rewind->keyframes[(tick / REWIND_KEYFRAME_INTERVAL) & (REWIND_KEYFRAMES - 1)];
+}
+
+static void save_keyframe(RewindBuffer *rewind, const GameState *game, uint64_t rng) {
+    RewindKeyframe *keyframe = keyframe_at(rewind, rewind->tick);
+
+    keyframe->state = *game;
+    keyframe->state.events = NULL;
+    keyframe->state.foods = NULL;
+    keyframe->rng = rng;
+    keyframe->boost_us = rewind->boost_us;
+    keyframe->tick = rewind->tick;
+}
+
+static RewindFood pack_food(const Food *food) {
+    RewindFood packed = { (int8_t)food->position.x, (int8_t)food->position.y,
+                          (uint8_t)food->type, (uint8_t)food->active };
+    return packed;
+}
+
+static void unpack_food(const RewindFood *packed, Food *food) {
+    food->position.x = packed->x;
+    food->position.y = packed->y;
+    food->type = packed->type;
+    food->active = packed->active;
+}
+
+// The boost is kept as the time it had run at its tick, not as a start
+// time: seeking rebuilds it against the current clock, so the boost has
+// the same time left as when the tick was played
+static int64_t pack_boost(const SpeedBoost *boost, struct timeval now) {
+    if (!boost->active) {
+        return -1;
+    }
+    long elapsed = get_time_diff_us(boost->start_time, now);
+    return elapsed > 0 ? elapsed : 0;
+}
+
+static void unpack_boost(int64_t packed, SpeedBoost *boost, struct timeval now) {
+    boost->active = packed >= 0;
+    if (boost->active) {
+        int64_t start = (int64_t)now.tv_sec * 1000000 + now.tv_usec - packed;
+        boost->start_time.tv_sec = start / 1000000;
+        boost->start_time.tv_usec = start % 1000000;
+    }
+}
+
+void rewind_init(RewindBuffer *rewind, const GameState *game) {
+    struct timeval now;
+
+    rewind->tick = 0;
+    rewind->newest = 0;
+    rewind->oldest = 0;
+    rewind->last_direction = game->snake.direction;
+    game_now(&now);
+    rewind->boost_us = pack_boost(&game->speed_boost, now);
+    for (int i = 0; i < REWIND_KEYFRAMES; i++) {
+        rewind->keyframes[i].tick = (unsigned long)-1;
+    }
+    save_keyframe(rewind, game, game_rng_state());
+}
+
+static void record(RewindBuffer *rewind, const GameState *before, const GameState *after,
+                   uint64_t rng_before, struct timeval now) {
+    RewindDelta *delta;
+
+    // Playing on after a rewind replaces the old future
+    rewind->newest = ++rewind->tick;
+    if (rewind->newest - rewind->oldest > REWIND_TICKS) {
+        rewind->oldest = rewind->newest - REWIND_TICKS;
+    }
+
+    delta = delta_at(rewind, rewind->tick);
+    delta->rng_before = rng_before;
+    delta->rng_after = game_rng_state();
+    delta->boost_before_us = rewind->boost_us;
+    delta->boost_after_us = pack_boost(&after->speed_boost, now);
+    rewind->boost_us = delta->boost_after_us;
+    delta->score_delta = (int16_t)(after->score - before->score);
+    delta->head_x = (int8_t)after->snake.body[0].x;
+    delta->head_y = (int8_t)after->snake.body[0].y;
+    delta->tail_x = (int8_t)before->snake.body[before->snake.length - 1].x;
+    delta->tail_y = (int8_t)before->snake.body[before->snake.length - 1].y;
+    delta->obstacle_x = 0;
+    delta->obstacle_y = 0;
+    if (after->obstacles.count > before->obstacles.count) {
+        delta->obstacle_x = (int8_t)after->obstacles.obstacles[before->obstacles.count].x;
+        delta->obstacle_y = (int8_t)after->obstacles.obstacles[before->obstacles.count].y;
+    }
+    delta->food_before = pack_food(&before->food);
+    delta->food_after = pack_food(&after->food);
+    delta->moves = (uint8_t)(rewind->last_direction | before->snake.direction << 2 |
+                             (after->snake.length - before->snake.length) << 4);
+    delta->eaten = 0;
+    for (int type = 0; type < 4; type++) {
+        if (after->special_apples_eaten[type] != before->special_apples_eaten[type]) {
+            delta->eaten = (uint8_t)(type + 1);
+        }
+    }
+    delta->states = (uint8_t)(before->state | after->state << 4);
+
+    rewind->last_direction = after->snake.direction;
+    if (rewind->tick % REWIND_KEYFRAME_INTERVAL == 0) {
+        save_keyframe(rewind, after, delta->rng_after);
+    }
+}
+
+int rewind_update(RewindBuffer *rewind, GameState *game) {
+    GameState before;
+    struct timeval now;
+    uint64_t rng = game_rng_state();
+
+    // Paused or finished games do not change, so there is nothing to record
+    if (game->state != GAME_RUNNING) {
+        return update_game(game);
+    }
+    before = *game;
+    int result = update_game(game);
+    game_now(&now);
+
+    if (game->foods) {
+        rewind->oldest = rewind->newest = ++rewind->tick;
+        rewind->last_direction = game->snake.direction;
+        rewind->boost_us = pack_boost(&game->speed_boost, now);
+        return result;
+    }
+    record(rewind, &before, game, rng, now);
+    return result;
+}
+
+// Delta `tick` backwards: state tick -> tick - 1
+static void undo(const RewindDelta *delta, GameState *game) {
+    int length = game->snake.length - (delta->moves >> 4);
+    Point *body = game->snake.body;
+
+    memmove(body, body + 1, sizeof(Point) * (size_t)(length - 1));
+    body[length - 1].x = delta->tail_x;
+    body[length - 1].y = delta->tail_y;
+    game->snake.length = length;
+    game->snake.direction = delta->moves & 3;
+
+    unpack_food(&delta->food_before, &game->food);
+    if (delta->obstacle_x) {
+        game->obstacles.count--;
+        grid_reset(&game->obstacles.grid, delta->obstacle_x, delta->obstacle_y);
+    }
+    game->score -= delta->score_delta;
+    if (delta->eaten) {
+        game->apples_eaten--;
+        game->special_apples_eaten[delta->eaten - 1]--;
+    }
+    game->state = delta->states & 15;
+    game_set_rng_state(delta->rng_before);
+}
+
+// Delta `tick` forwards: state tick - 1 -> tick, the same way update_game() got there
+static void redo(const RewindDelta *delta, GameState *game) {
+    Point *body = game->snake.body;
+
+    memmove(body + 1, body, sizeof(Point) * (size_t)(game->snake.length - 1));
+    body[0].x = delta->head_x;
+    body[0].y = delta->head_y;
+    for (int i = 0; i < delta->moves >> 4; i++) {
+        body[game->snake.length] = body[game->snake.length - 1];
+        game->snake.length++;
+    }
+    game->snake.direction = (delta->moves >> 2) & 3;
+
+    unpack_food(&delta->food_after, &game->food);
+    if (delta->obstacle_x) {
+        Point wall = { delta->obstacle_x, delta->obstacle_y };
+        game->obstacles.obstacles[game->obstacles.count++] = wall;
+        grid_set(&game->obstacles.grid, wall.x, wall.y);
+    }
+    game->score += delta->score_delta;
+    if (delta->eaten) {
+        game->apples_eaten++;
+        game->special_apples_eaten[delta->eaten - 1]++;
+    }
+    game->state = delta->states >> 4;
+    game_set_rng_state(delta->rng_after);
+}
+
+int rewind_seek(RewindBuffer *rewind, GameState *game, unsigned long tick) {
+    struct timeval now;
+
+    if (tick < rewind->oldest || tick > rewind->newest) {
+        return -1;
+    }
+
+    // Replaying from the keyframe at or below the target beats walking
+    // there from the current tick when it is closer
+    unsigned long base = tick - tick % REWIND_KEYFRAME_INTERVAL;
+    unsigned long distance = tick > rewind->tick ? tick - rewind->tick : rewind->tick - tick;
+    RewindKeyframe *keyframe = keyframe_at(rewind, base);
+    if (keyframe->tick == base && base >= rewind->oldest && tick - base < distance) {
+        GameEventBus *events = game->events;
+        FoodPool *foods = game->foods;
+        *game = keyframe->state;
+        game->events = events;
+        game->foods = foods;
+        game_set_rng_state(keyframe->rng);
+        rewind->boost_us = keyframe->boost_us;
+        rewind->tick = base;
+    }
+
+    while (rewind->tick > tick) {
+        rewind->boost_us = delta_at(rewind, rewind->tick)->boost_before_us;
+        undo(delta_at(rewind, rewind->tick), game);
+        rewind->tick--;
+    }
+    while (rewind->tick < tick) {
+        rewind->tick++;
+        redo(delta_at(rewind, rewind->tick), game);
+        rewind->boost_us = delta_at(rewind, rewind->tick)->boost_after_us;
+    }
+
+    game_now(&now);
+    unpack_boost(rewind->boost_us, &game->speed_boost, now);
+
+    snake_rehash(&game->snake);
+    obstacles_rehash(&game->obstacles);
+    rewind->last_direction = game->snake.direction;
+    return 0;
+}
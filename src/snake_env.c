@@ -0,0 +1,225 @@
+#include "snake_env.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(WIDTH <= 64, "bit-plane rows are single 64-bit words");
+
+#define PLANE_CELLS (WIDTH * HEIGHT)
+#define ROW_MASK (WIDTH == 64 ? ~0ULL : (1ULL << WIDTH) - 1)
+
+// Virtual time of the environment being stepped on this thread
+static _Thread_local struct timeval env_now;
+
+static void env_clock(struct timeval *out) {
+    *out = env_now;
+}
+
+static void set_env_time(uint64_t ticks) {
+    uint64_t us = ticks * ENV_TICK_US;
+    env_now.tv_sec = (time_t)(us / 1000000);
+    env_now.tv_usec = (suseconds_t)(us % 1000000);
+}
+
+// ========== Observation writes ==========
+
+size_t snake_env_obs_size(int format) {
+    if (format == ENV_OBS_BITS) {
+        return sizeof(uint64_t) * ENV_PLANES * HEIGHT;
+    }
+    return (size_t)ENV_PLANES * PLANE_CELLS;
+}
+
+static void put_cell(const SnakeEnv *env, int i, int plane, int x, int y, int value) {
+    if (x < 1 || x > WIDTH || y < 1 || y > HEIGHT) {
+        return;
+    }
+    if (env->format == ENV_OBS_BITS) {
+        uint64_t *row = (uint64_t *)env->obs + ((size_t)i * ENV_PLANES + plane) * HEIGHT + (y - 1);
+        uint64_t bit = 1ULL << (x - 1);
+        *row = value ? (*row | bit) : (*row & ~bit);
+    } else {
+        uint8_t *planes = (uint8_t *)env->obs + (size_t)i * ENV_PLANES * PLANE_CELLS;
+        planes[plane * PLANE_CELLS + (y - 1) * WIDTH + (x - 1)] = (uint8_t)value;
+    }
+}
+
+static void fill_plane(const SnakeEnv *env, int i, int plane, int value) {
+    if (env->format == ENV_OBS_BITS) {
+        uint64_t *rows = (uint64_t *)env->obs + ((size_t)i * ENV_PLANES + plane) * HEIGHT;
+        for (int y = 0; y < HEIGHT; y++) {
+            rows[y] = value ? ROW_MASK : 0;
+        }
+    } else {
+        uint8_t *planes = (uint8_t *)env->obs + (size_t)i * ENV_PLANES * PLANE_CELLS;
+        memset(planes + plane * PLANE_CELLS, value, PLANE_CELLS);
+    }
+}
+
+// Snake plane follows the per-cell segment count, so a duplicated tail stays set
+static void refresh_snake_cell(const SnakeEnv *env, int i, Point p) {
+    const FastGame *game = &env->games[i];
+    if (p.x >= 0 && p.x < GRID_W && p.y >= 0 && p.y < GRID_H) {
+        put_cell(env, i, ENV_PLANE_SNAKE, p.x, p.y, game->cells[p.y][p.x] != 0);
+    }
+}
+
+static void write_obs(const SnakeEnv *env, int i) {
+    const FastGame *game = &env->games[i];
+    char *obs = (char *)env->obs + (size_t)i * snake_env_obs_size(env->format);
+
+    memset(obs, 0, snake_env_obs_size(env->format));
+    for (int s = 0; s < game->length; s++) {
+        Point p = game->ring[(game->head + s) & FAST_RING_MASK];
+        put_cell(env, i, ENV_PLANE_SNAKE, p.x, p.y, 1);
+    }
+    Point head = game->ring[game->head];
+    put_cell(env, i, ENV_PLANE_HEAD, head.x, head.y, 1);
+
+    if (game->food.active) {
+        put_cell(env, i, ENV_PLANE_FOOD + game->food.type,
+                 game->food.position.x, game->food.position.y, 1);
+    }
+    for (int y = 1; y <= HEIGHT; y++) {
+        for (int x = 1; x <= WIDTH; x++) {
+            if (grid_test(&game->obstacles.grid, x, y)) {
+                put_cell(env, i, ENV_PLANE_OBSTACLE, x, y, 1);
+            }
+        }
+    }
+    if (game->speed_boost.active) {
+        fill_plane(env, i, ENV_PLANE_BOOST, 1);
+    }
+}
+
+// ========== Environments ==========
+
+int snake_env_init(SnakeEnv *env, int count, int format, void *obs) {
+    memset(env, 0, sizeof(*env));
+    if (count <= 0 || !obs || (format != ENV_OBS_U8 && format != ENV_OBS_BITS)) {
+        return -1;
+    }
+
+    env->count = count;
+    env->format = format;
+    env->obs = obs;
+    env->games = malloc(sizeof(FastGame) * count);
+    env->rng = calloc(count, sizeof(uint64_t));
+    env->ticks = calloc(count, sizeof(uint64_t));
+    env->episodes = calloc(count, sizeof(uint64_t));
+    if (!env->games || !env->rng || !env->ticks || !env->episodes) {
+        snake_env_free(env);
+        return -1;
+    }
+    return 0;
+}
+
+void snake_env_free(SnakeEnv *env) {
+    free(env->games);
+    free(env->rng);
+    free(env->ticks);
+    free(env->episodes);
+    memset(env, 0, sizeof(*env));
+}
+
+// Starts a new episode from the environment's own random stream
+static void reset_one(SnakeEnv *env, int i) {
+    GameState state;
+
+    game_set_rng_state(env->rng[i]);
+    env->ticks[i] = 0;
+    set_env_time(0);
+
+    init_game_state(&state);
+    generate_food(&state.snake, &state.obstacles, &state.food);
+    fast_game_from_state(&env->games[i], &state);
+
+    env->rng[i] = game_rng_state();
+    write_obs(env, i);
+}
+
+void snake_env_reset(SnakeEnv *env, unsigned int seed) {
+    uint64_t saved_rng = game_rng_state();
+    GameClock saved_clock = game_get_clock();
+
+    game_set_clock(env_clock);
+    for (int i = 0; i < env->count; i++) {
+        game_srand(seed + (unsigned int)i);
+        env->rng[i] = game_rng_state();
+        env->episodes[i] = 0;
+        reset_one(env, i);
+    }
+    game_set_clock(saved_clock);
+    game_set_rng_state(saved_rng);
+}
+
+void snake_env_step(SnakeEnv *env, const uint8_t *actions, int32_t *rewards, uint8_t *dones) {
+    uint64_t saved_rng = game_rng_state();
+    GameClock saved_clock = game_get_clock();
+
+    game_set_clock(env_clock);
+    for (int i = 0; i < env->count; i++) {
+        FastGame *game = &env->games[i];
+        Point old_head = game->ring[game->head];
+        Point old_tail = game->ring[(game->head + game->length - 1) & FAST_RING_MASK];
+        Food old_food = game->food;
+        int old_obstacles = game->obstacles.count;
+        int old_boost = game->speed_boost.active;
+        int old_score = game->score;
+
+        game_set_rng_state(env->rng[i]);
+        set_env_time(++env->ticks[i]);
+        if (actions && actions[i] < ENV_ACTION_NONE) {
+            fast_game_turn(game, actions[i]);
+        }
+        int state = fast_game_step(game);
+        env->rng[i] = game_rng_state();
+
+        if (rewards) {
+            rewards[i] = game->score - old_score;
+        }
+        if (dones) {
+            dones[i] = state == GAME_OVER ? ENV_LOST : state == GAME_WON ? ENV_WON : ENV_RUNNING;
+        }
+        if (state != GAME_RUNNING) {
+            env->episodes[i]++;
+            reset_one(env, i);
+            continue;
+        }
+
+        // Only the cells this step touched
+        Point head = game->ring[game->head];
+        put_cell(env, i, ENV_PLANE_HEAD, old_head.x, old_head.y, 0);
+        put_cell(env, i, ENV_PLANE_HEAD, head.x, head.y, 1);
+        put_cell(env, i, ENV_PLANE_SNAKE, head.x, head.y, 1);
+        refresh_snake_cell(env, i, old_head);
+        refresh_snake_cell(env, i, old_tail);
+
+        if (old_food.active != game->food.active || old_food.type != game->food.type ||
+            old_food.position.x != game->food.position.x ||
+            old_food.position.y != game->food.position.y) {
+            if (old_food.active) {
+                put_cell(env, i, ENV_PLANE_FOOD + old_food.type,
+                         old_food.position.x, old_food.position.y, 0);
+            }
+            if (game->food.active) {
+                put_cell(env, i, ENV_PLANE_FOOD + game->food.type,
+                         game->food.position.x, game->food.position.y, 1);
+            }
+        }
+        for (int o = old_obstacles; o < game->obstacles.count; o++) {
+            put_cell(env, i, ENV_PLANE_OBSTACLE,
+                     game->obstacles.obstacles[o].x, game->obstacles.obstacles[o].y, 1);
+        }
+        if (old_boost != game->speed_boost.active) {
+            fill_plane(env, i, ENV_PLANE_BOOST, game->speed_boost.active);
+        }
+    }
+    game_set_clock(saved_clock);
+    game_set_rng_state(saved_rng);
+}
+
+void snake_env_observe(SnakeEnv *env) {
+    for (int i = 0; i < env->count; i++) {
+        write_obs(env, i);
+    }
+}
@@ -0,0 +1,179 @@
+#include "stats.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ========== Welford ==========
+
+void running_stats_init(RunningStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+void running_stats_add(RunningStats *stats, double value) {
+    double delta = value - stats->mean;
+
+    if (stats->count == 0 || value < stats->min) {
+        stats->min = value;
+    }
+    if (stats->count == 0 || value > stats->max) {
+        stats->max = value;
+    }
+    stats->count++;
+    stats->mean += delta / (double)stats->count;
+    stats->m2 += delta * (value - stats->mean);
+}
+
+void running_stats_merge(RunningStats *dst, const RunningStats *src) {
+    if (src->count == 0) {
+        return;
+    }
+    if (dst->count == 0) {
+        *dst = *src;
+        return;
+    }
+    // Chan et al. pairwise update
+    double n_a = (double)dst->count;
+    double n_b = (double)src->count;
+    double n = n_a + n_b;
+    double delta = src->mean - dst->mean;
+
+    dst->mean += delta * n_b / n;
+    dst->m2 += src->m2 + delta * delta * n_a * n_b / n;
+    dst->count += src->count;
+    if (src->min < dst->min) {
+        dst->min = src->min;
+    }
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+double running_stats_variance(const RunningStats *stats) {
+    return stats->count > 1 ? stats->m2 / (double)(stats->count - 1) : 0.0;
+}
+
+double running_stats_ci95(const RunningStats *stats) {
+    if (stats->count < 2) {
+        return 0.0;
+    }
+    return 1.96 * sqrt(running_stats_variance(stats) / (double)stats->count);
+}
+
+// ========== t-digest ==========
+
+// k1 scale function: centroids get small near the tails, so extreme
+// quantiles stay accurate while the middle is summarized coarsely
+static double scale_k(double q) {
+    return TDIGEST_COMPRESSION / (2.0 * M_PI) * asin(2.0 * q - 1.0);
+}
+
+static double scale_q(double k) {
+    return (sin(k * 2.0 * M_PI / TDIGEST_COMPRESSION) + 1.0) / 2.0;
+}
+
+static int by_mean(const void *a, const void *b) {
+    double x = ((const TDigestCentroid *)a)->mean;
+    double y = ((const TDigestCentroid *)b)->mean;
+    return (x > y) - (x < y);
+}
+
+// Sorts the buffered values in with the centroids and merges neighbours
+// while the merged centroid stays within one unit of k
+static void compress(TDigest *digest) {
+    TDigestCentroid *c = digest->centroids;
+    int n = digest->count + digest->buffered;
+    int out = 0;
+    double before = 0.0;
+    double limit;
+
+    if (digest->buffered == 0) {
+        return;
+    }
+    qsort(c, n, sizeof(TDigestCentroid), by_mean);
+
+    limit = scale_q(scale_k(0.0) + 1.0) * digest->total;
+    for (int i = 1; i < n; i++) {
+        if (before + c[out].weight + c[i].weight <= limit) {
+            c[out].mean += (c[i].mean - c[out].mean) * c[i].weight / (c[out].weight + c[i].weight);
+            c[out].weight += c[i].weight;
+        } else {
+            before += c[out].weight;
+            limit = scale_q(scale_k(before / digest->total) + 1.0) * digest->total;
+            c[++out] = c[i];
+        }
+    }
+    digest->count = out + 1;
+    digest->buffered = 0;
+}
+
+void tdigest_init(TDigest *digest) {
+    digest->count = 0;
+    digest->buffered = 0;
+    digest->total = 0.0;
+    digest->min = 0.0;
+    digest->max = 0.0;
+}
+
+void tdigest_add(TDigest *digest, double value, double weight) {
+    if (digest->total == 0.0 || value < digest->min) {
+        digest->min = value;
+    }
+    if (digest->total == 0.0 || value > digest->max) {
+        digest->max = value;
+    }
+    if (digest->buffered == TDIGEST_BUFFER) {
+        compress(digest);
+    }
+    TDigestCentroid *slot = &digest->centroids[digest->count + digest->buffered++];
+    slot->mean = value;
+    slot->weight = weight;
+    digest->total += weight;
+}
+
+void tdigest_merge(TDigest *dst, const TDigest *src) {
+    double min = dst->min;
+    double max = dst->max;
+    int empty = dst->total == 0.0;
+    int n = src->count + src->buffered;
+
+    for (int i = 0; i < n; i++) {
+        tdigest_add(dst, src->centroids[i].mean, src->centroids[i].weight);
+    }
+    // Centroid means lie inside the source range; keep its true extremes
+    if (n > 0) {
+        dst->min = empty || src->min < min ? src->min : min;
+        dst->max = empty || src->max > max ? src->max : max;
+    }
+}
+
+double tdigest_quantile(TDigest *digest, double q) {
+    const TDigestCentroid *c = digest->centroids;
+
+    if (digest->total == 0.0) {
+        return 0.0;
+    }
+    compress(digest);
+    if (q <= 0.0) {
+        return digest->min;
+    }
+    if (q >= 1.0) {
+        return digest->max;
+    }
+
+    // Interpolate between centroid centres, with min and max as the ends
+    double target = q * digest->total;
+    double cumulative = 0.0;
+    double prev_pos = 0.0;
+    double prev_value = digest->min;
+    for (int i = 0; i < digest->count; i++) {
+        double pos = cumulative + c[i].weight / 2.0;
+        if (target < pos) {
+            return prev_value + (c[i].mean - prev_value) * (target - prev_pos) / (pos - prev_pos);
+        }
+        cumulative += c[i].weight;
+        prev_pos = pos;
+        prev_value = c[i].mean;
+    }
+    return prev_value + (digest->max - prev_value) * (target - prev_pos) /
+                        (digest->total - prev_pos);
+}
@@ -0,0 +1,82 @@
+#include "ttable.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(TTEntry) == sizeof(uint64_t), "entries pack into one word");
+_Static_assert(sizeof(TTSlot) * TTABLE_BUCKET == 64, "a bucket is one cache line");
+
+static uint64_t pack(const TTEntry *entry) {
+    uint64_t data;
+    memcpy(&data, entry, sizeof(data));
+    return data;
+}
+
+static TTEntry unpack(uint64_t data) {
+    TTEntry entry;
+    memcpy(&entry, &data, sizeof(entry));
+    return entry;
+}
+
+int ttable_init(TTable *table, int log2_buckets) {
+    size_t buckets;
+
+    if (log2_buckets < 0 || log2_buckets > 40) {
+        return -1;
+    }
+    buckets = (size_t)1 << log2_buckets;
+    table->slots = aligned_alloc(64, buckets * TTABLE_BUCKET * sizeof(TTSlot));
+    if (!table->slots) {
+        return -1;
+    }
+    table->mask = buckets - 1;
+    ttable_clear(table);
+    return 0;
+}
+
+void ttable_free(TTable *table) {
+    free(table->slots);
+    table->slots = NULL;
+    table->mask = 0;
+}
+
+void ttable_clear(TTable *table) {
+    memset(table->slots, 0, (table->mask + 1) * TTABLE_BUCKET * sizeof(TTSlot));
+}
+
+int ttable_probe(const TTable *table, uint64_t key, TTEntry *entry) {
+    const TTSlot *bucket = &table->slots[(key & table->mask) * TTABLE_BUCKET];
+
+    for (int i = 0; i < TTABLE_BUCKET; i++) {
+        uint64_t data = __atomic_load_n(&bucket[i].data, __ATOMIC_RELAXED);
+        uint64_t check = __atomic_load_n(&bucket[i].check, __ATOMIC_RELAXED);
+        // A slot torn by a concurrent store fails this test
+        if ((check ^ data) == key && (check | data) != 0) {
+            *entry = unpack(data);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void ttable_store(TTable *table, uint64_t key, const TTEntry *entry) {
+    TTSlot *bucket = &table->slots[(key & table->mask) * TTABLE_BUCKET];
+    uint64_t data = pack(entry);
+    int victim = 0;
+    int victim_depth = INT16_MAX + 1;
+
+    for (int i = 0; i < TTABLE_BUCKET; i++) {
+        uint64_t old_data = __atomic_load_n(&bucket[i].data, __ATOMIC_RELAXED);
+        uint64_t old_check = __atomic_load_n(&bucket[i].check, __ATOMIC_RELAXED);
+        if ((old_check ^ old_data) == key || (old_check | old_data) == 0) {
+            victim = i;
+            break;
+        }
+        int depth = unpack(old_data).depth;
+        if (depth < victim_depth) {
+            victim = i;
+            victim_depth = depth;
+        }
+    }
+    __atomic_store_n(&bucket[victim].data, data, __ATOMIC_RELAXED);
+    __atomic_store_n(&bucket[victim].check, key ^ data, __ATOMIC_RELAXED);
+}
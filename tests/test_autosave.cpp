@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+extern "C" {
+    #include "snake.h"
+    #include "autosave.h"
+}
+
+static struct timeval test_now;
+
+static void test_clock(struct timeval *now) {
+    *now = test_now;
+}
+
+class AutosaveTest : public ::testing::Test {
+protected:
+    std::string dir;
+    std::string path;
+    GameState game;
+    std::unique_ptr<FoodPool> pool{ new FoodPool };
+    std::unique_ptr<AutosaveState> state{ new AutosaveState };
+
+    void SetUp() override {
+        char tmpl[] = "/tmp/snake_autosave_XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        dir = tmpl;
+        path = dir + "/autosave";
+        test_now.tv_sec = 1000;
+        test_now.tv_usec = 0;
+        game_set_clock(test_clock);
+        game_srand(21);
+        init_game_state(&game);
+    }
+
+    void TearDown() override {
+        game_set_clock(NULL);
+        autosave_remove(path.c_str());
+        unlink((path + ".tmp").c_str());
+        rmdir(dir.c_str());
+    }
+
+    void play(GameState *g, int ticks) {
+        for (int t = 0; t < ticks && g->state == GAME_RUNNING; t++) {
+            int dir = (t / 5) % 4;
+            if (is_valid_direction_change(g->snake.direction, dir)) {
+                g->snake.direction = dir;
+            }
+            test_now.tv_usec += 100000;
+            if (test_now.tv_usec >= 1000000) {
+                test_now.tv_sec++;
+                test_now.tv_usec -= 1000000;
+            }
+            update_game(g);
+        }
+    }
+
+    // Corrupts one byte in the middle of a checkpoint file
+    void corrupt(const std::string &file) {
+        FILE *f = fopen(file.c_str(), "r+b");
+        ASSERT_NE(f, nullptr);
+        fseek(f, 100, SEEK_SET);
+        int c = fgetc(f);
+        fseek(f, 100, SEEK_SET);
+        fputc(c ^ 0x5a, f);
+        fclose(f);
+    }
+};
+
+TEST_F(AutosaveTest, ResumedGamePlaysOnExactlyLikeTheOriginal) {
+    ASSERT_EQ(food_pool_init(pool.get(), 12, nullptr), 0);
+    game.foods = pool.get();
+    play(&game, 40);
+    ASSERT_EQ(game.state, GAME_RUNNING);
+
+    Autosave *saver = new Autosave;
+    ASSERT_EQ(autosave_start(saver, path.c_str(), 0), 0);
+    autosave_capture(saver, &game, 40, 7, 0);
+    autosave_stop(saver);
+    EXPECT_EQ(saver->saved, 1UL);
+    EXPECT_EQ(saver->failed, 0UL);
+    delete saver;
+
+    // The original goes on; the copy is restored from disk and resumed
+    struct timeval saved_at = test_now;
+    play(&game, 60);
+    uint64_t expected = game_state_hash(&game);
+
+    GameState copy;
+    std::unique_ptr<FoodPool> copy_pool(new FoodPool);
+    uint64_t sequence = 0;
+    game_srand(999);
+    ASSERT_EQ(autosave_load(path.c_str(), state.get(), &sequence), 0);
+    EXPECT_EQ(sequence, 1u);
+    EXPECT_EQ(state->tick, 40u);
+    EXPECT_EQ(state->level_id, 7);
+    autosave_restore(state.get(), &copy, copy_pool.get());
+    EXPECT_EQ(copy.state, GAME_PAUSED);
+    EXPECT_EQ(copy.foods, copy_pool.get());
+    EXPECT_EQ(copy.paused_at.tv_sec, saved_at.tv_sec);
+
+    test_now = saved_at;
+    resume_game(&copy);
+    play(&copy, 60);
+    EXPECT_EQ(game_state_hash(&copy), expected);
+}
+
+TEST_F(AutosaveTest, BoostTimeIsNotSpentWhileTheGameIsSaved) {
+    activate_speed_boost(&game.speed_boost);
+    test_now.tv_sec += 2;
+    state->game = game;
+    state->has_foods = 0;
+    state->rng = game_rng_state();
+    state->saved_at = test_now;
+    ASSERT_EQ(autosave_write(path.c_str(), state.get(), 1), 0);
+
+    // An hour later the boost still has its last second left
+    test_now.tv_sec += 3600;
+    GameState copy;
+    ASSERT_EQ(autosave_load(path.c_str(), state.get(), nullptr), 0);
+    autosave_restore(state.get(), &copy, nullptr);
+    resume_game(&copy);
+    EXPECT_TRUE(is_speed_boost_active(&copy.speed_boost));
+    test_now.tv_usec += 900000;
+    EXPECT_TRUE(is_speed_boost_active(&copy.speed_boost));
+    test_now.tv_sec += 1;
+    EXPECT_FALSE(is_speed_boost_active(&copy.speed_boost));
+}
+
+TEST_F(AutosaveTest, FallsBackToThePreviousCheckpoint) {
+    uint64_t sequence = 0;
+
+    EXPECT_EQ(autosave_load(path.c_str(), state.get(), &sequence), -1);
+
+    memset(state.get(), 0, sizeof(AutosaveState));
+    state->game = game;
+    state->tick = 10;
+    ASSERT_EQ(autosave_write(path.c_str(), state.get(), 1), 0);
+    state->tick = 20;
+    ASSERT_EQ(autosave_write(path.c_str(), state.get(), 2), 0);
+    EXPECT_EQ(access((path + ".prev").c_str(), F_OK), 0);
+
+    ASSERT_EQ(autosave_load(path.c_str(), state.get(), &sequence), 0);
+    EXPECT_EQ(state->tick, 20u);
+    EXPECT_EQ(sequence, 2u);
+
+    corrupt(path);
+    ASSERT_EQ(autosave_load(path.c_str(), state.get(), &sequence), 0);
+    EXPECT_EQ(state->tick, 10u);
+    EXPECT_EQ(sequence, 1u);
+
+    corrupt(path + ".prev");
+    EXPECT_EQ(autosave_load(path.c_str(), state.get(), &sequence), -1);
+}
+
+TEST_F(AutosaveTest, CapturesFasterThanTheDiskKeepOnlyTheLatest) {
+    Autosave *saver = new Autosave;
+    ASSERT_EQ(autosave_start(saver, path.c_str(), 5), 0);
+    for (int tick = 1; tick <= 2000; tick++) {
+        game.score = tick;
+        autosave_capture(saver, &game, (uint64_t)tick, 0, tick % 2);
+    }
+    autosave_stop(saver);
+
+    EXPECT_EQ(saver->captured, 2000UL);
+    EXPECT_EQ(saver->saved + saver->replaced, 2000UL);
+    EXPECT_EQ(saver->failed, 0UL);
+
+    uint64_t sequence = 0;
+    ASSERT_EQ(autosave_load(path.c_str(), state.get(), &sequence), 0);
+    EXPECT_EQ(state->tick, 2000u);
+    EXPECT_EQ(state->game.score, 2000);
+    EXPECT_EQ(state->rewound, 0);
+    EXPECT_EQ(sequence, 5 + saver->saved);
+    delete saver;
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+extern "C" {
+    #include "compact_game.h"
+    #include "level.h"
+}
+
+// Test fixture driving games on a tick-aligned clock
+class CompactGameTest : public ::testing::Test {
+protected:
+    GameState game;
+    CompactGame compact;
+
+    static struct timeval now;
+    static void test_clock(struct timeval *out) {
+        *out = now;
+    }
+
+    void SetUp() override {
+        game_set_clock(test_clock);
+        now.tv_sec = 1000;
+        now.tv_usec = 0;
+        init_game_state(&game);
+    }
+
+    void TearDown() override {
+        game_set_clock(NULL);
+    }
+
+    static void tick() {
+        now.tv_usec += COMPACT_TICK_US;
+        if (now.tv_usec >= 1000000) {
+            now.tv_sec++;
+            now.tv_usec -= 1000000;
+        }
+    }
+
+    void expect_round_trip(const Grid *walls) {
+        GameState back;
+        ASSERT_EQ(compact_game_from_state(&compact, &game, walls), 0);
+        compact_game_to_state(&compact, &back);
+        EXPECT_EQ(game_state_hash(&back), game_state_hash(&game));
+    }
+};
+
+struct timeval CompactGameTest::now;
+
+TEST_F(CompactGameTest, FitsOneCacheLine) {
+    EXPECT_EQ(sizeof(CompactGame), 64u);
+    EXPECT_EQ(alignof(CompactGame), 64u);
+}
+
+TEST_F(CompactGameTest, RoundTripInitialState) {
+    expect_round_trip(NULL);
+    EXPECT_EQ(compact.length, 3);
+    EXPECT_EQ(compact.stacked, 0);
+}
+
+TEST_F(CompactGameTest, RoundTripStackedTailAndBoost) {
+    game.food.active = 1;
+    game.food.type = FOOD_GOLD;
+    game.food.position.x = game.snake.body[0].x + 1;
+    game.food.position.y = game.snake.body[0].y;
+    update_game(&game);
+    grow_snake(&game.snake, 2);
+    tick();
+    tick();
+
+    expect_round_trip(NULL);
+    EXPECT_EQ(compact.stacked, 3);
+    EXPECT_EQ(compact.boost_age, 3);
+}
+
+TEST_F(CompactGameTest, RejectsUnrepresentableStates) {
+    GameState broken = game;
+    broken.snake.body[1].x += 5;
+    EXPECT_EQ(compact_game_from_state(&compact, &broken, NULL), -1);
+
+    // Walls that are not in the obstacle list need the level grid
+    broken = game;
+    grid_set(&broken.obstacles.grid, 2, 2);
+    EXPECT_EQ(compact_game_from_state(&compact, &broken, NULL), -1);
+
+    broken = game;
+    broken.score = 70000;
+    EXPECT_EQ(compact_game_from_state(&compact, &broken, NULL), -1);
+}
+
+TEST_F(CompactGameTest, PacksWithLevelWalls) {
+    Level level;
+    ASSERT_GE(level_generate(&level, LEVEL_ROOMS, 3), 0);
+    level_apply(&level, &game);
+    game.obstacles.obstacles[0].x = WIDTH;
+    game.obstacles.obstacles[0].y = HEIGHT;
+    game.obstacles.count = 1;
+    grid_set(&game.obstacles.grid, WIDTH, HEIGHT);
+
+    expect_round_trip(&level.walls);
+    EXPECT_EQ(compact_game_from_state(&compact, &game, NULL), -1);
+}
+
+// Keeps only the compact form between ticks and checks it never drifts
+// from a game played on GameState
+TEST_F(CompactGameTest, PlaysThroughCompactFormLikeReference) {
+    for (unsigned int seed = 1; seed <= 40; seed++) {
+        Level level;
+        FastGame fast;
+        unsigned int inputs = seed * 2654435761u + 1;
+
+        game_srand(seed);
+        level_generate(&level, (int)(seed % LEVEL_KIND_COUNT), seed);
+        level_apply(&level, &game);
+        ASSERT_EQ(compact_game_from_state(&compact, &game, &level.walls), 0);
+
+        for (int t = 0; t < 400; t++) {
+            inputs = inputs * 1103515245u + 12345u;
+            int dir = (int)((inputs >> 20) % 4);
+            if ((inputs >> 16) % 4 == 0 && is_valid_direction_change(game.snake.direction, dir)) {
+                game.snake.direction = dir;
+            }
+            tick();
+
+            uint64_t rng = game_rng_state();
+            int expected = update_game(&game);
+            game_set_rng_state(rng);
+
+            compact_game_to_fast(&compact, &fast);
+            if ((inputs >> 16) % 4 == 0) {
+                fast_game_turn(&fast, dir);
+            }
+            ASSERT_EQ(fast_game_step(&fast), expected) << "seed " << seed << " tick " << t;
+            ASSERT_EQ(compact_game_from_fast(&compact, &fast, &level.walls), 0);
+
+            GameState back;
+            compact_game_to_state(&compact, &back);
+            ASSERT_EQ(game_state_hash(&back), game_state_hash(&game))
+                << "seed " << seed << " tick " << t;
+            if (expected != GAME_RUNNING) {
+                break;
+            }
+        }
+    }
+}
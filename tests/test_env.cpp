@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+extern "C" {
+    #include "snake_env.h"
+}
+
+// Heads for the food most of the time so that games eat every apple type
+static uint8_t greedy_action(const FastGame *game, unsigned int r) {
+    Point head = game->ring[game->head];
+    if ((r >> 16) % 5 == 0) {
+        return (uint8_t)((r >> 20) % 5);
+    }
+    if (game->food.position.x > head.x) return DIR_RIGHT;
+    if (game->food.position.x < head.x) return DIR_LEFT;
+    return game->food.position.y > head.y ? DIR_DOWN : DIR_UP;
+}
+
+// Steps a batch and checks the incrementally maintained observations
+// against a full rewrite
+static void run_and_compare(int format, int count, int steps) {
+    size_t size = snake_env_obs_size(format);
+    std::vector<unsigned char> obs(size * count), fresh(size * count);
+    std::vector<uint8_t> actions(count);
+    SnakeEnv env, check;
+    unsigned int r = 12345;
+
+    ASSERT_EQ(snake_env_init(&env, count, format, obs.data()), 0);
+    ASSERT_EQ(snake_env_init(&check, count, format, fresh.data()), 0);
+    snake_env_reset(&env, 1);
+
+    for (int step = 0; step < steps; step++) {
+        for (int i = 0; i < count; i++) {
+            r = r * 1103515245u + 12345u;
+            actions[i] = greedy_action(&env.games[i], r);
+        }
+        snake_env_step(&env, actions.data(), NULL, NULL);
+
+        // Same games, observations rebuilt from scratch
+        memcpy(check.games, env.games, sizeof(FastGame) * count);
+        snake_env_observe(&check);
+        ASSERT_EQ(obs, fresh) << "step " << step;
+    }
+    // Some games ended, so auto-reset rewrites were compared as well
+    uint64_t episodes = 0;
+    for (int i = 0; i < count; i++) {
+        episodes += env.episodes[i];
+    }
+    EXPECT_GT(episodes, 0u);
+    snake_env_free(&env);
+    snake_env_free(&check);
+}
+
+TEST(SnakeEnvTest, IncrementalBytePlanesMatchFullRewrite) {
+    run_and_compare(ENV_OBS_U8, 8, 2000);
+}
+
+TEST(SnakeEnvTest, IncrementalBitPlanesMatchFullRewrite) {
+    run_and_compare(ENV_OBS_BITS, 8, 2000);
+}
+
+TEST(SnakeEnvTest, ResetObservation) {
+    std::vector<uint8_t> obs(snake_env_obs_size(ENV_OBS_U8));
+    SnakeEnv env;
+
+    ASSERT_EQ(snake_env_init(&env, 1, ENV_OBS_U8, obs.data()), 0);
+    snake_env_reset(&env, 3);
+
+    auto at = [&](int plane, int x, int y) {
+        return obs[plane * WIDTH * HEIGHT + (y - 1) * WIDTH + (x - 1)];
+    };
+    EXPECT_EQ(at(ENV_PLANE_HEAD, WIDTH / 2, HEIGHT / 2), 1);
+    EXPECT_EQ(at(ENV_PLANE_SNAKE, WIDTH / 2 - 2, HEIGHT / 2), 1);
+
+    const Food &food = env.games[0].food;
+    ASSERT_TRUE(food.active);
+    EXPECT_EQ(at(ENV_PLANE_FOOD + food.type, food.position.x, food.position.y), 1);
+
+    int snake = 0;
+    for (int c = 0; c < WIDTH * HEIGHT; c++) {
+        snake += obs[ENV_PLANE_SNAKE * WIDTH * HEIGHT + c];
+    }
+    EXPECT_EQ(snake, 3);
+    snake_env_free(&env);
+}
+
+TEST(SnakeEnvTest, AutoResetOnDeath) {
+    std::vector<uint8_t> obs(snake_env_obs_size(ENV_OBS_BITS) * 2);
+    SnakeEnv env;
+    uint8_t actions[2] = { DIR_UP, ENV_ACTION_NONE };
+    uint8_t dones[2];
+    int32_t rewards[2];
+    int died = -1;
+
+    ASSERT_EQ(snake_env_init(&env, 2, ENV_OBS_BITS, obs.data()), 0);
+    snake_env_reset(&env, 5);
+    for (int step = 0; step < HEIGHT && died < 0; step++) {
+        snake_env_step(&env, actions, rewards, dones);
+        if (dones[0] == ENV_LOST) {
+            died = step;
+        }
+    }
+
+    ASSERT_GE(died, 0);
+    EXPECT_EQ(env.episodes[0], 1u);
+    EXPECT_EQ(env.ticks[0], 0u);
+    EXPECT_EQ(env.games[0].state, GAME_RUNNING);
+    EXPECT_EQ(env.games[0].length, 3);
+
+    // The new episode is already visible in the observation
+    const uint64_t *head_rows = (const uint64_t *)obs.data() + ENV_PLANE_HEAD * HEIGHT;
+    EXPECT_EQ(head_rows[HEIGHT / 2 - 1], 1ULL << (WIDTH / 2 - 1));
+    snake_env_free(&env);
+}
+
+TEST(SnakeEnvTest, RewardsFollowScore) {
+    std::vector<uint8_t> obs(snake_env_obs_size(ENV_OBS_U8));
+    SnakeEnv env;
+    int32_t reward;
+    uint8_t done;
+
+    ASSERT_EQ(snake_env_init(&env, 1, ENV_OBS_U8, obs.data()), 0);
+    snake_env_reset(&env, 9);
+
+    FastGame *game = &env.games[0];
+    Point head = game->ring[game->head];
+    game->food.position.x = head.x + 1;
+    game->food.position.y = head.y;
+    game->food.type = FOOD_REGULAR;
+
+    snake_env_step(&env, NULL, &reward, &done);
+    EXPECT_EQ(reward, 10);
+    EXPECT_EQ(done, ENV_RUNNING);
+    snake_env_free(&env);
+}
+
+TEST(SnakeEnvTest, SameSeedSameEpisodes) {
+    std::vector<uint8_t> a(snake_env_obs_size(ENV_OBS_U8) * 4), b(a.size());
+    SnakeEnv first, second;
+    uint8_t actions[4] = { DIR_UP, DIR_DOWN, ENV_ACTION_NONE, DIR_LEFT };
+
+    ASSERT_EQ(snake_env_init(&first, 4, ENV_OBS_U8, a.data()), 0);
+    ASSERT_EQ(snake_env_init(&second, 4, ENV_OBS_U8, b.data()), 0);
+    snake_env_reset(&first, 77);
+    game_srand(1);
+    snake_env_reset(&second, 77);
+    for (int step = 0; step < 300; step++) {
+        snake_env_step(&first, actions, NULL, NULL);
+        game_rand();
+        snake_env_step(&second, actions, NULL, NULL);
+    }
+    EXPECT_EQ(a, b);
+    snake_env_free(&first);
+    snake_env_free(&second);
+}
+
+TEST(SnakeEnvTest, RejectsBadArguments) {
+    uint8_t obs[8];
+    SnakeEnv env;
+    EXPECT_EQ(snake_env_init(&env, 0, ENV_OBS_U8, obs), -1);
+    EXPECT_EQ(snake_env_init(&env, 1, 7, obs), -1);
+    EXPECT_EQ(snake_env_init(&env, 1, ENV_OBS_U8, NULL), -1);
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+extern "C" {
+    #include "snake.h"
+}
+
+// Collects every event handed to a subscriber
+struct Recorder {
+    std::vector<GameEvent> events;
+    int calls = 0;
+};
+
+static void record_events(const GameEvent *events, int count,
+                          const GameState *game, void *context) {
+    (void)game;
+    Recorder *recorder = static_cast<Recorder *>(context);
+    recorder->events.assign(events, events + count);
+    recorder->calls++;
+}
+
+class EventTest : public ::testing::Test {
+protected:
+    GameState game;
+    GameEventBus bus;
+    Recorder recorder;
+
+    void SetUp() override {
+        game_srand(1);
+        init_game_state(&game);
+        game_events_init(&bus);
+        game_events_subscribe(&bus, record_events, &recorder);
+        game.events = &bus;
+    }
+
+    int count_type(int type) const {
+        int n = 0;
+        for (const GameEvent &event : recorder.events) {
+            n += event.type == type;
+        }
+        return n;
+    }
+
+    const GameEvent *find_type(int type) const {
+        for (const GameEvent &event : recorder.events) {
+            if (event.type == type) {
+                return &event;
+            }
+        }
+        return nullptr;
+    }
+};
+
+TEST_F(EventTest, MoveReportsHeadAndFreedTail) {
+    Point tail = game.snake.body[game.snake.length - 1];
+
+    EXPECT_EQ(update_game(&game), GAME_RUNNING);
+    EXPECT_EQ(recorder.calls, 1);
+    EXPECT_EQ(bus.tick, 1UL);
+
+    const GameEvent *moved = find_type(EVENT_MOVED);
+    ASSERT_NE(moved, nullptr);
+    EXPECT_EQ(moved->x, game.snake.body[0].x);
+    EXPECT_EQ(moved->y, game.snake.body[0].y);
+
+    const GameEvent *freed = find_type(EVENT_TAIL_FREED);
+    ASSERT_NE(freed, nullptr);
+    EXPECT_EQ(freed->x, tail.x);
+    EXPECT_EQ(freed->y, tail.y);
+}
+
+TEST_F(EventTest, GrowingTailFreesNothing) {
+    grow_snake(&game.snake, 1);
+
+    update_game(&game);
+    EXPECT_EQ(count_type(EVENT_TAIL_FREED), 0);
+    EXPECT_EQ(count_type(EVENT_MOVED), 1);
+}
+
+TEST_F(EventTest, EatingReportsFoodGrowthAndRespawn) {
+    game.food.position.x = game.snake.body[0].x + 1;
+    game.food.position.y = game.snake.body[0].y;
+    game.food.type = FOOD_GREEN;
+    game.food.active = 1;
+
+    update_game(&game);
+
+    const GameEvent *eaten = find_type(EVENT_FOOD_EATEN);
+    ASSERT_NE(eaten, nullptr);
+    EXPECT_EQ(eaten->arg, FOOD_GREEN);
+    EXPECT_EQ(eaten->x, game.snake.body[0].x);
+
+    const GameEvent *grew = find_type(EVENT_GREW);
+    ASSERT_NE(grew, nullptr);
+    EXPECT_EQ(grew->arg, 2);
+
+    const GameEvent *spawned = find_type(EVENT_FOOD_SPAWNED);
+    ASSERT_NE(spawned, nullptr);
+    EXPECT_EQ(spawned->x, game.food.position.x);
+    EXPECT_EQ(spawned->y, game.food.position.y);
+    EXPECT_EQ(spawned->arg, game.food.type);
+}
+
+TEST_F(EventTest, BlueAppleReportsObstacle) {
+    game.food.position.x = game.snake.body[0].x + 1;
+    game.food.position.y = game.snake.body[0].y;
+    game.food.type = FOOD_BLUE;
+    game.food.active = 1;
+
+    update_game(&game);
+
+    const GameEvent *added = find_type(EVENT_OBSTACLE_ADDED);
+    ASSERT_NE(added, nullptr);
+    EXPECT_GE(added->arg, 1);
+    EXPECT_EQ(added->x, game.obstacles.obstacles[0].x);
+    EXPECT_EQ(added->y, game.obstacles.obstacles[0].y);
+}
+
+TEST_F(EventTest, DeathReportsCause) {
+    game.snake.body[0].x = WIDTH;
+    game.snake.direction = DIR_RIGHT;
+
+    EXPECT_EQ(update_game(&game), GAME_OVER);
+    const GameEvent *died = find_type(EVENT_DIED);
+    ASSERT_NE(died, nullptr);
+    EXPECT_EQ(died->arg, DEATH_WALL);
+    EXPECT_EQ(recorder.calls, 1);
+}
+
+TEST_F(EventTest, CollisionCauseMatchesCheckCollision) {
+    EXPECT_EQ(collision_cause(&game.snake, &game.obstacles), DEATH_NONE);
+
+    game.obstacles.obstacles[0].x = game.snake.body[0].x;
+    game.obstacles.obstacles[0].y = game.snake.body[0].y;
+    game.obstacles.count = 1;
+    grid_set(&game.obstacles.grid, game.snake.body[0].x, game.snake.body[0].y);
+    EXPECT_EQ(collision_cause(&game.snake, &game.obstacles), DEATH_OBSTACLE);
+
+    game.snake.body[0] = game.snake.body[2];
+    EXPECT_EQ(collision_cause(&game.snake, &game.obstacles), DEATH_SELF);
+
+    game.snake.body[0].x = 0;
+    EXPECT_EQ(collision_cause(&game.snake, &game.obstacles), DEATH_WALL);
+}
+
+TEST_F(EventTest, BufferResetsEveryTick) {
+    update_game(&game);
+    update_game(&game);
+    EXPECT_EQ(recorder.calls, 2);
+    EXPECT_EQ(bus.count, (int)recorder.events.size());
+    EXPECT_EQ(count_type(EVENT_MOVED), 1);
+}
+
+TEST_F(EventTest, DetachedBusIsUntouched) {
+    game.events = NULL;
+    update_game(&game);
+    EXPECT_EQ(recorder.calls, 0);
+    EXPECT_EQ(bus.tick, 0UL);
+}
+
+TEST(EventBusTest, SubscribersAreLimited) {
+    GameEventBus bus;
+    Recorder recorder;
+
+    game_events_init(&bus);
+    for (int i = 0; i < GAME_EVENT_SUBSCRIBERS_MAX; i++) {
+        EXPECT_EQ(game_events_subscribe(&bus, record_events, &recorder), 0);
+    }
+    EXPECT_EQ(game_events_subscribe(&bus, record_events, &recorder), -1);
+}
+
+TEST(EventBusTest, OverflowIsDropped) {
+    GameEventBus bus;
+
+    game_events_init(&bus);
+    for (int i = 0; i < GAME_EVENTS_MAX + 4; i++) {
+        game_events_emit(&bus, EVENT_MOVED, 0, i, 0);
+    }
+    EXPECT_EQ(bus.count, GAME_EVENTS_MAX);
+    EXPECT_EQ(bus.events[GAME_EVENTS_MAX - 1].x, GAME_EVENTS_MAX - 1);
+    EXPECT_EQ(bus.dropped, 4UL);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+extern "C" {
+    #include "fast_game.h"
+    #include "level.h"
+}
+
+// Test fixture comparing the ring-buffer engine with game.c
+class FastGameTest : public ::testing::Test {
+protected:
+    GameState game;
+    FastGame fast;
+
+    void SetUp() override {
+        init_game_state(&game);
+        fast_game_from_state(&fast, &game);
+    }
+
+    static struct timeval now;
+    static void test_clock(struct timeval *out) {
+        *out = now;
+    }
+
+    // Plays one seeded game on both engines and checks they never diverge
+    void expect_same_game(unsigned int seed, int kind) {
+        Level level;
+        unsigned int inputs = seed * 2654435761u + 1;
+
+        game_set_clock(test_clock);
+        now.tv_sec = 1000;
+        now.tv_usec = 0;
+        game_srand(seed);
+        level_generate(&level, kind, seed);
+        level_apply(&level, &game);
+        fast_game_from_state(&fast, &game);
+
+        for (int tick = 0; tick < 500; tick++) {
+            inputs = inputs * 1103515245u + 12345u;
+            if ((inputs >> 16) % 4 == 0) {
+                int dir = (int)((inputs >> 20) % 4);
+                if (is_valid_direction_change(game.snake.direction, dir)) {
+                    game.snake.direction = dir;
+                }
+                fast_game_turn(&fast, dir);
+            }
+            now.tv_usec += 100000;
+            if (now.tv_usec >= 1000000) {
+                now.tv_sec++;
+                now.tv_usec -= 1000000;
+            }
+
+            uint64_t rng = game_rng_state();
+            int expected = update_game(&game);
+            uint64_t rng_after = game_rng_state();
+            game_set_rng_state(rng);
+            int actual = fast_game_step(&fast);
+
+            GameState converted;
+            fast_game_to_state(&fast, &converted);
+            ASSERT_EQ(actual, expected) << "seed " << seed << " tick " << tick;
+            ASSERT_EQ(game_rng_state(), rng_after) << "seed " << seed << " tick " << tick;
+            ASSERT_EQ(game_state_hash(&converted), game_state_hash(&game))
+                << "seed " << seed << " tick " << tick;
+            if (expected != GAME_RUNNING) {
+                break;
+            }
+        }
+        game_set_clock(NULL);
+    }
+};
+
+struct timeval FastGameTest::now;
+
+// ========== Conversion Tests ==========
+
+TEST_F(FastGameTest, RoundTripPreservesState) {
+    GameState back;
+    game.score = 40;
+    game.food.active = 1;
+    game.food.position.x = 3;
+    game.food.position.y = 4;
+    fast_game_from_state(&fast, &game);
+    fast_game_to_state(&fast, &back);
+    EXPECT_EQ(game_state_hash(&back), game_state_hash(&game));
+}
+
+TEST_F(FastGameTest, TurnRejectsReverse) {
+    fast_game_turn(&fast, DIR_LEFT);
+    EXPECT_EQ(fast.direction, DIR_RIGHT);
+    fast_game_turn(&fast, DIR_UP);
+    EXPECT_EQ(fast.direction, DIR_UP);
+}
+
+// ========== Semantics Tests ==========
+
+TEST_F(FastGameTest, WallCollisionMatchesReference) {
+    game.snake.body[0].x = WIDTH;
+    fast_game_from_state(&fast, &game);
+    EXPECT_EQ(update_game(&game), GAME_OVER);
+    EXPECT_EQ(fast_game_step(&fast), GAME_OVER);
+}
+
+TEST_F(FastGameTest, GreenAppleMatchesReference) {
+    game.food.active = 1;
+    game.food.type = FOOD_GREEN;
+    game.food.position.x = game.snake.body[0].x + 1;
+    game.food.position.y = game.snake.body[0].y;
+    fast_game_from_state(&fast, &game);
+
+    game_srand(5);
+    update_game(&game);
+    game_srand(5);
+    fast_game_step(&fast);
+
+    GameState converted;
+    fast_game_to_state(&fast, &converted);
+    EXPECT_EQ(converted.snake.length, 5);
+    EXPECT_EQ(game_state_hash(&converted), game_state_hash(&game));
+}
+
+TEST_F(FastGameTest, RandomGamesMatchReference) {
+    for (unsigned int seed = 1; seed <= 200; seed++) {
+        expect_same_game(seed, (int)(seed % LEVEL_KIND_COUNT));
+    }
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <utility>
+
+extern "C" {
+    #include "snake.h"
+}
+
+// Counts spawn events over every batch a tick hands out
+static void count_spawns(const GameEvent *events, int count, const GameState *game, void *context) {
+    (void)game;
+    for (int i = 0; i < count; i++) {
+        *static_cast<int *>(context) += events[i].type == EVENT_FOOD_SPAWNED;
+    }
+}
+
+class FoodPoolTest : public ::testing::Test {
+protected:
+    GameState game;
+    FoodPool pool;
+
+    void SetUp() override {
+        game_srand(7);
+        init_game_state(&game);
+    }
+
+    // Every food sits on a distinct free cell and the index agrees with the array
+    void expect_consistent() {
+        std::set<std::pair<int, int>> cells;
+        int indexed = 0;
+
+        for (int i = 0; i < pool.count; i++) {
+            const Food &food = pool.foods[i];
+            EXPECT_TRUE(food.active);
+            EXPECT_TRUE(cells.insert({ food.position.x, food.position.y }).second);
+            EXPECT_EQ(food_pool_find(&pool, food.position.x, food.position.y), i);
+            EXPECT_FALSE(is_position_on_obstacle(&game.obstacles, food.position.x, food.position.y));
+        }
+        for (int y = 0; y < GRID_H; y++) {
+            for (int x = 0; x < GRID_W; x++) {
+                indexed += food_pool_find(&pool, x, y) >= 0;
+            }
+        }
+        EXPECT_EQ(indexed, pool.count);
+    }
+};
+
+TEST_F(FoodPoolTest, AliasTableMatchesWeights) {
+    const int weights[4] = { 60, 15, 10, 15 };
+    const int samples = 400000;
+    int counts[4] = { 0, 0, 0, 0 };
+    FoodAlias alias;
+
+    ASSERT_EQ(food_alias_build(&alias, weights), 0);
+    for (int i = 0; i < samples; i++) {
+        counts[food_alias_sample(&alias)]++;
+    }
+    for (int type = 0; type < 4; type++) {
+        EXPECT_NEAR(counts[type] / (double)samples, weights[type] / 100.0, 0.005) << type;
+    }
+}
+
+TEST_F(FoodPoolTest, AliasTableRejectsBadWeightsAndSkipsZeroes) {
+    const int none[4] = { 0, 0, 0, 0 };
+    const int negative[4] = { 10, -1, 5, 5 };
+    const int gold_only[4] = { 0, 0, 3, 0 };
+    const int no_blue[4] = { 1, 1, 1, 0 };
+    FoodAlias alias;
+
+    EXPECT_EQ(food_alias_build(&alias, none), -1);
+    EXPECT_EQ(food_alias_build(&alias, negative), -1);
+
+    ASSERT_EQ(food_alias_build(&alias, gold_only), 0);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(food_alias_sample(&alias), FOOD_GOLD);
+    }
+    ASSERT_EQ(food_alias_build(&alias, no_blue), 0);
+    for (int i = 0; i < 10000; i++) {
+        EXPECT_NE(food_alias_sample(&alias), FOOD_BLUE);
+    }
+}
+
+TEST_F(FoodPoolTest, FirstTickFillsPoolOffTheSnake) {
+    ASSERT_EQ(food_pool_init(&pool, 300, nullptr), 0);
+    game.foods = &pool;
+
+    ASSERT_EQ(update_game(&game), GAME_RUNNING);
+    EXPECT_EQ(pool.count, 300);
+    EXPECT_FALSE(game.food.active);
+    for (int i = 0; i < pool.count; i++) {
+        EXPECT_FALSE(is_position_on_snake(&game.snake, pool.foods[i].position.x,
+                                          pool.foods[i].position.y));
+    }
+    expect_consistent();
+}
+
+TEST_F(FoodPoolTest, FillingPastTheEventBufferReachesSubscribers) {
+    GameEventBus bus;
+    int spawned = 0;
+    game_events_init(&bus);
+    ASSERT_EQ(game_events_subscribe(&bus, count_spawns, &spawned), 0);
+    ASSERT_EQ(food_pool_init(&pool, 100, nullptr), 0);
+    game.foods = &pool;
+    game.events = &bus;
+
+    ASSERT_EQ(update_game(&game), GAME_RUNNING);
+    EXPECT_EQ(pool.count, 100);
+    EXPECT_EQ(spawned, 100);
+    EXPECT_EQ(bus.dropped, 0UL);
+}
+
+TEST_F(FoodPoolTest, EatingRespawnsOnlyTheEatenFood) {
+    ASSERT_EQ(food_pool_init(&pool, 50, nullptr), 0);
+    game.foods = &pool;
+    ASSERT_EQ(update_game(&game), GAME_RUNNING);
+
+    // Move the snake so that it eats a food away from the left wall next tick
+    int index = 0;
+    while (pool.foods[index].position.x < 5) {
+        index++;
+    }
+    Point ahead = pool.foods[index].position;
+    for (int i = 0; i < game.snake.length; i++) {
+        game.snake.body[i].x = ahead.x - 1 - i;
+        game.snake.body[i].y = ahead.y;
+    }
+    game.snake.direction = DIR_RIGHT;
+    snake_rehash(&game.snake);
+    int type = pool.foods[index].type;
+    const int scores[4] = { 10, 20, 50, 15 };
+    const int growth[4] = { 1, 2, 1, 1 };
+    FoodPool before = pool;
+    int length = game.snake.length;
+
+    ASSERT_EQ(update_game(&game), GAME_RUNNING);
+    EXPECT_EQ(game.score, scores[type]);
+    EXPECT_EQ(game.snake.length, length + growth[type]);
+    EXPECT_EQ(pool.count, before.count);
+    for (int i = 0; i < pool.count; i++) {
+        if (i == index) {
+            EXPECT_FALSE(pool.foods[i].position.x == ahead.x && pool.foods[i].position.y == ahead.y);
+            continue;
+        }
+        EXPECT_EQ(pool.foods[i].position.x, before.foods[i].position.x) << i;
+        EXPECT_EQ(pool.foods[i].position.y, before.foods[i].position.y) << i;
+        EXPECT_EQ(pool.foods[i].type, before.foods[i].type) << i;
+    }
+    EXPECT_EQ(food_pool_find(&pool, ahead.x, ahead.y), -1);
+    expect_consistent();
+}
+
+TEST_F(FoodPoolTest, FullBoardShrinksPoolAndKeepsIndexDense) {
+    ASSERT_EQ(food_pool_init(&pool, FOOD_POOL_MAX, nullptr), 0);
+    int spawned = 0;
+    while (food_pool_spawn(&pool, &game.snake, &game.obstacles) >= 0) {
+        spawned++;
+    }
+    EXPECT_EQ(spawned, WIDTH * HEIGHT - game.snake.length);
+    expect_consistent();
+
+    // The snake takes the eaten cell, so a respawn finds no room: the food
+    // goes away and the last one fills the gap
+    game.snake.body[game.snake.length++] = pool.foods[3].position;
+    uint64_t hash = pool.hash;
+    Food last = pool.foods[pool.count - 1];
+    EXPECT_EQ(food_pool_respawn(&pool, 3, &game.snake, &game.obstacles), -1);
+    EXPECT_EQ(pool.count, spawned - 1);
+    EXPECT_EQ(pool.foods[3].position.x, last.position.x);
+    EXPECT_EQ(pool.foods[3].position.y, last.position.y);
+    EXPECT_NE(pool.hash, hash);
+    expect_consistent();
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+
+extern "C" {
+    #include "snake.h"
+    #include "heatmap.h"
+}
+
+class HeatmapTest : public ::testing::Test {
+protected:
+    std::unique_ptr<Heatmap> heatmap{ new Heatmap() };
+    GameEventBus bus;
+    GameState game;
+
+    void SetUp() override {
+        heatmap_clear(heatmap.get());
+        game_srand(11);
+        init_game_state(&game);
+        game_events_init(&bus);
+        ASSERT_EQ(game_events_subscribe(&bus, heatmap_on_events, heatmap.get()), 0);
+        game.events = &bus;
+    }
+
+    // update_game() dispatches the tick's events itself
+    int tick() {
+        return update_game(&game);
+    }
+
+    static std::string write(const std::function<int(FILE *)> &writer) {
+        char *data = nullptr;
+        size_t size = 0;
+        FILE *out = open_memstream(&data, &size);
+        EXPECT_EQ(writer(out), 0);
+        fclose(out);
+        std::string text(data, size);
+        free(data);
+        return text;
+    }
+};
+
+TEST_F(HeatmapTest, EventsLandOnTheirCells) {
+    Point start = game.snake.body[0];
+    game.food.active = 1;
+    game.food.type = FOOD_REGULAR;
+    game.food.position.x = start.x + 1;
+    game.food.position.y = start.y;
+
+    tick();
+    EXPECT_EQ(heatmap_get(heatmap.get(), HEATMAP_VISITS, start.x + 1, start.y), 1u);
+    EXPECT_EQ(heatmap_get(heatmap.get(), HEATMAP_FOOD, start.x + 1, start.y), 1u);
+
+    // A wall death is counted on the border cell the head ran into
+    int moves = 1;
+    while (tick() == GAME_RUNNING) {
+        moves++;
+    }
+    EXPECT_EQ(heatmap_get(heatmap.get(), HEATMAP_DEATH_WALL, WIDTH + 1, start.y), 1u);
+    EXPECT_EQ(heatmap_get(heatmap.get(), HEATMAP_DEATH_SELF, WIDTH + 1, start.y), 0u);
+    EXPECT_EQ(heatmap->games, 1u);
+
+    uint64_t visits = 0;
+    for (int y = 0; y < GRID_H; y++) {
+        for (int x = 0; x < GRID_W; x++) {
+            visits += heatmap_get(heatmap.get(), HEATMAP_VISITS, x, y);
+        }
+    }
+    EXPECT_EQ(visits, (uint64_t)moves + 1);
+}
+
+TEST_F(HeatmapTest, MergeSumsEveryLayer) {
+    std::unique_ptr<Heatmap> other{ new Heatmap() };
+    heatmap_clear(other.get());
+
+    heatmap_add(heatmap.get(), HEATMAP_VISITS, 0, 0);
+    heatmap_add(other.get(), HEATMAP_VISITS, 0, 0);
+    heatmap_add(other.get(), HEATMAP_DEATH_OBSTACLE, GRID_W - 1, GRID_H - 1);
+    heatmap_add(other.get(), HEATMAP_FOOD, GRID_W, 0);  // Off the grid: ignored
+    other->games = 3;
+    heatmap_merge(heatmap.get(), other.get());
+
+    EXPECT_EQ(heatmap_get(heatmap.get(), HEATMAP_VISITS, 0, 0), 2u);
+    EXPECT_EQ(heatmap_get(heatmap.get(), HEATMAP_DEATH_OBSTACLE, GRID_W - 1, GRID_H - 1), 1u);
+    EXPECT_EQ(heatmap_get(heatmap.get(), HEATMAP_FOOD, 0, 1), 0u);
+    EXPECT_EQ(heatmap->games, 3u);
+}
+
+TEST_F(HeatmapTest, ExportsCsvAndPgm) {
+    heatmap_add(heatmap.get(), HEATMAP_FOOD, 2, 1);
+    heatmap_add(heatmap.get(), HEATMAP_FOOD, 2, 1);
+    heatmap_add(heatmap.get(), HEATMAP_FOOD, 3, 1);
+
+    std::string csv = write([&](FILE *out) { return heatmap_write_csv(heatmap.get(), out); });
+    EXPECT_EQ(csv.rfind("x,y,visits,food,wall,self,obstacle\n0,0,0,0,0,0,0\n", 0), 0u);
+    EXPECT_NE(csv.find("\n2,1,0,2,0,0,0\n"), std::string::npos);
+    EXPECT_EQ(std::count(csv.begin(), csv.end(), '\n'), GRID_W * GRID_H + 1);
+
+    std::string pgm = write([&](FILE *out) {
+        return heatmap_write_pgm(heatmap.get(), HEATMAP_FOOD, out);
+    });
+    std::string head = "P5\n" + std::to_string(GRID_W) + " " + std::to_string(GRID_H) + "\n255\n";
+    ASSERT_EQ(pgm.size(), head.size() + GRID_W * GRID_H);
+    EXPECT_EQ(pgm.compare(0, head.size(), head), 0);
+    // Brightness is logarithmic: the busiest cell is white, one hit of two is 63%
+    EXPECT_EQ((unsigned char)pgm[head.size() + GRID_W + 2], 255);
+    EXPECT_EQ((unsigned char)pgm[head.size() + GRID_W + 3], 161);
+    EXPECT_EQ((unsigned char)pgm[head.size()], 0);
+}
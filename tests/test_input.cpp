@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+
+extern "C" {
+    #include "input.h"
+}
+
+static int decode(const char *s, int *used) {
+    return input_decode(reinterpret_cast<const unsigned char *>(s), (int)strlen(s), used);
+}
+
+TEST(InputDecodeTest, LettersAndQuit) {
+    int used;
+    EXPECT_EQ(decode("w", &used), INPUT_UP);
+    EXPECT_EQ(decode("D", &used), INPUT_RIGHT);
+    EXPECT_EQ(decode("s", &used), INPUT_DOWN);
+    EXPECT_EQ(decode("a", &used), INPUT_LEFT);
+    EXPECT_EQ(decode("Q", &used), INPUT_QUIT);
+    EXPECT_EQ(decode("p", &used), INPUT_PAUSE);
+    EXPECT_EQ(decode(" ", &used), INPUT_PAUSE);
+    EXPECT_EQ(decode("[", &used), INPUT_REWIND);
+    EXPECT_EQ(decode("]", &used), INPUT_FORWARD);
+    EXPECT_EQ(decode("{", &used), INPUT_REWIND_FAR);
+    EXPECT_EQ(decode("}", &used), INPUT_FORWARD_FAR);
+    EXPECT_EQ(decode("x", &used), INPUT_OTHER);
+    EXPECT_EQ(used, 1);
+}
+
+TEST(InputDecodeTest, ArrowsInBothCursorModes) {
+    int used;
+    EXPECT_EQ(decode("\x1b[A", &used), INPUT_UP);
+    EXPECT_EQ(used, 3);
+    EXPECT_EQ(decode("\x1b[C", &used), INPUT_RIGHT);
+    EXPECT_EQ(decode("\x1bOB", &used), INPUT_DOWN);
+    EXPECT_EQ(decode("\x1bOD", &used), INPUT_LEFT);
+}
+
+TEST(InputDecodeTest, PartialSequenceWaits) {
+    int used;
+    EXPECT_EQ(decode("\x1b", &used), INPUT_NONE);
+    EXPECT_EQ(used, 0);
+    EXPECT_EQ(decode("\x1b[", &used), INPUT_NONE);
+    EXPECT_EQ(used, 0);
+    EXPECT_EQ(decode("\x1bx", &used), INPUT_OTHER);
+    EXPECT_EQ(used, 1);
+}
+
+TEST(InputRingTest, FifoUntilFull) {
+    InputRing ring;
+    InputCommand command;
+
+    input_ring_init(&ring);
+    EXPECT_EQ(input_ring_pop(&ring, &command), 0);
+
+    for (int i = 0; i < INPUT_RING_SIZE; i++) {
+        InputCommand in = { i, (uint64_t)i };
+        EXPECT_EQ(input_ring_push(&ring, &in), 0);
+    }
+    InputCommand extra = { 0, 0 };
+    EXPECT_EQ(input_ring_push(&ring, &extra), -1);
+
+    for (int i = 0; i < INPUT_RING_SIZE; i++) {
+        ASSERT_EQ(input_ring_pop(&ring, &command), 1);
+        EXPECT_EQ(command.key, i);
+    }
+    EXPECT_EQ(input_ring_pop(&ring, &command), 0);
+}
+
+TEST(InputRingTest, CrossThreadOrderIsKept) {
+    static InputRing ring;
+    const int total = 20000;
+
+    input_ring_init(&ring);
+    std::thread producer([&] {
+        for (int i = 0; i < total; i++) {
+            InputCommand in = { i, (uint64_t)i * 3 };
+            while (input_ring_push(&ring, &in) < 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    while (expected < total) {
+        InputCommand command;
+        if (!input_ring_pop(&ring, &command)) {
+            // Let the producer run, which matters on a single CPU
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(command.key, expected);
+        ASSERT_EQ(command.time_ns, (uint64_t)expected * 3);
+        expected++;
+    }
+    producer.join();
+}
+
+TEST(InputThreadTest, DecodesKeysFromDescriptor) {
+    static InputThread input;
+    int fds[2];
+    InputCommand command;
+    int keys[4];
+    int count = 0;
+
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(input_thread_start(&input, fds[0]), 0);
+
+    uint64_t before = input_now_ns();
+    ASSERT_EQ(write(fds[1], "w\x1b[Bq", 5), 5);
+    for (int spin = 0; spin < 2000 && count < 3; spin++) {
+        while (count < 4 && input_ring_pop(&input.ring, &command)) {
+            EXPECT_GE(command.time_ns, before);
+            keys[count++] = command.key;
+        }
+        usleep(1000);
+    }
+    input_thread_stop(&input);
+    close(fds[0]);
+    close(fds[1]);
+
+    ASSERT_EQ(count, 3);
+    EXPECT_EQ(keys[0], INPUT_UP);
+    EXPECT_EQ(keys[1], INPUT_DOWN);
+    EXPECT_EQ(keys[2], INPUT_QUIT);
+}
+
+TEST(InputThreadTest, WaitWakesOnKeyOrTimeout) {
+    static InputThread input;
+    int fds[2];
+
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(input_thread_start(&input, fds[0]), 0);
+
+    uint64_t start = input_now_ns();
+    EXPECT_EQ(input_wait(&input, 20000000), 0);
+    EXPECT_GE(input_now_ns() - start, 20000000u);
+
+    ASSERT_EQ(write(fds[1], "d", 1), 1);
+    EXPECT_EQ(input_wait(&input, 5000000000LL), 1);
+    InputCommand command;
+    ASSERT_EQ(input_ring_peek(&input.ring, &command), 1);
+    EXPECT_EQ(command.key, INPUT_RIGHT);
+    ASSERT_EQ(input_ring_pop(&input.ring, &command), 1);
+    EXPECT_EQ(input_ring_pop(&input.ring, &command), 0);
+
+    input_thread_stop(&input);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(InputThreadTest, LoneEscapeIsFlushed) {
+    static InputThread input;
+    int fds[2];
+    InputCommand command;
+    int got = 0;
+
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(input_thread_start(&input, fds[0]), 0);
+    ASSERT_EQ(write(fds[1], "\x1b", 1), 1);
+    for (int spin = 0; spin < 2000 && !got; spin++) {
+        got = input_ring_pop(&input.ring, &command);
+        usleep(1000);
+    }
+    input_thread_stop(&input);
+    close(fds[0]);
+    close(fds[1]);
+
+    ASSERT_TRUE(got);
+    EXPECT_EQ(command.key, INPUT_OTHER);
+}
+
+TEST(InputLatencyTest, PercentilesFollowBuckets) {
+    InputLatency latency;
+
+    memset(&latency, 0, sizeof(latency));
+    for (int i = 0; i < 99; i++) {
+        input_latency_add(&latency, 3000);       // 3 us
+    }
+    input_latency_add(&latency, 5000000);        // 5 ms
+
+    EXPECT_EQ(latency.count, 100UL);
+    EXPECT_EQ(latency.max_ns, 5000000u);
+    EXPECT_DOUBLE_EQ(input_latency_percentile(&latency, 0.5), 4.0);
+    EXPECT_DOUBLE_EQ(input_latency_percentile(&latency, 1.0), 5000.0);
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+extern "C" {
+    #include "leaderboard.h"
+}
+
+// Test fixture with a scratch leaderboard directory
+class LeaderboardTest : public ::testing::Test {
+protected:
+    char dir[32];
+    std::string log_path;
+    std::string snap_path;
+    Leaderboard board;
+
+    void SetUp() override {
+        strcpy(dir, "/tmp/snake_scores_XXXXXX");
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        log_path = std::string(dir) + "/scores.log";
+        snap_path = std::string(dir) + "/scores.snap";
+        ASSERT_EQ(leaderboard_open(&board, dir), 0);
+    }
+
+    void TearDown() override {
+        leaderboard_close(&board);
+        unlink(log_path.c_str());
+        unlink(snap_path.c_str());
+        rmdir(dir);
+    }
+
+    ScoreEntry make_entry(int score, int level) {
+        ScoreEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.timestamp = 1000 + score;
+        entry.score = score;
+        entry.level = (uint16_t)level;
+        entry.state = GAME_OVER;
+        return entry;
+    }
+
+    void reopen() {
+        leaderboard_close(&board);
+        ASSERT_EQ(leaderboard_open(&board, dir), 0);
+    }
+};
+
+// ========== Top-K Tests ==========
+
+TEST_F(LeaderboardTest, KeepsBestScoresInOrder) {
+    for (int i = 1; i <= 30; i++) {
+        ScoreEntry entry = make_entry((i * 37) % 100, 0);
+        ASSERT_EQ(leaderboard_record(&board, &entry), 0);
+    }
+
+    ScoreEntry top[LEADERBOARD_TOP_K];
+    int n = leaderboard_top(&board, -1, top, LEADERBOARD_TOP_K);
+    ASSERT_EQ(n, LEADERBOARD_TOP_K);
+    for (int i = 1; i < n; i++) {
+        EXPECT_GE(top[i - 1].score, top[i].score);
+    }
+    EXPECT_EQ(top[0].score, 99);
+    EXPECT_EQ(board.total_games, 30u);
+}
+
+TEST_F(LeaderboardTest, SeparatesLevels) {
+    ScoreEntry a = make_entry(50, 1);
+    ScoreEntry b = make_entry(70, 2);
+    leaderboard_record(&board, &a);
+    leaderboard_record(&board, &b);
+
+    ScoreEntry top[LEADERBOARD_TOP_K];
+    ASSERT_EQ(leaderboard_top(&board, 1, top, LEADERBOARD_TOP_K), 1);
+    EXPECT_EQ(top[0].score, 50);
+    EXPECT_EQ(leaderboard_top(&board, 3, top, LEADERBOARD_TOP_K), 0);
+    EXPECT_EQ(leaderboard_top(&board, -1, top, LEADERBOARD_TOP_K), 2);
+}
+
+TEST_F(LeaderboardTest, EntryFromGame) {
+    GameState game;
+    init_game_state(&game);
+    game.score = 120;
+    game.apples_eaten = 7;
+    game.special_apples_eaten[FOOD_GOLD] = 2;
+    game.state = GAME_WON;
+
+    ScoreEntry entry;
+    score_entry_from_game(&entry, &game, 5);
+    EXPECT_EQ(entry.score, 120);
+    EXPECT_EQ(entry.apples_eaten, 7);
+    EXPECT_EQ(entry.special_apples_eaten[FOOD_GOLD], 2);
+    EXPECT_EQ(entry.level, 5);
+    EXPECT_EQ(entry.state, GAME_WON);
+}
+
+// ========== Persistence Tests ==========
+
+TEST_F(LeaderboardTest, SurvivesReopen) {
+    for (int i = 0; i < 5; i++) {
+        ScoreEntry entry = make_entry(i * 10, 0);
+        leaderboard_record(&board, &entry);
+    }
+    reopen();
+
+    ScoreEntry top[LEADERBOARD_TOP_K];
+    ASSERT_EQ(leaderboard_top(&board, -1, top, LEADERBOARD_TOP_K), 5);
+    EXPECT_EQ(top[0].score, 40);
+    EXPECT_EQ(board.total_games, 5u);
+}
+
+TEST_F(LeaderboardTest, DropsTornTail) {
+    ScoreEntry entry = make_entry(10, 0);
+    leaderboard_record(&board, &entry);
+    leaderboard_close(&board);
+
+    // Simulate a crash in the middle of the next append
+    int fd = open(log_path.c_str(), O_WRONLY | O_APPEND);
+    char partial[17] = {0};
+    ASSERT_EQ(write(fd, partial, sizeof(partial)), (ssize_t)sizeof(partial));
+    close(fd);
+
+    ASSERT_EQ(leaderboard_open(&board, dir), 0);
+    EXPECT_EQ(board.total_games, 1u);
+    EXPECT_EQ(board.log_size, 40u);
+
+    ScoreEntry next = make_entry(20, 0);
+    leaderboard_record(&board, &next);
+    reopen();
+    EXPECT_EQ(board.total_games, 2u);
+}
+
+TEST_F(LeaderboardTest, AppendAfterCrashedWriterKeepsRecord) {
+    ScoreEntry entry = make_entry(10, 0);
+    leaderboard_record(&board, &entry);
+
+    // Another session died halfway through its append while we stay open
+    int fd = open(log_path.c_str(), O_WRONLY | O_APPEND);
+    char partial[17] = {0};
+    ASSERT_EQ(write(fd, partial, sizeof(partial)), (ssize_t)sizeof(partial));
+    close(fd);
+
+    ScoreEntry next = make_entry(20, 0);
+    ASSERT_EQ(leaderboard_record(&board, &next), 0);
+    EXPECT_EQ(board.total_games, 2u);
+    reopen();
+    EXPECT_EQ(board.total_games, 2u);
+    EXPECT_EQ(board.log_size, 80u);
+}
+
+TEST_F(LeaderboardTest, StopsAtCorruptRecord) {
+    for (int i = 0; i < 3; i++) {
+        ScoreEntry entry = make_entry(i, 0);
+        leaderboard_record(&board, &entry);
+    }
+    leaderboard_close(&board);
+
+    // Flip a byte inside the second record
+    int fd = open(log_path.c_str(), O_RDWR);
+    char byte = 0x7F;
+    ASSERT_EQ(pwrite(fd, &byte, 1, 40 + 12), 1);
+    close(fd);
+
+    ASSERT_EQ(leaderboard_open(&board, dir), 0);
+    EXPECT_EQ(board.total_games, 1u);
+}
+
+TEST_F(LeaderboardTest, SnapshotCoversLog) {
+    for (int i = 0; i < 20; i++) {
+        ScoreEntry entry = make_entry(i, i % 3);
+        leaderboard_record(&board, &entry);
+    }
+    ASSERT_EQ(leaderboard_compact(&board), 0);
+    EXPECT_EQ(board.since_snapshot, 0u);
+
+    ScoreEntry extra = make_entry(500, 1);
+    leaderboard_record(&board, &extra);
+    reopen();
+
+    // Only the record after the snapshot is replayed
+    EXPECT_EQ(board.since_snapshot, 1u);
+    EXPECT_EQ(board.total_games, 21u);
+    ScoreEntry top[LEADERBOARD_TOP_K];
+    ASSERT_GT(leaderboard_top(&board, 1, top, LEADERBOARD_TOP_K), 0);
+    EXPECT_EQ(top[0].score, 500);
+}
+
+TEST_F(LeaderboardTest, IgnoresStaleSnapshot) {
+    for (int i = 0; i < 4; i++) {
+        ScoreEntry entry = make_entry(i, 0);
+        leaderboard_record(&board, &entry);
+    }
+    leaderboard_compact(&board);
+    leaderboard_close(&board);
+    ASSERT_EQ(truncate(log_path.c_str(), 40), 0);
+
+    ASSERT_EQ(leaderboard_open(&board, dir), 0);
+    EXPECT_EQ(board.total_games, 1u);
+}
+
+TEST_F(LeaderboardTest, RejectsTamperedSnapshotHeader) {
+    for (int i = 0; i < 4; i++) {
+        ScoreEntry entry = make_entry(i, 0);
+        leaderboard_record(&board, &entry);
+    }
+    ASSERT_EQ(leaderboard_compact(&board), 0);
+    leaderboard_close(&board);
+
+    // total_games follows the 8-byte magic and log_size
+    int fd = open(snap_path.c_str(), O_RDWR);
+    uint64_t games = 1000;
+    ASSERT_EQ(pwrite(fd, &games, sizeof(games), 16), (ssize_t)sizeof(games));
+    close(fd);
+
+    // The snapshot is dropped and the log replayed from the start
+    ASSERT_EQ(leaderboard_open(&board, dir), 0);
+    EXPECT_EQ(board.total_games, 4u);
+    EXPECT_EQ(board.since_snapshot, 4u);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+    #include "level.h"
+}
+
+// Test fixture for connectivity and level generation
+class LevelTest : public ::testing::Test {
+protected:
+    Grid walls;
+    GameState game;
+
+    void SetUp() override {
+        grid_clear(&walls);
+        init_game_state(&game);
+    }
+
+    // Wall across the whole board at column x, except one gap at gap_y
+    void build_divider(Grid *grid, int x, int gap_y) {
+        for (int y = 1; y <= HEIGHT; y++) {
+            if (y != gap_y) {
+                grid_set(grid, x, y);
+            }
+        }
+    }
+};
+
+// ========== Grid Tests ==========
+
+TEST_F(LevelTest, GridSetAndTest) {
+    grid_set(&walls, 5, 7);
+    EXPECT_TRUE(grid_test(&walls, 5, 7));
+    EXPECT_FALSE(grid_test(&walls, 7, 5));
+    EXPECT_EQ(grid_count(&walls), 1);
+}
+
+TEST_F(LevelTest, GridResetClearsCell) {
+    grid_set(&walls, WIDTH, HEIGHT);
+    grid_reset(&walls, WIDTH, HEIGHT);
+    EXPECT_FALSE(grid_test(&walls, WIDTH, HEIGHT));
+}
+
+TEST_F(LevelTest, GridIgnoresOutOfRange) {
+    grid_set(&walls, -1, 3);
+    grid_set(&walls, GRID_W, 3);
+    EXPECT_EQ(grid_count(&walls), 0);
+    EXPECT_FALSE(grid_test(&walls, GRID_W + 5, GRID_H + 5));
+}
+
+// ========== Connectivity Tests ==========
+
+TEST_F(LevelTest, EmptyBoardIsConnected) {
+    EXPECT_TRUE(grid_is_connected(&walls));
+}
+
+TEST_F(LevelTest, DividerWithGapIsConnected) {
+    build_divider(&walls, 10, 4);
+    EXPECT_TRUE(grid_is_connected(&walls));
+}
+
+TEST_F(LevelTest, ClosedDividerSplitsBoard) {
+    build_divider(&walls, 10, 4);
+    grid_set(&walls, 10, 4);
+    EXPECT_FALSE(grid_is_connected(&walls));
+}
+
+TEST_F(LevelTest, EnclosedCellSplitsBoard) {
+    grid_set(&walls, 1, 2);
+    grid_set(&walls, 2, 1);
+    EXPECT_FALSE(grid_is_connected(&walls));
+}
+
+TEST_F(LevelTest, CanPlaceObstacleRejectsSplit) {
+    build_divider(&game.obstacles.grid, 10, 4);
+    EXPECT_FALSE(can_place_obstacle(&game.obstacles, 10, 4));
+    EXPECT_TRUE(can_place_obstacle(&game.obstacles, 20, 4));
+}
+
+TEST_F(LevelTest, AddObstacleNeverSplitsBoard) {
+    game_srand(1);
+    build_divider(&game.obstacles.grid, 30, 4);
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        add_obstacle(&game);
+        ASSERT_TRUE(grid_is_connected(&game.obstacles.grid));
+    }
+    EXPECT_FALSE(grid_test(&game.obstacles.grid, 30, 4));
+}
+
+TEST_F(LevelTest, AddObstacleUpdatesGrid) {
+    game_srand(2);
+    add_obstacle(&game);
+    ASSERT_EQ(game.obstacles.count, 1);
+    Point p = game.obstacles.obstacles[0];
+    EXPECT_TRUE(is_position_on_obstacle(&game.obstacles, p.x, p.y));
+}
+
+// ========== Generator Tests ==========
+
+TEST_F(LevelTest, GeneratedLevelsAreValid) {
+    Level level;
+    for (int kind = 0; kind < LEVEL_KIND_COUNT; kind++) {
+        for (unsigned int seed = 1; seed <= 50; seed++) {
+            ASSERT_GT(level_generate(&level, kind, seed), 0);
+            EXPECT_TRUE(level_is_valid(&level));
+        }
+    }
+}
+
+TEST_F(LevelTest, GeneratorIsDeterministic) {
+    Level a, b;
+    level_generate(&a, LEVEL_MAZE, 42);
+    level_generate(&b, LEVEL_MAZE, 42);
+    EXPECT_EQ(memcmp(&a.walls, &b.walls, sizeof(Grid)), 0);
+}
+
+TEST_F(LevelTest, EmptyLevelHasNoWalls) {
+    Level level;
+    level_generate(&level, LEVEL_EMPTY, 7);
+    EXPECT_EQ(grid_count(&level.walls), 0);
+}
+
+TEST_F(LevelTest, ApplyPlacesSnakeAtSpawn) {
+    Level level;
+    level_generate(&level, LEVEL_PILLARS, 3);
+    level_apply(&level, &game);
+    EXPECT_EQ(game.snake.body[0].x, level.spawn.x);
+    EXPECT_EQ(game.snake.body[0].y, level.spawn.y);
+    EXPECT_EQ(game.snake.direction, level.direction);
+    EXPECT_FALSE(check_collision(&game.snake, &game.obstacles));
+}
+
+TEST_F(LevelTest, KindNamesRoundTrip) {
+    for (int kind = 0; kind < LEVEL_KIND_COUNT; kind++) {
+        EXPECT_EQ(level_kind_from_name(level_kind_name(kind)), kind);
+    }
+    EXPECT_EQ(level_kind_from_name("spiral"), -1);
+}
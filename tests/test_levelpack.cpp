@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+extern "C" {
+    #include "levelpack.h"
+}
+
+// Test fixture with a scratch directory for pack files
+class LevelPackTest : public ::testing::Test {
+protected:
+    char dir[32];
+    std::string pack_path;
+    Level levels[3];
+
+    void SetUp() override {
+        strcpy(dir, "/tmp/snake_pack_XXXXXX");
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        pack_path = std::string(dir) + "/levels.pack";
+        level_generate(&levels[0], LEVEL_MAZE, 1);
+        level_generate(&levels[1], LEVEL_ROOMS, 2);
+        level_generate(&levels[2], LEVEL_PILLARS, 3);
+    }
+
+    void TearDown() override {
+        unlink(pack_path.c_str());
+        rmdir(dir);
+    }
+};
+
+// ========== Pack Format Tests ==========
+
+TEST_F(LevelPackTest, WriteAndOpenRoundTrip) {
+    ASSERT_EQ(levelpack_write(pack_path.c_str(), levels, 3), 0);
+
+    LevelPack pack;
+    ASSERT_EQ(levelpack_open(&pack, pack_path.c_str()), 0);
+    ASSERT_EQ(pack.count, 3);
+    for (int i = 0; i < 3; i++) {
+        const LevelRecord *record = levelpack_get(&pack, i);
+        EXPECT_EQ(memcmp(&record->walls, &levels[i].walls, sizeof(Grid)), 0);
+        EXPECT_EQ(record->spawn_x, levels[i].spawn.x);
+        EXPECT_EQ(record->spawn_y, levels[i].spawn.y);
+        EXPECT_STREQ(record->name, levels[i].name);
+        EXPECT_EQ(record->wall_count, grid_count(&levels[i].walls));
+    }
+    levelpack_close(&pack);
+}
+
+TEST_F(LevelPackTest, GetOutOfRangeReturnsNull) {
+    ASSERT_EQ(levelpack_write(pack_path.c_str(), levels, 1), 0);
+
+    LevelPack pack;
+    ASSERT_EQ(levelpack_open(&pack, pack_path.c_str()), 0);
+    EXPECT_EQ(levelpack_get(&pack, 1), nullptr);
+    EXPECT_EQ(levelpack_get(&pack, -1), nullptr);
+    levelpack_close(&pack);
+}
+
+TEST_F(LevelPackTest, GetRejectsUnplayableRecords) {
+    ASSERT_EQ(levelpack_write(pack_path.c_str(), levels, 3), 0);
+
+    // Corrupt the records in place: a bad direction, a spawn off the board,
+    // a spawn on a wall
+    FILE *f = fopen(pack_path.c_str(), "r+b");
+    ASSERT_NE(f, nullptr);
+    LevelRecord records[3];
+    fseek(f, sizeof(LevelPackHeader), SEEK_SET);
+    ASSERT_EQ(fread(records, sizeof(LevelRecord), 3, f), 3u);
+    records[0].direction = 7;
+    records[1].spawn_x = WIDTH + 5;
+    grid_set(&records[2].walls, records[2].spawn_x, records[2].spawn_y);
+    fseek(f, sizeof(LevelPackHeader), SEEK_SET);
+    ASSERT_EQ(fwrite(records, sizeof(LevelRecord), 3, f), 3u);
+    fclose(f);
+
+    LevelPack pack;
+    ASSERT_EQ(levelpack_open(&pack, pack_path.c_str()), 0);
+    EXPECT_EQ(levelpack_get(&pack, 0), nullptr);
+    EXPECT_EQ(levelpack_get(&pack, 1), nullptr);
+    EXPECT_EQ(levelpack_get(&pack, 2), nullptr);
+    levelpack_close(&pack);
+}
+
+TEST_F(LevelPackTest, RejectsForeignFile) {
+    FILE *f = fopen(pack_path.c_str(), "wb");
+    char junk[128] = "definitely not a level pack";
+    fwrite(junk, sizeof(junk), 1, f);
+    fclose(f);
+
+    LevelPack pack;
+    EXPECT_EQ(levelpack_open(&pack, pack_path.c_str()), -1);
+}
+
+TEST_F(LevelPackTest, RejectsTruncatedFile) {
+    ASSERT_EQ(levelpack_write(pack_path.c_str(), levels, 3), 0);
+    ASSERT_EQ(truncate(pack_path.c_str(), sizeof(LevelPackHeader) + sizeof(LevelRecord)), 0);
+
+    LevelPack pack;
+    EXPECT_EQ(levelpack_open(&pack, pack_path.c_str()), -1);
+}
+
+TEST_F(LevelPackTest, ApplySeedsObstacleGrid) {
+    ASSERT_EQ(levelpack_write(pack_path.c_str(), levels, 3), 0);
+
+    LevelPack pack;
+    GameState game;
+    ASSERT_EQ(levelpack_open(&pack, pack_path.c_str()), 0);
+    levelpack_apply(levelpack_get(&pack, 0), &game);
+    EXPECT_EQ(memcmp(&game.obstacles.grid, &levels[0].walls, sizeof(Grid)), 0);
+    EXPECT_EQ(game.snake.body[0].x, levels[0].spawn.x);
+    EXPECT_EQ(game.obstacles.count, 0);
+    levelpack_close(&pack);
+}
+
+// ========== ASCII Map Tests ==========
+
+TEST_F(LevelPackTest, AsciiRoundTrip) {
+    FILE *f = tmpfile();
+    level_write_ascii(&levels[0], f);
+    level_write_ascii(&levels[1], f);
+    rewind(f);
+
+    Level read;
+    ASSERT_EQ(level_read_ascii(&read, f), 1);
+    EXPECT_EQ(memcmp(&read.walls, &levels[0].walls, sizeof(Grid)), 0);
+    EXPECT_STREQ(read.name, levels[0].name);
+    ASSERT_EQ(level_read_ascii(&read, f), 1);
+    EXPECT_EQ(memcmp(&read.walls, &levels[1].walls, sizeof(Grid)), 0);
+    EXPECT_EQ(level_read_ascii(&read, f), 0);
+    fclose(f);
+}
+
+TEST_F(LevelPackTest, AsciiRejectsShortRows) {
+    FILE *f = tmpfile();
+    fputs("name: broken\n#..#\n", f);
+    rewind(f);
+
+    Level read;
+    EXPECT_EQ(level_read_ascii(&read, f), -1);
+    fclose(f);
+}
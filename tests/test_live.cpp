@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+extern "C" {
+    #include "snake.h"
+    #include "live.h"
+}
+
+class LiveTest : public ::testing::Test {
+protected:
+    std::string name;
+    LiveExport writer;
+    LiveExport reader;
+    GameState game;
+
+    void SetUp() override {
+        name = "/snake-live-test-" + std::to_string(getpid());
+        writer.shared = nullptr;
+        reader.shared = nullptr;
+        game_srand(5);
+        init_game_state(&game);
+    }
+
+    void TearDown() override {
+        live_close(&reader);
+        live_close(&writer);
+        shm_unlink(name.c_str());
+    }
+};
+
+TEST_F(LiveTest, ReaderSeesPublishedState) {
+    ASSERT_EQ(live_create(&writer, name.c_str()), 0);
+    ASSERT_EQ(live_attach(&reader, name.c_str()), 0);
+
+    FoodPool pool;
+    ASSERT_EQ(food_pool_init(&pool, 3, nullptr), 0);
+    game.foods = &pool;
+    game.score = 120;
+    live_publish(&writer, &game, 1, 1000000);
+    update_game(&game);
+    live_publish(&writer, &game, 2, 1100000);
+
+    LiveSnapshot snapshot;
+    int retries = -1;
+    ASSERT_EQ(live_read(&reader, &snapshot, &retries), 0);
+    EXPECT_EQ(retries, 0);
+    EXPECT_EQ(snapshot.tick, 2u);
+    EXPECT_EQ(snapshot.tick_ns, 1100000u);
+    EXPECT_EQ(snapshot.interval_ns, 100000u);
+    EXPECT_EQ(snapshot.publishes, 2u);
+    EXPECT_EQ(snapshot.pid, getpid());
+    EXPECT_EQ(snapshot.game.score, 120);
+    EXPECT_EQ(snapshot.game.snake.body[0].x, game.snake.body[0].x);
+    EXPECT_EQ(snapshot.game.foods, nullptr);
+
+    // Republishing the same tick (a redraw while paused) keeps the timing
+    live_publish(&writer, &game, 2, 5000000);
+    ASSERT_EQ(live_read(&reader, &snapshot, nullptr), 0);
+    EXPECT_EQ(snapshot.tick_ns, 1100000u);
+    EXPECT_EQ(snapshot.interval_ns, 100000u);
+
+    // A seek is not a tick interval
+    live_publish(&writer, &game, 40, 6000000);
+    ASSERT_EQ(live_read(&reader, &snapshot, nullptr), 0);
+    EXPECT_EQ(snapshot.interval_ns, 0u);
+}
+
+TEST_F(LiveTest, AttachRejectsMissingAndForeignSegments) {
+    EXPECT_EQ(live_attach(&reader, name.c_str()), -1);
+
+    // Right size, but nobody wrote a header
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, sizeof(LiveShared)), 0);
+    close(fd);
+    EXPECT_EQ(live_attach(&reader, name.c_str()), -1);
+    EXPECT_EQ(reader.shared, nullptr);
+
+    // The writer takes it over; once it exits the name is gone
+    ASSERT_EQ(live_create(&writer, name.c_str()), 0);
+    EXPECT_EQ(live_attach(&reader, name.c_str()), 0);
+    live_close(&writer);
+    live_close(&reader);
+    EXPECT_EQ(live_attach(&reader, name.c_str()), -1);
+}
+
+TEST_F(LiveTest, ConcurrentReadersNeverSeeTornSnapshots) {
+    ASSERT_EQ(live_create(&writer, name.c_str()), 0);
+    const uint64_t publishes = 200000;
+    std::atomic<bool> done(false);
+    std::atomic<long> consistent(0), torn(0);
+
+    // Fields at both ends of the snapshot all carry the tick number
+    std::thread producer([&] {
+        GameState state = game;
+        for (uint64_t tick = 1; tick <= publishes; tick++) {
+            state.snake.body[0].x = (int)tick;
+            state.snake.body[MAX_SNAKE_LENGTH - 1].y = (int)tick;
+            state.score = (int)tick;
+            state.paused_at.tv_sec = (time_t)tick;
+            live_publish(&writer, &state, tick, tick * 1000);
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&] {
+            LiveExport view;
+            LiveSnapshot snapshot;
+            if (live_attach(&view, name.c_str()) < 0) {
+                torn++;
+                return;
+            }
+            while (!done) {
+                if (live_read(&view, &snapshot, nullptr) < 0 || snapshot.tick == 0) {
+                    continue;
+                }
+                int tick = (int)snapshot.tick;
+                if (snapshot.game.snake.body[0].x == tick &&
+                    snapshot.game.snake.body[MAX_SNAKE_LENGTH - 1].y == tick &&
+                    snapshot.game.score == tick && snapshot.game.paused_at.tv_sec == tick &&
+                    snapshot.tick_ns == snapshot.tick * 1000 && snapshot.publishes == snapshot.tick) {
+                    consistent++;
+                } else {
+                    torn++;
+                }
+            }
+            live_close(&view);
+        });
+    }
+    producer.join();
+    for (auto &reader_thread : readers) {
+        reader_thread.join();
+    }
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_GT(consistent.load(), 0);
+}
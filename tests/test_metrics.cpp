@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+extern "C" {
+    #include "snake.h"
+    #include "metrics.h"
+}
+
+class MetricsTest : public ::testing::Test {
+protected:
+    std::unique_ptr<Metrics> metrics{ new Metrics() };
+    char text[METRICS_TEXT_MAX];
+
+    std::string format() {
+        metrics_format(metrics.get(), text, sizeof(text));
+        return text;
+    }
+
+    // Sends a request to a UNIX socket and returns the whole answer
+    static std::string scrape(const std::string &path) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return "";
+        }
+        const char request[] = "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n";
+        EXPECT_EQ(write(fd, request, sizeof(request) - 1), (ssize_t)(sizeof(request) - 1));
+        std::string answer;
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fd, buf, sizeof(buf))) > 0) {
+            answer.append(buf, (size_t)n);
+        }
+        close(fd);
+        return answer;
+    }
+};
+
+TEST_F(MetricsTest, HistogramBucketsAreCumulative) {
+    metrics_observe(&metrics->obstacle_attempts, 1);
+    metrics_observe(&metrics->obstacle_attempts, 3);
+    metrics_observe(&metrics->obstacle_attempts, 4);
+    metrics_observe(&metrics->obstacle_attempts, 100);
+    std::string out = format();
+
+    EXPECT_NE(out.find("# TYPE snake_obstacle_attempts histogram"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_bucket{le=\"1\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_bucket{le=\"2\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_bucket{le=\"4\"} 3\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_bucket{le=\"64\"} 3\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_bucket{le=\"128\"} 4\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_bucket{le=\"+Inf\"} 4\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_sum 108\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_obstacle_attempts_count 4\n"), std::string::npos);
+
+    // Durations are recorded in nanoseconds and shown in seconds
+    metrics_observe(&metrics->tick_ns, 1500);
+    out = format();
+    EXPECT_NE(out.find("snake_tick_duration_seconds_bucket{le=\"1.024e-06\"} 0\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_tick_duration_seconds_bucket{le=\"2.048e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_tick_duration_seconds_sum 1.5e-06\n"), std::string::npos);
+}
+
+TEST_F(MetricsTest, EngineEventsCountFoodAndWalls) {
+    GameEventBus bus;
+    GameState game;
+    game_srand(3);
+    init_game_state(&game);
+    game_events_init(&bus);
+    ASSERT_EQ(game_events_subscribe(&bus, metrics_on_events, metrics.get()), 0);
+    game.events = &bus;
+
+    for (int i = 0; i < 20; i++) {
+        add_obstacle(&game);
+        game_events_dispatch(&bus, &game);
+        bus.count = 0;
+    }
+    game_events_emit(&bus, EVENT_FOOD_SPAWNED, FOOD_GOLD, 1, 1);
+    game_events_emit(&bus, EVENT_FOOD_SPAWNED, FOOD_GOLD, 2, 1);
+    game_events_emit(&bus, EVENT_FOOD_SPAWNED, FOOD_BLUE, 3, 1);
+    game_events_dispatch(&bus, &game);
+
+    EXPECT_EQ(metrics->obstacles, (uint64_t)game.obstacles.count);
+    EXPECT_EQ(metrics->obstacle_attempts.count, metrics->obstacles);
+    EXPECT_EQ(metrics->obstacle_attempts.sum, metrics->obstacles + metrics->obstacle_retries);
+    EXPECT_EQ(metrics->food_spawned[FOOD_GOLD], 2u);
+    EXPECT_EQ(metrics->food_spawned[FOOD_BLUE], 1u);
+
+    metrics_add(&metrics->games[GAME_OVER], 1);
+    std::string out = format();
+    EXPECT_NE(out.find("snake_food_spawned_total{type=\"gold\"} 2\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_games_finished_total{state=\"over\"} 1\n"), std::string::npos);
+    EXPECT_NE(out.find("snake_games_finished_total{state=\"won\"} 0\n"), std::string::npos);
+    EXPECT_EQ(out.find("state=\"running\""), std::string::npos);
+}
+
+TEST_F(MetricsTest, ServesTextFormatOverUnixSocket) {
+    char dir[] = "/tmp/snake_metrics_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    std::string path = std::string(dir) + "/metrics.sock";
+    MetricsServer server;
+
+    ASSERT_EQ(metrics_listen(&server, metrics.get(), ("unix:" + path).c_str()), 0);
+    metrics_add(&metrics->ticks, 41);
+    metrics_add(&metrics->ticks, 1);
+    std::string answer = scrape(path);
+    EXPECT_EQ(answer.rfind("HTTP/1.0 200 OK\r\n", 0), 0u);
+    EXPECT_NE(answer.find("Content-Type: text/plain; version=0.0.4\r\n"), std::string::npos);
+    EXPECT_NE(answer.find("\r\n\r\n# HELP snake_ticks_total"), std::string::npos);
+    EXPECT_NE(answer.find("\nsnake_ticks_total 42\n"), std::string::npos);
+
+    scrape(path);
+    metrics_stop(&server);
+    EXPECT_EQ(server.scrapes, 2UL);
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+    rmdir(dir);
+}
+
+TEST_F(MetricsTest, RefusesAddressesOffThisMachine) {
+    MetricsServer server;
+    EXPECT_EQ(metrics_listen(&server, metrics.get(), "0.0.0.0:0"), -1);
+    EXPECT_EQ(metrics_listen(&server, metrics.get(), "10.1.2.3:9100"), -1);
+    EXPECT_EQ(metrics_listen(&server, metrics.get(), "127.0.0.1:notaport"), -1);
+
+    ASSERT_EQ(metrics_listen(&server, metrics.get(), "127.0.0.1:0"), 0);
+    metrics_stop(&server);
+}
@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <arpa/inet.h>
+
+extern "C" {
+    #include "snake.h"
+    #include "netplay.h"
+}
+
+class NetplayTest : public ::testing::Test {
+protected:
+    std::unique_ptr<NetServer> server{ new NetServer };
+    std::unique_ptr<NetPredictor> predictor{ new NetPredictor };
+    NetMessage message;
+    uint64_t now = 1000000000ull;
+
+    void SetUp() override {
+        GameState start;
+        game_srand(5);
+        init_game_state(&start);
+        net_server_init(server.get(), &start, game_rng_state(), 100000);
+        net_predict_init(predictor.get());
+        net_server_start_message(server.get(), &message, now);
+        net_predict_start(predictor.get(), &message, now);
+    }
+
+    // Client inputs reach the server, which plays one tick and answers
+    void server_tick(bool deliver_inputs) {
+        if (deliver_inputs) {
+            net_predict_inputs(predictor.get(), &message, now);
+            net_server_input(server.get(), &message, now);
+        }
+        NetMessage state;
+        net_server_tick(server.get(), &state, now);
+        net_predict_confirm(predictor.get(), &state, now);
+    }
+
+    void clear_out(NetMessage *out, int type) {
+        memset(out, 0, sizeof(*out));
+        out->type = (uint16_t)type;
+    }
+
+    // Points a listening link at another local link
+    void aim(NetLink *from, const NetLink *to) {
+        memset(&from->peer, 0, sizeof(from->peer));
+        from->peer.sin_family = AF_INET;
+        from->peer.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        from->peer.sin_port = htons((uint16_t)net_local_port(to));
+        from->has_peer = 1;
+    }
+
+    // Waits up to a second for one packet on an undelayed link
+    void receive_one(NetLink *link) {
+        uint64_t start = input_now_ns();
+        while (input_now_ns() - start < 1000000000ull) {
+            if (net_receive(link, &message, input_now_ns())) {
+                return;
+            }
+            net_wait(link, input_now_ns(), input_now_ns() + 1000000ull);
+        }
+        FAIL() << "no packet arrived";
+    }
+
+    void expect_dropped(NetLink *link, unsigned long dropped) {
+        uint64_t start = input_now_ns();
+        while (link->dropped < dropped && input_now_ns() - start < 1000000000ull) {
+            net_wait(link, input_now_ns(), input_now_ns() + 1000000ull);
+            EXPECT_EQ(net_receive(link, &message, input_now_ns()), 0);
+        }
+        EXPECT_EQ(link->dropped, dropped);
+    }
+
+    void say_hello(NetLink *from, NetLink *to) {
+        NetMessage hello;
+        clear_out(&hello, NET_HELLO);
+        ASSERT_EQ(net_send(from, &hello), 0);
+        ASSERT_NO_FATAL_FAILURE(receive_one(to));
+        EXPECT_EQ(message.type, NET_HELLO);
+    }
+
+    // A turn every few ticks that is never straight back
+    int turn_for(uint32_t tick) {
+        int dir = (int)((tick / 3) % 4);
+        return tick % 3 == 0 ? dir : -1;
+    }
+};
+
+TEST_F(NetplayTest, OnTimeTurnsNeverRollBack) {
+    // The client stays three ticks ahead, so its turns always arrive in time
+    for (uint32_t t = 1; t <= 3; t++) {
+        net_predict_tick(predictor.get(), turn_for(t), now, now);
+    }
+    for (int i = 0; i < 200 && server->game.state == GAME_RUNNING; i++) {
+        now += 100000000ull;
+        net_predict_tick(predictor.get(), turn_for(predictor->tick + 1), now, now);
+        server_tick(true);
+        ASSERT_EQ(predictor->confirmed, server->tick);
+        EXPECT_EQ(game_state_hash(&predictor->states[server->tick % NET_HISTORY]),
+                  game_state_hash(&server->game));
+    }
+    EXPECT_GT(predictor->confirms, 10UL);
+    EXPECT_EQ(predictor->corrections, 0UL);
+    EXPECT_EQ(server->late, 0UL);
+    EXPECT_GT(predictor->predicted.count, 0UL);
+}
+
+TEST_F(NetplayTest, LateTurnRollsBackAndConverges) {
+    // Up is never a reversal of the starting direction
+    for (uint32_t t = 1; t <= 6; t++) {
+        net_predict_tick(predictor.get(), t == 2 ? DIR_UP : -1, now, now);
+    }
+    ASSERT_EQ(predictor->game.snake.direction, DIR_UP);
+
+    // The turn for tick 2 is lost on the way until after the server's tick 3
+    for (int i = 0; i < 3; i++) {
+        server_tick(false);
+    }
+    // Tick 1 matched; ticks 2 and 3 each moved the turn one tick later
+    EXPECT_EQ(predictor->corrections, 2UL);
+    EXPECT_EQ(predictor->resimulated, 4UL + 3UL);
+
+    // Now it arrives and the server applies it on tick 4, as the client re-predicted
+    unsigned long corrections = predictor->corrections;
+    server_tick(true);
+    EXPECT_EQ(server->late, 1UL);
+    EXPECT_EQ(predictor->corrections, corrections);
+    server_tick(true);
+    server_tick(true);
+    EXPECT_EQ(predictor->confirmed, 6u);
+    EXPECT_EQ(game_state_hash(&predictor->game), game_state_hash(&server->game));
+    EXPECT_EQ(predictor->rng, server->rng);
+    EXPECT_EQ(predictor->authoritative.count, 1UL);
+}
+
+TEST_F(NetplayTest, ServerAheadOfThePredictionIsTakenAsIs) {
+    for (int i = 0; i < 4; i++) {
+        server_tick(false);
+    }
+    EXPECT_EQ(predictor->snaps, 4UL);
+    EXPECT_EQ(predictor->tick, 4u);
+    EXPECT_EQ(game_state_hash(&predictor->game), game_state_hash(&server->game));
+
+    // A state from another game is ignored
+    NetMessage stale;
+    net_server_tick(server.get(), &stale, now);
+    stale.game++;
+    EXPECT_EQ(net_predict_confirm(predictor.get(), &stale, now), -1);
+}
+
+TEST_F(NetplayTest, ImpossibleStatesAreDropped) {
+    NetMessage start;
+    net_server_start_message(server.get(), &start, now);
+
+    NetMessage bad = start;
+    bad.game++;
+    bad.state.snake.length = 30000;
+    EXPECT_EQ(net_predict_start(predictor.get(), &bad, now), -1);
+    bad = start;
+    bad.game++;
+    bad.state.snake.body[1].x = -40;
+    EXPECT_EQ(net_predict_start(predictor.get(), &bad, now), -1);
+    EXPECT_EQ(predictor->number, start.game);
+
+    NetMessage state;
+    net_server_tick(server.get(), &state, now);
+    void (*breakers[])(GameState *) = {
+        [](GameState *g) { g->obstacles.count = MAX_OBSTACLES + 1; },
+        [](GameState *g) { g->snake.direction = 9; },
+        [](GameState *g) { g->food.type = 4; },
+        [](GameState *g) { g->state = 77; },
+    };
+    for (auto breaker : breakers) {
+        bad = state;
+        breaker(&bad.state);
+        EXPECT_EQ(net_predict_confirm(predictor.get(), &bad, now), -1);
+    }
+    EXPECT_EQ(predictor->rejected, 6UL);
+    EXPECT_EQ(predictor->confirms, 0UL);
+
+    // The genuine state still goes through
+    EXPECT_GE(net_predict_confirm(predictor.get(), &state, now), 0);
+    EXPECT_EQ(predictor->confirmed, state.tick);
+}
+
+TEST_F(NetplayTest, ServerDropsImpossibleDirections) {
+    NetMessage inputs;
+    memset(&inputs, 0, sizeof(inputs));
+    inputs.type = NET_INPUTS;
+    inputs.game = server->number;
+    inputs.count = 2;
+    inputs.inputs[0].tick = 1;
+    inputs.inputs[0].direction = 1000;
+    inputs.inputs[1].tick = 2;
+    inputs.inputs[1].direction = -7;
+
+    net_server_input(server.get(), &inputs, now);
+    EXPECT_EQ(server->pending_count, 0);
+    EXPECT_EQ(server->rejected, 2UL);
+}
+
+TEST_F(NetplayTest, DelayedLinkHoldsPacketsBackInOrder) {
+    NetLink server_link, client_link;
+    ASSERT_EQ(net_listen(&server_link, 0), 0);
+    ASSERT_EQ(net_connect(&client_link, "127.0.0.1", net_local_port(&server_link)), 0);
+    ASSERT_NO_FATAL_FAILURE(say_hello(&client_link, &server_link));
+    net_set_delay(&server_link, 30000000ull, 0);
+
+    for (uint32_t tick = 1; tick <= 3; tick++) {
+        NetMessage out;
+        net_predict_inputs(predictor.get(), &out, tick);
+        out.tick = tick;
+        ASSERT_EQ(net_send(&client_link, &out), 0);
+    }
+    uint64_t sent = input_now_ns();
+    uint64_t start = sent;
+    while (server_link.received < 4 && input_now_ns() - start < 1000000000ull) {
+        net_wait(&server_link, input_now_ns(), input_now_ns() + 1000000ull);
+        EXPECT_EQ(net_receive(&server_link, &message, sent), 0);
+    }
+    ASSERT_EQ(server_link.received, 4UL);
+    EXPECT_EQ(net_receive(&server_link, &message, sent + 29000000ull), 0);
+
+    uint64_t later = input_now_ns() + 30000000ull;
+    for (uint32_t tick = 1; tick <= 3; tick++) {
+        ASSERT_EQ(net_receive(&server_link, &message, later), 1);
+        EXPECT_EQ(message.tick, tick);
+    }
+    EXPECT_EQ(net_receive(&server_link, &message, later), 0);
+
+    // The server answers the client that said hello
+    EXPECT_EQ(net_send(&server_link, &message), 0);
+    net_close(&client_link);
+    net_close(&server_link);
+}
+
+TEST_F(NetplayTest, LinksIgnoreStrangers) {
+    NetLink server_link, client_link, stranger;
+    ASSERT_EQ(net_listen(&server_link, 0), 0);
+    ASSERT_EQ(net_listen(&stranger, 0), 0);
+    ASSERT_EQ(net_connect(&client_link, "127.0.0.1", net_local_port(&server_link)), 0);
+
+    // Nothing but a hello gives the server a partner
+    aim(&stranger, &server_link);
+    NetMessage out;
+    clear_out(&out, NET_INPUTS);
+    ASSERT_EQ(net_send(&stranger, &out), 0);
+    ASSERT_NO_FATAL_FAILURE(expect_dropped(&server_link, 1));
+    EXPECT_FALSE(server_link.has_peer);
+
+    ASSERT_NO_FATAL_FAILURE(say_hello(&client_link, &server_link));
+    ASSERT_EQ(net_send(&stranger, &out), 0);
+    ASSERT_NO_FATAL_FAILURE(expect_dropped(&server_link, 2));
+    EXPECT_EQ(server_link.peer.sin_port, htons((uint16_t)net_local_port(&client_link)));
+
+    // The client only listens to its server
+    aim(&stranger, &client_link);
+    clear_out(&out, NET_STATE);
+    ASSERT_EQ(net_send(&stranger, &out), 0);
+    ASSERT_NO_FATAL_FAILURE(expect_dropped(&client_link, 1));
+    ASSERT_EQ(net_send(&server_link, &out), 0);
+    ASSERT_NO_FATAL_FAILURE(receive_one(&client_link));
+    EXPECT_EQ(message.type, NET_STATE);
+
+    // A new hello moves the server to whoever sent it
+    aim(&stranger, &server_link);
+    ASSERT_NO_FATAL_FAILURE(say_hello(&stranger, &server_link));
+    EXPECT_EQ(server_link.peer.sin_port, htons((uint16_t)net_local_port(&stranger)));
+
+    net_close(&stranger);
+    net_close(&client_link);
+    net_close(&server_link);
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+extern "C" {
+    #include "persist_game.h"
+    #include "level.h"
+}
+
+// Test fixture comparing the structurally shared engine with game.c
+class PersistGameTest : public ::testing::Test {
+protected:
+    PersistPool pool;
+    GameState game;
+    PersistGame persist;
+
+    // One future being followed on both engines
+    struct Branch {
+        GameState reference;
+        PersistGame persist;
+        uint64_t rng;
+        unsigned int inputs;
+    };
+
+    void SetUp() override {
+        persist_pool_init(&pool);
+        init_game_state(&game);
+        ASSERT_EQ(persist_game_from_state(&persist, &pool, &game), 0);
+    }
+
+    void TearDown() override {
+        persist_game_release(&persist);
+        EXPECT_EQ(pool.chunks_live, 0UL);
+        EXPECT_EQ(pool.spines_live, 0UL);
+        persist_pool_destroy(&pool);
+        game_set_clock(NULL);
+    }
+
+    static struct timeval now;
+    static void test_clock(struct timeval *out) {
+        *out = now;
+    }
+
+    static void expect_same(const PersistGame &actual, const GameState &expected) {
+        GameState converted;
+        persist_game_to_state(&actual, &converted);
+        ASSERT_EQ(converted.snake.length, expected.snake.length);
+        ASSERT_EQ(game_state_hash(&converted), game_state_hash(&expected));
+    }
+
+    // Steps a branch on both engines from its own RNG stream
+    static int step_branch(Branch &branch) {
+        branch.inputs = branch.inputs * 1103515245u + 12345u;
+        if ((branch.inputs >> 16) % 4 == 0) {
+            int dir = (int)((branch.inputs >> 20) % 4);
+            if (is_valid_direction_change(branch.reference.snake.direction, dir)) {
+                branch.reference.snake.direction = dir;
+            }
+            persist_game_turn(&branch.persist, dir);
+        }
+
+        game_set_rng_state(branch.rng);
+        int expected = update_game(&branch.reference);
+        uint64_t rng_after = game_rng_state();
+        game_set_rng_state(branch.rng);
+        int actual = persist_game_step(&branch.persist);
+        EXPECT_EQ(actual, expected);
+        EXPECT_EQ(game_rng_state(), rng_after);
+        branch.rng = rng_after;
+        return expected;
+    }
+};
+
+struct timeval PersistGameTest::now;
+
+// ========== Conversion Tests ==========
+
+TEST_F(PersistGameTest, RoundTripKeepsStackedTail) {
+    GameState back;
+    grow_snake(&game.snake, 3);
+    game.score = 30;
+    persist_game_release(&persist);
+    ASSERT_EQ(persist_game_from_state(&persist, &pool, &game), 0);
+
+    EXPECT_EQ(persist.body.distinct, 3);
+    EXPECT_EQ(persist.body.stacked, 3);
+    persist_game_to_state(&persist, &back);
+    EXPECT_EQ(game_state_hash(&back), game_state_hash(&game));
+
+    // The copies unfold one per move, exactly as in the array
+    for (int i = 0; i < 4; i++) {
+        uint64_t rng = game_rng_state();
+        update_game(&game);
+        game_set_rng_state(rng);
+        persist_game_step(&persist);
+        expect_same(persist, game);
+    }
+    EXPECT_EQ(persist.body.stacked, 0);
+}
+
+// ========== Sharing Tests ==========
+
+TEST_F(PersistGameTest, ForkSharesBodyUntilWritten) {
+    PersistGame branch;
+    unsigned long chunks = pool.chunks_live;
+
+    persist_game_step(&persist);
+    persist_game_fork(&branch, &persist);
+    EXPECT_EQ(pool.chunks_live, chunks);
+    EXPECT_EQ(pool.spines_live, 1UL);
+
+    // The first write copies the spine and the head chunk, nothing else
+    persist_game_turn(&branch, DIR_DOWN);
+    persist_game_step(&branch);
+    EXPECT_EQ(pool.spine_copies, 1UL);
+    EXPECT_EQ(pool.chunk_copies, 1UL);
+    EXPECT_EQ(pool.spines_live, 2UL);
+
+    // The other side now owns its blocks again and writes in place
+    persist_game_step(&persist);
+    EXPECT_EQ(pool.spine_copies, 1UL);
+    EXPECT_EQ(pool.chunk_copies, 1UL);
+    EXPECT_NE(persist_body_at(&persist.body, 0).y, persist_body_at(&branch.body, 0).y);
+    EXPECT_EQ(persist_body_at(&persist.body, 2).x, persist_body_at(&branch.body, 2).x);
+
+    persist_game_release(&branch);
+    EXPECT_EQ(pool.spines_live, 1UL);
+}
+
+// ========== Semantics Tests ==========
+
+TEST_F(PersistGameTest, ForkedFuturesMatchReference) {
+    const int live = 6;
+
+    game_set_clock(test_clock);
+    for (unsigned int seed = 1; seed <= 60; seed++) {
+        Level level;
+        std::vector<Branch> branches;
+        Branch main;
+
+        now.tv_sec = 1000;
+        now.tv_usec = 0;
+        game_srand(seed);
+        level_generate(&level, (int)(seed % LEVEL_KIND_COUNT), seed);
+        init_game_state(&main.reference);
+        level_apply(&level, &main.reference);
+        persist_game_release(&persist);
+        ASSERT_EQ(persist_game_from_state(&main.persist, &pool, &main.reference), 0);
+        main.rng = game_rng_state();
+        main.inputs = seed * 2654435761u + 1;
+
+        for (int tick = 0; tick < 400; tick++) {
+            now.tv_usec += 100000;
+            if (now.tv_usec >= 1000000) {
+                now.tv_sec++;
+                now.tv_usec -= 1000000;
+            }
+
+            // Every few ticks the main line spawns a future with its own inputs
+            if (tick % 3 == 0 && (int)branches.size() < live) {
+                Branch branch = main;
+                persist_game_fork(&branch.persist, &main.persist);
+                branch.inputs ^= (unsigned int)(tick + 1) * 40503u;
+                branch.rng ^= (uint64_t)(tick + 1) << 32;
+                branches.push_back(branch);
+            }
+
+            for (size_t i = 0; i < branches.size(); i++) {
+                int result = step_branch(branches[i]);
+                expect_same(branches[i].persist, branches[i].reference);
+                if (HasFailure()) {
+                    FAIL() << "seed " << seed << " tick " << tick << " branch " << i;
+                }
+                if (result != GAME_RUNNING) {
+                    persist_game_release(&branches[i].persist);
+                    branches.erase(branches.begin() + (long)i--);
+                }
+            }
+
+            int result = step_branch(main);
+            expect_same(main.persist, main.reference);
+            if (HasFailure()) {
+                FAIL() << "seed " << seed << " tick " << tick;
+            }
+            if (result != GAME_RUNNING) {
+                break;
+            }
+        }
+
+        for (Branch &branch : branches) {
+            persist_game_release(&branch.persist);
+        }
+        persist = main.persist;
+    }
+    EXPECT_GT(pool.spine_copies, 0UL);
+}
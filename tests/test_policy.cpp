@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+
+extern "C" {
+    #include "policy.h"
+}
+
+class PolicyTest : public ::testing::Test {
+protected:
+    GameState state;
+    FastGame game;
+    Policy policy;
+
+    void SetUp() override {
+        init_game_state(&state);
+        fast_game_from_state(&game, &state);
+        memset(&policy, 0, sizeof(policy));
+    }
+};
+
+TEST_F(PolicyTest, FeaturesSeeWallsAndBody) {
+    float inputs[POLICY_INPUTS];
+
+    policy_features(&game, inputs);
+    // Left of the head is the body, right is open up to the wall
+    EXPECT_EQ(inputs[2 * DIR_LEFT], 1.0f);
+    EXPECT_EQ(inputs[2 * DIR_RIGHT], 0.0f);
+    EXPECT_FLOAT_EQ(inputs[2 * DIR_RIGHT + 1], (float)(WIDTH - WIDTH / 2) / WIDTH);
+    EXPECT_EQ(inputs[POLICY_INPUTS - 4], 1.0f);   // Bias
+    EXPECT_EQ(inputs[POLICY_INPUTS - 1], 0.0f);   // Padding
+}
+
+TEST_F(PolicyTest, FeaturesSeeFoodType) {
+    float inputs[POLICY_INPUTS];
+
+    game.food.active = 1;
+    game.food.type = FOOD_GOLD;
+    game.food.position.x = game.ring[game.head].x + 4;
+    game.food.position.y = game.ring[game.head].y;
+    policy_features(&game, inputs);
+    EXPECT_FLOAT_EQ(inputs[8], 4.0f / WIDTH);
+    EXPECT_EQ(inputs[9], 0.0f);
+    EXPECT_EQ(inputs[10 + FOOD_GOLD], 1.0f);
+}
+
+TEST_F(PolicyTest, EvalMatchesScalarReference) {
+    float inputs[POLICY_INPUTS], outputs[POLICY_OUTPUTS];
+    float *genes = reinterpret_cast<float *>(&policy);
+
+    for (size_t g = 0; g < POLICY_GENES; g++) {
+        genes[g] = (float)((g * 37) % 11) / 10.0f - 0.5f;
+    }
+    for (int i = 0; i < POLICY_INPUTS; i++) {
+        inputs[i] = (float)(i % 5) / 4.0f;
+    }
+    policy_eval(&policy, inputs, outputs);
+
+    for (int o = 0; o < POLICY_OUTPUTS; o++) {
+        double out = policy.b2[o];
+        for (int h = 0; h < POLICY_HIDDEN; h++) {
+            double sum = policy.b1[h];
+            for (int i = 0; i < POLICY_INPUTS; i++) {
+                sum += (double)policy.w1[i][h] * inputs[i];
+            }
+            out += (sum > 0 ? sum : 0) * policy.w2[h][o];
+        }
+        EXPECT_NEAR(outputs[o], out, 1e-4);
+    }
+}
+
+TEST_F(PolicyTest, ActNeverReverses) {
+    // Output bias strongly prefers going left, straight back into the body
+    policy.b2[DIR_LEFT] = 10.0f;
+    policy.b2[DIR_UP] = 1.0f;
+    EXPECT_EQ(policy_act(&policy, &game), DIR_UP);
+}
+
+TEST_F(PolicyTest, CheckpointRoundTrip) {
+    char path[] = "/tmp/snake_policy_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    std::vector<Policy> saved(3), loaded(4);
+    float fitness[3] = { 1.5f, -2.0f, 30.0f }, loaded_fitness[4];
+    for (int p = 0; p < 3; p++) {
+        float *genes = reinterpret_cast<float *>(&saved[p]);
+        for (size_t g = 0; g < POLICY_GENES; g++) {
+            genes[g] = (float)(p * 1000 + g);
+        }
+    }
+    ASSERT_EQ(policy_save_population(path, saved.data(), fitness, 3, 17, 99), 0);
+
+    int count = 4, generation = 0;
+    uint64_t rng = 0;
+    ASSERT_EQ(policy_load_population(path, loaded.data(), loaded_fitness, &count,
+                                     &generation, &rng), 0);
+    EXPECT_EQ(count, 3);
+    EXPECT_EQ(generation, 17);
+    EXPECT_EQ(rng, 99u);
+    EXPECT_EQ(loaded_fitness[2], 30.0f);
+    EXPECT_EQ(memcmp(loaded.data(), saved.data(), sizeof(Policy) * 3), 0);
+
+    // A smaller destination is refused
+    count = 2;
+    EXPECT_EQ(policy_load_population(path, loaded.data(), loaded_fitness, &count,
+                                     &generation, &rng), -1);
+
+    // So is a flipped bit
+    FILE *f = fopen(path, "r+b");
+    fseek(f, 100, SEEK_SET);
+    fputc(0x55, f);
+    fclose(f);
+    count = 4;
+    EXPECT_EQ(policy_load_population(path, loaded.data(), loaded_fitness, &count,
+                                     &generation, &rng), -1);
+    unlink(path);
+}
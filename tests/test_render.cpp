@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+extern "C" {
+    #include "render.h"
+}
+
+// Captures what the ANSI backend writes through a pipe
+class AnsiRenderTest : public ::testing::Test {
+protected:
+    int fds[2];
+
+    void SetUp() override {
+        ASSERT_EQ(pipe(fds), 0);
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        render_ansi_output(fds[1]);
+    }
+
+    void TearDown() override {
+        render_ansi_output(STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    std::string frame() {
+        std::string data;
+        char buf[4096];
+        ssize_t n;
+
+        render_ansi.present();
+        while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+            data.append(buf, n);
+        }
+        return data;
+    }
+};
+
+TEST_F(AnsiRenderTest, FirstFrameClearsScreen) {
+    render_ansi.clear();
+    render_ansi.text(0, 0, 0, 0, "hi");
+
+    std::string out = frame();
+    EXPECT_EQ(out.rfind("\x1b[0m\x1b[2J", 0), 0u);
+    EXPECT_NE(out.find("\x1b[1;1Hhi"), std::string::npos);
+}
+
+TEST_F(AnsiRenderTest, UnchangedFrameWritesNothing) {
+    render_ansi.clear();
+    render_ansi.text(3, 4, COLOR_INFO, ATTR_BOLD, "SCORE");
+    frame();
+
+    render_ansi.clear();
+    render_ansi.text(3, 4, COLOR_INFO, ATTR_BOLD, "SCORE");
+    EXPECT_EQ(frame(), "");
+}
+
+TEST_F(AnsiRenderTest, OnlyChangedCellsAreSent) {
+    render_ansi.clear();
+    render_ansi.put(5, 10, COLOR_SNAKE, ATTR_BOLD, '@');
+    frame();
+
+    render_ansi.clear();
+    render_ansi.put(5, 11, COLOR_SNAKE, ATTR_BOLD, '@');
+    std::string out = frame();
+
+    // Old cell blanked with the default style, new one drawn in green bold
+    EXPECT_NE(out.find("\x1b[6;11H\x1b[0m "), std::string::npos);
+    EXPECT_NE(out.find("\x1b[0;1;32;40m@"), std::string::npos);
+    EXPECT_EQ(out.find("\x1b[2J"), std::string::npos);
+}
+
+TEST_F(AnsiRenderTest, ShortGapsAreRepeatedNotSkipped) {
+    render_ansi.clear();
+    render_ansi.text(1, 0, 0, 0, "abcdef");
+    frame();
+
+    render_ansi.clear();
+    render_ansi.text(1, 0, 0, 0, "Xbcdef");
+    render_ansi.put(1, 3, 0, 0, 'Y');
+    std::string out = frame();
+    EXPECT_NE(out.find("XbcY"), std::string::npos);
+}
+
+TEST_F(AnsiRenderTest, OffscreenCellsAreClipped) {
+    render_ansi.clear();
+    render_ansi.put(-1, 0, 0, 0, 'a');
+    render_ansi.put(0, SCREEN_COLS, 0, 0, 'b');
+    render_ansi.text(SCREEN_ROWS, 0, 0, 0, "c");
+    std::string out = frame();
+    EXPECT_EQ(out.find_first_of("abc"), std::string::npos);
+}
+
+TEST_F(AnsiRenderTest, GameFrameIsOneWrite) {
+    GameState game;
+    RenderStats stats = { 0, 0, 0, 0 };
+
+    init_game_state(&game);
+    draw_game(&render_ansi, &game);
+    render_present(&render_ansi, &stats);
+
+    EXPECT_EQ(stats.frames, 1UL);
+    if (stats.available) {
+        EXPECT_EQ(stats.syscalls, 1ULL);
+        EXPECT_GT(stats.bytes, 0ULL);
+    }
+}
+
+TEST(RenderTest, BackendLookup) {
+    EXPECT_EQ(render_backend_by_name("ansi"), &render_ansi);
+    EXPECT_EQ(render_backend_by_name("ncurses"), &render_ncurses);
+    EXPECT_EQ(render_backend_by_name("vt52"), nullptr);
+}
+
+// ========== Viewport Tests ==========
+
+// Backend that keeps the last frame as characters
+static char recorded[SCREEN_ROWS][SCREEN_COLS];
+static int recorded_puts;
+
+static int record_init(void) { return 0; }
+static void record_shutdown(void) {}
+static void record_clear(void) {
+    memset(recorded, ' ', sizeof(recorded));
+    recorded_puts = 0;
+}
+static void record_put(int y, int x, int color, int attrs, char ch) {
+    (void)color;
+    (void)attrs;
+    recorded_puts++;
+    if (y >= 0 && y < SCREEN_ROWS && x >= 0 && x < SCREEN_COLS) {
+        recorded[y][x] = ch;
+    }
+}
+static void record_text(int y, int x, int color, int attrs, const char *s) {
+    for (; *s; s++, x++) {
+        record_put(y, x, color, attrs, *s);
+    }
+}
+static void record_present(void) {}
+static int record_read_key(int wait) {
+    (void)wait;
+    return INPUT_NONE;
+}
+
+static const RenderBackend recorder = {
+    "record", record_init, record_shutdown, record_clear, record_put,
+    record_text, record_present, record_read_key,
+};
+
+class ViewportTest : public ::testing::Test {
+protected:
+    GameState game;
+    Camera camera;
+    char full[GRID_H][GRID_W];
+
+    void SetUp() override {
+        game_srand(3);
+        init_game_state(&game);
+        camera_init(&camera, 12, 20);
+    }
+
+    // The window must show exactly what the full frame has in those cells
+    void expect_window_matches() {
+        draw_game(&recorder, &game);
+        for (int y = 0; y < GRID_H; y++) {
+            memcpy(full[y], recorded[y], GRID_W);
+        }
+        draw_game_viewport(&recorder, &camera, &game);
+        for (int row = 0; row < camera.rows; row++) {
+            for (int col = 0; col < camera.cols; col++) {
+                ASSERT_EQ(recorded[row][col], full[camera.y + row][camera.x + col])
+                    << "cell " << camera.x + col << "," << camera.y + row;
+            }
+        }
+
+        Point head = game.snake.body[0];
+        EXPECT_GE(head.x - camera.x, 0);
+        EXPECT_LT(head.x - camera.x, camera.cols);
+        EXPECT_GE(head.y - camera.y, 0);
+        EXPECT_LT(head.y - camera.y, camera.rows);
+    }
+};
+
+TEST_F(ViewportTest, WindowMatchesFullFrameWhileFollowingTheHead) {
+    unsigned int inputs = 12345;
+
+    for (int t = 0; t < 400 && game.state == GAME_RUNNING; t++) {
+        inputs = inputs * 1103515245u + 12345u;
+        int dir = (int)((inputs >> 20) % 4);
+        if ((inputs >> 16) % 3 == 0 && is_valid_direction_change(game.snake.direction, dir)) {
+            game.snake.direction = dir;
+        }
+        // Grow often so the segment grid sees stacked tails and blue walls
+        if (t % 6 == 0 && game.food.active) {
+            game.food.type = t % 4;
+            handle_food_eaten(&game);
+        }
+        update_game(&game);
+        ASSERT_NO_FATAL_FAILURE(expect_window_matches()) << "tick " << t;
+    }
+}
+
+TEST_F(ViewportTest, HeadStaysInsideTheMargin) {
+    game.snake.direction = DIR_UP;
+    for (int t = 0; t < HEIGHT / 2 - 1; t++) {
+        update_game(&game);
+        camera_follow(&camera, &game);
+        int from_top = game.snake.body[0].y - camera.y;
+        EXPECT_TRUE(from_top >= camera.margin || camera.y == 0) << t;
+    }
+    EXPECT_EQ(camera.y, 0);
+}
+
+TEST_F(ViewportTest, CostDependsOnWindowNotSnakeLength) {
+    // A long snake and many walls fill the board outside the window
+    grow_snake(&game.snake, MAX_SNAKE_LENGTH - game.snake.length);
+    for (int x = 2; x < WIDTH; x += 3) {
+        grid_set(&game.obstacles.grid, x, 2);
+    }
+    draw_game_viewport(&recorder, &camera, &game);
+
+    // Every window cell at most once, plus the one-line HUD
+    EXPECT_LE(recorded_puts, camera.rows * camera.cols + camera.cols);
+}
+
+TEST_F(ViewportTest, SegmentGridRebuildsAfterJumps) {
+    for (int t = 0; t < 5; t++) {
+        update_game(&game);
+        camera_follow(&camera, &game);
+    }
+    // A different game: the grid has to be rebuilt, not patched
+    GameState other;
+    init_game_state(&other);
+    other.snake.body[0].y = other.snake.body[1].y = other.snake.body[2].y = 3;
+    camera_follow(&camera, &other);
+
+    int total = 0;
+    for (int y = 0; y < GRID_H; y++) {
+        for (int x = 0; x < GRID_W; x++) {
+            total += camera.segments[y][x];
+        }
+    }
+    EXPECT_EQ(total, other.snake.length);
+    for (int i = 0; i < other.snake.length; i++) {
+        EXPECT_EQ(camera.segments[3][other.snake.body[i].x], 1);
+    }
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+extern "C" {
+    #include "snake.h"
+    #include "rewind.h"
+}
+
+static struct timeval test_now;
+
+static void test_clock(struct timeval *now) {
+    *now = test_now;
+}
+
+class RewindTest : public ::testing::Test {
+protected:
+    GameState game;
+    std::unique_ptr<RewindBuffer> history{ new RewindBuffer };
+    std::vector<uint64_t> hashes;        // game_state_hash() after each tick
+    std::vector<uint64_t> rngs;
+    std::vector<struct timeval> times;   // Clock when each tick was played
+
+    void SetUp() override {
+        test_now.tv_sec = 1000;
+        test_now.tv_usec = 0;
+        game_set_clock(test_clock);
+        game_srand(11);
+        init_game_state(&game);
+        rewind_init(history.get(), &game);
+        hashes.push_back(game_state_hash(&game));
+        rngs.push_back(game_rng_state());
+        times.push_back(test_now);
+    }
+
+    void TearDown() override {
+        game_set_clock(NULL);
+    }
+
+    // Greedy towards the food, avoiding anything that kills on the next tick
+    void steer() {
+        static const int dx[4] = { 0, 1, 0, -1 };
+        static const int dy[4] = { -1, 0, 1, 0 };
+        Point head = game.snake.body[0];
+        int best = -1, best_distance = 1 << 30;
+
+        for (int dir = 0; dir < 4; dir++) {
+            int x = head.x + dx[dir], y = head.y + dy[dir];
+            if (!is_valid_direction_change(game.snake.direction, dir) ||
+                x < 1 || x > WIDTH || y < 1 || y > HEIGHT ||
+                is_position_on_obstacle(&game.obstacles, x, y)) {
+                continue;
+            }
+            int blocked = 0;
+            for (int i = 0; i < game.snake.length - 1; i++) {
+                blocked |= game.snake.body[i].x == x && game.snake.body[i].y == y;
+            }
+            int distance = game.food.active ?
+                abs(x - game.food.position.x) + abs(y - game.food.position.y) : 0;
+            if (!blocked && distance < best_distance) {
+                best = dir;
+                best_distance = distance;
+            }
+        }
+        if (best >= 0) {
+            game.snake.direction = best;
+        }
+    }
+
+    void play(int ticks) {
+        for (int t = 0; t < ticks && game.state == GAME_RUNNING; t++) {
+            steer();
+            test_now.tv_usec += 100000;
+            if (test_now.tv_usec >= 1000000) {
+                test_now.tv_sec++;
+                test_now.tv_usec -= 1000000;
+            }
+            rewind_update(history.get(), &game);
+            hashes.resize(history->tick);
+            rngs.resize(history->tick);
+            times.resize(history->tick);
+            hashes.push_back(game_state_hash(&game));
+            rngs.push_back(game_rng_state());
+            times.push_back(test_now);
+        }
+    }
+
+    // Seeking at the moment the tick was played gives back its exact state,
+    // boost start time included
+    void expect_at(unsigned long tick) {
+        test_now = times[tick];
+        ASSERT_EQ(rewind_seek(history.get(), &game, tick), 0) << tick;
+        EXPECT_EQ(history->tick, tick);
+        EXPECT_EQ(game_state_hash(&game), hashes[tick]) << tick;
+        EXPECT_EQ(game_rng_state(), rngs[tick]) << tick;
+
+        Snake snake = game.snake;
+        Obstacles obstacles = game.obstacles;
+        snake_rehash(&snake);
+        obstacles_rehash(&obstacles);
+        EXPECT_EQ(game.snake.hash, snake.hash);
+        EXPECT_EQ(game.obstacles.hash, obstacles.hash);
+    }
+};
+
+TEST_F(RewindTest, SeekReproducesEveryRecordedTick) {
+    play(1500);
+    ASSERT_GT(history->newest, (unsigned long)REWIND_KEYFRAME_INTERVAL);
+    ASSERT_GT(game.apples_eaten, 5);
+
+    unsigned long newest = history->newest;
+    unsigned int r = 5;
+    for (int i = 0; i < 200; i++) {
+        r = r * 1103515245u + 12345u;
+        ASSERT_NO_FATAL_FAILURE(expect_at((r >> 8) % (newest + 1)));
+    }
+    // Walk the whole history one tick at a time in both directions
+    for (unsigned long t = newest; t-- > 0;) {
+        ASSERT_NO_FATAL_FAILURE(expect_at(t));
+    }
+    for (unsigned long t = 1; t <= newest; t++) {
+        ASSERT_NO_FATAL_FAILURE(expect_at(t));
+    }
+}
+
+TEST_F(RewindTest, PlayingOnAfterRewindReplaysTheSameFuture) {
+    play(300);
+    ASSERT_EQ(history->newest, 300UL);
+    std::vector<uint64_t> original = hashes;
+
+    test_now = times[150];
+    ASSERT_EQ(rewind_seek(history.get(), &game, 150), 0);
+    play(150);
+
+    ASSERT_EQ(history->newest, 300UL);
+    for (unsigned long t = 150; t <= 300; t++) {
+        EXPECT_EQ(hashes[t], original[t]) << t;
+    }
+}
+
+TEST_F(RewindTest, BoostKeepsItsTimeLeftWhenSeekingLater) {
+    // Play until a gold apple starts a boost, then one more tick
+    while (game.state == GAME_RUNNING && !game.speed_boost.active) {
+        play(1);
+    }
+    ASSERT_TRUE(game.speed_boost.active);
+    play(1);
+    ASSERT_TRUE(game.speed_boost.active);
+    unsigned long boosted = history->tick;
+    long elapsed = get_time_diff_us(game.speed_boost.start_time, test_now);
+    play(200);
+
+    // Seek from the other direction long after the boost would have run out
+    for (unsigned long from : { 0UL, history->newest }) {
+        ASSERT_EQ(rewind_seek(history.get(), &game, from), 0);
+        test_now.tv_sec += 60;
+        ASSERT_EQ(rewind_seek(history.get(), &game, boosted), 0);
+        ASSERT_TRUE(game.speed_boost.active);
+        EXPECT_EQ(get_time_diff_us(game.speed_boost.start_time, test_now), elapsed) << from;
+
+        // The pause that follows a rewind does not eat into it either
+        pause_game(&game);
+        test_now.tv_sec += 30;
+        resume_game(&game);
+        EXPECT_TRUE(is_speed_boost_active(&game.speed_boost));
+        EXPECT_EQ(get_time_diff_us(game.speed_boost.start_time, test_now), elapsed) << from;
+    }
+}
+
+TEST_F(RewindTest, NewMovesAfterRewindReplaceTheFuture) {
+    play(300);
+    ASSERT_EQ(rewind_seek(history.get(), &game, 100), 0);
+
+    // A turn the old timeline never took
+    game.snake.direction = (game.snake.direction + 1) % 4;
+    rewind_update(history.get(), &game);
+    EXPECT_EQ(history->tick, 101UL);
+    EXPECT_EQ(history->newest, 101UL);
+    EXPECT_EQ(rewind_seek(history.get(), &game, 102), -1);
+    EXPECT_EQ(rewind_seek(history.get(), &game, 0), 0);
+    EXPECT_EQ(game_state_hash(&game), hashes[0]);
+}
+
+TEST_F(RewindTest, HistoryIsBoundedToTheRing) {
+    // Keep the snake alive by circling in place without food
+    game.food.active = 1;
+    game.food.position.x = 1;
+    game.food.position.y = 1;
+    for (unsigned long t = 0; t < REWIND_TICKS + 1000UL; t++) {
+        game.snake.direction = (int)((t / 2) % 4);
+        ASSERT_EQ(rewind_update(history.get(), &game), GAME_RUNNING) << t;
+    }
+    EXPECT_EQ(history->newest, REWIND_TICKS + 1000UL);
+    EXPECT_EQ(history->oldest, 1000UL);
+    EXPECT_EQ(rewind_seek(history.get(), &game, 999), -1);
+    EXPECT_EQ(rewind_seek(history.get(), &game, 1000), 0);
+    EXPECT_EQ(rewind_seek(history.get(), &game, REWIND_TICKS + 1000UL), 0);
+}
+
+TEST_F(RewindTest, DeathCanBeSteppedBackAndPausedTicksAreNotRecorded) {
+    pause_game(&game);
+    EXPECT_EQ(rewind_update(history.get(), &game), GAME_PAUSED);
+    EXPECT_EQ(history->tick, 0UL);
+    resume_game(&game);
+
+    // Straight into the right wall
+    int ticks = 0;
+    while (rewind_update(history.get(), &game) == GAME_RUNNING) {
+        ticks++;
+    }
+    EXPECT_EQ(game.state, GAME_OVER);
+    EXPECT_EQ(collision_cause(&game.snake, &game.obstacles), DEATH_WALL);
+
+    ASSERT_EQ(rewind_seek(history.get(), &game, history->tick - 1), 0);
+    EXPECT_EQ(game.state, GAME_RUNNING);
+    EXPECT_EQ(collision_cause(&game.snake, &game.obstacles), DEATH_NONE);
+    EXPECT_EQ(game.snake.body[0].x, WIDTH);
+    EXPECT_EQ(history->tick, (unsigned long)ticks);
+}
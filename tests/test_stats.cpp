@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+extern "C" {
+    #include "stats.h"
+}
+
+// ========== Welford Tests ==========
+
+TEST(RunningStatsTest, MatchesTwoPassFormulas) {
+    RunningStats stats;
+    const double values[] = { 3, 7, 7, 19, -4, 2.5 };
+    double sum = 0, sq = 0;
+
+    running_stats_init(&stats);
+    for (double v : values) {
+        running_stats_add(&stats, v);
+        sum += v;
+    }
+    double mean = sum / 6;
+    for (double v : values) {
+        sq += (v - mean) * (v - mean);
+    }
+    EXPECT_EQ(stats.count, 6u);
+    EXPECT_NEAR(stats.mean, mean, 1e-12);
+    EXPECT_NEAR(running_stats_variance(&stats), sq / 5, 1e-12);
+    EXPECT_EQ(stats.min, -4);
+    EXPECT_EQ(stats.max, 19);
+    EXPECT_NEAR(running_stats_ci95(&stats), 1.96 * std::sqrt(sq / 5 / 6), 1e-12);
+}
+
+TEST(RunningStatsTest, MergeEqualsSingleStream) {
+    RunningStats all, a, b, empty;
+    running_stats_init(&all);
+    running_stats_init(&a);
+    running_stats_init(&b);
+    running_stats_init(&empty);
+    for (int i = 0; i < 1000; i++) {
+        double v = std::sin(i) * 100 + 1e6;   // Large offset tests stability
+        running_stats_add(&all, v);
+        running_stats_add(i % 3 ? &a : &b, v);
+    }
+    running_stats_merge(&a, &empty);
+    running_stats_merge(&a, &b);
+    EXPECT_EQ(a.count, all.count);
+    EXPECT_NEAR(a.mean, all.mean, 1e-6);
+    EXPECT_NEAR(running_stats_variance(&a), running_stats_variance(&all), 1e-6);
+    EXPECT_EQ(a.min, all.min);
+    EXPECT_EQ(a.max, all.max);
+}
+
+// ========== t-digest Tests ==========
+
+class TDigestTest : public ::testing::Test {
+protected:
+    std::unique_ptr<TDigest> digest{new TDigest};
+
+    void SetUp() override {
+        tdigest_init(digest.get());
+    }
+};
+
+TEST_F(TDigestTest, EmptyAndSingleValue) {
+    EXPECT_EQ(tdigest_quantile(digest.get(), 0.5), 0.0);
+    tdigest_add(digest.get(), 42, 1);
+    EXPECT_EQ(tdigest_quantile(digest.get(), 0.0), 42);
+    EXPECT_EQ(tdigest_quantile(digest.get(), 0.5), 42);
+    EXPECT_EQ(tdigest_quantile(digest.get(), 1.0), 42);
+}
+
+TEST_F(TDigestTest, QuantilesOfSkewedStreamWithBoundedMemory) {
+    std::mt19937 rng(7);
+    std::exponential_distribution<double> dist(0.01);
+    std::vector<double> values;
+
+    for (int i = 0; i < 200000; i++) {
+        double v = dist(rng);
+        values.push_back(v);
+        tdigest_add(digest.get(), v, 1);
+        ASSERT_LE(digest->count + digest->buffered, TDIGEST_CENTROIDS + TDIGEST_BUFFER);
+    }
+    std::sort(values.begin(), values.end());
+    for (double q : { 0.01, 0.1, 0.5, 0.9, 0.99, 0.999 }) {
+        double exact = values[(size_t)(q * (values.size() - 1))];
+        double approx = tdigest_quantile(digest.get(), q);
+        // Rank error: where the estimate lands in the sorted data
+        double rank = (double)(std::lower_bound(values.begin(), values.end(), approx) -
+                               values.begin()) / values.size();
+        EXPECT_NEAR(rank, q, 0.01 * std::min(q, 1 - q) + 0.001) << "q " << q << " exact " << exact;
+    }
+    EXPECT_LE(digest->count, TDIGEST_COMPRESSION + 1);
+    EXPECT_EQ(tdigest_quantile(digest.get(), 1.0), values.back());
+}
+
+TEST_F(TDigestTest, MergeMatchesSingleDigest) {
+    std::unique_ptr<TDigest> parts[4];
+    for (auto &part : parts) {
+        part.reset(new TDigest);
+        tdigest_init(part.get());
+    }
+    for (int i = 0; i < 40000; i++) {
+        double v = (i * 7919) % 10007;
+        tdigest_add(digest.get(), v, 1);
+        tdigest_add(parts[i % 4].get(), v, 1);
+    }
+    std::unique_ptr<TDigest> merged(new TDigest);
+    tdigest_init(merged.get());
+    for (auto &part : parts) {
+        tdigest_merge(merged.get(), part.get());
+    }
+    EXPECT_EQ(merged->total, 40000);
+    EXPECT_EQ(merged->min, digest->min);
+    EXPECT_EQ(merged->max, digest->max);
+    for (double q : { 0.05, 0.5, 0.95 }) {
+        EXPECT_NEAR(tdigest_quantile(merged.get(), q), q * 10006, 10006 * 0.01) << "q " << q;
+    }
+}
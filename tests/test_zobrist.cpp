@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C" {
+    #include "snake.h"
+    #include "level.h"
+    #include "ttable.h"
+}
+
+// ========== Zobrist Tests ==========
+
+class ZobristTest : public ::testing::Test {
+protected:
+    GameState game;
+
+    void SetUp() override {
+        init_game_state(&game);
+    }
+
+    void expect_matches_rehash() {
+        Snake snake = game.snake;
+        Obstacles obstacles = game.obstacles;
+        snake_rehash(&snake);
+        obstacles_rehash(&obstacles);
+        EXPECT_EQ(game.snake.hash, snake.hash);
+        EXPECT_EQ(game.obstacles.hash, obstacles.hash);
+    }
+};
+
+TEST_F(ZobristTest, IncrementalMatchesRehashOverGames) {
+    for (unsigned int seed = 1; seed <= 30; seed++) {
+        Level level;
+        unsigned int inputs = seed * 2654435761u + 1;
+
+        game_srand(seed);
+        ASSERT_GE(level_generate(&level, (int)(seed % LEVEL_KIND_COUNT), seed), 0);
+        level_apply(&level, &game);
+        expect_matches_rehash();
+
+        for (int t = 0; t < 500; t++) {
+            inputs = inputs * 1103515245u + 12345u;
+            int dir = (int)((inputs >> 20) % 4);
+            if ((inputs >> 16) % 4 == 0 && is_valid_direction_change(game.snake.direction, dir)) {
+                game.snake.direction = dir;
+            }
+            // Feed the snake every few ticks so growth and blue walls are covered
+            if (t % 7 == 0 && !game.food.active) {
+                generate_food(&game.snake, &game.obstacles, &game.food);
+            }
+            if (t % 5 == 0 && game.food.active) {
+                game.food.type = t % 4;
+                handle_food_eaten(&game);
+            }
+            int state = update_game(&game);
+            ASSERT_NO_FATAL_FAILURE(expect_matches_rehash()) << "seed " << seed << " tick " << t;
+            if (state != GAME_RUNNING) {
+                break;
+            }
+        }
+    }
+}
+
+TEST_F(ZobristTest, SamePositionFromDifferentHistory) {
+    GameState other;
+
+    // Turn up, then right, then down: the snake ends on row 10 again
+    init_game_state(&other);
+    for (int dir : { DIR_UP, DIR_RIGHT, DIR_DOWN }) {
+        other.snake.direction = dir;
+        update_snake_position(&other.snake);
+    }
+
+    // Build the same body directly and move it once
+    game.snake.body[0] = { WIDTH / 2, HEIGHT / 2 - 1 };
+    game.snake.body[1] = { WIDTH / 2, HEIGHT / 2 };
+    game.snake.body[2] = { WIDTH / 2 - 1, HEIGHT / 2 };
+    snake_rehash(&game.snake);
+    game.snake.direction = DIR_RIGHT;
+    update_snake_position(&game.snake);
+    game.snake.direction = DIR_DOWN;
+    update_snake_position(&game.snake);
+
+    ASSERT_EQ(memcmp(game.snake.body, other.snake.body, sizeof(Point) * 3), 0);
+    EXPECT_EQ(game_zobrist(&game), game_zobrist(&other));
+}
+
+TEST_F(ZobristTest, CoversFoodObstaclesDirectionAndBoost) {
+    uint64_t base = game_zobrist(&game);
+
+    game.food.active = 1;
+    game.food.position = { 3, 3 };
+    uint64_t with_food = game_zobrist(&game);
+    EXPECT_NE(with_food, base);
+    game.food.type = FOOD_GOLD;
+    EXPECT_NE(game_zobrist(&game), with_food);
+
+    game.snake.direction = DIR_DOWN;
+    uint64_t turned = game_zobrist(&game);
+    game.speed_boost.active = 1;
+    EXPECT_NE(game_zobrist(&game), turned);
+
+    uint64_t before = game_zobrist(&game);
+    add_obstacle(&game);
+    ASSERT_EQ(game.obstacles.count, 1);
+    EXPECT_NE(game_zobrist(&game), before);
+
+    // A segment stacked on the tail changes the length and the hash
+    before = game_zobrist(&game);
+    grow_snake(&game.snake, 1);
+    EXPECT_NE(game_zobrist(&game), before);
+}
+
+// ========== Transposition Table Tests ==========
+
+TEST(TTableTest, StoreProbeAndReplace) {
+    TTable table;
+    TTEntry entry = { 120, 5, TT_EXACT, DIR_LEFT }, found;
+
+    ASSERT_EQ(ttable_init(&table, 4), 0);
+    EXPECT_EQ(ttable_probe(&table, 0x1234, &found), 0);
+
+    ttable_store(&table, 0x1234, &entry);
+    ASSERT_EQ(ttable_probe(&table, 0x1234, &found), 1);
+    EXPECT_EQ(found.value, 120);
+    EXPECT_EQ(found.depth, 5);
+    EXPECT_EQ(found.move, DIR_LEFT);
+    EXPECT_EQ(ttable_probe(&table, 0x1234 + 16, &found), 0);
+
+    // Fill the bucket; the fifth key evicts the shallowest entry
+    for (int i = 1; i < TTABLE_BUCKET; i++) {
+        TTEntry deep = { i, (int16_t)(10 + i), TT_LOWER, 0 };
+        ttable_store(&table, 0x1234 + 16 * i, &deep);
+    }
+    TTEntry newer = { -1, 1, TT_UPPER, 0 };
+    ttable_store(&table, 0x1234 + 16 * TTABLE_BUCKET, &newer);
+    EXPECT_EQ(ttable_probe(&table, 0x1234, &found), 0);
+    EXPECT_EQ(ttable_probe(&table, 0x1234 + 16 * TTABLE_BUCKET, &found), 1);
+    EXPECT_EQ(ttable_probe(&table, 0x1234 + 16, &found), 1);
+
+    ttable_clear(&table);
+    EXPECT_EQ(ttable_probe(&table, 0x1234 + 16, &found), 0);
+    ttable_free(&table);
+}
+
+TEST(TTableTest, ConcurrentWritersNeverYieldTornEntries) {
+    TTable table;
+    std::atomic<long> bad{0}, hits{0};
+    std::vector<std::thread> threads;
+
+    ASSERT_EQ(ttable_init(&table, 6), 0);
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            uint64_t x = 0x9E3779B97F4A7C15ULL * (t + 1);
+            for (int i = 0; i < 200000; i++) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                uint64_t key = x % 4096 * 0x100000001B3ULL;
+                // Every writer stores the same entry for a key
+                TTEntry entry = { (int32_t)(key >> 40), (int16_t)(key >> 20 & 0x7FFF),
+                                  (uint8_t)(key % 3), (uint8_t)(key % 4) };
+                TTEntry found;
+                if (ttable_probe(&table, key, &found)) {
+                    hits++;
+                    if (memcmp(&found, &entry, sizeof(entry)) != 0) {
+                        bad++;
+                    }
+                }
+                ttable_store(&table, key, &entry);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_GT(hits.load(), 0);
+    EXPECT_EQ(bad.load(), 0);
+    ttable_free(&table);
+}
@@ -0,0 +1,90 @@
+#include "compact_game.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Keeps N games resident in compact form and steps all of them by
+// unpacking into one FastGame, stepping and packing back. Reports the
+// memory per game and the resulting steps per second.
+
+static struct timeval bench_now;
+
+static void bench_clock(struct timeval *out) {
+    *out = bench_now;
+}
+
+static double seconds_since(struct timeval start) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return get_time_diff_us(start, now) / 1e6;
+}
+
+int main(int argc, char **argv) {
+    long count = 1000000;
+    int rounds = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                count = atol(optarg);
+                break;
+            case 'r':
+                rounds = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n games] [-r rounds]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    CompactGame *games = aligned_alloc(64, sizeof(CompactGame) * count);
+    GameState state;
+    FastGame fast;
+    unsigned int r = 1;
+    long steps = 0;
+    struct timeval start;
+
+    if (!games) {
+        fprintf(stderr, "out of memory for %ld games\n", count);
+        return 1;
+    }
+    game_set_clock(bench_clock);
+    bench_now.tv_sec = 1000;
+    game_srand(1);
+    init_game_state(&state);
+    for (long i = 0; i < count; i++) {
+        compact_game_from_state(&games[i], &state, NULL);
+    }
+
+    gettimeofday(&start, NULL);
+    for (int round = 0; round < rounds; round++) {
+        bench_now.tv_usec += COMPACT_TICK_US;
+        if (bench_now.tv_usec >= 1000000) {
+            bench_now.tv_sec++;
+            bench_now.tv_usec -= 1000000;
+        }
+        for (long i = 0; i < count; i++) {
+            compact_game_to_fast(&games[i], &fast);
+            if (fast.state != GAME_RUNNING) {
+                fast_game_from_state(&fast, &state);
+            }
+            r = r * 1103515245u + 12345u;
+            if ((r >> 16) % 4 == 0) {
+                fast_game_turn(&fast, (int)((r >> 20) % 4));
+            }
+            fast_game_step(&fast);
+            compact_game_from_fast(&games[i], &fast, NULL);
+            steps++;
+        }
+    }
+    double elapsed = seconds_since(start);
+
+    printf("%ld games: %zu bytes each (GameState %zu, FastGame %zu), %.1f MB resident\n",
+           count, sizeof(CompactGame), sizeof(GameState), sizeof(FastGame),
+           sizeof(CompactGame) * count / 1e6);
+    printf("%.0f steps/s through unpack + step + pack\n", steps / elapsed);
+    free(games);
+    return 0;
+}
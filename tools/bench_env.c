@@ -0,0 +1,82 @@
+#include "snake_env.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Steps batches of 1..4096 environments with pseudo-random actions and
+// reports environment steps per second for both observation formats.
+
+static double seconds_since(struct timeval start) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return get_time_diff_us(start, now) / 1e6;
+}
+
+static double bench(int count, int format, long total_steps) {
+    void *obs = aligned_alloc(64, (snake_env_obs_size(format) * count + 63) / 64 * 64);
+    uint8_t *actions = malloc(count);
+    int32_t *rewards = malloc(sizeof(int32_t) * count);
+    uint8_t *dones = malloc(count);
+    SnakeEnv env;
+    unsigned int r = 1;
+    struct timeval start;
+
+    if (!obs || !actions || !rewards || !dones || snake_env_init(&env, count, format, obs) < 0) {
+        fprintf(stderr, "out of memory for %d environments\n", count);
+        exit(1);
+    }
+    snake_env_reset(&env, 1);
+
+    long rounds = total_steps / count;
+    if (rounds < 16) {
+        rounds = 16;
+    }
+    gettimeofday(&start, NULL);
+    for (long round = 0; round < rounds; round++) {
+        for (int i = 0; i < count; i++) {
+            r = r * 1103515245u + 12345u;
+            actions[i] = (uint8_t)((r >> 16) % 5);
+        }
+        snake_env_step(&env, actions, rewards, dones);
+    }
+    double rate = rounds * (double)count / seconds_since(start);
+
+    snake_env_free(&env);
+    free(obs);
+    free(actions);
+    free(rewards);
+    free(dones);
+    return rate;
+}
+
+int main(int argc, char **argv) {
+    long steps = 2000000;
+    int max_batch = 4096;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:")) != -1) {
+        switch (opt) {
+            case 'n':
+                steps = atol(optarg);
+                break;
+            case 'b':
+                max_batch = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n steps per batch size] [-b max batch]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    printf("%6s %14s %14s\n", "batch", "u8 steps/s", "bits steps/s");
+    for (int count = 1; count <= max_batch; count *= 4) {
+        double u8 = bench(count, ENV_OBS_U8, steps);
+        double bits = bench(count, ENV_OBS_BITS, steps);
+        printf("%6d %14.0f %14.0f\n", count, u8, bits);
+        if (count < max_batch && count * 4 > max_batch) {
+            count = max_batch / 4;
+        }
+    }
+    return 0;
+}
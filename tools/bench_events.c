@@ -0,0 +1,106 @@
+#include "snake.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Measures what the event stream costs update_game: no bus attached,
+// a bus without subscribers, and a bus with a subscriber that reads
+// every event. Every mode plays the same seeded games.
+
+static struct timeval virtual_now;
+
+static void virtual_clock(struct timeval *out) {
+    *out = virtual_now;
+}
+
+static void count_events(const GameEvent *events, int count,
+                         const GameState *game, void *context) {
+    long *total = context;
+    (void)game;
+    for (int i = 0; i < count; i++) {
+        *total += events[i].type + 1;
+    }
+}
+
+// Plays until the tick budget is spent, restarting finished games.
+// The turn pattern depends only on the tick number.
+static long run(long ticks, GameEventBus *bus) {
+    GameState game;
+    long checksum = 0;
+
+    game_srand(1);
+    init_game_state(&game);
+    game.events = bus;
+    for (long t = 0; t < ticks; t++) {
+        virtual_now.tv_usec += 100000;
+        if (virtual_now.tv_usec >= 1000000) {
+            virtual_now.tv_sec++;
+            virtual_now.tv_usec -= 1000000;
+        }
+        int dir = (int)((t / 7) % 4);
+        if (t % 7 == 0 && is_valid_direction_change(game.snake.direction, dir)) {
+            game.snake.direction = dir;
+        }
+        if (update_game(&game) != GAME_RUNNING) {
+            checksum += game.score;
+            init_game_state(&game);
+            game.events = bus;
+        }
+    }
+    return checksum + game.score;
+}
+
+static double measure(const char *label, long ticks, GameEventBus *bus, long *checksum) {
+    struct timeval start, end;
+
+    gettimeofday(&start, NULL);
+    *checksum = run(ticks, bus);
+    gettimeofday(&end, NULL);
+
+    double ns = get_time_diff_us(start, end) * 1000.0 / ticks;
+    printf("%-22s %8.1f ns/tick\n", label, ns);
+    return ns;
+}
+
+int main(int argc, char **argv) {
+    long ticks = 5000000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+            case 'n':
+                ticks = atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n ticks]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (ticks <= 0) {
+        ticks = 1;
+    }
+
+    GameEventBus idle_bus, busy_bus;
+    long seen = 0;
+    long sums[3];
+
+    game_set_clock(virtual_clock);
+    game_events_init(&idle_bus);
+    game_events_init(&busy_bus);
+    game_events_subscribe(&busy_bus, count_events, &seen);
+
+    double base = measure("no bus", ticks, NULL, &sums[0]);
+    double idle = measure("bus, no subscribers", ticks, &idle_bus, &sums[1]);
+    double busy = measure("bus, one subscriber", ticks, &busy_bus, &sums[2]);
+
+    printf("overhead: %+.1f%% idle, %+.1f%% subscribed (%lu ticks, %ld event weight)\n",
+           (idle / base - 1.0) * 100.0, (busy / base - 1.0) * 100.0,
+           busy_bus.tick, seen);
+
+    if (sums[0] != sums[1] || sums[0] != sums[2]) {
+        fprintf(stderr, "games diverged between modes\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "persist_game.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Forks one mid-game position into N futures and plays each for K ticks,
+// once with a full GameState copy per branch and once with the
+// structurally shared body. Reports fork and step time and the memory
+// held by the snake bodies of all branches.
+
+static struct timeval bench_now;
+
+static void bench_clock(struct timeval *out) {
+    *out = bench_now;
+}
+
+static double seconds_since(struct timeval start) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return get_time_diff_us(start, now) / 1e6;
+}
+
+// Grows the snake and lets it unfold along a serpentine path, so the
+// branches start from a long, fully distinct body
+static void mid_game(GameState *state, int length) {
+    init_game_state(state);
+    grow_snake(&state->snake, length - state->snake.length);
+    while (state->state == GAME_RUNNING &&
+           state->snake.body[length - 2].x == state->snake.body[length - 1].x &&
+           state->snake.body[length - 2].y == state->snake.body[length - 1].y) {
+        Point head = state->snake.body[0];
+        if (state->snake.direction == DIR_DOWN) {
+            state->snake.direction = head.x == WIDTH ? DIR_LEFT : DIR_RIGHT;
+        } else if ((state->snake.direction == DIR_RIGHT && head.x == WIDTH) ||
+                   (state->snake.direction == DIR_LEFT && head.x == 1)) {
+            state->snake.direction = DIR_DOWN;
+        }
+        update_game(state);
+    }
+}
+
+static int next_turn(unsigned int *r) {
+    *r = *r * 1103515245u + 12345u;
+    return (*r >> 16) % 4 == 0 ? (int)((*r >> 20) % 4) : -1;
+}
+
+int main(int argc, char **argv) {
+    long count = 10000;
+    int ticks = 20;
+    int length = 40;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:k:l:")) != -1) {
+        switch (opt) {
+            case 'n':
+                count = atol(optarg);
+                break;
+            case 'k':
+                ticks = atoi(optarg);
+                break;
+            case 'l':
+                length = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n branches] [-k ticks] [-l length]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (count < 1 || ticks < 0 || length < 3 || length >= WIN_LENGTH) {
+        fprintf(stderr, "need n >= 1, k >= 0 and 3 <= l < %d\n", WIN_LENGTH);
+        return 1;
+    }
+
+    GameState *copies = malloc(sizeof(GameState) * count);
+    PersistGame *forks = malloc(sizeof(PersistGame) * count);
+    GameState root;
+    PersistGame persist_root;
+    PersistPool pool;
+    struct timeval start;
+
+    if (!copies || !forks) {
+        fprintf(stderr, "out of memory for %ld branches\n", count);
+        return 1;
+    }
+    game_set_clock(bench_clock);
+    bench_now.tv_sec = 1000;
+    game_srand(1);
+    mid_game(&root, length);
+    persist_pool_init(&pool);
+    if (persist_game_from_state(&persist_root, &pool, &root) < 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    printf("root: length %d, %s\n", root.snake.length,
+           root.state == GAME_RUNNING ? "running" : "finished");
+
+    // Full copies
+    unsigned int r = 7;
+    gettimeofday(&start, NULL);
+    for (long i = 0; i < count; i++) {
+        copies[i] = root;
+    }
+    double copy_fork = seconds_since(start);
+    gettimeofday(&start, NULL);
+    for (long i = 0; i < count; i++) {
+        for (int t = 0; t < ticks && copies[i].state == GAME_RUNNING; t++) {
+            int dir = next_turn(&r);
+            if (dir >= 0 && is_valid_direction_change(copies[i].snake.direction, dir)) {
+                copies[i].snake.direction = dir;
+            }
+            update_game(&copies[i]);
+        }
+    }
+    double copy_play = seconds_since(start);
+
+    // Shared bodies, with the same inputs
+    unsigned long base_bytes = pool.bytes;
+    r = 7;
+    game_srand(1);
+    gettimeofday(&start, NULL);
+    for (long i = 0; i < count; i++) {
+        persist_game_fork(&forks[i], &persist_root);
+    }
+    double persist_fork = seconds_since(start);
+    gettimeofday(&start, NULL);
+    for (long i = 0; i < count; i++) {
+        for (int t = 0; t < ticks && forks[i].state == GAME_RUNNING; t++) {
+            int dir = next_turn(&r);
+            if (dir >= 0) {
+                persist_game_turn(&forks[i], dir);
+            }
+            if (persist_game_step(&forks[i]) < 0) {
+                fprintf(stderr, "out of memory after %ld branches\n", i);
+                return 1;
+            }
+        }
+    }
+    double persist_play = seconds_since(start);
+    unsigned long live_bytes = pool.chunks_live * sizeof(PersistChunk) +
+                               pool.spines_live * sizeof(PersistSpine);
+    double steps = (double)count * (ticks > 0 ? ticks : 1);
+
+    printf("%ld branches x %d ticks\n", count, ticks);
+    printf("  GameState copy: fork %8.1f ns/branch, play %8.1f ns/tick, bodies %8.1f KB (%zu bytes each)\n",
+           copy_fork * 1e9 / count, copy_play * 1e9 / steps,
+           sizeof(Snake) * count / 1e3, sizeof(Snake));
+    printf("  shared body:    fork %8.1f ns/branch, play %8.1f ns/tick, bodies %8.1f KB (pool %.1f KB)\n",
+           persist_fork * 1e9 / count, persist_play * 1e9 / steps,
+           (sizeof(PersistBody) * count + live_bytes) / 1e3, (pool.bytes - base_bytes) / 1e3);
+    printf("  %lu chunks and %lu spines live, %lu chunk and %lu spine copies\n",
+           pool.chunks_live, pool.spines_live, pool.chunk_copies, pool.spine_copies);
+
+    for (long i = 0; i < count; i++) {
+        persist_game_release(&forks[i]);
+    }
+    persist_game_release(&persist_root);
+    persist_pool_destroy(&pool);
+    free(copies);
+    free(forks);
+    return 0;
+}
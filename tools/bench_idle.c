@@ -0,0 +1,246 @@
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+// Starts many ./snake sessions on their own pseudo-terminals, leaves them
+// idle on the welcome screen (-m menu) or paused mid-game (-m pause), and
+// measures the CPU time and context switches they use while idle.
+
+typedef struct {
+    pid_t pid;
+    int master;
+    unsigned long long cpu_ticks;
+    unsigned long long switches;
+} Session;
+
+static void drain(Session *sessions, int count, int timeout_ms) {
+    static struct pollfd *fds;
+    static int capacity;
+    char buf[4096];
+
+    if (capacity < count) {
+        free(fds);
+        fds = malloc(sizeof(struct pollfd) * count);
+        capacity = count;
+    }
+    for (int i = 0; i < count; i++) {
+        fds[i].fd = sessions[i].master;
+        fds[i].events = POLLIN;
+    }
+    if (poll(fds, count, timeout_ms) <= 0) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        if (fds[i].revents & POLLIN) {
+            while (read(fds[i].fd, buf, sizeof(buf)) == (ssize_t)sizeof(buf)) {
+            }
+        }
+    }
+}
+
+// Keeps reading every terminal so no session blocks on a full pty
+static void drain_for(Session *sessions, int count, double seconds) {
+    struct timeval start, now;
+    gettimeofday(&start, NULL);
+    for (;;) {
+        gettimeofday(&now, NULL);
+        double elapsed = (now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1e6;
+        if (elapsed >= seconds) {
+            return;
+        }
+        drain(sessions, count, (int)((seconds - elapsed) * 1000) + 1);
+    }
+}
+
+static void send_key(Session *sessions, int count, char key) {
+    for (int i = 0; i < count; i++) {
+        if (write(sessions[i].master, &key, 1) < 0) {
+            perror("write");
+        }
+    }
+}
+
+// utime + stime of the whole process, in clock ticks
+static unsigned long long cpu_ticks(pid_t pid) {
+    char path[64], line[1024];
+    unsigned long long utime = 0, stime = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        return 0;
+    }
+    if (fgets(line, sizeof(line), in)) {
+        char *p = strrchr(line, ')');
+        if (p) {
+            sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                   &utime, &stime);
+        }
+    }
+    fclose(in);
+    return utime + stime;
+}
+
+// Context switches of every thread in the process
+static unsigned long long switches(pid_t pid) {
+    char path[320], line[256];
+    unsigned long long total = 0, value;
+
+    snprintf(path, sizeof(path), "/proc/%d/task", (int)pid);
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return 0;
+    }
+    struct dirent *task;
+    while ((task = readdir(dir))) {
+        if (task->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/proc/%d/task/%s/status", (int)pid, task->d_name);
+        FILE *in = fopen(path, "r");
+        if (!in) {
+            continue;
+        }
+        while (fgets(line, sizeof(line), in)) {
+            if (sscanf(line, "voluntary_ctxt_switches: %llu", &value) == 1 ||
+                sscanf(line, "nonvoluntary_ctxt_switches: %llu", &value) == 1) {
+                total += value;
+            }
+        }
+        fclose(in);
+    }
+    closedir(dir);
+    return total;
+}
+
+// The sessions save their games on SIGTERM, so the scratch home is a tree
+static void remove_tree(const char *path) {
+    struct stat st;
+    DIR *dir;
+
+    if (lstat(path, &st) == 0 && S_ISDIR(st.st_mode) && (dir = opendir(path))) {
+        struct dirent *entry;
+        while ((entry = readdir(dir))) {
+            char child[4096];
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+            remove_tree(child);
+        }
+        closedir(dir);
+    }
+    if (remove(path) < 0) {
+        perror(path);
+    }
+}
+
+int main(int argc, char **argv) {
+    int count = 500;
+    double seconds = 10.0;
+    const char *mode = "pause";
+    const char *binary = "./snake";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:m:b:")) != -1) {
+        switch (opt) {
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 't':
+                seconds = atof(optarg);
+                break;
+            case 'm':
+                mode = optarg;
+                break;
+            case 'b':
+                binary = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n sessions] [-t seconds] [-m menu|pause] [-b ./snake]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (count <= 0 || (strcmp(mode, "menu") != 0 && strcmp(mode, "pause") != 0)) {
+        fprintf(stderr, "Need at least one session and mode menu or pause\n");
+        return 1;
+    }
+
+    char home[] = "/tmp/snake_idle_XXXXXX";
+    if (!mkdtemp(home)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    Session *sessions = calloc(count, sizeof(Session));
+    struct winsize size = { 24, 80, 0, 0 };
+    int started = 0;
+
+    for (; started < count; started++) {
+        Session *s = &sessions[started];
+        s->pid = forkpty(&s->master, NULL, NULL, &size);
+        if (s->pid < 0) {
+            perror("forkpty");
+            break;
+        }
+        if (s->pid == 0) {
+            setenv("TERM", "xterm", 1);
+            setenv("SNAKE_HOME", home, 1);
+            execl(binary, binary, (char *)NULL);
+            _exit(127);
+        }
+    }
+    count = started;
+
+    // Let every session reach the welcome screen, then start and pause the games
+    drain_for(sessions, count, 1.0 + count / 200.0);
+    if (strcmp(mode, "pause") == 0) {
+        send_key(sessions, count, 'x');
+        drain_for(sessions, count, 0.3);
+        send_key(sessions, count, 'p');
+    }
+    drain_for(sessions, count, 1.0);
+
+    for (int i = 0; i < count; i++) {
+        sessions[i].cpu_ticks = cpu_ticks(sessions[i].pid);
+        sessions[i].switches = switches(sessions[i].pid);
+    }
+    drain_for(sessions, count, seconds);
+
+    unsigned long long ticks = 0, ctx = 0;
+    int alive = 0;
+    for (int i = 0; i < count; i++) {
+        if (waitpid(sessions[i].pid, NULL, WNOHANG) == 0) {
+            alive++;
+        }
+        ticks += cpu_ticks(sessions[i].pid) - sessions[i].cpu_ticks;
+        ctx += switches(sessions[i].pid) - sessions[i].switches;
+    }
+
+    double cpu_ms = ticks * 1000.0 / sysconf(_SC_CLK_TCK);
+    printf("%d sessions (%d still running), %s, %.1f s\n", count, alive, mode, seconds);
+    printf("CPU: %.1f ms total, %.4f ms/s per session (%.5f%% of a core)\n",
+           cpu_ms, cpu_ms / seconds / count, cpu_ms / seconds / count / 10.0);
+    printf("context switches: %.2f per second per session\n", ctx / seconds / count);
+
+    for (int i = 0; i < count; i++) {
+        kill(sessions[i].pid, SIGTERM);
+        close(sessions[i].master);
+    }
+    for (int i = 0; i < count; i++) {
+        waitpid(sessions[i].pid, NULL, 0);
+    }
+    remove_tree(home);
+    free(sessions);
+    return 0;
+}
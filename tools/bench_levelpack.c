@@ -0,0 +1,104 @@
+#include "levelpack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Compares startup cost of parsing ASCII maps against mapping a level pack.
+// Both paths end with every level applied to a GameState.
+
+static double elapsed_us(struct timeval start) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (double)get_time_diff_us(start, now);
+}
+
+int main(int argc, char **argv) {
+    int count = 500;
+    int rounds = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 'r':
+                rounds = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n levels] [-r rounds]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    char dir[] = "/tmp/snake_levels_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    char txt_path[64], pack_path[64];
+    snprintf(txt_path, sizeof(txt_path), "%s/levels.txt", dir);
+    snprintf(pack_path, sizeof(pack_path), "%s/levels.pack", dir);
+
+    Level *levels = malloc(sizeof(Level) * count);
+    FILE *txt = fopen(txt_path, "w");
+    for (int i = 0; i < count; i++) {
+        level_generate(&levels[i], 1 + i % (LEVEL_KIND_COUNT - 1), (unsigned int)i);
+        level_write_ascii(&levels[i], txt);
+    }
+    fclose(txt);
+    levelpack_write(pack_path, levels, count);
+
+    GameState game;
+    Level level;
+    long checksum = 0;
+    struct timeval start;
+
+    gettimeofday(&start, NULL);
+    for (int r = 0; r < rounds; r++) {
+        FILE *in = fopen(txt_path, "r");
+        while (level_read_ascii(&level, in) > 0) {
+            level_apply(&level, &game);
+            checksum += game.obstacles.grid.rows[HEIGHT / 2][0];
+        }
+        fclose(in);
+    }
+    double ascii_us = elapsed_us(start) / rounds;
+
+    gettimeofday(&start, NULL);
+    for (int r = 0; r < rounds; r++) {
+        LevelPack pack;
+        if (levelpack_open(&pack, pack_path) < 0) {
+            fprintf(stderr, "failed to open %s\n", pack_path);
+            return 1;
+        }
+        for (int i = 0; i < pack.count; i++) {
+            levelpack_apply(levelpack_get(&pack, i), &game);
+            checksum += game.obstacles.grid.rows[HEIGHT / 2][0];
+        }
+        levelpack_close(&pack);
+    }
+    double pack_us = elapsed_us(start) / rounds;
+
+    gettimeofday(&start, NULL);
+    for (int r = 0; r < rounds; r++) {
+        LevelPack pack;
+        levelpack_open(&pack, pack_path);
+        levelpack_close(&pack);
+    }
+    double open_us = elapsed_us(start) / rounds;
+
+    printf("levels:            %d (%zu bytes per record)\n", count, sizeof(LevelRecord));
+    printf("ascii parse+apply: %10.1f us (%.3f us/level)\n", ascii_us, ascii_us / count);
+    printf("pack mmap+apply:   %10.1f us (%.3f us/level)\n", pack_us, pack_us / count);
+    printf("pack open only:    %10.1f us\n", open_us);
+    printf("speedup:           %10.1fx\n", ascii_us / pack_us);
+    printf("(checksum %ld)\n", checksum);
+
+    unlink(txt_path);
+    unlink(pack_path);
+    rmdir(dir);
+    free(levels);
+    return 0;
+}
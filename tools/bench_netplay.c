@@ -0,0 +1,197 @@
+#include "snake.h"
+#include "netplay.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Plays a bot against a server over loopback with an artificial delay on
+// both directions and reports what prediction costs and what it buys:
+// how often the client had to roll back, how long re-simulation took, and
+// how long a key took to show on the predicted game versus in a server state.
+
+typedef struct {
+    NetLink link;
+    NetServer server;
+    volatile sig_atomic_t stop;
+} ServerThread;
+
+static void *server_main(void *arg) {
+    ServerThread *s = arg;
+    net_serve(&s->link, &s->server, &s->stop);
+    return NULL;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-d delay_ms] [-j jitter_ms] [-t tick_ms] [-g ticks] [-k key_ms]\n", prog);
+    fprintf(stderr, "  -d  one-way delay added to every packet (default 50)\n");
+    fprintf(stderr, "  -j  extra random delay 0..jitter (default 10)\n");
+    fprintf(stderr, "  -t  server tick in milliseconds (default 20)\n");
+    fprintf(stderr, "  -g  client ticks to play (default 1000)\n");
+    fprintf(stderr, "  -k  mean time between bot key presses (default 150)\n");
+}
+
+static uint64_t bench_rng = 0x2545F4914F6CDD1DULL;
+
+static uint64_t next_rand(void) {
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 7;
+    bench_rng ^= bench_rng << 17;
+    return bench_rng;
+}
+
+// Turns towards the food, along the longer axis first, never straight back
+static int bot_direction(const GameState *game) {
+    Point head = game->snake.body[0];
+    Point food = game->food.position;
+    int dx = food.x - head.x, dy = food.y - head.y;
+    int horizontal = dx > 0 ? DIR_RIGHT : DIR_LEFT;
+    int vertical = dy > 0 ? DIR_DOWN : DIR_UP;
+    int first = abs(dx) >= abs(dy) ? horizontal : vertical;
+    int second = first == horizontal ? vertical : horizontal;
+
+    if ((first == horizontal ? dx : dy) != 0 &&
+        is_valid_direction_change(game->snake.direction, first)) {
+        return first;
+    }
+    if (is_valid_direction_change(game->snake.direction, second)) {
+        return second;
+    }
+    return (int)(next_rand() % 4);
+}
+
+static double mean_ms(const InputLatency *latency) {
+    return latency->count ? latency->total_ns / 1e6 / latency->count : 0.0;
+}
+
+int main(int argc, char **argv) {
+    double delay_ms = 50, jitter_ms = 10, tick_ms = 20, key_ms = 150;
+    long ticks = 1000;
+    static ServerThread server;
+    static NetPredictor predictor;
+    static GameState start;
+    NetLink link;
+    NetMessage message;
+    pthread_t thread;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:j:t:g:k:")) != -1) {
+        switch (opt) {
+            case 'd': delay_ms = atof(optarg); break;
+            case 'j': jitter_ms = atof(optarg); break;
+            case 't': tick_ms = atof(optarg); break;
+            case 'g': ticks = atol(optarg); break;
+            case 'k': key_ms = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (tick_ms < 1 || ticks < 1 || key_ms < 1 || delay_ms < 0 || jitter_ms < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    game_srand(1);
+    init_game_state(&start);
+    if (net_listen(&server.link, 0) < 0 ||
+        net_connect(&link, "127.0.0.1", net_local_port(&server.link)) < 0) {
+        fprintf(stderr, "cannot open loopback sockets\n");
+        return 1;
+    }
+    net_set_delay(&server.link, (uint64_t)(delay_ms * 1e6), (uint64_t)(jitter_ms * 1e6));
+    net_set_delay(&link, (uint64_t)(delay_ms * 1e6), (uint64_t)(jitter_ms * 1e6));
+    net_server_init(&server.server, &start, game_rng_state(), (uint32_t)(tick_ms * 1000));
+    if (pthread_create(&thread, NULL, server_main, &server) != 0) {
+        fprintf(stderr, "cannot start the server thread\n");
+        return 1;
+    }
+
+    net_predict_init(&predictor);
+    uint64_t hello_at = 0;
+    uint64_t press_at = input_now_ns() + (uint64_t)(key_ms * 1e6);
+    uint64_t key_ns = 0;
+    int pressed = -1;
+    unsigned long games = 0;
+    long played = 0;
+
+    while (played < ticks) {
+        uint64_t now = input_now_ns();
+
+        if (!predictor.started && now >= hello_at) {
+            memset(&message, 0, sizeof(message));
+            message.type = NET_HELLO;
+            message.echo_ns = now;
+            net_send(&link, &message);
+            hello_at = now + 1000000000ull;
+        }
+        while (net_receive(&link, &message, now)) {
+            if (message.type == NET_START &&
+                (!predictor.started || message.game != predictor.number)) {
+                if (net_predict_start(&predictor, &message, now) == 0) {
+                    games++;
+                }
+            } else if (message.type == NET_STATE) {
+                net_predict_confirm(&predictor, &message, now);
+            }
+        }
+
+        // The bot presses a key at random moments, not in step with the ticks
+        if (pressed < 0 && now >= press_at && predictor.started) {
+            pressed = bot_direction(&predictor.game);
+            key_ns = press_at;
+            press_at += (uint64_t)((0.5 + (next_rand() % 1000) / 1000.0) * key_ms * 1e6);
+        }
+
+        if (!net_predict_due(&predictor, now)) {
+            uint64_t until = predictor.started ? net_predict_next_ns(&predictor) : hello_at;
+            if (pressed < 0 && predictor.started && press_at < until) {
+                until = press_at;
+            }
+            net_wait(&link, now, until);
+            continue;
+        }
+        net_predict_tick(&predictor, pressed, key_ns, now);
+        pressed = -1;
+        net_predict_inputs(&predictor, &message, now);
+        net_send(&link, &message);
+        played++;
+    }
+
+    memset(&message, 0, sizeof(message));
+    message.type = NET_BYE;
+    net_send(&link, &message);
+    server.stop = 1;
+    pthread_join(thread, NULL);
+
+    printf("loopback, %.0f ms one way + 0..%.0f ms jitter, %.0f ms ticks, %ld client ticks, %lu games\n",
+           delay_ms, jitter_ms, tick_ms, played, games);
+    printf("rtt estimate        %8.1f ms\n", predictor.rtt_ns / 1e6);
+    printf("server states       %8lu   corrections %lu (%.1f%%), snapped ahead %lu\n",
+           predictor.confirms, predictor.corrections,
+           predictor.confirms ? 100.0 * predictor.corrections / predictor.confirms : 0.0,
+           predictor.snaps);
+    printf("late turns          %8lu   of %lu sent\n",
+           server.server.late, predictor.predicted.count);
+    if (predictor.corrections > 0) {
+        printf("per correction      %8.1f ticks re-simulated, %.2f us (max %.2f us)\n",
+               (double)predictor.resimulated / predictor.corrections,
+               predictor.resim_ns / 1e3 / predictor.corrections, predictor.resim_max_ns / 1e3);
+        printf("per re-simulated    %8.3f us/tick\n",
+               predictor.resimulated ? predictor.resim_ns / 1e3 / predictor.resimulated : 0.0);
+    }
+    printf("key -> predicted    %8.1f ms avg, p99 <= %.1f ms  (%lu keys)\n",
+           mean_ms(&predictor.predicted), input_latency_percentile(&predictor.predicted, 0.99) / 1000.0,
+           predictor.predicted.count);
+    printf("key -> server state %8.1f ms avg, p99 <= %.1f ms  (%lu keys)\n",
+           mean_ms(&predictor.authoritative),
+           input_latency_percentile(&predictor.authoritative, 0.99) / 1000.0,
+           predictor.authoritative.count);
+    printf("packets             %8lu sent, %lu received, %lu dropped\n",
+           link.sent, link.received, link.dropped);
+
+    net_close(&link);
+    net_close(&server.link);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Renders the same seeded game with each backend and reports write
+// syscalls, bytes and time per frame. Frames go to stdout, the report to
+// stderr: run it in a terminal, or redirect stdout to a file or /dev/null.
+
+static struct timeval virtual_now;
+
+static void virtual_clock(struct timeval *out) {
+    *out = virtual_now;
+}
+
+static void run(const RenderBackend *out, int frames) {
+    GameState game;
+    RenderStats stats = { 0, 0, 0, 0 };
+    struct timeval start, end;
+
+    if (out->init() < 0) {
+        fprintf(stderr, "%-8s cannot initialize (TERM=%s)\n", out->name,
+                getenv("TERM") ? getenv("TERM") : "");
+        return;
+    }
+
+    game_srand(7);
+    init_game_state(&game);
+    gettimeofday(&start, NULL);
+    for (int f = 0; f < frames; f++) {
+        virtual_now.tv_sec++;
+        int dir = (f / 9) % 4;
+        if (f % 9 == 0 && is_valid_direction_change(game.snake.direction, dir)) {
+            game.snake.direction = dir;
+        }
+        if (update_game(&game) != GAME_RUNNING) {
+            init_game_state(&game);
+        }
+        draw_game(out, &game);
+        render_present(out, &stats);
+    }
+    gettimeofday(&end, NULL);
+    out->shutdown();
+
+    double us = (double)get_time_diff_us(start, end) / frames;
+    if (stats.available) {
+        fprintf(stderr, "%-8s %6d frames %8.2f syscalls/frame %9.1f bytes/frame %8.1f us/frame\n",
+                out->name, frames, (double)stats.syscalls / frames,
+                (double)stats.bytes / frames, us);
+    } else {
+        fprintf(stderr, "%-8s %6d frames %8.1f us/frame (/proc/self/io unavailable)\n",
+                out->name, frames, us);
+    }
+}
+
+int main(int argc, char **argv) {
+    int frames = 2000;
+    const char *only = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 'r':
+                only = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n frames] [-r ansi|ncurses] > /dev/null\n", argv[0]);
+                return 1;
+        }
+    }
+    if (frames <= 0) {
+        frames = 1;
+    }
+
+    game_set_clock(virtual_clock);
+
+    const RenderBackend *backends[] = { &render_ansi, &render_ncurses };
+    for (int i = 0; i < 2; i++) {
+        if (!only || strcmp(only, backends[i]->name) == 0) {
+            run(backends[i], frames);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,381 @@
+#include "fast_game.h"
+#include "level.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Differential soak test: plays random games on the reference engine
+// (game.c) and the ring-buffer engine (fast_game.c) side by side, compares
+// return codes, RNG state and state hashes every tick, and shrinks any
+// divergence to a minimal replay.
+
+#define ACTION_KEEP 4
+#define MAX_TICKS_LIMIT 100000
+
+typedef struct {
+    unsigned int seed;
+    int level_kind;
+    int ticks;
+    unsigned char actions[MAX_TICKS_LIMIT];
+    int tick_us[MAX_TICKS_LIMIT];
+} Replay;
+
+typedef struct {
+    long first_game;
+    long games;
+    int max_ticks;
+    long ticks_played;
+    long divergences;
+    Replay replay;               // First divergence found by this worker
+} Worker;
+
+// ========== Virtual clock ==========
+
+static _Thread_local struct timeval virtual_now;
+
+static void virtual_clock(struct timeval *now) {
+    *now = virtual_now;
+}
+
+static void advance_clock(int us) {
+    virtual_now.tv_usec += us;
+    virtual_now.tv_sec += virtual_now.tv_usec / 1000000;
+    virtual_now.tv_usec %= 1000000;
+}
+
+// ========== Input generation ==========
+
+static uint64_t mix(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void random_replay(Replay *replay, unsigned int seed, int max_ticks) {
+    uint64_t state = seed ^ 0xD1B54A32D192ED03ULL;
+
+    replay->seed = seed;
+    replay->level_kind = (int)(mix(&state) % LEVEL_KIND_COUNT);
+    replay->ticks = max_ticks;
+    for (int i = 0; i < max_ticks; i++) {
+        replay->tick_us[i] = 50000 + (int)(mix(&state) % 120001);
+    }
+}
+
+// Picks the next input for a generated game: mostly moves that do not
+// die on the spot, often towards the food, sometimes anything at all,
+// so games last long enough to grow, boost and place obstacles.
+static int pick_action(const GameState *game, uint64_t *state) {
+    static const int dx[4] = { 0, 1, 0, -1 };
+    static const int dy[4] = { -1, 0, 1, 0 };
+    uint64_t r = mix(state);
+    int safe[4];
+    int safe_count = 0;
+
+    if ((r & 15) == 0) {
+        return (int)((r >> 4) % 5);
+    }
+
+    for (int dir = 0; dir < 4; dir++) {
+        if (!is_valid_direction_change(game->snake.direction, dir)) {
+            continue;
+        }
+        int x = game->snake.body[0].x + dx[dir];
+        int y = game->snake.body[0].y + dy[dir];
+        if (x >= 1 && x <= WIDTH && y >= 1 && y <= HEIGHT &&
+            !is_position_on_obstacle(&game->obstacles, x, y) &&
+            !is_position_on_snake(&game->snake, x, y)) {
+            safe[safe_count++] = dir;
+        }
+    }
+    if (safe_count == 0) {
+        return ACTION_KEEP;
+    }
+
+    if ((r >> 8) & 1 && game->food.active) {
+        for (int i = 0; i < safe_count; i++) {
+            int dir = safe[i];
+            int dist_now = abs(game->food.position.x - game->snake.body[0].x) +
+                           abs(game->food.position.y - game->snake.body[0].y);
+            int dist_next = abs(game->food.position.x - game->snake.body[0].x - dx[dir]) +
+                            abs(game->food.position.y - game->snake.body[0].y - dy[dir]);
+            if (dist_next < dist_now) {
+                return dir;
+            }
+        }
+    }
+    return safe[(r >> 16) % safe_count];
+}
+
+// ========== Side-by-side run ==========
+
+// Plays the replay on both engines. Returns the tick at which they
+// diverge, or -1 if they agree until the game ends or the replay runs out.
+// With `inputs` set, the actions are generated on the fly and stored.
+static int run_replay(Replay *replay, uint64_t *inputs, int *ticks_played) {
+    GameState ref, fast_state;
+    FastGame fast;
+    Level level;
+
+    game_set_clock(virtual_clock);
+    virtual_now.tv_sec = 1000000;
+    virtual_now.tv_usec = 0;
+    game_srand(replay->seed);
+
+    if (replay->level_kind != LEVEL_EMPTY &&
+        level_generate(&level, replay->level_kind, replay->seed) > 0) {
+        level_apply(&level, &ref);
+    } else {
+        init_game_state(&ref);
+    }
+    fast_game_from_state(&fast, &ref);
+
+    for (int tick = 0; tick < replay->ticks; tick++) {
+        if (inputs) {
+            replay->actions[tick] = (unsigned char)pick_action(&ref, inputs);
+        }
+        int action = replay->actions[tick];
+        if (action != ACTION_KEEP) {
+            if (is_valid_direction_change(ref.snake.direction, action)) {
+                ref.snake.direction = action;
+            }
+            fast_game_turn(&fast, action);
+        }
+        advance_clock(replay->tick_us[tick]);
+
+        uint64_t rng_before = game_rng_state();
+        int ref_result = update_game(&ref);
+        uint64_t rng_ref = game_rng_state();
+
+        game_set_rng_state(rng_before);
+        int fast_result = fast_game_step(&fast);
+        uint64_t rng_fast = game_rng_state();
+
+        fast_game_to_state(&fast, &fast_state);
+        if (ref_result != fast_result || rng_ref != rng_fast ||
+            game_state_hash(&ref) != game_state_hash(&fast_state)) {
+            if (ticks_played) {
+                *ticks_played = tick + 1;
+            }
+            return tick;
+        }
+        if (ref_result != GAME_RUNNING) {
+            if (ticks_played) {
+                *ticks_played = tick + 1;
+            }
+            return -1;
+        }
+    }
+    if (ticks_played) {
+        *ticks_played = replay->ticks;
+    }
+    return -1;
+}
+
+// Delta-debugging style shrink: cut the replay at the divergence, then
+// drop chunks of ticks and neutralise turns while it still diverges.
+static void shrink_replay(Replay *replay) {
+    Replay *candidate = malloc(sizeof(Replay));
+    int tick = run_replay(replay, NULL, NULL);
+
+    if (tick < 0) {
+        free(candidate);
+        return;
+    }
+    replay->ticks = tick + 1;
+
+    for (int chunk = replay->ticks / 2; chunk >= 1; chunk /= 2) {
+        for (int start = 0; start + chunk <= replay->ticks; ) {
+            *candidate = *replay;
+            memmove(&candidate->actions[start], &candidate->actions[start + chunk],
+                    (size_t)(candidate->ticks - start - chunk));
+            memmove(&candidate->tick_us[start], &candidate->tick_us[start + chunk],
+                    sizeof(int) * (size_t)(candidate->ticks - start - chunk));
+            candidate->ticks -= chunk;
+
+            int at = run_replay(candidate, NULL, NULL);
+            if (at >= 0) {
+                candidate->ticks = at + 1;
+                *replay = *candidate;
+            } else {
+                start += chunk;
+            }
+        }
+    }
+
+    for (int i = 0; i < replay->ticks; i++) {
+        if (replay->actions[i] == ACTION_KEEP) {
+            continue;
+        }
+        *candidate = *replay;
+        candidate->actions[i] = ACTION_KEEP;
+        if (run_replay(candidate, NULL, NULL) >= 0) {
+            *replay = *candidate;
+        }
+    }
+    free(candidate);
+}
+
+static void write_replay(const Replay *replay, FILE *out) {
+    fprintf(out, "seed %u level %s ticks %d\n", replay->seed,
+            level_kind_name(replay->level_kind), replay->ticks);
+    for (int i = 0; i < replay->ticks; i++) {
+        fprintf(out, "%c%d%c", "URDL."[replay->actions[i]], replay->tick_us[i],
+                (i % 10 == 9 || i == replay->ticks - 1) ? '\n' : ' ');
+    }
+}
+
+static int read_replay(Replay *replay, FILE *in) {
+    char kind[32];
+
+    if (fscanf(in, "seed %u level %31s ticks %d", &replay->seed, kind, &replay->ticks) != 3 ||
+        replay->ticks < 0 || replay->ticks > MAX_TICKS_LIMIT) {
+        return -1;
+    }
+    replay->level_kind = level_kind_from_name(kind);
+    if (replay->level_kind < 0) {
+        return -1;
+    }
+    for (int i = 0; i < replay->ticks; i++) {
+        char action;
+        if (fscanf(in, " %c%d", &action, &replay->tick_us[i]) != 2) {
+            return -1;
+        }
+        const char *pos = strchr("URDL.", action);
+        if (!pos) {
+            return -1;
+        }
+        replay->actions[i] = (unsigned char)(pos - "URDL.");
+    }
+    return 0;
+}
+
+// ========== Soak ==========
+
+static void *soak_worker(void *arg) {
+    Worker *worker = arg;
+    Replay *replay = malloc(sizeof(Replay));
+
+    for (long g = 0; g < worker->games; g++) {
+        unsigned int seed = (unsigned int)(worker->first_game + g);
+        uint64_t inputs = seed ^ 0x2545F4914F6CDD1DULL;
+        int played = 0;
+
+        random_replay(replay, seed, worker->max_ticks);
+        int tick = run_replay(replay, &inputs, &played);
+        worker->ticks_played += played;
+        if (tick >= 0) {
+            replay->ticks = played;
+            if (worker->divergences++ == 0) {
+                shrink_replay(replay);
+                worker->replay = *replay;
+            }
+        }
+    }
+    free(replay);
+    return NULL;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-g games] [-s first_seed] [-t max_ticks] [-j threads] [-o replay.txt]\n", prog);
+    fprintf(stderr, "       %s -r replay.txt\n", prog);
+}
+
+int main(int argc, char **argv) {
+    long games = 100000;
+    unsigned int first_seed = 1;
+    int max_ticks = 2000;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *out_path = NULL;
+    const char *replay_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:s:t:j:o:r:")) != -1) {
+        switch (opt) {
+            case 'g': games = atol(optarg); break;
+            case 's': first_seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 't': max_ticks = atoi(optarg); break;
+            case 'j': threads = atoi(optarg); break;
+            case 'o': out_path = optarg; break;
+            case 'r': replay_path = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (max_ticks < 1 || max_ticks > MAX_TICKS_LIMIT || threads < 1 || games < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (replay_path) {
+        static Replay replay;
+        FILE *in = fopen(replay_path, "r");
+        if (!in || read_replay(&replay, in) < 0) {
+            fprintf(stderr, "%s: cannot read replay\n", replay_path);
+            return 1;
+        }
+        fclose(in);
+        int tick = run_replay(&replay, NULL, NULL);
+        if (tick >= 0) {
+            printf("engines diverge at tick %d\n", tick);
+            return 1;
+        }
+        printf("engines agree for all %d ticks\n", replay.ticks);
+        return 0;
+    }
+
+    Worker *workers = calloc((size_t)threads, sizeof(Worker));
+    pthread_t *ids = calloc((size_t)threads, sizeof(pthread_t));
+    struct timeval start, end;
+
+    long next_game = first_seed;
+    gettimeofday(&start, NULL);
+    for (int i = 0; i < threads; i++) {
+        workers[i].first_game = next_game;
+        workers[i].games = games / threads + (i < games % threads);
+        next_game += workers[i].games;
+        workers[i].max_ticks = max_ticks;
+        pthread_create(&ids[i], NULL, soak_worker, &workers[i]);
+    }
+
+    long ticks = 0;
+    long divergences = 0;
+    const Replay *first = NULL;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        ticks += workers[i].ticks_played;
+        divergences += workers[i].divergences;
+        if (!first && workers[i].divergences) {
+            first = &workers[i].replay;
+        }
+    }
+    gettimeofday(&end, NULL);
+
+    double secs = get_time_diff_us(start, end) / 1e6;
+    printf("games:       %ld (%d threads)\n", games, threads);
+    printf("ticks:       %ld\n", ticks);
+    printf("games/sec:   %.0f\n", games / secs);
+    printf("ticks/sec:   %.0f\n", ticks / secs);
+    printf("divergences: %ld\n", divergences);
+
+    if (first) {
+        printf("\nminimal replay (%d ticks):\n", first->ticks);
+        write_replay(first, stdout);
+        if (out_path) {
+            FILE *out = fopen(out_path, "w");
+            if (out) {
+                write_replay(first, out);
+                fclose(out);
+            }
+        }
+    }
+
+    free(workers);
+    free(ids);
+    return divergences ? 1 : 0;
+}
@@ -0,0 +1,112 @@
+#include "levelpack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Converts ASCII maps (see level_read_ascii) into a binary level pack,
+// or dumps a pack back to ASCII with -d.
+
+#define MAX_PACK_LEVELS 65536
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s maps.txt levels.pack\n", prog);
+    fprintf(stderr, "       %s -d levels.pack\n", prog);
+}
+
+static int dump_pack(const char *path) {
+    LevelPack pack;
+
+    if (levelpack_open(&pack, path) < 0) {
+        fprintf(stderr, "%s: not a valid level pack\n", path);
+        return 1;
+    }
+    for (int i = 0; i < pack.count; i++) {
+        const LevelRecord *record = levelpack_get(&pack, i);
+        Level level;
+
+        if (!record) {
+            fprintf(stderr, "%s: level %d is not playable, skipped\n", path, i);
+            continue;
+        }
+        levelpack_to_level(record, &level);
+        level_write_ascii(&level, stdout);
+    }
+    levelpack_close(&pack);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int dump = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d")) != -1) {
+        switch (opt) {
+            case 'd':
+                dump = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (dump) {
+        if (optind + 1 != argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        return dump_pack(argv[optind]);
+    }
+
+    if (optind + 2 != argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[optind], "r");
+    if (!in) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    Level *levels = malloc(sizeof(Level) * MAX_PACK_LEVELS);
+    int count = 0;
+    int status;
+
+    if (!levels) {
+        fprintf(stderr, "out of memory for %d levels\n", MAX_PACK_LEVELS);
+        fclose(in);
+        return 1;
+    }
+
+    while (count < MAX_PACK_LEVELS && (status = level_read_ascii(&levels[count], in)) > 0) {
+        if (levels[count].name[0] == '\0') {
+            snprintf(levels[count].name, sizeof(levels[count].name), "map-%d", count);
+        }
+        if (!level_is_valid(&levels[count])) {
+            fprintf(stderr, "map %d (%s): spawn blocked or free space not connected\n",
+                    count, levels[count].name);
+            fclose(in);
+            free(levels);
+            return 1;
+        }
+        count++;
+    }
+    fclose(in);
+
+    if (status < 0) {
+        fprintf(stderr, "map %d: expected %d rows of %d '.', '#' or '^>v<' cells\n",
+                count, HEIGHT, WIDTH);
+        free(levels);
+        return 1;
+    }
+
+    if (levelpack_write(argv[optind + 1], levels, count) < 0) {
+        perror(argv[optind + 1]);
+        free(levels);
+        return 1;
+    }
+    printf("%d levels written to %s\n", count, argv[optind + 1]);
+    free(levels);
+    return 0;
+}
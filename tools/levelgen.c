@@ -0,0 +1,86 @@
+#include "level.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Prints generated levels as ASCII maps, or measures generator throughput
+// with -b.
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-k empty|maze|rooms|pillars] [-s seed] [-n count] [-b]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    int kind = LEVEL_MAZE;
+    unsigned int seed = 1;
+    int count = 1;
+    int bench = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "k:s:n:b")) != -1) {
+        switch (opt) {
+            case 'k':
+                kind = level_kind_from_name(optarg);
+                if (kind < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 's':
+                seed = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 'b':
+                bench = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!bench) {
+        Level level;
+        for (int i = 0; i < count; i++) {
+            if (level_generate(&level, kind, seed + i) < 0) {
+                fprintf(stderr, "seed %u: no connected layout found\n", seed + i);
+                return 1;
+            }
+            level_write_ascii(&level, stdout);
+        }
+        return 0;
+    }
+
+    if (count < 1000) {
+        count = 1000;
+    }
+
+    struct timeval start, end;
+    Level level;
+    long candidates = 0;
+    int failed = 0;
+
+    gettimeofday(&start, NULL);
+    for (int i = 0; i < count; i++) {
+        int tried = level_generate(&level, kind, seed + i);
+        if (tried < 0) {
+            failed++;
+            candidates += LEVEL_MAX_CANDIDATES;
+        } else {
+            candidates += tried;
+        }
+    }
+    gettimeofday(&end, NULL);
+
+    double secs = get_time_diff_us(start, end) / 1e6;
+    printf("kind:           %s\n", level_kind_name(kind));
+    printf("levels:         %d (%d failed)\n", count, failed);
+    printf("candidates:     %ld (%.2f per level)\n", candidates, (double)candidates / count);
+    printf("levels/sec:     %.0f\n", count / secs);
+    printf("candidates/sec: %.0f\n", candidates / secs);
+    printf("us/candidate:   %.2f\n", secs * 1e6 / candidates);
+    return 0;
+}
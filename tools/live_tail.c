@@ -0,0 +1,108 @@
+#include "live.h"
+#include "input.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Follows a game started with ./snake -e NAME through its shared-memory
+// segment and prints a line whenever the tick or the game state changes:
+// score, length, speed boost, the time between the last two ticks and how
+// long ago the last one happened. Reading never blocks the game.
+
+static const char *state_name(int state) {
+    switch (state) {
+        case GAME_RUNNING: return "running";
+        case GAME_OVER: return "over";
+        case GAME_WON: return "won";
+        case GAME_QUIT: return "quit";
+        case GAME_PAUSED: return "paused";
+        default: return "?";
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-n name] [-i poll_ms] [-c lines]\n", prog);
+    fprintf(stderr, "  -n  segment name (default %s)\n", LIVE_NAME);
+    fprintf(stderr, "  -i  poll interval in milliseconds (default 20)\n");
+    fprintf(stderr, "  -c  stop after this many lines (default: until the game exits)\n");
+}
+
+int main(int argc, char **argv) {
+    const char *name = LIVE_NAME;
+    int poll_ms = 20;
+    long max_lines = 0;
+    LiveExport live = { NULL, "", 0 };
+    LiveSnapshot snapshot;
+    unsigned long long reads = 0, retried = 0, failed = 0;
+    uint64_t last_publish = 0;
+    long lines = 0;
+    int waiting = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:i:c:")) != -1) {
+        switch (opt) {
+            case 'n': name = optarg; break;
+            case 'i': poll_ms = atoi(optarg); break;
+            case 'c': max_lines = atol(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (poll_ms < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // The game may not have started yet
+    while (live_attach(&live, name) < 0) {
+        if (!waiting) {
+            fprintf(stderr, "waiting for %s...\n", name);
+            waiting = 1;
+        }
+        usleep((useconds_t)poll_ms * 1000);
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    int last_state = -1;
+    uint64_t last_tick = (uint64_t)-1;
+    for (;;) {
+        int retries;
+        reads++;
+        if (live_read(&live, &snapshot, &retries) < 0) {
+            failed++;
+            usleep((useconds_t)poll_ms * 1000);
+            continue;
+        }
+        retried += retries > 0;
+
+        if (snapshot.publishes != last_publish &&
+            (snapshot.tick != last_tick || snapshot.game.state != last_state)) {
+            uint64_t now = input_now_ns();
+            printf("tick %6llu  %-7s  score %5d  len %3d  %s  interval %6.1f ms  age %6.1f ms\n",
+                   (unsigned long long)snapshot.tick, state_name(snapshot.game.state),
+                   snapshot.game.score, snapshot.game.snake.length, snapshot.boost ? "x2" : "  ",
+                   snapshot.interval_ns / 1e6,
+                   now > snapshot.tick_ns ? (now - snapshot.tick_ns) / 1e6 : 0.0);
+            last_tick = snapshot.tick;
+            last_state = snapshot.game.state;
+            if (max_lines > 0 && ++lines >= max_lines) {
+                break;
+            }
+        }
+        last_publish = snapshot.publishes;
+
+        // The segment outlives a crashed game, so check that its writer is still there
+        if (snapshot.game.state == GAME_QUIT ||
+            (kill(snapshot.pid, 0) < 0 && errno == ESRCH)) {
+            break;
+        }
+        usleep((useconds_t)poll_ms * 1000);
+    }
+
+    fprintf(stderr, "%llu reads, %llu retried, %llu gave up\n", reads, retried, failed);
+    live_close(&live);
+    return 0;
+}
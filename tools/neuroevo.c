@@ -0,0 +1,302 @@
+#include "policy.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Evolves small fixed-topology policies (policy.h) on the ring-buffer
+// engine. Every generation each policy plays the same seeded games; the
+// population is evaluated in parallel and bred with elitism, tournament
+// selection, uniform crossover and Gaussian mutation.
+//
+// Fitness per game = score + 10 * apples_eaten + 1000 * win. Score already
+// rewards gold apples (+50) and blue apples leave walls that end careless
+// games early, so both are learned from the same signal.
+
+#define TICK_US 100000
+#define STARVE_TICKS 400           // Ticks without an apple before a game is cut
+#define TOURNAMENT 3
+#define MUTATION_RATE 0.1
+#define MUTATION_SIGMA 0.2
+
+typedef struct {
+    const Policy *population;
+    float *fitness;
+    int count;
+    int games;
+    int max_ticks;
+    unsigned int seed;           // Games of this generation use seed..seed+games-1
+    int next;                    // Next policy to evaluate (shared)
+} Generation;
+
+// ========== Random numbers for breeding ==========
+
+static uint64_t evo_rng;
+
+static uint64_t evo_next(void) {
+    uint64_t z = (evo_rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double evo_uniform(void) {
+    return (evo_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double evo_normal(void) {
+    double u = evo_uniform();
+    double v = evo_uniform();
+    return sqrt(-2.0 * log(u + 1e-300)) * cos(6.283185307179586 * v);
+}
+
+// ========== Evaluation ==========
+
+static _Thread_local struct timeval virtual_now;
+
+static void virtual_clock(struct timeval *now) {
+    *now = virtual_now;
+}
+
+static float play(const Policy *policy, unsigned int seed, int max_ticks) {
+    GameState start;
+    FastGame game;
+    int state = GAME_RUNNING;
+    int hunger = 0;
+
+    game_srand(seed);
+    virtual_now.tv_sec = 0;
+    virtual_now.tv_usec = 0;
+    init_game_state(&start);
+    fast_game_from_state(&game, &start);
+
+    for (int tick = 0; tick < max_ticks && state == GAME_RUNNING; tick++) {
+        int apples = game.apples_eaten;
+
+        virtual_now.tv_usec += TICK_US;
+        virtual_now.tv_sec += virtual_now.tv_usec / 1000000;
+        virtual_now.tv_usec %= 1000000;
+
+        fast_game_turn(&game, policy_act(policy, &game));
+        state = fast_game_step(&game);
+        hunger = game.apples_eaten == apples ? hunger + 1 : 0;
+        if (hunger > STARVE_TICKS) {
+            break;
+        }
+    }
+    return (float)(game.score + 10 * game.apples_eaten + (state == GAME_WON ? 1000 : 0));
+}
+
+static void *evaluate_worker(void *arg) {
+    Generation *gen = arg;
+
+    game_set_clock(virtual_clock);
+    for (;;) {
+        int i = __atomic_fetch_add(&gen->next, 1, __ATOMIC_RELAXED);
+        if (i >= gen->count) {
+            break;
+        }
+        float total = 0.0f;
+        for (int g = 0; g < gen->games; g++) {
+            total += play(&gen->population[i], gen->seed + (unsigned int)g, gen->max_ticks);
+        }
+        gen->fitness[i] = total / gen->games;
+    }
+    return NULL;
+}
+
+static void evaluate(Generation *gen, int threads) {
+    pthread_t ids[256];
+    int started = 0;
+
+    gen->next = 0;
+    for (; started < threads; started++) {
+        if (pthread_create(&ids[started], NULL, evaluate_worker, gen) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        evaluate_worker(gen);
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(ids[t], NULL);
+    }
+}
+
+// ========== Breeding ==========
+
+static const float *sort_fitness;
+
+static int by_fitness_desc(const void *a, const void *b) {
+    float fa = sort_fitness[*(const int *)a];
+    float fb = sort_fitness[*(const int *)b];
+    return (fa < fb) - (fa > fb);
+}
+
+static int tournament(const float *fitness, int count) {
+    int best = (int)(evo_next() % count);
+    for (int k = 1; k < TOURNAMENT; k++) {
+        int other = (int)(evo_next() % count);
+        if (fitness[other] > fitness[best]) {
+            best = other;
+        }
+    }
+    return best;
+}
+
+static void breed(const Policy *parents, const float *fitness, const int *order,
+                  Policy *children, int count) {
+    int elites = count / 8 > 0 ? count / 8 : 1;
+
+    for (int i = 0; i < elites; i++) {
+        children[i] = parents[order[i]];
+    }
+    for (int i = elites; i < count; i++) {
+        const float *a = (const float *)&parents[tournament(fitness, count)];
+        const float *b = (const float *)&parents[tournament(fitness, count)];
+        float *child = (float *)&children[i];
+
+        for (size_t g = 0; g < POLICY_GENES; g++) {
+            child[g] = (evo_next() & 1) ? a[g] : b[g];
+            if (evo_uniform() < MUTATION_RATE) {
+                child[g] += (float)(MUTATION_SIGMA * evo_normal());
+            }
+        }
+    }
+}
+
+static double seconds_since(struct timeval start) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return get_time_diff_us(start, now) / 1e6;
+}
+
+int main(int argc, char **argv) {
+    int count = 64;
+    int generations = 50;
+    int games = 16;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_ticks = 3000;
+    int every = 5;
+    unsigned int seed = 1;
+    const char *checkpoint = "neuroevo.ckpt";
+    const char *resume = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:g:e:j:t:s:c:k:r:")) != -1) {
+        switch (opt) {
+            case 'p': count = atoi(optarg); break;
+            case 'g': generations = atoi(optarg); break;
+            case 'e': games = atoi(optarg); break;
+            case 'j': threads = atoi(optarg); break;
+            case 't': max_ticks = atoi(optarg); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'c': checkpoint = optarg; break;
+            case 'k': every = atoi(optarg); break;
+            case 'r': resume = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-p population] [-g generations] [-e games] [-j threads]\n"
+                                "       [-t max ticks] [-s seed] [-c checkpoint] [-k every] [-r resume]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (count < 2 || games < 1 || generations < 1 || max_ticks < 1) {
+        fprintf(stderr, "Need population >= 2 and positive generations, games and ticks\n");
+        return 1;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > 256) {
+        threads = 256;
+    }
+
+    Policy *population = aligned_alloc(32, sizeof(Policy) * count);
+    Policy *children = aligned_alloc(32, sizeof(Policy) * count);
+    float *fitness = calloc(count, sizeof(float));
+    int *order = malloc(sizeof(int) * count);
+    if (!population || !children || !fitness || !order) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    int first = 0;
+    if (resume) {
+        int loaded = count;
+        int generation;
+        if (policy_load_population(resume, population, fitness, &loaded, &generation, &evo_rng) < 0) {
+            fprintf(stderr, "%s: not a usable checkpoint for %d policies\n", resume, count);
+            return 1;
+        }
+        // Refill a larger population from the loaded one, then breed the next generation
+        for (int i = loaded; i < count; i++) {
+            population[i] = population[i % loaded];
+            fitness[i] = fitness[i % loaded];
+        }
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        sort_fitness = fitness;
+        qsort(order, count, sizeof(int), by_fitness_desc);
+        breed(population, fitness, order, children, count);
+        memcpy(population, children, sizeof(Policy) * count);
+        first = generation + 1;
+        printf("resumed %s at generation %d\n", resume, first);
+    } else {
+        evo_rng = seed;
+        for (int i = 0; i < count; i++) {
+            float *genes = (float *)&population[i];
+            for (size_t g = 0; g < POLICY_GENES; g++) {
+                genes[g] = (float)(0.5 * evo_normal());
+            }
+        }
+    }
+
+    struct timeval start;
+    gettimeofday(&start, NULL);
+    printf("%5s %10s %10s %10s\n", "gen", "best", "mean", "gens/min");
+
+    for (int gen = first; gen < first + generations; gen++) {
+        Generation work = { population, fitness, count, games, max_ticks,
+                            seed * 7919u + (unsigned int)gen * 104729u, 0 };
+        evaluate(&work, threads);
+
+        double mean = 0.0;
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+            mean += fitness[i];
+        }
+        sort_fitness = fitness;
+        qsort(order, count, sizeof(int), by_fitness_desc);
+
+        double elapsed = seconds_since(start);
+        printf("%5d %10.1f %10.1f %10.1f\n", gen, fitness[order[0]], mean / count,
+               (gen - first + 1) * 60.0 / (elapsed > 0 ? elapsed : 1e-9));
+        fflush(stdout);
+
+        int last = gen == first + generations - 1;
+        if ((every > 0 && (gen - first + 1) % every == 0) || last) {
+            if (policy_save_population(checkpoint, population, fitness, count, gen, evo_rng) < 0) {
+                fprintf(stderr, "%s: cannot write checkpoint\n", checkpoint);
+            }
+        }
+        if (!last) {
+            breed(population, fitness, order, children, count);
+            Policy *swap = population;
+            population = children;
+            children = swap;
+        }
+    }
+
+    printf("%d generations of %d policies x %d games on %d threads in %.1f s\n",
+           generations, count, games, threads, seconds_since(start));
+    free(population);
+    free(children);
+    free(fitness);
+    free(order);
+    return 0;
+}
@@ -0,0 +1,451 @@
+#define _GNU_SOURCE
+#include "snake.h"
+#include "level.h"
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+
+// Headless runner: plays seeded games on the reference engine with a
+// greedy driver and reports ticks per second. With -P it also profiles
+// chosen engine functions with hardware counters (perf_event_open):
+// before every tick each probe runs once on the live state, the mutating
+// ones on scratch copies with the RNG restored, so the game is unchanged.
+// The copies are made by an untimed setup step outside the counted window.
+// Without counter access (containers, paranoid kernels) it falls back to
+// wall-clock timing only.
+
+#define COUNTERS 4
+#define COUNTER_CYCLES 0
+#define COUNTER_INSTRUCTIONS 1
+#define COUNTER_BRANCH_MISSES 2
+#define COUNTER_L1D_MISSES 3
+
+typedef struct {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+} CounterSpec;
+
+static const CounterSpec counter_specs[COUNTERS] = {
+    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { "L1D misses", PERF_TYPE_HW_CACHE,
+      PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+      PERF_COUNT_HW_CACHE_RESULT_MISS << 16 },
+};
+
+typedef struct {
+    const char *name;
+    void (*setup)(GameState *game);  // Untimed preparation, NULL if none
+    void (*run)(GameState *game);
+    int enabled;
+    int leader;                  // Group leader fd, -1 when timing only
+    int slot[COUNTERS];          // Position in the group read, -1 if not opened
+    int fds[COUNTERS];           // Follower counter fds (fds[0] unused, the leader)
+    int opened;
+    double counts[COUNTERS];
+    long calls;
+    uint64_t ns;
+} Probe;
+
+static volatile long sink;
+static int tick_result;
+static GameState scratch;        // Filled by the setup step of mutating probes
+
+// ========== Probes ==========
+
+static void probe_update_game(GameState *game) {
+    tick_result = update_game(game);
+}
+
+static void setup_scratch_snake(GameState *game) {
+    scratch.snake = game->snake;
+}
+
+static void probe_update_snake_position(GameState *game) {
+    (void)game;
+    update_snake_position(&scratch.snake);
+    sink += scratch.snake.body[0].x;
+}
+
+static void probe_check_self_collision(GameState *game) {
+    sink += check_self_collision(&game->snake);
+}
+
+static void probe_check_collision(GameState *game) {
+    sink += check_collision(&game->snake, &game->obstacles);
+}
+
+static void setup_scratch_food(GameState *game) {
+    scratch.food = game->food;
+}
+
+static void probe_generate_food(GameState *game) {
+    generate_food(&game->snake, &game->obstacles, &scratch.food);
+    sink += scratch.food.position.x;
+}
+
+static void setup_scratch_game(GameState *game) {
+    scratch = *game;
+    scratch.events = NULL;
+}
+
+static void probe_add_obstacle(GameState *game) {
+    (void)game;
+    add_obstacle(&scratch);
+    sink += scratch.obstacles.count;
+}
+
+static void probe_game_state_hash(GameState *game) {
+    sink += (long)game_state_hash(game);
+}
+
+static void probe_empty(GameState *game) {
+    (void)game;
+}
+
+static Probe probes[] = {
+    { "update_game", NULL, probe_update_game, 0, -1, {0}, {0}, 0, {0}, 0, 0 },
+    { "update_snake_position", setup_scratch_snake, probe_update_snake_position,
+      0, -1, {0}, {0}, 0, {0}, 0, 0 },
+    { "check_self_collision", NULL, probe_check_self_collision, 0, -1, {0}, {0}, 0, {0}, 0, 0 },
+    { "check_collision", NULL, probe_check_collision, 0, -1, {0}, {0}, 0, {0}, 0, 0 },
+    { "generate_food", setup_scratch_food, probe_generate_food, 0, -1, {0}, {0}, 0, {0}, 0, 0 },
+    { "add_obstacle", setup_scratch_game, probe_add_obstacle, 0, -1, {0}, {0}, 0, {0}, 0, 0 },
+    { "game_state_hash", NULL, probe_game_state_hash, 0, -1, {0}, {0}, 0, {0}, 0, 0 },
+    { "empty", NULL, probe_empty, 0, -1, {0}, {0}, 0, {0}, 0, 0 },
+};
+
+#define PROBE_COUNT ((int)(sizeof(probes) / sizeof(probes[0])))
+#define PROBE_UPDATE_GAME 0
+
+// ========== Counters ==========
+
+static int open_counter(const CounterSpec *spec, int group) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec->type;
+    attr.config = spec->config;
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// Opens one counter group per enabled probe. Returns 0, or -1 with errno
+// set when the PMU cannot be used at all.
+static int open_probe_counters(void) {
+    for (int p = 0; p < PROBE_COUNT; p++) {
+        Probe *probe = &probes[p];
+        if (!probe->enabled) {
+            continue;
+        }
+        probe->leader = open_counter(&counter_specs[COUNTER_CYCLES], -1);
+        if (probe->leader < 0) {
+            return -1;
+        }
+        probe->slot[COUNTER_CYCLES] = 0;
+        probe->opened = 1;
+        // Events the CPU lacks (often L1D in VMs) are reported as n/a
+        for (int c = 1; c < COUNTERS; c++) {
+            int fd = open_counter(&counter_specs[c], probe->leader);
+            probe->fds[c] = fd;
+            probe->slot[c] = fd < 0 ? -1 : probe->opened++;
+        }
+    }
+    return 0;
+}
+
+static void close_probe_counters(void) {
+    for (int p = 0; p < PROBE_COUNT; p++) {
+        Probe *probe = &probes[p];
+        if (probe->leader < 0) {
+            continue;
+        }
+        for (int c = 1; c < COUNTERS; c++) {
+            if (probe->slot[c] >= 0) {
+                close(probe->fds[c]);
+                probe->slot[c] = -1;
+            }
+        }
+        close(probe->leader);
+        probe->leader = -1;
+    }
+}
+
+static void read_probe_counters(Probe *probe) {
+    uint64_t data[3 + COUNTERS];
+
+    if (probe->leader < 0 || read(probe->leader, data, sizeof(data)) < (ssize_t)(3 * sizeof(uint64_t))) {
+        return;
+    }
+    // Scale in case the kernel had to multiplex the group
+    double scale = data[2] ? (double)data[1] / (double)data[2] : 0.0;
+    for (int c = 0; c < COUNTERS; c++) {
+        if (probe->slot[c] >= 0 && (uint64_t)probe->slot[c] < data[0]) {
+            probe->counts[c] = (double)data[3 + probe->slot[c]] * scale;
+        }
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Only the run step falls between the clock reads and inside the counted
+// window; setup copies and the counter ioctls stay outside both
+static void run_probe(Probe *probe, GameState *game) {
+    uint64_t start, end;
+
+    if (probe->setup) {
+        probe->setup(game);
+    }
+    if (probe->leader >= 0) {
+        ioctl(probe->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    start = now_ns();
+    probe->run(game);
+    end = now_ns();
+    if (probe->leader >= 0) {
+        ioctl(probe->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+    probe->ns += end - start;
+    probe->calls++;
+}
+
+// ========== Game driver ==========
+
+static _Thread_local struct timeval virtual_now;
+
+static void virtual_clock(struct timeval *now) {
+    *now = virtual_now;
+}
+
+static int cell_is_free(const GameState *game, int x, int y) {
+    return x > 0 && x <= WIDTH && y > 0 && y <= HEIGHT &&
+           !is_position_on_snake(&game->snake, x, y) &&
+           !is_position_on_obstacle(&game->obstacles, x, y);
+}
+
+// Heads for the food along free cells, keeping the direction on ties
+static void steer(GameState *game) {
+    static const int dx[4] = { 0, 1, 0, -1 };
+    static const int dy[4] = { -1, 0, 1, 0 };
+    Point head = game->snake.body[0];
+    int best = -1;
+    int best_distance = 0;
+
+    for (int i = 0; i < 4; i++) {
+        int dir = (game->snake.direction + i) & 3;
+        int x = head.x + dx[dir];
+        int y = head.y + dy[dir];
+        if (!is_valid_direction_change(game->snake.direction, dir) || !cell_is_free(game, x, y)) {
+            continue;
+        }
+        int distance = game->food.active ?
+            abs(x - game->food.position.x) + abs(y - game->food.position.y) : 0;
+        if (best < 0 || distance < best_distance) {
+            best = dir;
+            best_distance = distance;
+        }
+    }
+    if (best >= 0) {
+        game->snake.direction = best;
+    }
+}
+
+static long play_game(unsigned int seed, int level_kind, int max_ticks, int profile) {
+    static GameState game;
+    Level level;
+    long ticks = 0;
+
+    game_srand(seed);
+    if (level_kind >= 0 && level_generate(&level, level_kind, seed) >= 0) {
+        level_apply(&level, &game);
+    } else {
+        init_game_state(&game);
+    }
+    virtual_now.tv_sec = 1000;
+    virtual_now.tv_usec = 0;
+
+    for (int t = 0; t < max_ticks; t++) {
+        steer(&game);
+        virtual_now.tv_usec += 100000;
+        if (virtual_now.tv_usec >= 1000000) {
+            virtual_now.tv_sec++;
+            virtual_now.tv_usec -= 1000000;
+        }
+
+        if (profile) {
+            uint64_t rng = game_rng_state();
+            for (int p = PROBE_UPDATE_GAME + 1; p < PROBE_COUNT; p++) {
+                if (probes[p].enabled) {
+                    run_probe(&probes[p], &game);
+                    game_set_rng_state(rng);
+                }
+            }
+        }
+        if (profile && probes[PROBE_UPDATE_GAME].enabled) {
+            run_probe(&probes[PROBE_UPDATE_GAME], &game);
+        } else {
+            tick_result = update_game(&game);
+        }
+        ticks++;
+        if (tick_result != GAME_RUNNING) {
+            break;
+        }
+    }
+    return ticks;
+}
+
+// ========== Report ==========
+
+static void print_ratio(double value, int available, int width, int precision) {
+    if (available) {
+        printf(" %*.*f", width, precision, value);
+    } else {
+        printf(" %*s", width, "n/a");
+    }
+}
+
+static void print_report(long ticks, int counters) {
+    printf("\n%-22s %10s %9s %6s %11s %13s %13s\n", "function", "calls", "ns/call",
+           "IPC", "instr/call", "br-miss/tick", "L1D-miss/tick");
+    for (int p = 0; p < PROBE_COUNT; p++) {
+        const Probe *probe = &probes[p];
+        if (!probe->enabled || probe->calls == 0) {
+            continue;
+        }
+        double cycles = probe->counts[COUNTER_CYCLES];
+        int has_cycles = counters && probe->slot[COUNTER_CYCLES] >= 0 && cycles > 0;
+        int has_instr = counters && probe->slot[COUNTER_INSTRUCTIONS] >= 0;
+
+        printf("%-22s %10ld %9.1f", probe->name, probe->calls, (double)probe->ns / probe->calls);
+        print_ratio(has_cycles ? probe->counts[COUNTER_INSTRUCTIONS] / cycles : 0,
+                    has_cycles && has_instr, 6, 2);
+        print_ratio(probe->counts[COUNTER_INSTRUCTIONS] / probe->calls, has_instr, 11, 1);
+        print_ratio(probe->counts[COUNTER_BRANCH_MISSES] / ticks,
+                    counters && probe->slot[COUNTER_BRANCH_MISSES] >= 0, 13, 3);
+        print_ratio(probe->counts[COUNTER_L1D_MISSES] / ticks,
+                    counters && probe->slot[COUNTER_L1D_MISSES] >= 0, 13, 3);
+        printf("\n");
+    }
+    printf("\nEach row includes the probe's own floor (a clock read, the counter switch); the 'empty' row shows it.\n");
+}
+
+static int enable_probes(const char *list) {
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%s", list);
+
+    for (char *name = strtok(buf, ","); name; name = strtok(NULL, ",")) {
+        int found = 0;
+        for (int p = 0; p < PROBE_COUNT; p++) {
+            if (strcmp(name, "all") == 0 || strcmp(name, probes[p].name) == 0) {
+                probes[p].enabled = 1;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "unknown function: %s\n", name);
+            return -1;
+        }
+    }
+    probes[PROBE_COUNT - 1].enabled = 1;
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-g games] [-s first_seed] [-t max_ticks] [-l level] [-P functions]\n", prog);
+    fprintf(stderr, "  -l takes empty, maze, rooms or pillars (default: the classic board)\n");
+    fprintf(stderr, "  -P takes a comma-separated list or 'all':");
+    for (int p = 0; p < PROBE_COUNT - 1; p++) {
+        fprintf(stderr, " %s", probes[p].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+    long games = 1000;
+    unsigned int first_seed = 1;
+    int max_ticks = 5000;
+    int level_kind = -1;
+    const char *profile_list = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:s:t:l:P:")) != -1) {
+        switch (opt) {
+            case 'g': games = atol(optarg); break;
+            case 's': first_seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 't': max_ticks = atoi(optarg); break;
+            case 'l':
+                level_kind = level_kind_from_name(optarg);
+                if (level_kind < 0) {
+                    fprintf(stderr, "unknown level: %s\n", optarg);
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'P': profile_list = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (games < 1 || max_ticks < 1 || (profile_list && enable_probes(profile_list) < 0)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int counters = 0;
+    if (profile_list) {
+        if (open_probe_counters() == 0) {
+            counters = 1;
+            for (int c = 1; c < COUNTERS; c++) {
+                if (probes[PROBE_COUNT - 1].slot[c] < 0) {
+                    printf("counter unavailable: %s\n", counter_specs[c].name);
+                }
+            }
+        } else {
+            printf("hardware counters unavailable (%s); timing only\n", strerror(errno));
+            close_probe_counters();
+        }
+    }
+
+    struct timeval start, end;
+    long ticks = 0;
+    game_set_clock(virtual_clock);
+    gettimeofday(&start, NULL);
+    for (long g = 0; g < games; g++) {
+        ticks += play_game(first_seed + (unsigned int)g, level_kind, max_ticks, profile_list != NULL);
+    }
+    gettimeofday(&end, NULL);
+    game_set_clock(NULL);
+
+    double secs = get_time_diff_us(start, end) / 1e6;
+    printf("games:     %ld\n", games);
+    printf("ticks:     %ld (%.1f per game)\n", ticks, (double)ticks / games);
+    printf("ticks/sec: %.0f%s\n", ticks / secs, profile_list ? " (with probes)" : "");
+
+    if (profile_list) {
+        for (int p = 0; p < PROBE_COUNT && counters; p++) {
+            read_probe_counters(&probes[p]);
+        }
+        print_report(ticks, counters);
+        close_probe_counters();
+    }
+    return 0;
+}
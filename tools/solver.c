@@ -0,0 +1,1105 @@
+#include "snake.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+// Exhaustive solver for small boards (up to 64 cells). Plays the rules of
+// game.c on a W x H field chosen at run time and computes the exact value
+// of a position: the best expected score, or the probability of reaching
+// the target length, under optimal play.
+//
+// Decision nodes are positions right after food has spawned. Between two
+// apples the game is deterministic, so a breadth-first search over the
+// bodies reachable without eating collects every distinct way to eat the
+// apple; each one then branches over a blue apple's wall (uniform over the
+// cells add_obstacle() accepts) and over the next spawn (uniform over free
+// cells, types weighted like generate_food()). Every apple makes the snake
+// longer, so nodes form a DAG and cycles only occur inside the BFS.
+//
+// Nodes are memoized under a canonical key (minimum over the board's
+// symmetries) in a lock-free open-addressing table that can live in an
+// mmap'ed file and be reused by later runs. Threads split the children of
+// the root. The speed boost does not change the rules and is ignored, as
+// are the retry caps of generate_food()/add_obstacle().
+//
+// The tree grows by a factor of 5-10 per unit of target length, so -w is
+// what decides whether a run finishes; usage() lists measured limits.
+
+#define MAX_SIDE 8
+#define MAX_CELLS 64
+#define KEY_WORDS 4
+
+#define GOAL_SCORE 0
+#define GOAL_WIN 1
+
+#define CHANCE_EXPECT 0
+#define CHANCE_BEST 1
+#define CHANCE_WORST 2
+
+#define MEMO_MAGIC "SNKSOLV2"
+#define MEMO_PROBES 64
+#define MEMO_EMPTY 0
+#define MEMO_WRITING 1
+#define MEMO_READY 2
+
+typedef struct {
+    uint8_t body[MAX_CELLS];     // Cells, head first
+    int length;
+    uint64_t obstacles;          // Cell mask of walls
+    int obstacle_count;
+    int food;                    // Cell, or -1 when no apple is on the board
+    int food_type;
+} Position;
+
+typedef struct {
+    Position pos;                // After the move and growth, before any spawn
+    int gain;
+    int type;                    // Type of the apple eaten, -1 for none
+} Outcome;
+
+typedef struct {
+    Position pos;
+    double weight;
+} Child;
+
+typedef struct {
+    uint64_t key[KEY_WORDS];
+    double value;
+    uint64_t state;              // MEMO_*
+} MemoEntry;
+
+typedef struct {
+    char magic[8];
+    int32_t width;
+    int32_t height;
+    int32_t target;
+    int32_t goal;
+    int32_t chance;
+    int32_t log2_capacity;
+    uint64_t used;
+    uint8_t reserved[24];
+} MemoHeader;
+
+typedef struct {
+    uint64_t key[KEY_WORDS];
+    uint32_t stamp;
+} VisitSlot;
+
+// Open-addressing set of encodings; a new stamp empties it in O(1)
+typedef struct {
+    VisitSlot *slots;
+    uint64_t mask;
+    uint64_t count;
+    uint32_t stamp;
+} VisitSet;
+
+typedef struct {
+    VisitSet visited;
+    VisitSet eaten;
+    uint8_t *queue;              // MAX_CELLS bytes per body
+    size_t queue_capacity;
+    long configs;                // Bodies expanded by the BFS
+    long nodes;                  // Decision nodes solved (memo misses)
+    long hits;
+} Worker;
+
+_Static_assert(sizeof(MemoHeader) == 64, "memo header is one cache line");
+
+// ========== Board ==========
+
+static int board_w, board_h, board_cells;
+static int target_length;
+static int goal = GOAL_SCORE;
+static int chance_mode = CHANCE_EXPECT;
+static uint64_t board_mask;
+static int neighbour[MAX_CELLS][4];              // -1 off the board
+static int symmetry_count;
+static uint8_t symmetry[8][MAX_CELLS];
+
+// Mirrors handle_food_eaten() and generate_food()
+static const int food_score[4] = { 10, 20, 50, 15 };
+static const int food_growth[4] = { 1, 2, 1, 1 };
+static const double food_chance[4] = { 0.60, 0.15, 0.10, 0.15 };
+
+static const int step_x[4] = { 0, 1, 0, -1 };
+static const int step_y[4] = { -1, 0, 1, 0 };
+
+static void setup_board(int w, int h) {
+    board_w = w;
+    board_h = h;
+    board_cells = w * h;
+    board_mask = board_cells == 64 ? ~0ULL : (1ULL << board_cells) - 1;
+
+    for (int c = 0; c < board_cells; c++) {
+        int x = c % w;
+        int y = c / w;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + step_x[d];
+            int ny = y + step_y[d];
+            neighbour[c][d] = nx >= 0 && nx < w && ny >= 0 && ny < h ? ny * w + nx : -1;
+        }
+        // Rectangles keep 4 symmetries, squares all 8
+        int sym[8][2] = {
+            { x, y }, { w - 1 - x, y }, { x, h - 1 - y }, { w - 1 - x, h - 1 - y },
+            { y, x }, { h - 1 - y, x }, { y, w - 1 - x }, { h - 1 - y, w - 1 - x },
+        };
+        symmetry_count = w == h ? 8 : 4;
+        for (int t = 0; t < symmetry_count; t++) {
+            symmetry[t][c] = (uint8_t)(sym[t][1] * w + sym[t][0]);
+        }
+    }
+}
+
+static uint64_t body_mask(const Position *pos, int segments) {
+    uint64_t mask = 0;
+    for (int i = 0; i < segments; i++) {
+        mask |= 1ULL << pos->body[i];
+    }
+    return mask;
+}
+
+// Same check as grid_is_connected(): all non-wall cells form one region
+static int free_space_connected(uint64_t walls) {
+    uint64_t free = board_mask & ~walls;
+    uint64_t reach = free & -free;
+    uint64_t left_edge = 0;
+    uint64_t right_edge = 0;
+
+    if (!free) {
+        return 1;
+    }
+    for (int y = 0; y < board_h; y++) {
+        left_edge |= 1ULL << (y * board_w);
+        right_edge |= 1ULL << (y * board_w + board_w - 1);
+    }
+    for (;;) {
+        uint64_t grown = reach | (reach << board_w) | (reach >> board_w) |
+                         ((reach & ~right_edge) << 1) | ((reach & ~left_edge) >> 1);
+        grown &= free;
+        if (grown == reach) {
+            return reach == free;
+        }
+        reach = grown;
+    }
+}
+
+// ========== Encoding ==========
+
+typedef struct {
+    uint64_t *words;
+    int bit;
+} BitWriter;
+
+static void put_bits(BitWriter *out, uint64_t value, int bits) {
+    for (int i = 0; i < bits; i++, out->bit++) {
+        if (value >> i & 1) {
+            out->words[out->bit >> 6] |= 1ULL << (out->bit & 63);
+        }
+    }
+}
+
+static int move_dir(int from, int to) {
+    int dx = to % board_w - from % board_w;
+    int dy = to / board_w - from / board_w;
+    for (int d = 0; d < 4; d++) {
+        if (step_x[d] == dx && step_y[d] == dy) {
+            return d;
+        }
+    }
+    return 0;
+}
+
+// Head, length, food, stacked tail, 2-bit moves along the body and the
+// wall mask, all seen through symmetry t
+static void encode(const Position *pos, int t, uint64_t *key) {
+    const uint8_t *map = symmetry[t];
+    BitWriter out = { key, 0 };
+    int unfolded = pos->length;
+    uint64_t walls = 0;
+
+    memset(key, 0, sizeof(uint64_t) * KEY_WORDS);
+    while (unfolded > 1 && pos->body[unfolded - 1] == pos->body[unfolded - 2]) {
+        unfolded--;
+    }
+    put_bits(&out, map[pos->body[0]], 6);
+    put_bits(&out, (uint64_t)pos->length, 7);
+    put_bits(&out, pos->food < 0 ? 0 : map[pos->food] + 1, 7);
+    put_bits(&out, pos->food < 0 ? 0 : (uint64_t)pos->food_type, 2);
+    put_bits(&out, (uint64_t)(pos->length - unfolded), 7);
+    for (int i = 1; i < unfolded; i++) {
+        put_bits(&out, (uint64_t)move_dir(map[pos->body[i - 1]], map[pos->body[i]]), 2);
+    }
+    for (uint64_t m = pos->obstacles; m; m &= m - 1) {
+        walls |= 1ULL << map[__builtin_ctzll(m)];
+    }
+    // Moves end before bit 160, so the walls get the last word to themselves
+    key[KEY_WORDS - 1] = walls;
+}
+
+static int key_less(const uint64_t *a, const uint64_t *b) {
+    for (int i = 0; i < KEY_WORDS; i++) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i];
+        }
+    }
+    return 0;
+}
+
+// Only symmetries that map the head to its smallest image are encoded;
+// the choice is the same for every symmetric copy of a position
+static void canonical_key(const Position *pos, uint64_t *key) {
+    uint64_t candidate[KEY_WORDS];
+    int head = MAX_CELLS;
+    int found = 0;
+
+    for (int t = 0; t < symmetry_count; t++) {
+        if (symmetry[t][pos->body[0]] < head) {
+            head = symmetry[t][pos->body[0]];
+        }
+    }
+    for (int t = 0; t < symmetry_count; t++) {
+        if (symmetry[t][pos->body[0]] != head) {
+            continue;
+        }
+        encode(pos, t, found ? candidate : key);
+        if (found && key_less(candidate, key)) {
+            memcpy(key, candidate, sizeof(candidate));
+        }
+        found = 1;
+    }
+}
+
+static uint64_t key_hash(const uint64_t *key) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < KEY_WORDS; i++) {
+        h = (h ^ key[i]) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+// ========== Memo table ==========
+
+static MemoHeader *memo_header;
+static MemoEntry *memo;
+static uint64_t memo_mask;
+static size_t memo_bytes;
+static int memo_loaded;
+
+static int memo_open(const char *path, int log2_capacity) {
+    uint64_t capacity = 1ULL << log2_capacity;
+    int fd = -1;
+    int flags = MAP_SHARED;
+    int zeroed = 1;              // Fresh mappings read as zeros already
+
+    memo_bytes = sizeof(MemoHeader) + capacity * sizeof(MemoEntry);
+    if (path) {
+        struct stat st;
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0 || fstat(fd, &st) < 0) {
+            return -1;
+        }
+        if ((size_t)st.st_size != memo_bytes && ftruncate(fd, (off_t)memo_bytes) < 0) {
+            close(fd);
+            return -1;
+        }
+        zeroed = st.st_size == 0;
+    } else {
+        flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+    }
+    void *base = mmap(NULL, memo_bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    memo_header = base;
+    memo = (MemoEntry *)((char *)base + sizeof(MemoHeader));
+    memo_mask = capacity - 1;
+
+    // Results only carry over between runs with the same rules
+    MemoHeader expected;
+    memset(&expected, 0, sizeof(expected));
+    memcpy(expected.magic, MEMO_MAGIC, sizeof(expected.magic));
+    expected.width = board_w;
+    expected.height = board_h;
+    expected.target = target_length;
+    expected.goal = goal;
+    expected.chance = chance_mode;
+    expected.log2_capacity = log2_capacity;
+    expected.used = memo_header->used;
+    if (memcmp(memo_header, &expected, sizeof(expected)) == 0 && memo_header->used > 0) {
+        memo_loaded = 1;
+        return 0;
+    }
+    // Clearing a zero mapping would only fault in every page of it
+    if (!zeroed) {
+        memset(memo, 0, capacity * sizeof(MemoEntry));
+    }
+    expected.used = 0;
+    *memo_header = expected;
+    return 0;
+}
+
+static void memo_close(void) {
+    if (memo_header) {
+        msync(memo_header, memo_bytes, MS_SYNC);
+        munmap(memo_header, memo_bytes);
+    }
+}
+
+static int memo_lookup(const uint64_t *key, double *value) {
+    uint64_t i = key_hash(key);
+
+    for (int probe = 0; probe < MEMO_PROBES; probe++, i++) {
+        MemoEntry *entry = &memo[i & memo_mask];
+        uint64_t state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+        if (state == MEMO_EMPTY) {
+            return 0;
+        }
+        if (state == MEMO_READY && memcmp(entry->key, key, sizeof(entry->key)) == 0) {
+            *value = entry->value;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// A full probe window just drops the result; it is recomputed if needed
+static void memo_store(const uint64_t *key, double value) {
+    uint64_t i = key_hash(key);
+
+    for (int probe = 0; probe < MEMO_PROBES; probe++, i++) {
+        MemoEntry *entry = &memo[i & memo_mask];
+        uint64_t state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+        if (state == MEMO_EMPTY &&
+            __atomic_compare_exchange_n(&entry->state, &state, MEMO_WRITING, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            memcpy(entry->key, key, sizeof(entry->key));
+            entry->value = value;
+            __atomic_store_n(&entry->state, MEMO_READY, __ATOMIC_RELEASE);
+            __atomic_fetch_add(&memo_header->used, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        if (state == MEMO_READY && memcmp(entry->key, key, sizeof(entry->key)) == 0) {
+            return;
+        }
+    }
+}
+
+// ========== Per-thread BFS scratch ==========
+
+static int visit_insert(VisitSet *set, const uint64_t *key) {
+    if ((set->count + 1) * 2 > set->mask + 1) {
+        VisitSet grown = { NULL, set->mask * 2 + 1, 0, 1 };
+        grown.slots = calloc(grown.mask + 1, sizeof(VisitSlot));
+        if (!grown.slots) {
+            fprintf(stderr, "out of memory for the search frontier\n");
+            exit(1);
+        }
+        for (uint64_t i = 0; i <= set->mask; i++) {
+            if (set->slots[i].stamp == set->stamp) {
+                visit_insert(&grown, set->slots[i].key);
+            }
+        }
+        free(set->slots);
+        *set = grown;
+    }
+
+    for (uint64_t i = key_hash(key);; i++) {
+        VisitSlot *slot = &set->slots[i & set->mask];
+        if (slot->stamp != set->stamp) {
+            memcpy(slot->key, key, sizeof(slot->key));
+            slot->stamp = set->stamp;
+            set->count++;
+            return 1;
+        }
+        if (memcmp(slot->key, key, sizeof(slot->key)) == 0) {
+            return 0;
+        }
+    }
+}
+
+static void visit_reset(VisitSet *set) {
+    set->count = 0;
+    if (++set->stamp == 0) {
+        memset(set->slots, 0, (set->mask + 1) * sizeof(VisitSlot));
+        set->stamp = 1;
+    }
+}
+
+static void worker_init(Worker *w) {
+    memset(w, 0, sizeof(*w));
+    w->visited.mask = w->eaten.mask = 1023;
+    w->visited.stamp = w->eaten.stamp = 1;
+    w->visited.slots = calloc(1024, sizeof(VisitSlot));
+    w->eaten.slots = calloc(1024, sizeof(VisitSlot));
+    w->queue_capacity = 1024;
+    w->queue = malloc(w->queue_capacity * MAX_CELLS);
+    if (!w->visited.slots || !w->eaten.slots || !w->queue) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+}
+
+static void worker_free(Worker *w) {
+    free(w->visited.slots);
+    free(w->eaten.slots);
+    free(w->queue);
+}
+
+static size_t worker_bytes(const Worker *w) {
+    return (w->visited.mask + w->eaten.mask + 2) * sizeof(VisitSlot) +
+           w->queue_capacity * MAX_CELLS;
+}
+
+// ========== Game rules ==========
+
+// Moves pos one step in direction d. Returns 0 if the snake dies.
+static int step(const Position *pos, int d, Position *next) {
+    int head = neighbour[pos->body[0]][d];
+
+    if (head < 0 || (pos->obstacles >> head & 1)) {
+        return 0;
+    }
+    // The tail moves away first; a stacked tail keeps its cell taken
+    if (body_mask(pos, pos->length - 1) >> head & 1) {
+        return 0;
+    }
+    *next = *pos;
+    memmove(next->body + 1, pos->body, (size_t)pos->length - 1);
+    next->body[0] = (uint8_t)head;
+    return 1;
+}
+
+static void eat(Position *pos, Outcome *outcome) {
+    int type = pos->food_type;
+
+    for (int i = 0; i < food_growth[type] && pos->length < MAX_CELLS; i++) {
+        pos->body[pos->length] = pos->body[pos->length - 1];
+        pos->length++;
+    }
+    outcome->pos = *pos;
+    outcome->pos.food = -1;
+    outcome->gain = food_score[type];
+    outcome->type = type;
+}
+
+// Every distinct body that reaches the current apple without dying first.
+// The apple's type only matters once it is eaten, so one search serves all
+// four types spawned on the same cell.
+static int list_arrivals(Worker *w, const Position *node, Position **out) {
+    size_t head = 0, tail = 0;
+    int count = 0, capacity = 16;
+    uint64_t key[KEY_WORDS];
+    Position pos = *node;
+    Position *arrivals = malloc(sizeof(Position) * capacity);
+
+    if (!arrivals) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    visit_reset(&w->visited);
+    visit_reset(&w->eaten);
+    encode(node, 0, key);
+    visit_insert(&w->visited, key);
+    memcpy(w->queue, node->body, MAX_CELLS);
+    tail = 1;
+
+    while (head < tail && node->food >= 0) {
+        memcpy(pos.body, w->queue + (head++ % w->queue_capacity) * MAX_CELLS, MAX_CELLS);
+        w->configs++;
+
+        for (int d = 0; d < 4; d++) {
+            Position next;
+            if (!step(&pos, d, &next)) {
+                continue;
+            }
+            if (next.body[0] == node->food) {
+                encode(&next, 0, key);
+                if (visit_insert(&w->eaten, key)) {
+                    if (count == capacity) {
+                        capacity *= 2;
+                        arrivals = realloc(arrivals, sizeof(Position) * capacity);
+                        if (!arrivals) {
+                            fprintf(stderr, "out of memory\n");
+                            exit(1);
+                        }
+                    }
+                    arrivals[count++] = next;
+                }
+                continue;
+            }
+            encode(&next, 0, key);
+            if (!visit_insert(&w->visited, key)) {
+                continue;
+            }
+            // The queue is a ring; grow it when the frontier fills it
+            if (tail - head == w->queue_capacity) {
+                size_t old = w->queue_capacity;
+                uint8_t *grown = malloc(old * 2 * MAX_CELLS);
+                if (!grown) {
+                    fprintf(stderr, "out of memory for the search frontier\n");
+                    exit(1);
+                }
+                for (size_t i = head; i < tail; i++) {
+                    memcpy(grown + (i - head) * MAX_CELLS,
+                           w->queue + (i % old) * MAX_CELLS, MAX_CELLS);
+                }
+                free(w->queue);
+                w->queue = grown;
+                w->queue_capacity = old * 2;
+                tail -= head;
+                head = 0;
+            }
+            memcpy(w->queue + (tail++ % w->queue_capacity) * MAX_CELLS, next.body, MAX_CELLS);
+        }
+    }
+    *out = arrivals;
+    return count;
+}
+
+// Every distinct way to eat the current apple without dying first
+static int list_outcomes(Worker *w, const Position *node, Outcome **out) {
+    Position *arrivals;
+    int count = list_arrivals(w, node, &arrivals);
+    Outcome *outcomes = malloc(sizeof(Outcome) * ((size_t)count + 1));
+
+    if (!outcomes) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        eat(&arrivals[i], &outcomes[i]);
+    }
+    free(arrivals);
+    *out = outcomes;
+    return count;
+}
+
+// Positions after an apple: a blue apple's wall, then the next spawn
+static int list_children(const Outcome *outcome, Child **out) {
+    uint64_t walls[MAX_CELLS];
+    int wall_options = 0;
+    uint64_t snake = body_mask(&outcome->pos, outcome->pos.length);
+    int eaten_at = outcome->pos.body[0];
+
+    if (outcome->type == FOOD_BLUE && outcome->pos.obstacle_count < MAX_OBSTACLES) {
+        uint64_t candidates = board_mask & ~snake & ~outcome->pos.obstacles;
+        for (uint64_t m = candidates; m; m &= m - 1) {
+            int c = __builtin_ctzll(m);
+            // add_obstacle() keeps walls away from the apple it was placed for
+            if (abs(c % board_w - eaten_at % board_w) < 3 &&
+                abs(c / board_w - eaten_at / board_w) < 3) {
+                continue;
+            }
+            if (free_space_connected(outcome->pos.obstacles | 1ULL << c)) {
+                walls[wall_options++] = 1ULL << c;
+            }
+        }
+    }
+    if (wall_options == 0) {
+        walls[wall_options++] = 0;
+    }
+
+    Child *children = malloc(sizeof(Child) * (size_t)wall_options * (MAX_CELLS * 4 + 1));
+    int count = 0;
+    if (!children) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (int o = 0; o < wall_options; o++) {
+        Position pos = outcome->pos;
+        if (walls[o]) {
+            pos.obstacles |= walls[o];
+            pos.obstacle_count++;
+        }
+        uint64_t free = board_mask & ~snake & ~pos.obstacles;
+        int free_count = __builtin_popcountll(free);
+        if (free_count == 0) {
+            pos.food = -1;
+            children[count].pos = pos;
+            children[count++].weight = 1.0 / wall_options;
+            continue;
+        }
+        for (uint64_t m = free; m; m &= m - 1) {
+            for (int type = 0; type < 4; type++) {
+                pos.food = __builtin_ctzll(m);
+                pos.food_type = type;
+                children[count].pos = pos;
+                children[count++].weight = food_chance[type] / free_count / wall_options;
+            }
+        }
+    }
+    *out = children;
+    return count;
+}
+
+static double combine(double acc, double value, double weight, int first) {
+    switch (chance_mode) {
+        case CHANCE_BEST:
+            return first || value > acc ? value : acc;
+        case CHANCE_WORST:
+            return first || value < acc ? value : acc;
+        default:
+            return acc + weight * value;
+    }
+}
+
+// In win mode values lie in [0, 1], so a sure win cannot be beaten and,
+// with best- or worst-case spawns, one extreme child settles the node
+static int settled(double value, int chance) {
+    if (goal != GOAL_WIN) {
+        return 0;
+    }
+    return (chance == CHANCE_BEST && value >= 1.0) || (chance == CHANCE_WORST && value <= 0.0);
+}
+
+// Children that differ only in the apple's type (same cell and walls)
+static int spawn_group(const Child *children, int count) {
+    int n = 1;
+    while (n < count && children[0].pos.food >= 0 &&
+           children[n].pos.food == children[0].pos.food &&
+           children[n].pos.obstacles == children[0].pos.obstacles) {
+        n++;
+    }
+    return n;
+}
+
+static void solve_spawn(Worker *w, const Child *children, int count, double *values);
+
+static double chance_value(Worker *w, const Outcome *outcome) {
+    Child *children;
+    int count = list_children(outcome, &children);
+    double value = 0.0;
+    double values[4];
+
+    for (int i = 0; i < count;) {
+        int n = spawn_group(children + i, count - i);
+        solve_spawn(w, children + i, n, values);
+        for (int k = 0; k < n; k++) {
+            value = combine(value, values[k], children[i + k].weight, i + k == 0);
+        }
+        i += n;
+        if (settled(value, chance_mode)) {
+            break;
+        }
+    }
+    free(children);
+    return value;
+}
+
+static int has_safe_move(const Position *pos) {
+    Position next;
+    for (int d = 0; d < 4; d++) {
+        if (step(pos, d, &next)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static double outcome_value(const Outcome *outcome, double after) {
+    return goal == GOAL_SCORE ? outcome->gain + after : after;
+}
+
+// Value of a decision node: the game ends on the first safe move once the
+// snake is long enough, otherwise the best way to eat the apple counts
+static int solve_leaf(const Position *node, double *value) {
+    if (node->length >= target_length) {
+        *value = goal == GOAL_WIN && has_safe_move(node) ? 1.0 : 0.0;
+        return 1;
+    }
+    // Walls never go away: once the free cells cannot hold the target
+    // length the game cannot be won
+    if (goal == GOAL_WIN && board_cells - node->obstacle_count < target_length) {
+        *value = 0.0;
+        return 1;
+    }
+    return 0;
+}
+
+static double eat_value(Worker *w, const Position *node, const Position *arrivals, int count) {
+    double value = 0.0;
+
+    for (int i = 0; i < count && !settled(value, CHANCE_BEST); i++) {
+        Position pos = arrivals[i];
+        Outcome outcome;
+        pos.food_type = node->food_type;
+        eat(&pos, &outcome);
+        double v = outcome_value(&outcome, chance_value(w, &outcome));
+        if (v > value) {
+            value = v;
+        }
+    }
+    return value;
+}
+
+// Solves the nodes of one spawn group; the ways to reach the apple are
+// searched once, and only if some type misses the memo
+static void solve_spawn(Worker *w, const Child *children, int count, double *values) {
+    uint64_t keys[4][KEY_WORDS];
+    int missing = 0;
+
+    for (int i = 0; i < count; i++) {
+        const Position *node = &children[i].pos;
+        if (solve_leaf(node, &values[i])) {
+            continue;
+        }
+        canonical_key(node, keys[i]);
+        if (memo_lookup(keys[i], &values[i])) {
+            w->hits++;
+            continue;
+        }
+        missing |= 1 << i;
+    }
+    if (!missing) {
+        return;
+    }
+
+    Position *arrivals;
+    int arrival_count = list_arrivals(w, &children[0].pos, &arrivals);
+    for (int i = 0; i < count; i++) {
+        if (missing >> i & 1) {
+            w->nodes++;
+            values[i] = eat_value(w, &children[i].pos, arrivals, arrival_count);
+            memo_store(keys[i], values[i]);
+        }
+    }
+    free(arrivals);
+}
+
+static double solve(Worker *w, const Position *node) {
+    Child child = { *node, 1.0 };
+    double value;
+
+    solve_spawn(w, &child, 1, &value);
+    return value;
+}
+
+// ========== Parallel root ==========
+
+typedef struct {
+    Child *children;             // One spawn group
+    int count;
+    int outcome;
+    double values[4];
+} Task;
+
+typedef struct {
+    Task *tasks;
+    int task_count;
+    int next;                    // Next task to claim (shared)
+    int done;
+    Worker *workers;
+} Root;
+
+static Root root;
+
+static void *solve_worker(void *arg) {
+    Worker *w = arg;
+
+    for (;;) {
+        int i = __atomic_fetch_add(&root.next, 1, __ATOMIC_RELAXED);
+        if (i >= root.task_count) {
+            break;
+        }
+        solve_spawn(w, root.tasks[i].children, root.tasks[i].count, root.tasks[i].values);
+        __atomic_fetch_add(&root.done, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+// ========== Command line ==========
+
+static int parse_cell(const char **s, int *cell) {
+    int x, y, used;
+    if (sscanf(*s, "%d,%d%n", &x, &y, &used) != 2 || x < 0 || x >= board_w ||
+        y < 0 || y >= board_h) {
+        return -1;
+    }
+    *s += used;
+    *cell = y * board_w + x;
+    return 0;
+}
+
+// "x,y:RRD" - head cell, then the direction from each segment to the next
+static int parse_snake(const char *s, Position *pos) {
+    int cell;
+    if (parse_cell(&s, &cell) < 0 || *s++ != ':') {
+        return -1;
+    }
+    pos->body[0] = (uint8_t)cell;
+    pos->length = 1;
+    for (; *s; s++) {
+        const char *dirs = "URDL";
+        const char *d = strchr(dirs, *s);
+        if (!d || !*d || pos->length == MAX_CELLS) {
+            return -1;
+        }
+        int prev = pos->body[pos->length - 1];
+        int next = neighbour[prev][d - dirs];
+        if (next < 0 || (body_mask(pos, pos->length) >> next & 1)) {
+            return -1;
+        }
+        pos->body[pos->length++] = (uint8_t)next;
+    }
+    return pos->length >= 2 ? 0 : -1;
+}
+
+static int parse_food(const char *s, Position *pos) {
+    const char *types = "rgyb";
+    const char *t;
+    if (parse_cell(&s, &pos->food) < 0 || *s++ != ':' || !(t = strchr(types, *s)) || !*t) {
+        return -1;
+    }
+    pos->food_type = (int)(t - types);
+    return 0;
+}
+
+static int parse_obstacles(const char *s, Position *pos) {
+    while (*s) {
+        int cell;
+        if (parse_cell(&s, &cell) < 0 || (*s && *s++ != ';')) {
+            return -1;
+        }
+        pos->obstacles |= 1ULL << cell;
+        pos->obstacle_count++;
+    }
+    return 0;
+}
+
+static long rss_kb(void) {
+    FILE *in = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = -1;
+    while (in && fgets(line, sizeof(line), in)) {
+        if (sscanf(line, "VmRSS: %ld", &kb) == 1) {
+            break;
+        }
+    }
+    if (in) {
+        fclose(in);
+    }
+    return kb;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-W width] [-H height] [-w target_length] [-g score|win]\n"
+            "          [-c expect|best|worst] [-s x,y:DIRS] [-f x,y:r|g|y|b] [-o x,y;x,y...]\n"
+            "          [-j threads] [-m memo_file] [-M log2_memo_entries]\n"
+            "  Cells are 0-based; DIRS (U/R/D/L) lead from the head along the body.\n"
+            "  Without -f the position is the game start: the first move spawns food.\n"
+            "  The target length sets the cost: every extra unit multiplies the work\n"
+            "  by 5-10. Default: the start length + 3. Rough single-thread times for\n"
+            "  the expected score: 4x4 -w 7 15 s, -w 8 90 s; 5x4 -w 6 40 s;\n"
+            "  6x6 -w 5 45 s; bigger boards or targets are out of reach. Win mode\n"
+            "  (-g win) with -c best or worst cuts off far more of the tree.\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    int w = 4, h = 4;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int log2_memo = 22;
+    const char *snake_arg = NULL, *food_arg = NULL, *obstacle_arg = NULL;
+    const char *memo_path = NULL;
+    int opt;
+
+    target_length = -1;
+    while ((opt = getopt(argc, argv, "W:H:w:g:c:s:f:o:j:m:M:")) != -1) {
+        switch (opt) {
+            case 'W': w = atoi(optarg); break;
+            case 'H': h = atoi(optarg); break;
+            case 'w': target_length = atoi(optarg); break;
+            case 'g': goal = strcmp(optarg, "win") == 0 ? GOAL_WIN : GOAL_SCORE; break;
+            case 'c':
+                chance_mode = strcmp(optarg, "best") == 0 ? CHANCE_BEST :
+                              strcmp(optarg, "worst") == 0 ? CHANCE_WORST : CHANCE_EXPECT;
+                break;
+            case 's': snake_arg = optarg; break;
+            case 'f': food_arg = optarg; break;
+            case 'o': obstacle_arg = optarg; break;
+            case 'j': threads = atoi(optarg); break;
+            case 'm': memo_path = optarg; break;
+            case 'M': log2_memo = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (w < 2 || h < 2 || w > MAX_SIDE || h > MAX_SIDE || threads < 1 || threads > 256 ||
+        log2_memo < 10 || log2_memo > 36) {
+        usage(argv[0]);
+        return 1;
+    }
+    setup_board(w, h);
+
+    // Default start mirrors init_game_state(): length 3, heading right
+    Position start;
+    memset(&start, 0, sizeof(start));
+    start.food = -1;
+    if (snake_arg ? parse_snake(snake_arg, &start) < 0 : w < 3) {
+        fprintf(stderr, "invalid snake\n");
+        return 1;
+    }
+    if (!snake_arg) {
+        int head = (h / 2) * w + w / 2;
+        start.length = w / 2 + 1 < 3 ? w / 2 + 1 : 3;
+        for (int i = 0; i < start.length; i++) {
+            start.body[i] = (uint8_t)(head - i);
+        }
+    }
+    if (target_length < 0) {
+        target_length = start.length + 3;
+    }
+    if ((food_arg && parse_food(food_arg, &start) < 0) ||
+        (obstacle_arg && parse_obstacles(obstacle_arg, &start) < 0) ||
+        (body_mask(&start, start.length) & start.obstacles) ||
+        (start.food >= 0 && ((body_mask(&start, start.length) | start.obstacles) >> start.food & 1))) {
+        fprintf(stderr, "invalid food or obstacles\n");
+        return 1;
+    }
+    if (memo_open(memo_path, log2_memo) < 0) {
+        fprintf(stderr, "cannot open memo table\n");
+        return 1;
+    }
+
+    // Root outcomes: ways to eat the given apple, or the first moves of a
+    // new game (food spawns after the first move)
+    Worker *workers = malloc(sizeof(Worker) * (size_t)threads);
+    Outcome *outcomes = NULL;
+    int outcome_count = 0;
+    double value = 0.0;
+    int trivial = start.length >= target_length;
+
+    for (int t = 0; t < threads; t++) {
+        worker_init(&workers[t]);
+    }
+    if (trivial) {
+        value = solve(&workers[0], &start);
+    } else if (start.food >= 0) {
+        outcome_count = list_outcomes(&workers[0], &start, &outcomes);
+    } else {
+        outcomes = malloc(sizeof(Outcome) * 4);
+        for (int d = 0; d < 4; d++) {
+            Position next;
+            if (step(&start, d, &next)) {
+                outcomes[outcome_count].pos = next;
+                outcomes[outcome_count].gain = 0;
+                outcomes[outcome_count++].type = -1;
+            }
+        }
+    }
+
+    // Every spawn group of every root outcome is one task
+    Child **children = calloc((size_t)outcome_count + 1, sizeof(Child *));
+    int *child_counts = calloc((size_t)outcome_count + 1, sizeof(int));
+    int child_total = 0;
+    for (int o = 0; o < outcome_count; o++) {
+        child_counts[o] = list_children(&outcomes[o], &children[o]);
+        child_total += child_counts[o];
+    }
+    root.tasks = calloc((size_t)child_total + 1, sizeof(Task));
+    for (int o = 0; o < outcome_count; o++) {
+        for (int c = 0; c < child_counts[o]; root.task_count++) {
+            Task *task = &root.tasks[root.task_count];
+            task->children = &children[o][c];
+            task->count = spawn_group(task->children, child_counts[o] - c);
+            task->outcome = o;
+            c += task->count;
+        }
+    }
+    root.workers = workers;
+
+    struct timeval start_time, now;
+    pthread_t ids[256];
+    int started = 0;
+    gettimeofday(&start_time, NULL);
+    for (; started < threads && root.task_count > 0; started++) {
+        if (pthread_create(&ids[started], NULL, solve_worker, &workers[started]) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        solve_worker(&workers[0]);
+    }
+    // Progress every five seconds while the workers run
+    for (int polls = 1; __atomic_load_n(&root.done, __ATOMIC_RELAXED) < root.task_count; polls++) {
+        usleep(100000);
+        if (polls % 50 == 0) {
+            fprintf(stderr, "%d/%d root spawns, %d s\n",
+                    __atomic_load_n(&root.done, __ATOMIC_RELAXED), root.task_count, polls / 10);
+        }
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(ids[t], NULL);
+    }
+    gettimeofday(&now, NULL);
+
+    if (!trivial) {
+        for (int o = 0, i = 0; o < outcome_count; o++) {
+            double after = 0.0;
+            for (int first = 1; i < root.task_count && root.tasks[i].outcome == o; i++) {
+                for (int k = 0; k < root.tasks[i].count; k++, first = 0) {
+                    after = combine(after, root.tasks[i].values[k],
+                                    root.tasks[i].children[k].weight, first);
+                }
+            }
+            double v = outcome_value(&outcomes[o], after);
+            if (v > value) {
+                value = v;
+            }
+        }
+    }
+
+    long configs = 0, nodes = 0, hits = 0;
+    size_t scratch = 0;
+    for (int t = 0; t < threads; t++) {
+        configs += workers[t].configs;
+        nodes += workers[t].nodes;
+        hits += workers[t].hits;
+        scratch += worker_bytes(&workers[t]);
+    }
+    double secs = get_time_diff_us(start_time, now) / 1e6;
+    uint64_t used = memo_header->used;
+
+    static const char *chance_names[] = { "expected", "best-case", "worst-case" };
+    printf("board %dx%d, target length %d, %s over spawns\n", w, h, target_length,
+           chance_names[chance_mode]);
+    if (goal == GOAL_WIN) {
+        printf("win probability: %.6f\n", value);
+    } else {
+        printf("score: %.4f\n", value);
+    }
+    printf("states:   %ld bodies, %ld nodes in %.2f s (%.0f states/s, %d threads)\n",
+           configs, nodes, secs, secs > 0 ? (configs + nodes) / secs : 0.0, started ? started : 1);
+    printf("memo:     %lu / %lu entries (%.1f%%), %ld hits%s\n", (unsigned long)used,
+           (unsigned long)(memo_mask + 1), 100.0 * used / (memo_mask + 1), hits,
+           memo_loaded ? ", reused from file" : "");
+    printf("memory:   %.1f MB memo touched, %.1f MB search scratch, %.1f MB RSS\n",
+           used * sizeof(MemoEntry) / 1e6, scratch / 1e6, rss_kb() / 1e3);
+
+    for (int o = 0; o < outcome_count; o++) {
+        free(children[o]);
+    }
+    free(children);
+    free(child_counts);
+    free(root.tasks);
+    free(outcomes);
+    for (int t = 0; t < threads; t++) {
+        worker_free(&workers[t]);
+    }
+    free(workers);
+    memo_close();
+    return 0;
+}
@@ -0,0 +1,446 @@
+#include "fast_game.h"
+#include "heatmap.h"
+#include "level.h"
+#include "policy.h"
+#include "stats.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+// Round-robin tournament: every bot plays the same seed schedule (seed,
+// level and food sequence are identical across bots). Seeds are claimed by
+// worker threads, each keeping its own streaming aggregates per bot, which
+// are merged at the end, so memory does not grow with the game count.
+// Paired score differences against the first bot use the shared seeds to
+// give tighter confidence intervals than the independent means.
+// With -H every worker also counts head visits, eaten food and deaths per
+// cell in its own heatmap; the maps are summed after the join and written
+// as CSV and PGM files.
+
+#define MAX_BOTS 16
+#define TICK_US 100000
+#define STARVE_TICKS 1000          // Ticks without an apple before a game is cut
+#define SEED_CHUNK 16
+
+// Game outcomes; DEATH_WALL..DEATH_OBSTACLE come from collision_cause()
+#define OUTCOME_WON 4
+#define OUTCOME_CUT 5              // Tick limit or starvation
+#define OUTCOMES 6
+
+#define BOT_RANDOM 0
+#define BOT_STRAIGHT 1
+#define BOT_GREEDY 2
+#define BOT_POLICY 3
+
+typedef struct {
+    char name[64];
+    int kind;
+    Policy *policy;
+} Bot;
+
+typedef struct {
+    RunningStats score;
+    RunningStats length;
+    RunningStats ticks;
+    RunningStats score_delta;    // Against bot 0 on the same seed
+    TDigest score_q;
+    TDigest length_q;
+    TDigest ticks_q;
+    long outcomes[OUTCOMES];
+} BotStats;
+
+typedef struct {
+    const Bot *bots;
+    int bot_count;
+    long games;
+    unsigned int first_seed;
+    int level_kind;
+    int max_ticks;
+    long next;                   // Next seed index to claim (shared)
+} Schedule;
+
+typedef struct {
+    Schedule *schedule;
+    BotStats *stats;             // One per bot
+    Heatmap *heatmap;            // NULL without -H
+} Worker;
+
+typedef struct {
+    int score;
+    int length;
+    int ticks;
+    int outcome;
+} GameResult;
+
+static const char *outcome_names[OUTCOMES] = { "", "wall", "self", "obstacle", "won", "cut" };
+
+// ========== Bots ==========
+
+static _Thread_local struct timeval virtual_now;
+
+static void virtual_clock(struct timeval *now) {
+    *now = virtual_now;
+}
+
+static const int step_x[4] = { 0, 1, 0, -1 };
+static const int step_y[4] = { -1, 0, 1, 0 };
+
+static int cell_is_free(const FastGame *game, int x, int y) {
+    return x > 0 && x <= WIDTH && y > 0 && y <= HEIGHT && game->cells[y][x] == 0 &&
+           !grid_test(&game->obstacles.grid, x, y);
+}
+
+static int choose(const Bot *bot, const FastGame *game, uint64_t *rng) {
+    Point head = game->ring[game->head];
+    int best = game->direction;
+    int best_distance = -1;
+
+    switch (bot->kind) {
+        case BOT_POLICY:
+            return policy_act(bot->policy, game);
+        case BOT_RANDOM:
+            *rng ^= *rng << 13;
+            *rng ^= *rng >> 7;
+            *rng ^= *rng << 17;
+            return (int)(*rng % 4);
+    }
+
+    // Straight keeps going until blocked; greedy heads for the food.
+    // Both only pick free cells, trying the current direction first.
+    for (int i = 0; i < 4; i++) {
+        int dir = (game->direction + i) & 3;
+        int x = head.x + step_x[dir];
+        int y = head.y + step_y[dir];
+        if (!is_valid_direction_change(game->direction, dir) || !cell_is_free(game, x, y)) {
+            continue;
+        }
+        int distance = bot->kind == BOT_GREEDY && game->food.active ?
+            abs(x - game->food.position.x) + abs(y - game->food.position.y) : 0;
+        if (best_distance < 0 || distance < best_distance) {
+            best = dir;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+// ========== Games ==========
+
+// With a heatmap, records what the engine's MOVED, FOOD_EATEN and DIED
+// events would report: the head after every move, including the fatal one
+static GameResult play(const Bot *bot, const Schedule *schedule, unsigned int seed,
+                       Heatmap *heatmap) {
+    GameState start;
+    FastGame game;
+    GameResult result = { 0, 0, 0, OUTCOME_CUT };
+    uint64_t rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+    int hunger = 0;
+
+    game_srand(seed);
+    virtual_now.tv_sec = 0;
+    virtual_now.tv_usec = 0;
+    Level level;
+    if (schedule->level_kind >= 0 && level_generate(&level, schedule->level_kind, seed) >= 0) {
+        level_apply(&level, &start);
+    } else {
+        init_game_state(&start);
+    }
+    fast_game_from_state(&game, &start);
+
+    for (int tick = 0; tick < schedule->max_ticks && hunger < STARVE_TICKS; tick++) {
+        int apples = game.apples_eaten;
+
+        virtual_now.tv_usec += TICK_US;
+        virtual_now.tv_sec += virtual_now.tv_usec / 1000000;
+        virtual_now.tv_usec %= 1000000;
+
+        fast_game_turn(&game, choose(bot, &game, &rng));
+        int state = fast_game_step(&game);
+        result.ticks = tick + 1;
+        hunger = game.apples_eaten == apples ? hunger + 1 : 0;
+        if (heatmap) {
+            Point head = game.ring[game.head];
+            heatmap_add(heatmap, HEATMAP_VISITS, head.x, head.y);
+            if (game.apples_eaten != apples) {
+                heatmap_add(heatmap, HEATMAP_FOOD, head.x, head.y);
+            }
+        }
+
+        if (state == GAME_WON) {
+            result.outcome = OUTCOME_WON;
+            break;
+        }
+        if (state == GAME_OVER) {
+            GameState dead;
+            fast_game_to_state(&game, &dead);
+            result.outcome = collision_cause(&dead.snake, &dead.obstacles);
+            if (heatmap) {
+                heatmap_add(heatmap, HEATMAP_DEATH_WALL + result.outcome - DEATH_WALL,
+                            dead.snake.body[0].x, dead.snake.body[0].y);
+            }
+            break;
+        }
+    }
+    result.score = game.score;
+    result.length = game.length;
+    if (heatmap) {
+        heatmap->games++;
+    }
+    return result;
+}
+
+static void init_bot_stats(BotStats *stats) {
+    running_stats_init(&stats->score);
+    running_stats_init(&stats->length);
+    running_stats_init(&stats->ticks);
+    running_stats_init(&stats->score_delta);
+    tdigest_init(&stats->score_q);
+    tdigest_init(&stats->length_q);
+    tdigest_init(&stats->ticks_q);
+    memset(stats->outcomes, 0, sizeof(stats->outcomes));
+}
+
+static void record(BotStats *stats, const GameResult *result, const GameResult *baseline) {
+    running_stats_add(&stats->score, result->score);
+    running_stats_add(&stats->length, result->length);
+    running_stats_add(&stats->ticks, result->ticks);
+    running_stats_add(&stats->score_delta, result->score - baseline->score);
+    tdigest_add(&stats->score_q, result->score, 1);
+    tdigest_add(&stats->length_q, result->length, 1);
+    tdigest_add(&stats->ticks_q, result->ticks, 1);
+    stats->outcomes[result->outcome]++;
+}
+
+static void merge_bot_stats(BotStats *dst, const BotStats *src) {
+    running_stats_merge(&dst->score, &src->score);
+    running_stats_merge(&dst->length, &src->length);
+    running_stats_merge(&dst->ticks, &src->ticks);
+    running_stats_merge(&dst->score_delta, &src->score_delta);
+    tdigest_merge(&dst->score_q, &src->score_q);
+    tdigest_merge(&dst->length_q, &src->length_q);
+    tdigest_merge(&dst->ticks_q, &src->ticks_q);
+    for (int i = 0; i < OUTCOMES; i++) {
+        dst->outcomes[i] += src->outcomes[i];
+    }
+}
+
+static void *tournament_worker(void *arg) {
+    Worker *worker = arg;
+    Schedule *schedule = worker->schedule;
+    GameResult results[MAX_BOTS];
+
+    game_set_clock(virtual_clock);
+    for (;;) {
+        long first = __atomic_fetch_add(&schedule->next, SEED_CHUNK, __ATOMIC_RELAXED);
+        if (first >= schedule->games) {
+            break;
+        }
+        long last = first + SEED_CHUNK < schedule->games ? first + SEED_CHUNK : schedule->games;
+        for (long g = first; g < last; g++) {
+            unsigned int seed = schedule->first_seed + (unsigned int)g;
+            for (int b = 0; b < schedule->bot_count; b++) {
+                results[b] = play(&schedule->bots[b], schedule, seed, worker->heatmap);
+            }
+            for (int b = 0; b < schedule->bot_count; b++) {
+                record(&worker->stats[b], &results[b], &results[0]);
+            }
+        }
+    }
+    return NULL;
+}
+
+// ========== Report ==========
+
+static void print_report(const Bot *bots, BotStats *stats, int bot_count) {
+    printf("\n%-16s %8s %16s %7s %7s %7s %9s %7s %7s %9s %7s %7s\n", "bot", "games",
+           "score", "p50", "p90", "p99", "length", "p50", "p99", "ticks", "p50", "p99");
+    for (int b = 0; b < bot_count; b++) {
+        BotStats *s = &stats[b];
+        printf("%-16.16s %8lu %8.1f ±%6.1f %7.0f %7.0f %7.0f %9.2f %7.0f %7.0f %9.1f %7.0f %7.0f\n",
+               bots[b].name, (unsigned long)s->score.count,
+               s->score.mean, running_stats_ci95(&s->score),
+               tdigest_quantile(&s->score_q, 0.5), tdigest_quantile(&s->score_q, 0.9),
+               tdigest_quantile(&s->score_q, 0.99),
+               s->length.mean, tdigest_quantile(&s->length_q, 0.5),
+               tdigest_quantile(&s->length_q, 0.99),
+               s->ticks.mean, tdigest_quantile(&s->ticks_q, 0.5),
+               tdigest_quantile(&s->ticks_q, 0.99));
+    }
+
+    printf("\n%-16s", "outcome %");
+    for (int o = DEATH_WALL; o < OUTCOMES; o++) {
+        printf(" %9s", outcome_names[o]);
+    }
+    printf(" %22s\n", "score vs first bot");
+    for (int b = 0; b < bot_count; b++) {
+        const BotStats *s = &stats[b];
+        printf("%-16.16s", bots[b].name);
+        for (int o = DEATH_WALL; o < OUTCOMES; o++) {
+            printf(" %9.2f", s->score.count ? 100.0 * s->outcomes[o] / s->score.count : 0.0);
+        }
+        printf(" %+13.1f ±%6.1f\n", s->score_delta.mean, running_stats_ci95(&s->score_delta));
+    }
+}
+
+// ========== Command line ==========
+
+static int parse_bots(const char *list, Bot *bots) {
+    char buf[1024];
+    int count = 0;
+
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *name = strtok(buf, ","); name; name = strtok(NULL, ",")) {
+        Bot *bot = &bots[count];
+        if (count == MAX_BOTS) {
+            fprintf(stderr, "at most %d bots\n", MAX_BOTS);
+            return -1;
+        }
+        snprintf(bot->name, sizeof(bot->name), "%s", name);
+        bot->policy = NULL;
+        if (strcmp(name, "random") == 0) {
+            bot->kind = BOT_RANDOM;
+        } else if (strcmp(name, "straight") == 0) {
+            bot->kind = BOT_STRAIGHT;
+        } else if (strcmp(name, "greedy") == 0) {
+            bot->kind = BOT_GREEDY;
+        } else if (strncmp(name, "policy=", 7) == 0) {
+            bot->kind = BOT_POLICY;
+            bot->policy = aligned_alloc(_Alignof(Policy), sizeof(Policy));
+            if (!bot->policy || policy_load_best(name + 7, bot->policy) < 0) {
+                fprintf(stderr, "%s: cannot load policy checkpoint\n", name + 7);
+                return -1;
+            }
+        } else {
+            fprintf(stderr, "unknown bot: %s\n", name);
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-b bots] [-g games per bot] [-s first_seed] [-t max_ticks] "
+                    "[-l level] [-j threads] [-H heatmap_prefix]\n", prog);
+    fprintf(stderr, "  bots: comma-separated random, straight, greedy, policy=<checkpoint>\n");
+    fprintf(stderr, "  level: empty, maze, rooms or pillars (default: the classic board)\n");
+    fprintf(stderr, "  -H: write PREFIX.csv and PREFIX-{visits,food,wall,self,obstacle}.pgm "
+                    "over all bots' games\n");
+}
+
+int main(int argc, char **argv) {
+    static Bot bots[MAX_BOTS];
+    Schedule schedule;
+    const char *bot_list = "greedy,straight,random";
+    const char *heatmap_prefix = NULL;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    memset(&schedule, 0, sizeof(schedule));
+    schedule.games = 10000;
+    schedule.first_seed = 1;
+    schedule.max_ticks = 5000;
+    schedule.level_kind = -1;
+
+    while ((opt = getopt(argc, argv, "b:g:s:t:l:j:H:")) != -1) {
+        switch (opt) {
+            case 'b': bot_list = optarg; break;
+            case 'g': schedule.games = atol(optarg); break;
+            case 's': schedule.first_seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 't': schedule.max_ticks = atoi(optarg); break;
+            case 'l':
+                schedule.level_kind = level_kind_from_name(optarg);
+                if (schedule.level_kind < 0) {
+                    fprintf(stderr, "unknown level: %s\n", optarg);
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'j': threads = atoi(optarg); break;
+            case 'H': heatmap_prefix = optarg; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    schedule.bot_count = parse_bots(bot_list, bots);
+    if (schedule.bot_count <= 0 || schedule.games < 1 || schedule.max_ticks < 1 ||
+        threads < 1 || threads > 256) {
+        usage(argv[0]);
+        return 1;
+    }
+    schedule.bots = bots;
+
+    Worker workers[256];
+    pthread_t ids[256];
+    int started = 0;
+    struct timeval start, end;
+
+    gettimeofday(&start, NULL);
+    for (int t = 0; t < threads; t++) {
+        workers[t].schedule = &schedule;
+        workers[t].stats = malloc(sizeof(BotStats) * schedule.bot_count);
+        workers[t].heatmap = heatmap_prefix ? malloc(sizeof(Heatmap)) : NULL;
+        if (!workers[t].stats || (heatmap_prefix && !workers[t].heatmap)) {
+            free(workers[t].stats);
+            free(workers[t].heatmap);
+            break;
+        }
+        if (workers[t].heatmap) {
+            heatmap_clear(workers[t].heatmap);
+        }
+        for (int b = 0; b < schedule.bot_count; b++) {
+            init_bot_stats(&workers[t].stats[b]);
+        }
+        if (pthread_create(&ids[t], NULL, tournament_worker, &workers[t]) != 0) {
+            free(workers[t].stats);
+            free(workers[t].heatmap);
+            break;
+        }
+        started++;
+    }
+    if (started == 0) {
+        fprintf(stderr, "cannot start workers\n");
+        return 1;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(ids[t], NULL);
+    }
+    gettimeofday(&end, NULL);
+
+    // Fold every worker into the first one
+    for (int t = 1; t < started; t++) {
+        for (int b = 0; b < schedule.bot_count; b++) {
+            merge_bot_stats(&workers[0].stats[b], &workers[t].stats[b]);
+        }
+        if (heatmap_prefix) {
+            heatmap_merge(workers[0].heatmap, workers[t].heatmap);
+        }
+        free(workers[t].stats);
+        free(workers[t].heatmap);
+    }
+
+    double secs = get_time_diff_us(start, end) / 1e6;
+    printf("%ld seeds x %d bots on %d threads in %.2f s (%.0f games/s)\n",
+           schedule.games, schedule.bot_count, started, secs,
+           schedule.games * schedule.bot_count / secs);
+    print_report(bots, workers[0].stats, schedule.bot_count);
+    if (heatmap_prefix) {
+        if (heatmap_export(workers[0].heatmap, heatmap_prefix) < 0) {
+            fprintf(stderr, "%s: cannot write heatmaps\n", heatmap_prefix);
+        } else {
+            printf("\nheatmaps of %llu games written to %s.csv and %s-*.pgm\n",
+                   (unsigned long long)workers[0].heatmap->games, heatmap_prefix, heatmap_prefix);
+        }
+    }
+
+    free(workers[0].stats);
+    free(workers[0].heatmap);
+    for (int b = 0; b < schedule.bot_count; b++) {
+        free(bots[b].policy);
+    }
+    return 0;
+}